@@ -118,6 +118,7 @@ class iDynLink : public iKin::iKinLink
 {
     friend class iDynChain;
     friend class OneLinkNewtonEuler;
+    friend class OneChainNewtonEuler;
 
 protected:
     // DH rototranslation matrix (it's the same matrix you get calling iKinLink->getH(true) but it's stored here for performance reason)
@@ -553,8 +554,16 @@ protected:
     ///pointer to OneChainNewtonEuler class, to be used for computing forces and torques
     OneChainNewtonEuler *NE;
 
+    ///true if the Newton-Euler propagations run through the allocation-free engine
+    bool fastNE;
+
     const yarp::sig::Vector zero0;
 
+    ///scratch buffers of the Composite Rigid Body Algorithm: links masses, COMs and inertias (N-by-13)
+    yarp::sig::Matrix crbaLinks;
+    ///scratch buffers of the Composite Rigid Body Algorithm: joints axes, origins and composite wrenches (DOF-by-12)
+    yarp::sig::Matrix crbaJoints;
+
     /**
     * Clone function
     */
@@ -820,6 +829,22 @@ public:
     */
     void prepareNewtonEuler(const NewEulMode NewEulMode_s=DYNAMIC);
 
+    /**
+    * Select the engine for the Newton-Euler recursive computations: the
+    * allocation-free engine, which works with fixed-size math on buffers
+    * preallocated by prepareNewtonEuler(), or the original one (default),
+    * which goes through the OneLinkNewtonEuler methods. The choice is kept
+    * across calls to prepareNewtonEuler().
+    * @note BackwardKinematicFromEnd() always runs through the original path.
+    * @param sw true to select the allocation-free engine
+    */
+    void setFastNewtonEuler(const bool sw);
+
+    /**
+    * @return true if the allocation-free Newton-Euler engine is selected
+    */
+    bool getFastNewtonEuler() const { return fastNE; }
+
     /**
     * Compute forces and torques with the Newton-Euler recursive algorithm: forward
     * and backward phase are performed, and results are stored in the links; to get
@@ -1094,6 +1119,7 @@ public:
     /**
     * Compute the joint space mass matrix considering only the active joints.
     * @return a DOF-by-DOF symmetric positive-definite matrix
+    * @note joint velocities and accelerations are set to zero.
     */
     yarp::sig::Matrix computeMassMatrix();
 
@@ -1104,6 +1130,20 @@ public:
     */
     yarp::sig::Matrix computeMassMatrix(const yarp::sig::Vector& q);
 
+    /**
+    * Compute the joint space mass matrix considering only the active joints
+    * by means of the Composite Rigid Body Algorithm, as an alternative to the
+    * Newton-Euler construction of computeMassMatrix(): a single kinematic pass
+    * gives the links inertias in the base frame, which are then accumulated
+    * from the end-effector backward to get the wrench each joint axis sees
+    * under a unit acceleration.
+    * Joint velocities and accelerations are neither used nor modified.
+    * @param M the DOF-by-DOF symmetric positive-definite matrix; it is
+    *          resized only if it has not the right size already, so that
+    *          no memory is allocated once the buffers are in place.
+    */
+    void computeMassMatrixCRBA(yarp::sig::Matrix &M);
+
     /**
     * Compute the torques due to centrifugal and coriolis effects considering only the active joints.
     * @return a DOF-dim vector
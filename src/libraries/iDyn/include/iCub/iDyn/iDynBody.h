@@ -54,6 +54,12 @@
 #include <iCub/iDyn/iDynContact.h>
 #include <deque>
 #include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 
 namespace iCub
@@ -512,6 +518,79 @@ public:
 };
 
 
+/**
+* \ingroup iDynBody
+*
+* A small pool of worker threads used by iDynNode to solve the limbs attached
+* to a node concurrently. The calling thread takes part in the computation and
+* returns only when all the jobs of the batch are completed; between two batches 
+* the workers busy-wait for a short time before going to sleep, so that the
+* consecutive passes of one tick (kinematics, wrenches) are dispatched without 
+* paying the wake-up latency. Workers can be pinned to given CPUs (Linux only).
+* The same pool can be shared by multiple nodes, provided that they are solved
+* by the same thread.
+*/
+class iDynWorkerPool
+{
+private:
+    // Copy constructor: not implemented.
+    iDynWorkerPool(const iDynWorkerPool&);
+    // Assignment operator: not implemented.
+    iDynWorkerPool &operator=(const iDynWorkerPool&);
+
+protected:
+    std::vector<std::thread> workers;
+    std::mutex               mtx;
+    std::condition_variable  cond;
+
+    /// batch ticket: generation (32 bits) | number of jobs (16 bits) | next job (16 bits)
+    std::atomic<unsigned long long> ticket;
+    std::atomic<unsigned int> pending;
+    std::atomic<unsigned int> sleeping;
+    std::atomic<bool>         closing;
+    const std::function<void(unsigned int)> *job;
+    unsigned int generation;
+    double spinTime;
+
+    bool hasJob() const;
+    bool runJob();
+    void workerLoop();
+
+public:
+    /**
+    * Constructor: starts the workers.
+    * @param threads the number of worker threads, in addition to the
+    *                calling one.
+    * @param cpus the CPUs the workers are pinned to (worker i is 
+    *             pinned to cpus[i%cpus.size()]); if empty, the workers
+    *             are left to the scheduler.
+    * @param _spinTime the time in [s] the workers busy-wait for a new
+    *                  batch before going to sleep.
+    */
+    iDynWorkerPool(const unsigned int threads, const std::vector<int> &cpus=std::vector<int>(),
+                   const double _spinTime=200e-6);
+
+    /**
+    * Returns the number of worker threads.
+    * @return the number of worker threads.
+    */
+    unsigned int getNumThreads() const { return (unsigned int)workers.size(); }
+
+    /**
+    * Executes job(0),...,job(n-1) concurrently and waits for their 
+    * completion. The jobs must be independent of each other.
+    * @param n the number of jobs.
+    * @param job the job to be executed.
+    */
+    void run(const unsigned int n, const std::function<void(unsigned int)> &job);
+
+    /**
+    * Destructor: stops the workers.
+    */
+    virtual ~iDynWorkerPool();
+};
+
+
 /**
 * \ingroup iDynBody
 *
@@ -559,11 +638,23 @@ protected:
     /// total mass of the node
     double mass;
 
+    /// the worker pool used to solve the limbs concurrently (NULL = sequential)
+    iDynWorkerPool *pool;
+    /// the indexes of the limbs to be solved in the current pass
+    std::vector<unsigned int> tasks;
+
     /**
     * Reset all data to zero. The list of limbs is not modified or deleted.
     */
     void zero();
 
+    /**
+    * Executes the given task on all the limbs listed in tasks, concurrently 
+    * if a worker pool is set, otherwise sequentially in the listed order.
+    * @param task the task, receiving the index of the limb in the RBT list
+    */
+    void runTasks(const std::function<void(unsigned int)> &task);
+
     /**
     * Compute Pn and H_A_Node matrices given two chains. This function is private, and
     * is used by computeJacobian() and computePose() to merely avoid code duplication.
@@ -728,6 +819,24 @@ public:
     */
     bool solveWrench(const yarp::sig::Matrix &F, const yarp::sig::Matrix &M);
 
+    /**
+    * Set the worker pool used to solve the limbs attached to the node concurrently.
+    * Once the node kinematics/wrench is known, the output limbs are independent of
+    * each other, as well as the input limbs of the wrench pass: these limbs are 
+    * dispatched to the pool, while the node summation is performed after the join,
+    * in the order of insertion of the limbs, so that the results are identical to 
+    * the sequential computation.
+    * @param _pool the worker pool (not owned by the node); NULL restores the 
+    *              sequential computation (default)
+    */
+    void setWorkerPool(iDynWorkerPool *_pool);
+
+    /**
+    * Return the worker pool used to solve the limbs attached to the node.
+    * @return the worker pool, NULL if the computation is sequential
+    */
+    iDynWorkerPool *getWorkerPool() const;
+
     /**
     * Set the wrench measure on the limbs with input wrench
     * @param F a (3xN) matrix with forces
@@ -1475,6 +1584,8 @@ protected:
     /// defining the connection between Upper and Lower Torso
     RigidBodyTransformation * rbt;
     version_tag tag;
+    /// the worker pool shared by UpperTorso and LowerTorso (NULL = sequential)
+    iDynWorkerPool * pool;
 
 public:
 
@@ -1525,6 +1636,37 @@ public:
     */
     bool getCOM(iCub::skinDynLib::BodyPart which_part, yarp::sig::Vector &COM, double & mass);
 
+    /**
+    * Computes the joint space mass matrix of one of the limbs of the iCub
+    * at the current joints configuration of the limb (see iDynChain::computeMassMatrix()).
+    * @param which_part selects the limb (e.g: LEFT_LEG, TORSO, RIGHT_ARM, HEAD, etc..)
+    * @param M the DOF-by-DOF mass matrix of the selected limb
+    * @param crba if true, the matrix is computed through the Composite Rigid Body
+    *        Algorithm (see iDynChain::computeMassMatrixCRBA()), which resizes M only
+    *        if needed, so that it can be preallocated by the caller
+    * @return true if succeeds, false otherwise (e.g. aggregated body parts)
+    */
+    bool computeMassMatrix(iCub::skinDynLib::BodyPart which_part, yarp::sig::Matrix &M,
+                           const bool crba=false);
+
+    /**
+    * Enables the concurrent solution of the limbs attached to UpperTorso and LowerTorso
+    * (see iDynNode::setWorkerPool()). The two nodes are still solved one after the other,
+    * since LowerTorso depends on UpperTorso, but they share the same pool of workers.
+    * @param threads the number of worker threads in addition to the calling one; 0 
+    *                restores the sequential computation (default)
+    * @param cpus the CPUs the workers are pinned to; if empty, the workers are left to
+    *             the scheduler
+    * @return true if succeeds, false otherwise
+    */
+    bool setParallelSolver(const unsigned int threads, const std::vector<int> &cpus=std::vector<int>());
+
+    /**
+    * Return the number of worker threads used to solve the limbs concurrently.
+    * @return the number of worker threads, 0 if the computation is sequential
+    */
+    unsigned int getParallelSolver() const;
+
     /**
     * Retrieves a vector containing the velocities of all the iCub joints, ordered in this way:
     * left leg (6), right leg (6), torso (3), left arm (7), right arm (7), head (3).
@@ -59,7 +59,33 @@ protected:
     // body part related to this solver
     iCub::skinDynLib::BodyPart      bodyPart;
 
+    // factorization cache: the pseudo-inverse of A is reused as long as the contact
+    // set and the configuration of the contact sub-chain do not change
+    bool                cacheEnabled;
+    double              cacheTol;
+    yarp::sig::Vector   cacheKey;
+    yarp::sig::Vector   cacheNewKey;
+    yarp::sig::Matrix   cachePinvA;
+    unsigned long       factorizations;
+    unsigned long       cacheHits;
+
     void findContactSubChain(unsigned int &firstLink, unsigned int &lastLink);
+
+    /**
+     * Fill the signature of the contact sub-chain, i.e. the contacts (link, type, CoP and force 
+     * direction) and the joint angles between firstContactLink and lastContactLink, which A depends on.
+     */
+    void buildCacheKey(unsigned int firstContactLink, unsigned int lastContactLink, yarp::sig::Vector &key);
+
+    /**
+     * Check whether the cached pseudo-inverse of A can be reused with the given signature.
+     */
+    bool isCacheValid(const yarp::sig::Vector &key) const;
+
+    /**
+     * Initialize the factorization cache.
+     */
+    void initCache();
     
     yarp::sig::Matrix buildA(unsigned int firstContactLink, unsigned int lastContactLink);
     yarp::sig::Vector buildB(unsigned int firstContactLink, unsigned int lastContactLink);
@@ -155,6 +181,34 @@ public:
      */
     void computeWrenchFromSensorNewtonEuler();
 
+    /**
+     * Enable/disable the caching of the pseudo-inverse of the linear system solved by 
+     * computeExternalContacts(). The matrix of the system depends only on the contacts
+     * (link, CoP, force direction, known moment) and on the configuration of the joints
+     * of the contact sub-chain: as long as these are unchanged, only the known term is 
+     * recomputed and the SVD is skipped. The cache is enabled by default.
+     * @param enable true/false to enable/disable the cache
+     * @param tol the tolerance used to compare CoPs, force directions and joint angles
+     *            with the ones of the cached factorization; 0 (default) requires an exact
+     *            match, so that the results are identical to the ones obtained without cache
+     */
+    void setFactorizationCache(const bool enable, const double tol=0.0);
+
+    /**
+     * @return true if the factorization cache is enabled
+     */
+    bool getFactorizationCache() const;
+
+    /**
+     * @return the number of factorizations (SVD) of the linear system carried out so far
+     */
+    unsigned long getFactorizationNumber() const;
+
+    /**
+     * @return the number of times the cached factorization has been reused so far
+     */
+    unsigned long getCacheHitNumber() const;
+
     //***************************************************************************************
     // GET METHODS
     //***************************************************************************************
@@ -51,6 +51,7 @@
 #include <iCub/skinDynLib/common.h>
 #include <deque>
 #include <string>
+#include <vector>
 
 
 namespace iCub
@@ -94,6 +95,8 @@ const std::string ChainComputationMode_s[4] = {"Kinematic Forward - Wrench Forwa
 */
 class OneLinkNewtonEuler
 {
+    friend class OneChainNewtonEuler;
+
 protected:
 
     /// STATIC/DYNAMIC/DYNAMIC_W_ROTOR/DYNAMIC_CORIOLIS_GRAVITY
@@ -490,6 +493,8 @@ public:
 */
 class BaseLinkNewtonEuler : public OneLinkNewtonEuler
 {
+    friend class OneChainNewtonEuler;
+
 protected:
     ///initial angular velocity
     yarp::sig::Vector w;    
@@ -901,6 +906,46 @@ protected:
     /// verbosity flag
     unsigned int verbose;
 
+    /// true if the propagations run through the allocation-free engine
+    bool fastEngine;
+    /// rotation R and distance r (projected) of each link, contiguous (12 doubles per link)
+    std::vector<double> frames;
+
+    /**
+     * Fills the frames buffer straight from the Denavit-Hartenberg parameters of the links.
+     */
+    void updateFrames();
+
+    /**
+     * Returns the rotation (row-major 3x3) of the i-th element of neChain.
+     */
+    const double *frameR(unsigned int i) const;
+
+    /**
+     * Returns the distance r (projected) of the i-th element of neChain.
+     */
+    const double *framer(unsigned int i) const;
+
+    /**
+     * Allocation-free counterpart of ForwardKinematics() for the elements from..to of neChain.
+     */
+    void fastForwardKinematics(unsigned int from, unsigned int to);
+
+    /**
+     * Allocation-free counterpart of BackwardWrench() for the elements from..to (from>=to) of neChain.
+     */
+    void fastBackwardWrench(int from, int to);
+
+    /**
+     * Allocation-free counterpart of ForwardWrench() for the elements from..to of neChain.
+     */
+    void fastForwardWrench(unsigned int from, unsigned int to);
+
+    /**
+     * Allocation-free counterpart of computeTorque() for the elements from..to (from>=to) of neChain.
+     */
+    void fastTorques(int from, int to);
+
 public:
 
   /**
@@ -959,6 +1004,21 @@ public:
     void setVerbose(unsigned int verb=iCub::skinDynLib::VERBOSE);
     void setMode(const NewEulMode _mode);
     void setInfo(const std::string _info);
+
+    /**
+    * Enables/disables the allocation-free engine, which performs the
+    * propagations with fixed-size math on preallocated buffers instead
+    * of going through the OneLinkNewtonEuler methods (default disabled).
+    * BackwardKinematicFromEnd() is not covered and always runs through
+    * the OneLinkNewtonEuler methods.
+    * @param sw true to enable the engine
+    */
+    void setFastEngine(const bool sw);
+
+    /**
+    * @return true if the allocation-free engine is enabled
+    */
+    bool getFastEngine() const;
     
     /**
     * [classic] Initialize the base with measured or known kinematics variables
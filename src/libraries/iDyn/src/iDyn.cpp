@@ -477,6 +477,7 @@ iDynChain::iDynChain()
 : iKinChain()
 {
     NE=NULL;
+    fastNE=false;
     setIterMode(KINFWD_WREBWD);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -488,6 +489,7 @@ void iDynChain::clone(const iDynChain &c)
     iterateMode_kinematics = c.iterateMode_kinematics;
     iterateMode_wrench = c.iterateMode_wrench;
     NE = c.NE;
+    fastNE = c.fastNE;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void iDynChain::build()
@@ -924,6 +926,14 @@ void iDynChain::prepareNewtonEuler(const NewEulMode NewEulMode_s)
     if( NE != NULL)
         delete NE;
     NE = new OneChainNewtonEuler(const_cast<iDynChain *>(this),info,NewEulMode_s,verbose);
+    NE->setFastEngine(fastNE);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynChain::setFastNewtonEuler(const bool sw)
+{
+    fastNE = sw;
+    if( NE != NULL)
+        NE->setFastEngine(fastNE);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iDynChain::computeNewtonEuler(const Vector &w0, const Vector &dw0, const Vector &ddp0, const Vector &F0, const Vector &Mu0 )
@@ -1640,6 +1650,134 @@ Matrix iDynChain::computeMassMatrix()
     return M;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynChain::computeMassMatrixCRBA(Matrix &M)
+{
+    if((M.rows()!=DOF) || (M.cols()!=DOF))
+        M.resize(DOF,DOF);
+    if(crbaLinks.rows()!=N)
+        crbaLinks.resize(N,13);
+    if(crbaJoints.rows()!=DOF)
+        crbaJoints.resize(DOF,12);
+
+    // forward pass: the joint axes and, for each link, the mass, the COM
+    // and the inertia (about the COM) expressed in the base frame
+    double R[9], p[3], Rn[9];
+    for(int r=0; r<3; r++)
+    {
+        for(int c=0; c<3; c++)
+            R[3*r+c] = H0(r,c);
+        p[r] = H0(r,3);
+    }
+
+    unsigned int j=0;
+    for(unsigned int k=0; k<N; k++)
+    {
+        iDynLink *l = refLink(k);
+        if(!l->isBlocked())
+        {
+            double *a = crbaJoints.data()+12*j;
+            a[0]=R[2]; a[1]=R[5]; a[2]=R[8];    // z axis of frame k-1
+            a[3]=p[0]; a[4]=p[1]; a[5]=p[2];    // origin of frame k-1
+            j++;
+        }
+
+        const Matrix &H = l->getH();
+        for(int r=0; r<3; r++)
+        {
+            const double *Rr = R+3*r;
+            for(int c=0; c<3; c++)
+                Rn[3*r+c] = Rr[0]*H(0,c) + Rr[1]*H(1,c) + Rr[2]*H(2,c);
+            p[r] += Rr[0]*H(0,3) + Rr[1]*H(1,3) + Rr[2]*H(2,3);
+        }
+        for(int i=0; i<9; i++)
+            R[i] = Rn[i];
+
+        const Vector &rc = l->getrC();
+        const Matrix &I = l->getInertia();
+        double *b = crbaLinks.data()+13*k;
+        b[0] = l->getMass();
+        for(int r=0; r<3; r++)
+            b[1+r] = p[r] + R[3*r]*rc[0] + R[3*r+1]*rc[1] + R[3*r+2]*rc[2];
+
+        // R*I, then (R*I)*R'
+        double RI[9];
+        for(int r=0; r<3; r++)
+            for(int c=0; c<3; c++)
+                RI[3*r+c] = R[3*r]*I(0,c) + R[3*r+1]*I(1,c) + R[3*r+2]*I(2,c);
+        for(int r=0; r<3; r++)
+            for(int c=0; c<3; c++)
+                b[4+3*r+c] = RI[3*r]*R[3*c] + RI[3*r+1]*R[3*c+1] + RI[3*r+2]*R[3*c+2];
+    }
+
+    // backward pass: accumulate the composite bodies from the end-effector
+    // and compute the wrench (about the base origin) needed to give a unit
+    // acceleration to the joint with the whole subtree attached
+    double S0=0.0;                  // sum of m
+    double S1[3]={0.0,0.0,0.0};     // sum of m*c
+    double S2[9]={0.0};             // sum of m*c*c'
+    double SI[9]={0.0};             // sum of I
+    j=DOF;
+    for(int k=N-1; k>=0; k--)
+    {
+        const double *b = crbaLinks.data()+13*k;
+        const double m = b[0];
+        S0 += m;
+        for(int r=0; r<3; r++)
+        {
+            S1[r] += m*b[1+r];
+            for(int c=0; c<3; c++)
+                S2[3*r+c] += m*b[1+r]*b[1+c];
+        }
+        for(int i=0; i<9; i++)
+            SI[i] += b[4+i];
+
+        if(allList[k]->isBlocked())
+            continue;
+
+        double *a = crbaJoints.data()+12*(--j);
+        const double *z = a;
+        const double *o = a+3;
+
+        // first moment and second moment of the subtree w.r.t. the joint origin
+        double s[3], P[9];
+        for(int r=0; r<3; r++)
+            s[r] = S1[r] - S0*o[r];
+        for(int r=0; r<3; r++)
+            for(int c=0; c<3; c++)
+                P[3*r+c] = S2[3*r+c] - S1[r]*o[c] - o[r]*S1[c] + S0*o[r]*o[c];
+        const double trP = P[0]+P[4]+P[8];
+
+        // n = Ic*z with Ic = SI + tr(P)*eye - P, i.e. the inertia about o
+        double n[3];
+        for(int r=0; r<3; r++)
+            n[r] = trP*z[r] + (SI[3*r]-P[3*r])*z[0] + (SI[3*r+1]-P[3*r+1])*z[1] + (SI[3*r+2]-P[3*r+2])*z[2];
+
+        // f = z x s, and the moment is moved to the base origin
+        double *f = a+9;
+        f[0] = z[1]*s[2] - z[2]*s[1];
+        f[1] = z[2]*s[0] - z[0]*s[2];
+        f[2] = z[0]*s[1] - z[1]*s[0];
+        a[6] = n[0] + o[1]*f[2] - o[2]*f[1];
+        a[7] = n[1] + o[2]*f[0] - o[0]*f[2];
+        a[8] = n[2] + o[0]*f[1] - o[1]*f[0];
+    }
+
+    // project the wrenches onto the motion subspace of the parent joints
+    for(unsigned int i=0; i<DOF; i++)
+    {
+        const double *z = crbaJoints.data()+12*i;
+        const double *o = z+3;
+        const double v[3] = { o[1]*z[2] - o[2]*z[1],
+                              o[2]*z[0] - o[0]*z[2],
+                              o[0]*z[1] - o[1]*z[0] };
+        for(unsigned int jj=i; jj<DOF; jj++)
+        {
+            const double *w = crbaJoints.data()+12*jj+6;
+            M(i,jj) = M(jj,i) = z[0]*w[0] + z[1]*w[1] + z[2]*w[2] + v[0]*w[3] + v[1]*w[4] + v[2]*w[5];
+        }
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Matrix iDynChain::computeMassMatrix(const Vector& q)
 {
     setAng(q);
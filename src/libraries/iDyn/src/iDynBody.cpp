@@ -20,6 +20,12 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <chrono>
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
 
 #include <iCub/iDyn/iDyn.h>
 #include <iCub/iDyn/iDynBody.h>
@@ -34,6 +40,8 @@ using namespace iCub::iDyn;
 using namespace iCub::skinDynLib;
 
 // #define DEBUG_FOOT_COM
+
+#define POOL_MAX_JOBS   0xffff
 //====================================
 //
 //      RIGID BODY TRANSFORMATION
@@ -406,6 +414,131 @@ Matrix RigidBodyTransformation::getHCOM(unsigned int iLink)
 
 
 
+//====================================
+//
+//      i DYN WORKER POOL
+//
+//====================================
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+iDynWorkerPool::iDynWorkerPool(const unsigned int threads, const vector<int> &cpus, const double _spinTime)
+:ticket(0), pending(0), sleeping(0), closing(false)
+{
+    job=NULL;
+    generation=0;
+    spinTime=_spinTime;
+
+    for(unsigned int i=0; i<threads; i++)
+    {
+        workers.push_back(thread(&iDynWorkerPool::workerLoop,this));
+#ifdef __linux__
+        if(cpus.size()>0)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus[i%cpus.size()],&set);
+            if(pthread_setaffinity_np(workers.back().native_handle(),sizeof(set),&set)!=0)
+                fprintf(stderr,"iDynWorkerPool: warning, could not pin worker %d to CPU %d \n",i,cpus[i%cpus.size()]);
+        }
+#endif
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynWorkerPool::hasJob() const
+{
+    unsigned long long t=ticket.load();
+    return ((t&POOL_MAX_JOBS)<((t>>16)&POOL_MAX_JOBS));
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynWorkerPool::runJob()
+{
+    // the ticket carries the generation of the batch and its size, hence
+    // a job can be claimed only within the batch it belongs to
+    unsigned long long t=ticket.load();
+    while((t&POOL_MAX_JOBS)<((t>>16)&POOL_MAX_JOBS))
+    {
+        if(ticket.compare_exchange_weak(t,t+1))
+        {
+            // the batch cannot be closed until this job is completed,
+            // hence job still points to the current task
+            (*job)((unsigned int)(t&POOL_MAX_JOBS));
+            pending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynWorkerPool::workerLoop()
+{
+    while(!closing.load())
+    {
+        if(runJob())
+            continue;
+
+        // busy-wait for the next batch
+        bool found=false;
+        chrono::steady_clock::time_point t0=chrono::steady_clock::now();
+        while(!closing.load() && (chrono::duration<double>(chrono::steady_clock::now()-t0).count()<spinTime))
+        {
+            if(hasJob())
+            {
+                found=true;
+                break;
+            }
+            this_thread::yield();
+        }
+
+        if(!found)
+        {
+            unique_lock<mutex> lck(mtx);
+            sleeping++;
+            cond.wait(lck,[this]{ return (closing.load() || hasJob()); });
+            sleeping--;
+        }
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynWorkerPool::run(const unsigned int n, const function<void(unsigned int)> &_job)
+{
+    if(workers.empty() || (n<2) || (n>POOL_MAX_JOBS))
+    {
+        for(unsigned int i=0; i<n; i++)
+            _job(i);
+        return;
+    }
+
+    job=&_job;
+    pending.store(n);
+    generation++;
+    ticket.store(((unsigned long long)generation<<32)|((unsigned long long)n<<16));
+
+    // the lock guarantees that no sleeping worker misses the notification
+    if(sleeping.load()>0)
+    {
+        lock_guard<mutex> lck(mtx);
+        cond.notify_all();
+    }
+
+    // the calling thread takes part in the batch, then waits for the jobs 
+    // still running on the workers
+    while(runJob());
+    while(pending.load()>0)
+        this_thread::yield();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+iDynWorkerPool::~iDynWorkerPool()
+{
+    {
+        lock_guard<mutex> lck(mtx);
+        closing.store(true);
+        cond.notify_all();
+    }
+
+    for(size_t i=0; i<workers.size(); i++)
+        workers[i].join();
+}
+
 //====================================
 //
 //      i DYN NODE
@@ -418,6 +551,7 @@ iDynNode::iDynNode(const NewEulMode _mode)
     rbtList.clear();
     mode = _mode;
     verbose = iCub::skinDynLib::VERBOSE;
+    pool = NULL;
     zero();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -427,6 +561,7 @@ iDynNode::iDynNode(const string &_info, const NewEulMode _mode, unsigned int ver
     rbtList.clear();
     mode = _mode;
     verbose = verb;
+    pool = NULL;
     zero();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -439,6 +574,25 @@ void iDynNode::zero()
     Mu.resize(3); Mu.zero();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynNode::runTasks(const function<void(unsigned int)> &task)
+{
+    if((pool!=NULL) && (tasks.size()>1))
+        pool->run((unsigned int)tasks.size(),[&](unsigned int k){ task(tasks[k]); });
+    else
+        for(size_t k=0; k<tasks.size(); k++)
+            task(tasks[k]);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynNode::setWorkerPool(iDynWorkerPool *_pool)
+{
+    pool = _pool;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+iDynWorkerPool *iDynNode::getWorkerPool() const
+{
+    return pool;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void iDynNode::addLimb(iDynLimb *limb, const Matrix &H, const FlowType kinFlow, const FlowType wreFlow, bool hasSensor)
 {
     string infoRbt = limb->getType() + " to node";
@@ -483,16 +637,19 @@ bool iDynNode::solveKinematics()
     if(inputNode==1)
     {
         //now forward the kinematic input from limbs whose kinematic flow is input type
+        //these limbs are independent, hence they can be solved concurrently
+        tasks.clear();
         for(unsigned int i=0; i<rbtList.size(); i++)
-        {
             if(rbtList[i].getKinematicFlow()==RBT_NODE_OUT)
-            {
-                //init the kinematics with the node information
-                rbtList[i].setKinematic(w,dw,ddp);
-                //solve kinematics in that limb/chain
-                rbtList[i].computeLimbKinematic();
-            }
-        }
+                tasks.push_back(i);
+
+        runTasks([this](unsigned int i)
+        {
+            //init the kinematics with the node information
+            rbtList[i].setKinematic(w,dw,ddp);
+            //solve kinematics in that limb/chain
+            rbtList[i].computeLimbKinematic();
+        });
         return true;
     
     }
@@ -532,16 +689,19 @@ bool iDynNode::solveKinematics(const Vector &w0, const Vector &dw0, const Vector
     if(inputNode==1)
     {
         //now forward the kinematic input from limbs whose kinematic flow is input type
+        //these limbs are independent, hence they can be solved concurrently
+        tasks.clear();
         for(unsigned int i=0; i<rbtList.size(); i++)
-        {
             if(rbtList[i].getKinematicFlow()==RBT_NODE_OUT)
-            {
-                //init the kinematics with the node information
-                rbtList[i].setKinematic(w,dw,ddp);
-                //solve kinematics in that limb/chain
-                rbtList[i].computeLimbKinematic();
-            }
-        }
+                tasks.push_back(i);
+
+        runTasks([this](unsigned int i)
+        {
+            //init the kinematics with the node information
+            rbtList[i].setKinematic(w,dw,ddp);
+            //solve kinematics in that limb/chain
+            rbtList[i].computeLimbKinematic();
+        });
         return true;
     
     }
@@ -595,19 +755,26 @@ bool iDynNode::solveWrench()
     //first get the forces/moments from each limb
     //assuming that each limb has been properly set with the outcoming measured
     //forces/moments which are necessary for the wrench computation
+    //the wrench pass of these limbs is independent, hence they can be solved concurrently
+    tasks.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
+        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)
+            tasks.push_back(i);
+
+    runTasks([this](unsigned int i)
     {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
-        {
-            //compute the wrench pass in that limb
-            rbtList[i].computeLimbWrench();
-            //update the node force/moment with the wrench coming from the limb base/end
-            // note that getWrench sum the result to F,Mu - because they are passed by reference
-            // F = F + F[i], Mu = Mu + Mu[i]
-            rbtList[i].getWrench(F,Mu);
-            //check
-            outputNode++;
-        }
+        //compute the wrench pass in that limb
+        rbtList[i].computeLimbWrench();
+    });
+
+    for(size_t k=0; k<tasks.size(); k++)
+    {
+        //update the node force/moment with the wrench coming from the limb base/end
+        // note that getWrench sum the result to F,Mu - because they are passed by reference
+        // F = F + F[i], Mu = Mu + Mu[i]
+        rbtList[tasks[k]].getWrench(F,Mu);
+        //check
+        outputNode++;
     }
 
     // node summation: already performed by each RBT
@@ -628,16 +795,18 @@ bool iDynNode::solveWrench()
     }
 
     //now forward the wrench output from the node to limbs whose wrench flow is output type
+    tasks.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
-    {
         if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
-        {
-            //init the wrench with the node information
-            rbtList[i].setWrench(F,Mu);
-            //solve wrench in that limb/chain
-            rbtList[i].computeLimbWrench();
-        }
-    }
+            tasks.push_back(i);
+
+    runTasks([this](unsigned int i)
+    {
+        //init the wrench with the node information
+        rbtList[i].setWrench(F,Mu);
+        //solve wrench in that limb/chain
+        rbtList[i].computeLimbWrench();
+    });
     return true;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1358,25 +1527,31 @@ bool iDynSensorNode::solveWrench()
     //first get the forces/moments from each limb
     //assuming that each limb has been properly set with the outcoming measured
     //forces/moments which are necessary for the wrench computation
+    //the wrench pass of these limbs is independent, hence they can be solved concurrently
+    tasks.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
+        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)
+            tasks.push_back(i);
+
+    runTasks([this](unsigned int i)
     {
-        if(rbtList[i].getWrenchFlow()==RBT_NODE_IN)         
-        {
-            //compute the wrench pass in that limb
-            // if there's a sensor, we must use iDynSensor
-            // otherwise we use the limb method as usual
-            if(rbtList[i].isSensorized()==true)
-                sensorList[i]->computeWrenchFromSensorNewtonEuler();
-            else
-                rbtList[i].computeLimbWrench();
+        //compute the wrench pass in that limb
+        // if there's a sensor, we must use iDynSensor
+        // otherwise we use the limb method as usual
+        if(rbtList[i].isSensorized()==true)
+            sensorList[i]->computeWrenchFromSensorNewtonEuler();
+        else
+            rbtList[i].computeLimbWrench();
+    });
 
-            //update the node force/moment with the wrench coming from the limb base/end
-            // note that getWrench sum the result to F,Mu - because they are passed by reference
-            // F = F + F[i], Mu = Mu + Mu[i]
-            rbtList[i].getWrench(F,Mu);
-            //check
-            outputNode++;
-        }
+    for(size_t k=0; k<tasks.size(); k++)
+    {
+        //update the node force/moment with the wrench coming from the limb base/end
+        // note that getWrench sum the result to F,Mu - because they are passed by reference
+        // F = F + F[i], Mu = Mu + Mu[i]
+        rbtList[tasks[k]].getWrench(F,Mu);
+        //check
+        outputNode++;
     }
 
     // node summation: already performed by each RBT
@@ -1397,16 +1572,18 @@ bool iDynSensorNode::solveWrench()
 
     //now forward the wrench output from the node to limbs whose wrench flow is output type
     // assuming they don't have a FT sensor
+    tasks.clear();
     for(unsigned int i=0; i<rbtList.size(); i++)
-    {
         if(rbtList[i].getWrenchFlow()==RBT_NODE_OUT)
-        {
-            //init the wrench with the node information
-            rbtList[i].setWrench(F,Mu);
-            //solve wrench in that limb/chain
-            rbtList[i].computeLimbWrench();
-        }
-    }
+            tasks.push_back(i);
+
+    runTasks([this](unsigned int i)
+    {
+        //init the wrench with the node information
+        rbtList[i].setWrench(F,Mu);
+        //solve wrench in that limb/chain
+        rbtList[i].computeLimbWrench();
+    });
     return true;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -2401,6 +2578,7 @@ iCubWholeBody::iCubWholeBody(version_tag _tag, const NewEulMode mode, unsigned i
 {
     //create all limbs
     tag = _tag;
+    pool = NULL;
     upperTorso = new iCubUpperTorso(tag,mode,verbose);
     lowerTorso = new iCubLowerTorso(tag,mode,verbose);
     
@@ -2416,6 +2594,7 @@ iCubWholeBody::~iCubWholeBody()
     if (upperTorso) delete upperTorso; upperTorso = NULL;
     if (lowerTorso) delete lowerTorso; lowerTorso = NULL;
     if (rbt)        delete rbt;        rbt        = NULL;
+    if (pool)       delete pool;       pool       = NULL;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void iCubWholeBody::attachLowerTorso(const Vector &FM_right_leg, const Vector &FM_left_leg)
@@ -2603,6 +2782,48 @@ bool iCubWholeBody::getCOM(BodyPart which_part, Vector &COM, double & mass)
     return true;
 }
 
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iCubWholeBody::computeMassMatrix(BodyPart which_part, Matrix &M, const bool crba)
+{
+    iDynLimb *limb;
+    switch (which_part)
+    {
+        case LEFT_LEG:  limb=lowerTorso->left;  break;
+        case RIGHT_LEG: limb=lowerTorso->right; break;
+        case TORSO:     limb=lowerTorso->up;    break;
+        case LEFT_ARM:  limb=upperTorso->left;  break;
+        case RIGHT_ARM: limb=upperTorso->right; break;
+        case HEAD:      limb=upperTorso->up;    break;
+        default:
+            return false;
+    }
+    if (crba)
+        limb->computeMassMatrixCRBA(M);
+    else
+        M=limb->computeMassMatrix();
+    return true;
+}
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iCubWholeBody::setParallelSolver(const unsigned int threads, const vector<int> &cpus)
+{
+    upperTorso->setWorkerPool(NULL);
+    lowerTorso->setWorkerPool(NULL);
+    if (pool) delete pool; pool = NULL;
+
+    if (threads>0)
+    {
+        pool = new iDynWorkerPool(threads,cpus);
+        upperTorso->setWorkerPool(pool);
+        lowerTorso->setWorkerPool(pool);
+    }
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+unsigned int iCubWholeBody::getParallelSolver() const
+{
+    return (pool!=NULL ? pool->getNumThreads() : 0);
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool iCubWholeBody::getAllPositions(Vector &pos)
 {
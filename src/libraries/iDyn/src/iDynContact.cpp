@@ -20,6 +20,7 @@
 #include <iCub/iDyn/iDynContact.h>
 #include <yarp/math/SVD.h>
 #include <stdio.h>
+#include <cmath>
 
 using namespace std;
 using namespace yarp::sig;
@@ -37,7 +38,10 @@ using namespace iCub::skinDynLib;
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 iDynContactSolver::iDynContactSolver(iDynChain *_c, const string &_info, const NewEulMode _mode, BodyPart _bodyPart, unsigned int verb)
-:iDynSensor(_c, _info, _mode, verb), bodyPart(_bodyPart){}
+:iDynSensor(_c, _info, _mode, verb), bodyPart(_bodyPart)
+{
+    initCache();
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 iDynContactSolver::iDynContactSolver(iDynChain *_c, unsigned int sensLink, SensorLinkNewtonEuler *sensor, 
                                     const string &_info, const NewEulMode _mode, BodyPart _bodyPart, unsigned int verb)
@@ -45,11 +49,15 @@ iDynContactSolver::iDynContactSolver(iDynChain *_c, unsigned int sensLink, Senso
 {
     lSens = sensLink;
     sens = sensor;
+    initCache();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 iDynContactSolver::iDynContactSolver(iDynChain *_c, unsigned int sensLink, const Matrix &_H, const Matrix &_HC, double _m, 
                                      const Matrix &_I, const string &_info, const NewEulMode _mode, BodyPart _bodyPart, unsigned int verb)
-:iDynSensor(_c, sensLink, _H, _HC, _m, _I, _info, _mode, verb), bodyPart(_bodyPart){}
+:iDynSensor(_c, sensLink, _H, _HC, _m, _I, _info, _mode, verb), bodyPart(_bodyPart)
+{
+    initCache();
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 iDynContactSolver::~iDynContactSolver(){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -138,10 +146,27 @@ const dynContactList& iDynContactSolver::computeExternalContacts()
 
     // BUILD AND SOLVE THE LINEAR SYSTEM AX=B RELATIVE TO THE CONTACT SUB-CHAIN
     // the reference frame is the <firstContactLink-1> 
-    Matrix A = buildA(firstContactLink, lastContactLink);
+    // A (hence its pseudo-inverse) is refactorized only if the contacts or the configuration
+    // of the contact sub-chain changed, while B depends on the dynamics and is always rebuilt
+    if(cacheEnabled)
+    {
+        buildCacheKey(firstContactLink, lastContactLink, cacheNewKey);
+        if(isCacheValid(cacheNewKey))
+            cacheHits++;
+        else
+        {
+            cachePinvA = pinv(buildA(firstContactLink, lastContactLink), TOLLERANCE);
+            cacheKey = cacheNewKey;
+            factorizations++;
+        }
+    }
+    else
+    {
+        cachePinvA = pinv(buildA(firstContactLink, lastContactLink), TOLLERANCE);
+        factorizations++;
+    }
     Vector B = buildB(firstContactLink, lastContactLink);
-    Matrix pinv_A = pinv(A, TOLLERANCE);
-    Vector X = pinv_A * B;
+    Vector X = cachePinvA * B;
     
     // SET THE COMPUTED VALUES IN THE CONTACT LIST
     unsigned int unknownInd = 0;
@@ -185,6 +210,28 @@ void iDynContactSolver::computeWrenchFromSensorNewtonEuler()
     chain->NE->computeTorques();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynContactSolver::setFactorizationCache(const bool enable, const double tol)
+{
+    cacheEnabled = enable;
+    cacheTol = tol;
+    cacheKey.resize(0);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynContactSolver::getFactorizationCache() const
+{
+    return cacheEnabled;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+unsigned long iDynContactSolver::getFactorizationNumber() const
+{
+    return factorizations;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+unsigned long iDynContactSolver::getCacheHitNumber() const
+{
+    return cacheHits;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Matrix iDynContactSolver::buildA(unsigned int firstContactLink, unsigned int lastContactLink)
 {
     unsigned int unknownNum = getUnknownNumber();
@@ -338,6 +385,55 @@ Matrix iDynContactSolver::getHFromAtoB(unsigned int a, unsigned int b)
     return H;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynContactSolver::initCache()
+{
+    cacheEnabled = true;
+    cacheTol = 0.0;
+    cacheKey.resize(0);
+    factorizations = 0;
+    cacheHits = 0;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void iDynContactSolver::buildCacheKey(unsigned int firstContactLink, unsigned int lastContactLink, Vector &key)
+{
+    // the key is laid out as:
+    // [first last | link type CoP(3) dir(3) | ... | q(first) ... q(last)]
+    // so that keys of different contact sets differ at least by 1 in the integer fields
+    key.resize(2 + 8*contactList.size() + lastContactLink-firstContactLink+1);
+    unsigned int k = 0;
+    key[k++] = firstContactLink;
+    key[k++] = lastContactLink;
+
+    for(dynContactList::const_iterator it=contactList.begin(); it!=contactList.end(); it++)
+    {
+        key[k++] = it->getLinkNumber();
+        key[k++] = (it->isMomentKnown() ? 2 : 0) + (it->isForceDirectionKnown() ? 1 : 0);
+
+        const Vector &CoP = it->getCoP();
+        for(unsigned int i=0; i<3; i++)
+            key[k++] = CoP[i];
+
+        const Vector &dir = it->getForceDirection();
+        for(unsigned int i=0; i<3; i++)
+            key[k++] = it->isForceDirectionKnown() ? dir[i] : 0.0;
+    }
+
+    for(unsigned int i=firstContactLink; i<=lastContactLink; i++)
+        key[k++] = chain->refLink(i)->getAng();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool iDynContactSolver::isCacheValid(const Vector &key) const
+{
+    if(key.length()!=cacheKey.length())
+        return false;
+
+    for(size_t i=0; i<key.length(); i++)
+        if(fabs(key[i]-cacheKey[i])>cacheTol)
+            return false;
+
+    return true;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 Vector iDynContactSolver::projectContact2Root(const dynContact &c)
 {
     Vector wrench = c.getForceMoment();
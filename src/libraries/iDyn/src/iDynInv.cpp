@@ -35,6 +35,51 @@ using namespace iCub::iKin;
 using namespace iCub::iDyn;
 using namespace iCub::skinDynLib;
 
+#define NE_FRAME_SIZE       12      // R (3x3) + r (3) of each link in OneChainNewtonEuler::frames
+
+namespace
+{
+    // fixed-size helpers of the allocation-free Newton-Euler engine;
+    // 3x3 matrices are stored row-major, as yarp::sig::Matrix does
+
+    // o=R*v
+    inline void mulRv(const double *R, const double *v, double *o)
+    {
+        o[0]=R[0]*v[0]+R[1]*v[1]+R[2]*v[2];
+        o[1]=R[3]*v[0]+R[4]*v[1]+R[5]*v[2];
+        o[2]=R[6]*v[0]+R[7]*v[1]+R[8]*v[2];
+    }
+
+    // o=R'*v
+    inline void mulRtv(const double *R, const double *v, double *o)
+    {
+        o[0]=R[0]*v[0]+R[3]*v[1]+R[6]*v[2];
+        o[1]=R[1]*v[0]+R[4]*v[1]+R[7]*v[2];
+        o[2]=R[2]*v[0]+R[5]*v[1]+R[8]*v[2];
+    }
+
+    // o=a x b
+    inline void crossv(const double *a, const double *b, double *o)
+    {
+        o[0]=a[1]*b[2]-a[2]*b[1];
+        o[1]=a[2]*b[0]-a[0]*b[2];
+        o[2]=a[0]*b[1]-a[1]*b[0];
+    }
+
+    // o+=k*(a x b)
+    inline void addCross(const double *a, const double *b, const double k, double *o)
+    {
+        o[0]+=k*(a[1]*b[2]-a[2]*b[1]);
+        o[1]+=k*(a[2]*b[0]-a[0]*b[2]);
+        o[2]+=k*(a[0]*b[1]-a[1]*b[0]);
+    }
+
+    inline void copy3(const double *v, double *o)
+    {
+        o[0]=v[0]; o[1]=v[1]; o[2]=v[2];
+    }
+}
+
 
 //================================
 //
@@ -1708,6 +1753,9 @@ OneChainNewtonEuler::OneChainNewtonEuler(iDynChain *_c, string _info, const NewE
     //the end effector is the last (nLinks+2-1 because it's an index)
     nEndEff = nLinks+1;
 
+    //buffers of the allocation-free engine
+    fastEngine = false;
+    frames.assign(NE_FRAME_SIZE*nLinks,0.0);
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 OneChainNewtonEuler::~OneChainNewtonEuler()
@@ -1815,6 +1863,16 @@ void OneChainNewtonEuler::setInfo(const string _info)
     info=_info;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::setFastEngine(const bool sw)
+{
+    fastEngine=sw;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+bool OneChainNewtonEuler::getFastEngine() const
+{
+    return fastEngine;
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 bool OneChainNewtonEuler::initKinematicBase(const Vector &w0,const Vector &dw0,const Vector &ddp0)
 {
     return neChain[0]->setAsBase(w0,dw0,ddp0);
@@ -1850,6 +1908,13 @@ NewEulMode  OneChainNewtonEuler::getMode()      const       {return mode;}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void OneChainNewtonEuler::ForwardKinematicFromBase()
 {
+    if(fastEngine)
+    {
+        updateFrames();
+        fastForwardKinematics(1,nEndEff-1);
+        return;
+    }
+
     for(unsigned int i=1;i<nEndEff;i++)
     {
         neChain[i]->ForwardKinematics(neChain[i-1]);
@@ -1882,6 +1947,14 @@ void OneChainNewtonEuler::BackwardKinematicFromEnd(const Vector &_w, const Vecto
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void OneChainNewtonEuler::BackwardWrenchFromEnd()
 {    
+    if(fastEngine)
+    {
+        updateFrames();
+        fastBackwardWrench(nEndEff-1,0);
+        fastTorques(nEndEff-1,1);
+        return;
+    }
+
     for(int i=nEndEff-1; i>=0; i--)
         neChain[i]->BackwardWrench(neChain[i+1]);
 
@@ -1891,6 +1964,12 @@ void OneChainNewtonEuler::BackwardWrenchFromEnd()
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 void OneChainNewtonEuler::computeTorques()
 {
+    if(fastEngine)
+    {
+        fastTorques(nEndEff-1,1);
+        return;
+    }
+
     for(int i=nEndEff-1; i>0; i--){
         neChain[i]->computeTorque(neChain[i-1]);
     }
@@ -1933,6 +2012,13 @@ bool OneChainNewtonEuler::ForwardWrenchToEnd(unsigned int lSens)
         // indexed lSens+2 = lSens + baseLink + the next one
         // that's because link lSens = neChain[lSens+1] is already set before
         // with a specific sensor method
+        if(fastEngine)
+        {
+            updateFrames();
+            fastForwardWrench(lSens+2,nEndEff-1);
+            return true;
+        }
+
         for(unsigned int i=lSens+2; i<nEndEff; i++)
             neChain[i]->ForwardWrench(neChain[i-1]);
         return true;
@@ -1954,6 +2040,14 @@ bool OneChainNewtonEuler::BackwardWrenchToBase(unsigned int lSens)
         // indexed lSens = lSens + baseLink - the previous one
         // that's because link lSens = neChain[lSens+1] is already set before
         // with a specific sensor method
+        if(fastEngine)
+        {
+            updateFrames();
+            fastBackwardWrench(lSens,0);
+            fastTorques(lSens+1,1);
+            return true;
+        }
+
         for(int i=lSens; i>=0; i--){
             neChain[i]->BackwardWrench(neChain[i+1]);
         }
@@ -1979,6 +2073,13 @@ bool OneChainNewtonEuler::ForwardWrenchFromAtoB(unsigned int lA, unsigned int lB
     if( (lB >= lA) && (lB <=nLinks))
     {
         // link lA --> neChain[lA+1] (same for B)
+        if(fastEngine)
+        {
+            updateFrames();
+            fastForwardWrench(lA+1,lB+1);
+            return true;
+        }
+
         for(unsigned int i=lA+1; i<=lB+1; i++){
             // the torques are automatically computed inside the "ForwardWrench" method
             neChain[i]->ForwardWrench(neChain[i-1]);
@@ -1999,6 +2100,14 @@ bool OneChainNewtonEuler::BackwardWrenchFromAtoB(unsigned int lA, unsigned int l
     {
         // link lA --> neChain[lA+1] (same for B)
         // note: it's int and not unsigned int to avoid problems when decrementing
+        if(fastEngine)
+        {
+            updateFrames();
+            fastBackwardWrench(lA+1,lB+1);
+            fastTorques(lA+2,lB+2);
+            return true;
+        }
+
         for(int i=lA+1; i>=(int)(lB+1); i--){
             neChain[i]->BackwardWrench(neChain[i+1]);
         }
@@ -2015,6 +2124,252 @@ bool OneChainNewtonEuler::BackwardWrenchFromAtoB(unsigned int lA, unsigned int l
     }
 }
 
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+    //   allocation-free engine
+    //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::updateFrames()
+{
+    // same as iDynLink::getR() and iDynLink::getr(true), without going through the H matrix
+    for(unsigned int i=0; i<nLinks; i++)
+    {
+        const iDynLink *l = neChain[i+1]->link;
+        const double theta = l->getAng()+l->getOffset();
+        const double ct = cos(theta),         st = sin(theta);
+        const double ca = cos(l->getAlpha()), sa = sin(l->getAlpha());
+        double *R = &frames[NE_FRAME_SIZE*i];
+        double *r = R+9;
+
+        R[0]=ct;  R[1]=-st*ca; R[2]=st*sa;
+        R[3]=st;  R[4]=ct*ca;  R[5]=-ct*sa;
+        R[6]=0.0; R[7]=sa;     R[8]=ca;
+
+        r[0]=l->getA();
+        r[1]=sa*l->getD();
+        r[2]=ca*l->getD();
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const double *OneChainNewtonEuler::frameR(unsigned int i) const
+{
+    if((i>0) && (i<nEndEff))
+        return &frames[NE_FRAME_SIZE*(i-1)];
+    return neChain[i]->getR().data();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+const double *OneChainNewtonEuler::framer(unsigned int i) const
+{
+    if((i>0) && (i<nEndEff))
+        return &frames[NE_FRAME_SIZE*(i-1)+9];
+    return neChain[i]->getr(true).data();
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::fastForwardKinematics(unsigned int from, unsigned int to)
+{
+    for(unsigned int i=from; i<=to; i++)
+    {
+        const OneLinkNewtonEuler *prev = neChain[i-1];
+        iDynLink *l = neChain[i]->link;
+        const double *R = frameR(i);
+        const double *r = framer(i);
+        const double *pw = prev->getAngVel().data();
+        const double *pdw = prev->getAngAcc().data();
+        const double *pddp = prev->getLinAcc().data();
+        double *w = l->w.data();
+        double *dw = l->dw.data();
+        double *ddp = l->ddp.data();
+        double *ddpC = l->ddpC.data();
+        double t[3];
+
+        if(neChain[i]->mode==STATIC)
+        {
+            w[0]=w[1]=w[2]=0.0;
+            dw[0]=dw[1]=dw[2]=0.0;
+            mulRtv(R,pddp,ddp);
+            copy3(ddp,ddpC);
+            continue;
+        }
+
+        // w = R'*(w_prev + dq*z0)
+        copy3(pw,t);
+        t[2]+=l->dq;
+        mulRtv(R,t,w);
+
+        // dw = R'*(dw_prev + ddq*z0 + dq*w_prev x z0)
+        t[0]=pdw[0]+l->dq*pw[1];
+        t[1]=pdw[1]-l->dq*pw[0];
+        t[2]=pdw[2];
+        if(neChain[i]->mode!=DYNAMIC_CORIOLIS_GRAVITY)
+            t[2]+=l->ddq;
+        mulRtv(R,t,dw);
+
+        // ddp = R'*ddp_prev + dw x r + w x (w x r)
+        mulRtv(R,pddp,ddp);
+        addCross(dw,r,1.0,ddp);
+        crossv(w,r,t);
+        addCross(w,t,1.0,ddp);
+
+        // ddpC = ddp + dw x rC + w x (w x rC)
+        const double *rc = l->rc.data();
+        copy3(ddp,ddpC);
+        addCross(dw,rc,1.0,ddpC);
+        crossv(w,rc,t);
+        addCross(w,t,1.0,ddpC);
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::fastBackwardWrench(int from, int to)
+{
+    // the final frame has no next element
+    if(from>=(int)nEndEff)
+        from=nEndEff-1;
+
+    for(int i=from; i>=to; i--)
+    {
+        OneLinkNewtonEuler *next = neChain[i+1];
+        const NewEulMode m = neChain[i]->mode;
+        const double *Rn = frameR(i+1);
+        const double *rn = framer(i+1);
+        const double *Fn = next->getForce().data();
+        const double *Mun = next->getMoment(false).data();
+
+        // the wrench (F,Mu) expressed in the frame of the next element, then rotated
+        double f[6], t[3], a[3], s[3];
+        const double *ddpC = next->getLinAccC().data();
+        const double mass = next->getMass();
+        a[0]=mass*ddpC[0]; a[1]=mass*ddpC[1]; a[2]=mass*ddpC[2];
+
+        t[0]=a[0]+Fn[0]; t[1]=a[1]+Fn[1]; t[2]=a[2]+Fn[2];
+        mulRv(Rn,t,f);
+
+        const double *rc = next->getrC().data();
+        s[0]=rn[0]+rc[0]; s[1]=rn[1]+rc[1]; s[2]=rn[2]+rc[2];
+        crossv(rn,Fn,t);
+        addCross(s,a,1.0,t);
+        t[0]+=Mun[0]; t[1]+=Mun[1]; t[2]+=Mun[2];
+        if(m!=STATIC)
+        {
+            const double *I = next->getInertia().data();
+            const double *w = next->getAngVel().data();
+            const double *dw = next->getAngAcc().data();
+            double Iw[3], Idw[3];
+            mulRv(I,dw,Idw);
+            mulRv(I,w,Iw);
+            t[0]+=Idw[0]; t[1]+=Idw[1]; t[2]+=Idw[2];
+            addCross(w,Iw,1.0,t);
+        }
+        mulRv(Rn,t,f+3);
+
+        if(m==DYNAMIC_W_ROTOR)
+        {
+            // rotor terms, w.r.t. the next link
+            const double *zm = next->zm.data();
+            const double kIm = next->getKr()*next->getIm();
+            const double k = kIm*next->getD2q();
+            f[3]+=k*zm[0]; f[4]+=k*zm[1]; f[5]+=k*zm[2];
+            addCross(next->getAngVel().data(),zm,kIm*next->getDq(),f+3);
+        }
+
+        if(i>0)
+        {
+            iDynLink *l = neChain[i]->link;
+            copy3(f,l->F.data());
+            copy3(f+3,l->Mu.data());
+        }
+        else
+        {
+            // the base stores the wrench rotated by H0, and the unrotated moment apart
+            BaseLinkNewtonEuler *base = static_cast<BaseLinkNewtonEuler*>(neChain[0]);
+            const Matrix &H0 = base->H0;
+            for(int j=0; j<3; j++)
+            {
+                base->F[j] = H0(j,0)*f[0]+H0(j,1)*f[1]+H0(j,2)*f[2];
+                base->Mu[j] = H0(j,0)*f[3]+H0(j,1)*f[4]+H0(j,2)*f[5];
+            }
+            if(base->Mu0.length()!=3)
+                base->Mu0.resize(3);
+            copy3(f+3,base->Mu0.data());
+        }
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::fastForwardWrench(unsigned int from, unsigned int to)
+{
+    for(unsigned int i=from; i<=to; i++)
+    {
+        // the final frame has no link to be filled in
+        if(i==nEndEff)
+        {
+            neChain[i]->ForwardWrench(neChain[i-1]);
+            continue;
+        }
+
+        const OneLinkNewtonEuler *prev = neChain[i-1];
+        iDynLink *l = neChain[i]->link;
+        const NewEulMode m = neChain[i]->mode;
+        const double *R = frameR(i);
+        const double *r = framer(i);
+        double *F = l->F.data();
+        double *Mu = l->Mu.data();
+        double a[3], s[3], t[3];
+
+        // F = R'*F_prev - m*ddpC
+        a[0]=l->m*l->ddpC[0]; a[1]=l->m*l->ddpC[1]; a[2]=l->m*l->ddpC[2];
+        mulRtv(R,prev->getForce().data(),F);
+        F[0]-=a[0]; F[1]-=a[1]; F[2]-=a[2];
+
+        // Mu = R'*Mu_prev - r x F - (r+rC) x m*ddpC [- I*dw - w x I*w]
+        copy3(prev->getMoment(false).data(),t);
+        if(m==DYNAMIC_W_ROTOR)
+        {
+            const double *zm = neChain[i]->zm.data();
+            const double kIm = l->kr*l->Im;
+            const double k = kIm*l->ddq;
+            t[0]-=k*zm[0]; t[1]-=k*zm[1]; t[2]-=k*zm[2];
+            addCross(l->w.data(),zm,-kIm*l->dq,t);
+        }
+        mulRtv(R,t,Mu);
+        addCross(r,F,-1.0,Mu);
+        s[0]=r[0]+l->rc[0]; s[1]=r[1]+l->rc[1]; s[2]=r[2]+l->rc[2];
+        addCross(s,a,-1.0,Mu);
+        if(m!=STATIC)
+        {
+            const double *I = l->I.data();
+            const double *w = l->w.data();
+            double Iw[3], Idw[3];
+            mulRv(I,l->dw.data(),Idw);
+            mulRv(I,w,Iw);
+            Mu[0]-=Idw[0]; Mu[1]-=Idw[1]; Mu[2]-=Idw[2];
+            addCross(w,Iw,-1.0,Mu);
+        }
+
+        fastTorques(i,i);
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+void OneChainNewtonEuler::fastTorques(int from, int to)
+{
+    // the final frame has no torque
+    if(from>=(int)nEndEff)
+        from=nEndEff-1;
+
+    for(int i=from; i>=to; i--)
+    {
+        iDynLink *l = neChain[i]->link;
+        double tau = neChain[i-1]->getMoment(true)[2];
+        if(neChain[i]->mode==DYNAMIC_W_ROTOR)
+        {
+            const double *dwM = l->dwM.data();
+            const double *zm = neChain[i]->zm.data();
+            tau += l->kr*l->Im*(dwM[0]*zm[0]+dwM[1]*zm[1]+dwM[2]*zm[2])
+                   + l->Fv*l->dq + l->Fs*sign(l->dq);
+        }
+        l->Tau = tau;
+    }
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
 //======================================
 //
 //            iDYN INV SENSOR
@@ -55,6 +55,7 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 
 #include <yarp/os/Property.h>
 #include <yarp/dev/ControlBoardInterfaces.h>
@@ -99,6 +100,10 @@ protected:
     bool         constrained;
     unsigned int verbose;
 
+    // incremented whenever the link matrix changes, so that
+    // the chains can tell whether their cached pass is stale
+    unsigned long stamp;
+
     yarp::sig::Matrix H;
     yarp::sig::Matrix cumH;
     yarp::sig::Matrix DnH;
@@ -191,7 +196,7 @@ public:
     * Sets the Link length A. 
     * @param new Link length _A. 
     */
-    void setA(const double _A) { A=_A; }
+    void setA(const double _A) { A=_A; stamp++; }
 
     /**
     * Returns the Link offset D.
@@ -227,7 +232,7 @@ public:
     * Sets the joint angle offset. 
     * @param new joint angle offset _Offset. 
     */
-    void setOffset(const double _Offset) { Offset=_Offset; }
+    void setOffset(const double _Offset) { Offset=_Offset; stamp++; }
 
     /**
     * Returns the joint angle lower bound.
@@ -370,10 +375,44 @@ protected:
     yarp::sig::Matrix hess_J;
     yarp::sig::Matrix hess_Jlnk;
 
+    // forward-kinematics cache: H0 followed by the N intermediate
+    // frames, the N link matrices and the end-effector frame
+    // (4x4 row-major each) along allList, as in GeoJacobian(); when
+    // some links are blocked, the same quantities along quickList,
+    // as in getH(); the pass is refreshed only when the chain is
+    // marked as dirty or the stamp of one link has changed
+    std::vector<double>        fwd_intH;
+    std::vector<double>        fwd_linkH;
+    double                     fwd_endEffH[16];
+    std::vector<double>        fwd_quickIntH;
+    std::vector<double>        fwd_quickLinkH;
+    double                     fwd_quickEndEffH[16];
+    std::vector<unsigned long> fwd_stamps;
+    bool                       fwd_cumul;
+    bool                       fwd_dirty;
+    yarp::sig::Matrix          fwd_J;
+    std::vector<double>        fwd_batchZP;
+    bool                       fwd_cacheOn;
+    bool                       fwd_JValid;
+    size_t                     fwd_hits;
+    size_t                     fwd_misses;
+
     virtual void clone(const iKinChain &c);
     virtual void build();
     virtual void dispose();
 
+    void updateAng(const yarp::sig::Vector &q);
+    void fastLinkH(const iKinLink *l, const bool c_override, double *H) const;
+    void fastLinkDH(const iKinLink *l, const bool c_override, double *DH) const;
+    bool isFwdKinValid() const;
+    void updateFwdKin();
+    const double *quickEndEffH() const;
+    const yarp::sig::Matrix &updateGeoJacobian();
+    void fastAnaJacobianCol(const double *intH, const double *linkH, const double *DL,
+                            const unsigned int j, const unsigned int n, const bool cumulHN,
+                            const double *H, const unsigned int col, yarp::sig::Matrix &J,
+                            const unsigned int c);
+
     yarp::sig::Vector RotAng(const yarp::sig::Matrix &R);
     yarp::sig::Vector dRotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dR);
     yarp::sig::Vector d2RotAng(const yarp::sig::Matrix &R, const yarp::sig::Matrix &dRi,
@@ -858,6 +897,116 @@ public:
     */
     yarp::sig::Matrix DJacobian(const unsigned int lnk, const yarp::sig::Vector &dq);
 
+    /**
+    * Fills the rigid roto-translation matrix from the root 
+    * reference frame to the end-effector frame (HN is taken into 
+    * account). 
+    * <i>Fast Version</i>: fixed-size 4x4 products are carried out 
+    * on the stack and no temporary is allocated. 
+    * @param H is the output 4x4 matrix; it is resized only if 
+    *          needed.
+    * @note The sequence of products is the same of getH().
+    */
+    void fastGetH(yarp::sig::Matrix &H);
+
+    /**
+    * Fills the coordinates of end-effector. 
+    * <i>Fast Version</i>: no temporary is allocated. 
+    * @param pose is the output vector (6x1 or 7x1); it is resized 
+    *             only if needed.
+    * @param axisRep if true returns the axis/angle notation. 
+    * @note The sequence of products is the same of EndEffPose().
+    */
+    void fastEndEffPose(yarp::sig::Vector &pose, const bool axisRep=true);
+
+    /**
+    * Fills the coordinates of end-effector computed in q. 
+    * <i>Fast Version</i>: no temporary is allocated. 
+    * @param q is the vector of new DOF values. 
+    * @param pose is the output vector (6x1 or 7x1); it is resized 
+    *             only if needed.
+    * @param axisRep if true returns the axis/angle notation. 
+    */
+    void fastEndEffPose(const yarp::sig::Vector &q, yarp::sig::Vector &pose,
+                        const bool axisRep=true);
+
+    /**
+    * Fills the geometric Jacobian of the end-effector. 
+    * <i>Fast Version</i>: the intermediate frames are stored in a 
+    * workspace preallocated by the chain and no temporary is 
+    * allocated. 
+    * @param J is the output 6xDOF matrix; it is resized only if 
+    *          needed.
+    * @note The sequence of products is the same of GeoJacobian().
+    */
+    void fastGeoJacobian(yarp::sig::Matrix &J);
+
+    /**
+    * Fills the geometric Jacobian of the end-effector computed in 
+    * q. 
+    * <i>Fast Version</i>: no temporary is allocated. 
+    * @param q is the vector of new DOF values. 
+    * @param J is the output 6xDOF matrix; it is resized only if 
+    *          needed.
+    */
+    void fastGeoJacobian(const yarp::sig::Vector &q, yarp::sig::Matrix &J);
+
+    /**
+    * Computes the end-effector poses and, optionally, the geometric 
+    * Jacobians for a batch of M joint configurations. 
+    * The DH link products are evaluated over several configurations 
+    * at once with vectorized kernels (AVX2 when iKin is compiled with 
+    * ICUB_IKIN_USE_AVX2 and the CPU supports it, plain scalar code 
+    * otherwise). 
+    * @param Q is the DOFxM matrix in structure-of-arrays layout: 
+    *          the ith row collects the values of the ith DOF for all 
+    *          the M configurations. 
+    * @param poses is the output 7xM (6xM) matrix whose columns are 
+    *              the end-effector poses; it is resized only if
+    *              needed.
+    * @param J if not NULL is filled with the (6*DOF)xM matrix whose 
+    *          mth column is the row-major 6xDOF geometric Jacobian
+    *          of the mth configuration.
+    * @param axisRep if true returns the axis/angle notation. 
+    * @return true/false on success/failure. 
+    * @note The joints are bounded as in setAng() but the state of 
+    *       the chain is not modified; H0 and HN are assumed to be
+    *       rigid roto-translations.
+    */
+    bool batchEndEffPose(const yarp::sig::Matrix &Q, yarp::sig::Matrix &poses,
+                         yarp::sig::Matrix *J=NULL, const bool axisRep=true);
+
+    /**
+    * Enables/disables the forward-kinematics cache. 
+    * When enabled, one forward pass computed for a given set of 
+    * joint angles, blocked links, H0 and HN serves all the 
+    * successive queries of poses, Jacobians and Hessians until one 
+    * of those quantities changes (enabled by default). 
+    * The products are carried out in the same sequence of the 
+    * uncached methods, so the results do not depend on the cache.
+    * @param enable if true the cache is used. 
+    */
+    void setFwdKinCache(const bool enable);
+
+    /**
+    * Returns the status of the forward-kinematics cache.
+    * @return true if the cache is used.
+    */
+    bool getFwdKinCache() const { return fwd_cacheOn; }
+
+    /**
+    * Returns the statistics of the forward-kinematics cache.
+    * @param hits is the number of queries served without 
+    *             recomputing the forward pass.
+    * @param misses is the number of forward passes carried out.
+    */
+    void getFwdKinCacheStats(size_t &hits, size_t &misses) const;
+
+    /**
+    * Resets the statistics of the forward-kinematics cache.
+    */
+    void resetFwdKinCacheStats() { fwd_hits=fwd_misses=0; }
+
     /**
     * Destructor. 
     */
@@ -50,6 +50,9 @@ protected:
     static void addVectorOption(yarp::os::Bottle &b, const int vcb, const yarp::sig::Vector &v);
     static bool getDesiredOption(const yarp::os::Bottle &reply, yarp::sig::Vector &xdhat,
                                  yarp::sig::Vector &odhat, yarp::sig::Vector &qdhat);
+    static bool getDesiredBatchOption(const yarp::os::Bottle &reply, yarp::sig::Matrix &xdhat,
+                                      yarp::sig::Matrix &odhat, yarp::sig::Matrix &qdhat,
+                                      yarp::sig::Matrix &res);
 
 public:
     /**
@@ -59,6 +62,14 @@ public:
     */
     static void addTargetOption(yarp::os::Bottle &b, const yarp::sig::Vector &xd);
 
+    /**
+    * Appends to a bottle all data needed to ask for a batch of 
+    * targets. 
+    * @param b is the bottle where to append the data.
+    * @param xd is the matrix whose rows are the targets.
+    */
+    static void addTargetsOption(yarp::os::Bottle &b, const yarp::sig::Matrix &xd);
+
     /**
     * Appends to a bottle all data needed to reconfigure chain's 
     * dof. 
@@ -117,6 +128,14 @@ public:
     */
     static yarp::os::Bottle *getTargetOption(const yarp::os::Bottle &b);
 
+    /**
+    * Retrieves the batch of targets data from a bottle.
+    * @param b is the bottle containing the data to be retrieved.
+    * @return a pointer to the sub-bottle containing the list of 
+    *         targets.
+    */
+    static yarp::os::Bottle *getTargetsOption(const yarp::os::Bottle &b);
+
     /**
     * Retrieves the end-effector pose data.
     * @param b is the bottle containing the data to be retrieved.
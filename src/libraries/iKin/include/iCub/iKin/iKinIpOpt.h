@@ -26,8 +26,17 @@
 #ifndef __IKINIPOPT_H__
 #define __IKINIPOPT_H__
 
+#include <cstddef>
+
 #include <iCub/iKin/iKinInv.h>
 
+#define IKINIPOPT_CACHE_DEFAULT_SIZE        64
+#define IKINIPOPT_CACHE_DEFAULT_WARMTOL     0.02    // [m] and [rad]
+#define IKINIPOPT_CACHE_DEFAULT_REUSETOL    1e-4    // [m] and [rad]
+#define IKINIPOPT_SOLVED_FROM_CACHE         100     // exit code of a solution taken from the cache
+#define IKINIPOPT_SOLVED_ANALYTICALLY       101     // exit code of a solution of the closed-form inversion
+#define IKINANALYTIC_DEFAULT_SWIVEL_SAMPLES 36
+#define IKINANALYTIC_DEFAULT_TOL            1e-6    // [m] and [rad]
 
 namespace iCub
 {
@@ -60,6 +69,24 @@ public:
 };
 
 
+/**
+* \ingroup iKinIpOpt
+*
+* Structure collecting the statistics of the solution cache of
+* iKinIpOptMin.
+*/
+struct iKinSolutionCacheStats
+{
+    size_t solves;      // requests handled while the cache was enabled
+    size_t reuses;      // requests answered straight from the cache
+    size_t warmStarts;  // optimizations seeded with a cached solution
+    size_t coldStarts;  // optimizations without any usable neighbour
+    size_t warmIters;   // iterations spent in warm-started optimizations
+    size_t coldIters;   // iterations spent in cold-started optimizations
+    double itersSaved;  // iterations saved w.r.t. the mean cold run
+};
+
+
 /**
 * \ingroup iKinIpOpt
 *
@@ -190,6 +217,147 @@ public:
 };
 
 
+/**
+* \ingroup iKinIpOpt
+*
+* Class for the closed-form inverse kinematics of the iCub arm. 
+*  
+* The shoulder and the wrist of the iCub arm are spherical 
+* joints, hence, once the torso is blocked, the wrist center 
+* depends only on the elbow angle and on the rotation of the 
+* shoulder. The elbow angle is thus retrieved from the distance 
+* between the shoulder and the wrist centers, whereas the 
+* residual redundancy is parametrized through the swivel angle 
+* of the arm about the line connecting the two centers. For 
+* each sampled swivel angle the shoulder and wrist angles are 
+* found in closed form and all the branches of the solution are 
+* checked against the joints bounds and the linear inequality 
+* constraints (e.g. iCubAdditionalArmConstraints). Among the 
+* feasible candidates, the one minimizing the same secondary 
+* objectives of iKinIpOptMin (plus a small term rewarding the 
+* proximity to the starting configuration) is refined locally 
+* and returned. 
+*  
+* @note The solver applies only to the full pose control with 
+*       the torso blocked and the arm joints released; when the
+*       arm structure is not supported (e.g. the wrist of hw
+*       3.0 is not spherical) or no feasible solution is found,
+*       the caller is expected to fall back on iKinIpOptMin.
+*/
+class iCubArmAnalyticSolver
+{
+private:
+    // Default constructor: not implemented.
+    iCubArmAnalyticSolver();
+    // Copy constructor: not implemented.
+    iCubArmAnalyticSolver(const iCubArmAnalyticSolver&);
+    // Assignment operator: not implemented.
+    iCubArmAnalyticSolver &operator=(const iCubArmAnalyticSolver&);
+
+protected:
+    iKinChain         *chain;
+    iKinLinIneqConstr  noLIC;
+    iKinLinIneqConstr *pLIC;
+
+    int    swivelSamples;
+    double tol;
+
+public:
+    /**
+    * Constructor. 
+    * @param arm the iCubArm object. 
+    * @param swivelSamples the number of samples used to explore 
+    *                      the swivel angle.
+    */
+    iCubArmAnalyticSolver(iCubArm &arm,
+                          const int swivelSamples=IKINANALYTIC_DEFAULT_SWIVEL_SAMPLES);
+
+    /**
+    * Attach a iKinLinIneqConstr object in order to impose 
+    * constraints of the form lB <= C*q <= uB on the solutions. 
+    * @param lic is the iKinLinIneqConstr object to attach.
+    */
+    void attachLIC(iKinLinIneqConstr &lic) { pLIC=&lic; }
+
+    /**
+    * Returns a reference to the attached Linear Inequality
+    * Constraints object.
+    * @return Linear Inequality Constraints pLIC. 
+    */
+    iKinLinIneqConstr &getLIC() { return *pLIC; }
+
+    /**
+    * Sets the number of samples used to explore the swivel angle.
+    * @param samples the number of samples (at least 4).
+    */
+    void setSwivelSamples(const int samples);
+
+    /**
+    * Returns the number of samples used to explore the swivel 
+    * angle. 
+    * @return the number of samples.
+    */
+    int getSwivelSamples() const { return swivelSamples; }
+
+    /**
+    * Sets the tolerance used to validate the solution against the
+    * desired pose.
+    * @param tol the tolerance in [m] and [rad].
+    */
+    void setTol(const double tol);
+
+    /**
+    * Retrieves the tolerance used to validate the solution.
+    * @return the tolerance.
+    */
+    double getTol() const { return tol; }
+
+    /**
+    * Checks whether the current chain configuration (DH 
+    * structure and blocked/released status of the links) can be 
+    * handled by the closed-form solution. 
+    * @return true/false on supported/unsupported configuration.
+    */
+    bool isSupported() const;
+
+    /**
+    * Executes the closed-form inversion. The chain state is not 
+    * modified. 
+    * @param q0 the starting joint configuration (DOF entries). 
+    * @param xd the desired pose (7 components: position and 
+    *           orientation in axis/angle representation).
+    * @param qd the solution (DOF entries), filled only on success.
+    * @param weight2ndTask weight for the elbow position task 
+    *                      (see iKinIpOptMin::solve); the elbow is
+    *                      meant as the origin of the frame 
+    *                      attached to the last shoulder's link.
+    * @param xd_2nd desired elbow position.
+    * @param w_2nd weights of the elbow position components. 
+    * @param weight3rdTask weight for the joints rest position 
+    *                      task.
+    * @param qd_3rd joints rest position.
+    * @param w_3rd weights of the joints rest position components. 
+    * @return true iff a feasible solution reaching the pose 
+    *         within the tolerance has been found.
+    */
+    bool solve(const yarp::sig::Vector &q0, const yarp::sig::Vector &xd,
+               yarp::sig::Vector &qd,
+               const double weight2ndTask, const yarp::sig::Vector &xd_2nd,
+               const yarp::sig::Vector &w_2nd, const double weight3rdTask,
+               const yarp::sig::Vector &qd_3rd, const yarp::sig::Vector &w_3rd);
+
+    /**
+    * Executes the closed-form inversion without secondary tasks.
+    * @param q0 the starting joint configuration (DOF entries). 
+    * @param xd the desired pose (7 components).
+    * @param qd the solution (DOF entries), filled only on success.
+    * @return true iff a feasible solution has been found.
+    */
+    bool solve(const yarp::sig::Vector &q0, const yarp::sig::Vector &xd,
+               yarp::sig::Vector &qd);
+};
+
+
 /**
 * \ingroup iKinIpOpt
 *
@@ -207,6 +375,7 @@ private:
 
 protected:
     void *App;
+    void *cache;
 
     iKinChain &chain;
     iKinChain chain2ndTask;
@@ -285,7 +454,7 @@ public:
     * @param lic is the iKinLinIneqConstr object to attach.
     * @see iKinLinIneqConstr
     */
-    void attachLIC(iKinLinIneqConstr &lic) { pLIC=&lic; }
+    void attachLIC(iKinLinIneqConstr &lic) { pLIC=&lic; clearSolutionCache(); }
 
     /**
     * Returns a reference to the attached Linear Inequality 
@@ -411,6 +580,61 @@ public:
     */
     void setBoundsInf(const double lower, const double upper);
 
+    /**
+    * Enables/disables the cache of recent target-solution pairs 
+    * (disabled at start-up by default). 
+    * @param enable true to enable the cache. 
+    * @param maxSize maximum number of stored solutions; when full, 
+    *                the oldest one is discarded.
+    * @param warmTol distance in [m] (and [rad] for the orientation
+    *                part) within which a cached solution, along
+    *                with its multipliers, is used to warm-start
+    *                the optimization.
+    * @param reuseTol distance within which a cached solution is 
+    *                 returned straight away without running the
+    *                 optimization at all. The same tolerance is
+    *                 applied to the weighted targets of the
+    *                 secondary and third tasks, to the angles of
+    *                 blocked links and to the initial joints q0.
+    * @note The cache is emptied whenever its settings change. 
+    *       Entries are matched only against requests issued with
+    *       the same DH parameters, joints limits, pose control
+    *       and priority, tasks weights and linear constraints.
+    *       Before being returned, a cached solution is checked to
+    *       attain in the current chain the pose it attained when
+    *       it was stored.
+    */
+    void setSolutionCache(const bool enable,
+                          const size_t maxSize=IKINIPOPT_CACHE_DEFAULT_SIZE,
+                          const double warmTol=IKINIPOPT_CACHE_DEFAULT_WARMTOL,
+                          const double reuseTol=IKINIPOPT_CACHE_DEFAULT_REUSETOL);
+
+    /**
+    * Returns the current settings of the solution cache. 
+    * @param maxSize if not NULL, returns the maximum size. 
+    * @param warmTol if not NULL, returns the warm-start tolerance.
+    * @param reuseTol if not NULL, returns the reuse tolerance. 
+    * @return true iff the cache is enabled. 
+    */
+    bool getSolutionCache(size_t *maxSize=NULL, double *warmTol=NULL,
+                          double *reuseTol=NULL) const;
+
+    /**
+    * Removes all the stored solutions from the cache. 
+    */
+    void clearSolutionCache();
+
+    /**
+    * Retrieves the statistics of the solution cache. 
+    * @return the statistics.
+    */
+    iKinSolutionCacheStats getSolutionCacheStats() const;
+
+    /**
+    * Resets the statistics of the solution cache. 
+    */
+    void resetSolutionCacheStats();
+
     /**
     * Executes the IpOpt algorithm trying to converge on target. 
     * @param q0 is the vector of initial joint angles values. 
@@ -448,6 +672,14 @@ public:
     *               default).
     * @param iterate pointer to a callback object (NULL by default). 
     * @return estimated joint angles.
+    *  
+    * @note When the solution cache is enabled, a request falling 
+    *       within the reuse tolerance of a cached one is answered
+    *       without optimizing (IKINIPOPT_SOLVED_FROM_CACHE is
+    *       returned as exit code and the callback is not invoked),
+    *       whereas a request falling
+    *       within the warm-start tolerance is seeded with the
+    *       cached primal and dual variables.
     */
     virtual yarp::sig::Vector solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
                                     double weight2ndTask, yarp::sig::Vector &xd_2nd, yarp::sig::Vector &w_2nd,
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+/**
+ * \defgroup iKinReach iKinReach
+ *
+ * @ingroup iKin
+ *
+ * Classes for precomputing the reachability of serial-links
+ * chains and iCub limbs.
+ *
+ * The workspace of a limb is sampled offline and stored in a
+ * voxel grid, where each occupied voxel retains the set of
+ * reachable approach directions, the best manipulability
+ * measure found and the corresponding joints configuration.
+ * The map is saved as a flat binary file that is memory-mapped
+ * at runtime, so that reachability and seed queries cost a
+ * constant-time lookup.
+ *
+ */
+
+#ifndef __IKINREACH_H__
+#define __IKINREACH_H__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <iCub/iKin/iKinFwd.h>
+
+#define IKINREACH_DIR_BINS          26
+#define IKINREACH_MAX_LINKS         32
+
+namespace iCub
+{
+
+namespace iKin
+{
+
+/**
+* \ingroup iKinReach
+*
+* Class for building and querying the reachability map of a
+* limb.
+*
+* Positions are expressed in the root reference frame of the
+* limb, whereas approach directions are given by the z-axis of
+* the end-effector frame, quantized in 26 bins. The map is bound
+* to the DH parameters of the links, to their blocked/released
+* status and to the H0 and HN matrices used to build it (see
+* isCompatible()). The joints limits are stored as well but they
+* are accounted for only at query time (see coversLimits() and
+* getSeed()).
+*/
+class iKinReachMap
+{
+private:
+    // Copy constructor: not implemented.
+    iKinReachMap(const iKinReachMap&);
+    // Assignment operator: not implemented.
+    iKinReachMap &operator=(const iKinReachMap&);
+
+protected:
+    std::vector<char> buffer;
+    void       *mapping;
+    const char *data;
+    size_t      length;
+
+    bool   setData(const char *_data, const size_t _length);
+    int    getVoxel(const yarp::sig::Vector &xd) const;
+    const char *getEntry(const yarp::sig::Vector &xd) const;
+
+public:
+    /**
+    * Default constructor.
+    */
+    iKinReachMap();
+
+    /**
+    * Samples the workspace of the limb and builds the map in
+    * memory, replacing the current content.
+    * @param limb the limb to be sampled; its configuration is not
+    *             modified.
+    * @param voxelSize the size of the voxels in [m].
+    * @param samples the number of random joints configurations.
+    * @param threads the number of threads sampling in parallel;
+    *                0 selects the number of available cores.
+    * @param seed the seed of the random generators.
+    * @return true/false on success/failure.
+    */
+    bool build(iKinLimb &limb, const double voxelSize,
+               const size_t samples, const int threads=0,
+               const unsigned int seed=0);
+
+    /**
+    * Saves the map to file.
+    * @param fileName the file name.
+    * @return true/false on success/failure.
+    */
+    bool save(const std::string &fileName) const;
+
+    /**
+    * Loads the map from file by memory-mapping it, replacing the
+    * current content.
+    * @param fileName the file name.
+    * @return true/false on success/failure.
+    */
+    bool load(const std::string &fileName);
+
+    /**
+    * Releases the map.
+    */
+    void clear();
+
+    /**
+    * Checks whether the map contains valid data.
+    * @return true/false on valid/invalid map.
+    */
+    bool isValid() const { return (data!=NULL); }
+
+    /**
+    * Checks whether the map can be used with the given chain,
+    * i.e. whether the chain shares the same geometry (DH
+    * parameters), the same blocked/released status and the same
+    * H0 and HN matrices, up to 1e-6.
+    * @param chain the chain to compare against.
+    * @return true/false on compatible/incompatible chain.
+    */
+    bool isCompatible(iKinChain &chain) const;
+
+    /**
+    * Checks whether the map is compatible with the given chain
+    * and the current joints limits of the chain lie within the
+    * ones used to build the map, so that a target outside the
+    * map is unreachable for the chain as well.
+    * @param chain the chain to compare against.
+    * @return true/false if the map covers/does not cover the
+    *         chain's limits.
+    */
+    bool coversLimits(iKinChain &chain) const;
+
+    /**
+    * Returns the size of the voxels.
+    * @return the voxel size in [m] (0 if the map is invalid).
+    */
+    double getVoxelSize() const;
+
+    /**
+    * Returns the number of degrees of freedom of the seeds.
+    * @return the number of DOF.
+    */
+    unsigned int getDOF() const;
+
+    /**
+    * Returns the number of occupied voxels.
+    * @return the number of occupied voxels.
+    */
+    size_t getNumVoxels() const;
+
+    /**
+    * Checks whether a target is reachable.
+    * @param xd the target position (3 components) or pose (7
+    *           components, with the orientation in axis/angle
+    *           representation).
+    * @param margin if positive, the position is deemed reachable
+    *               when any of the voxels within the given
+    *               distance (in voxels) from the target is
+    *               occupied; the orientation is not checked in
+    *               this case.
+    * @return true/false on reachable/unreachable target.
+    */
+    bool isReachable(const yarp::sig::Vector &xd, const int margin=0) const;
+
+    /**
+    * Returns the dexterity of the voxel containing the target,
+    * i.e. the fraction of reachable approach directions.
+    * @param xd the target position.
+    * @return the dexterity in [0,1].
+    */
+    double getDexterity(const yarp::sig::Vector &xd) const;
+
+    /**
+    * Returns the best manipulability measure sqrt(det(J*J')) of
+    * the positional Jacobian found within the voxel containing
+    * the target.
+    * @param xd the target position.
+    * @return the manipulability (0 if unreachable).
+    */
+    double getManipulability(const yarp::sig::Vector &xd) const;
+
+    /**
+    * Retrieves the joints configuration stored in the voxel
+    * containing the target, to be used as seed for the inverse
+    * kinematics.
+    * @param xd the target position.
+    * @param q the seed (DOF entries) in [rad].
+    * @param chain if not NULL, the seed is clamped within the
+    *              current joints limits of the chain.
+    * @return true/false on success/failure.
+    */
+    bool getSeed(const yarp::sig::Vector &xd, yarp::sig::Vector &q,
+                 iKinChain *chain=NULL) const;
+
+    /**
+    * Destructor.
+    */
+    virtual ~iKinReachMap();
+};
+
+}
+
+}
+
+#endif
+
+
@@ -178,6 +178,16 @@ given rest
  *    0.001)), [get] [conv]. Set/get the options for specifying
  *    solver's convergence.
  *
+ * \b cach request: example [set] [cach] ((enable on) (size 64)
+ *    (warm_tol 0.02) (reuse_tol 0.0001)), [get] [cach].
+ *    Set/get the options of the cache of recent solutions used
+ *    to warm-start the solver or to reply straight away for
+ *    targets close to already solved ones. The [get] reply also
+ *    contains the cache statistics (solves, reuses, warm_starts,
+ *    cold_starts, warm_iters, cold_iters, iters_saved) along
+ *    with the number of requests answered by the closed-form
+ *    inversion (analytic), which bypasses the cache.
+ *
  * Commands issued through the [ask] vocab:
  *
  * \b xd request: example [ask] ([xd] (x y z ax ay az theta))
@@ -186,7 +196,20 @@ given rest
  *    configuration q and the pose mode. The reply will contain
  *    something like [ack] ([q] (...)) ([x] (...)), where the
  *    found configuration q is returned as well as the final
- *    attained pose x.
+ *    attained pose x. The reply is [nack] if the target is
+ *    rejected through the reachability map (see reach_reject).
+ *
+ * \b xds request: example [ask] ([xds] ((x y z ...) (x y z ...)
+ *    ...)) ([pose] [xyz]) ([q] (...)). Ask to solve for a batch
+ *    of targets in one go, e.g. to rank many candidates. Targets
+ *    are solved independently starting from the same joint
+ *    configuration, sharing the workload among the workers set
+ *    up through the option batch_workers. The reply will
+ *    contain [ack] ([xs] ((...) ...)) ([qs] ((...) ...)) ([res]
+ *    ((ep eo) ...)), that is for each target the attained pose,
+ *    the found configuration and the position and orientation
+ *    residuals in [m] and [rad], respectively. The state of the
+ *    solver is not affected by a batch request.
  *
  * Commands concerning the thread status:
  *
@@ -252,6 +275,9 @@ given rest
 
 #include <iCub/iKin/iKinHlp.h>
 #include <iCub/iKin/iKinIpOpt.h>
+#include <iCub/iKin/iKinReach.h>
+
+#define IKINSLV_UNREACHABLE_TARGET      -1000   // exit code of a target rejected by the reachability map
 
 
 namespace iCub
@@ -325,6 +351,14 @@ public:
 };
 
 
+struct BatchWorker
+{
+    iKinLimb          *lmb;
+    iKinLinIneqConstr  cns;
+    iKinIpOptMin      *slv;
+};
+
+
 struct PartDescriptor
 {
     iKinLimb                      *lmb;
@@ -354,6 +388,15 @@ protected:
 
     iKinIpOptMin   *slv;
     SolverCallback *clb;
+    iKinReachMap   *reachMap;
+    bool            reachReject;
+
+    int    exitCode;
+    size_t analyticSolves;
+
+    std::deque<BatchWorker*> batchPool;
+    std::mutex               mtx_batch;
+    int                      batchWorkers;
 
     RpcProcessor                             *cmdProcessor;
     yarp::os::Port                           *rpcPort;
@@ -426,6 +469,8 @@ protected:
     void waitDOFHandling();
     void postDOFHandling();
     void fillDOFInfo(yarp::os::Bottle &reply);
+    void disposeBatchPool();
+    bool handleBatchAsk(const yarp::os::Bottle &command, yarp::os::Bottle &reply);
     void send(const yarp::sig::Vector &xd, const yarp::sig::Vector &x, const yarp::sig::Vector &q, double *tok);
     void printInfo(const std::string &typ, const yarp::sig::Vector &xd, const yarp::sig::Vector &x,
                    const yarp::sig::Vector &q, const double t);    
@@ -526,6 +571,43 @@ public:
     *    ports are pinged prior to connecting; a timeout equal to
     *    zero disables this option.
     *  
+    * \b cache_size <int>: example (cache_size 64), enables the
+    *    cache of recent solutions holding at most the given
+    *    number of entries; zero (default) disables the cache.
+    *  
+    * \b cache_warm_tol <double>: example (cache_warm_tol 0.02),
+    *    specifies the distance in [m] and [rad] from a cached
+    *    target within which the solver is warm-started.
+    *  
+    * \b cache_reuse_tol <double>: example (cache_reuse_tol
+    *    0.0001), specifies the distance in [m] and [rad] from a
+    *    cached target within which the cached solution is
+    *    returned without optimizing.
+    *  
+    * \b batch_workers <int>: example (batch_workers 4), specifies
+    *    the number of workers solving the targets of a batch
+    *    request in parallel (by default, the number of hardware
+    *    threads up to 8 with IpOpt 3.14 or later, 1 otherwise).
+    * \note Only IpOpt linked against a thread-safe linear solver
+    *       can be run with more than one worker: this is not the
+    *       case of MUMPS for IpOpt versions prior to 3.14.
+    *  
+    * \b reach_map <string>: example (reach_map right_arm.map),
+    *    specifies the file of the reachability map (see
+    *    iKinReachMap) built for the solver's part with the same
+    *    DOF configuration. The map provides the optimizer with a
+    *    seed, clamped within the current joints limits, whenever
+    *    the current configuration is farther from the target than
+    *    the seed.
+    *  
+    * \b reach_reject <vocab>: example (reach_reject on), enables
+    *    (off by default) the early rejection of the targets
+    *    lying outside the workspace stored in the reachability
+    *    map: in this case the optimization is skipped, the
+    *    current configuration is kept and [ask] requests are
+    *    replied with [nack]. Targets are not rejected while the
+    *    joints limits are wider than the ones of the map.
+    *  
     * @return true/false if successful/failed
     */
     virtual bool open(yarp::os::Searchable &options);
@@ -584,7 +666,10 @@ public:
 class iCubArmCartesianSolver : public CartesianSolver
 {
 protected:
+    iCubArmAnalyticSolver *analyticSlv;
+
     virtual PartDescriptor *getPartDesc(yarp::os::Searchable &options);
+    virtual yarp::sig::Vector solve(yarp::sig::Vector &xd);
     virtual bool decodeDOF(const yarp::sig::Vector &_dof);
 
 public:
@@ -595,9 +680,38 @@ public:
     *                 father's class constructor for the description
     *                 of the ports
     */
-    iCubArmCartesianSolver(const std::string &_slvName="armCartSolver") : CartesianSolver(_slvName) { }
+    iCubArmCartesianSolver(const std::string &_slvName="armCartSolver") :
+                           CartesianSolver(_slvName), analyticSlv(NULL) { }
 
+    /**
+    * Configure the solver and start it up. 
+    * @param options contains the set of options in form of a 
+    *                Property object. In addition to the options
+    *                of the father's class:
+    *  
+    * \b analytic_ik <vocab>: example (analytic_ik on), enables
+    *    (off by default) the closed-form inversion of the arm
+    *    when the full pose is controlled and the torso is not,
+    *    falling back on IpOpt whenever no feasible solution is
+    *    found (see iCubArmAnalyticSolver). The solution is
+    *    sampled over the swivel angle and does not go through
+    *    the solution cache; it is marked with the exit code
+    *    IKINIPOPT_SOLVED_ANALYTICALLY and counted apart in the
+    *    cache statistics ("analytic" field).
+    *  
+    * @return true/false if successful/failed
+    */
     virtual bool open(yarp::os::Searchable &options);
+
+    /**
+    * Stop the solver and dispose it. Called by destructor.
+    */
+    virtual void close();
+
+    /**
+    * Default destructor.
+    */
+    virtual ~iCubArmCartesianSolver();
 };
 
 
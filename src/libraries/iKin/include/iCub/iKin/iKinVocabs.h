@@ -30,6 +30,10 @@
 #define IKINSLV_VOCAB_OPT_XD            yarp::os::createVocab('x','d')
 #define IKINSLV_VOCAB_OPT_X             yarp::os::createVocab('x')
 #define IKINSLV_VOCAB_OPT_Q             yarp::os::createVocab('q')
+#define IKINSLV_VOCAB_OPT_XDS           yarp::os::createVocab('x','d','s')
+#define IKINSLV_VOCAB_OPT_XS            yarp::os::createVocab('x','s')
+#define IKINSLV_VOCAB_OPT_QS            yarp::os::createVocab('q','s')
+#define IKINSLV_VOCAB_OPT_RES           yarp::os::createVocab('r','e','s')
 #define IKINSLV_VOCAB_OPT_TOKEN         yarp::os::createVocab('t','o','k')
 #define IKINSLV_VOCAB_OPT_VERB          yarp::os::createVocab('v','e','r','b')
 #define IKINSLV_VOCAB_OPT_REST_POS      yarp::os::createVocab('r','e','s','p')
@@ -37,6 +41,7 @@
 #define IKINSLV_VOCAB_OPT_TIP_FRAME     yarp::os::createVocab('t','i','p')
 #define IKINSLV_VOCAB_OPT_TASK2         yarp::os::createVocab('t','s','k','2')
 #define IKINSLV_VOCAB_OPT_CONVERGENCE   yarp::os::createVocab('c','o','n','v')
+#define IKINSLV_VOCAB_OPT_CACHE         yarp::os::createVocab('c','a','c','h')
 #define IKINSLV_VOCAB_VAL_POSE_FULL     yarp::os::createVocab('f','u','l','l')
 #define IKINSLV_VOCAB_VAL_POSE_XYZ      yarp::os::createVocab('x','y','z')
 #define IKINSLV_VOCAB_VAL_PRIO_XYZ      yarp::os::createVocab('x','y','z')
@@ -13,10 +13,16 @@
 #include <cmath>
 #include <algorithm>
 
+#if defined(IKIN_USE_AVX2) && defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
 #include <yarp/os/Log.h>
 
 #include <iCub/iKin/iKinFwd.h>
 
+#define IKINFWD_BATCH_WIDTH     4
+
 using namespace std;
 using namespace yarp::os;
 using namespace yarp::dev;
@@ -25,6 +31,174 @@ using namespace yarp::math;
 using namespace iCub::ctrl;
 using namespace iCub::iKin;
 
+#ifdef IKIN_USE_AVX2
+namespace iCub
+{
+    namespace iKin
+    {
+        // defined in iKinFwdAvx2.cpp
+        void batchLinkProductAvx2(double *T, const double *c_theta, const double *s_theta,
+                                  const double c_alpha, const double s_alpha,
+                                  const double A, const double D);
+    }
+}
+#endif
+
+namespace
+{
+
+/************************************************************************/
+inline void mul4x4(const double *A, const double *B, double *C)
+{
+    // C=A*B with 4x4 row-major operands (C must not alias A or B)
+    for (int r=0; r<16; r+=4)
+        for (int c=0; c<4; c++)
+            C[r+c]=A[r]*B[c]+A[r+1]*B[4+c]+A[r+2]*B[8+c]+A[r+3]*B[12+c];
+}
+
+
+/************************************************************************/
+inline void poseFromH(const double *H, double *pose, const bool axisRep)
+{
+    pose[0]=H[3];
+    pose[1]=H[7];
+    pose[2]=H[11];
+
+    if (axisRep)
+    {
+        // same steps of dcm2axis()
+        double v0=H[9]-H[6];
+        double v1=H[2]-H[8];
+        double v2=H[4]-H[1];
+        double r=sqrt(v0*v0+v1*v1+v2*v2);
+
+        if (r<1e-9)
+        {
+            // degenerate case (theta equal to 0 or pi):
+            // delegate to dcm2axis() which relies on SVD
+            Matrix R(4,4);
+            std::copy(H,H+16,R.data());
+            Vector v=dcm2axis(R);
+            pose[3]=v[0];
+            pose[4]=v[1];
+            pose[5]=v[2];
+            pose[6]=v[3];
+        }
+        else
+        {
+            double k=1.0/r;
+            pose[3]=k*v0;
+            pose[4]=k*v1;
+            pose[5]=k*v2;
+            pose[6]=atan2(0.5*r,0.5*(H[0]+H[5]+H[10]-1));
+        }
+    }
+    else
+    {
+        // Euler Angles as XYZ (see RotAng())
+        pose[3]=atan2(-H[9],H[10]);
+        pose[4]=asin(H[8]);
+        pose[5]=atan2(-H[4],H[0]);
+    }
+}
+
+
+/************************************************************************/
+void batchLinkProduct(double *T, const double *c_theta, const double *s_theta,
+                      const double c_alpha, const double s_alpha,
+                      const double A, const double D)
+{
+    // T holds the first three rows of IKINFWD_BATCH_WIDTH frames in
+    // structure-of-arrays layout, i.e. T[e*IKINFWD_BATCH_WIDTH+k] is the
+    // eth element (row-major) of the kth frame; the product T*H with
+    // the DH matrix H exploits the sparsity of H, yet it keeps the
+    // same sequence of operations of the generic 4x4 product
+    const int W=IKINFWD_BATCH_WIDTH;
+
+    for (int r=0; r<3; r++)
+    {
+        double *t=T+4*r*W;
+        for (int k=0; k<W; k++)
+        {
+            const double t0=t[k];
+            const double t1=t[W+k];
+            const double t2=t[2*W+k];
+            const double t3=t[3*W+k];
+            const double c=c_theta[k];
+            const double s=s_theta[k];
+
+            t[k]    =t0*c+t1*s;
+            t[W+k]  =t0*(-s*c_alpha)+t1*(c*c_alpha)+t2*s_alpha;
+            t[2*W+k]=t0*(s*s_alpha)+t1*(-c*s_alpha)+t2*c_alpha;
+            t[3*W+k]=t0*(c*A)+t1*(s*A)+t2*D+t3;
+        }
+    }
+}
+
+
+typedef void (*BatchLinkProductFcn)(double*, const double*, const double*,
+                                    const double, const double,
+                                    const double, const double);
+
+
+#ifdef IKIN_USE_AVX2
+/************************************************************************/
+bool cpuSupportsAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info,0);
+    if (info[0]<7)
+        return false;
+
+    // AVX2 needs also the OS support for the YMM registers
+    __cpuid(info,1);
+    if (!(info[2]&(1<<27)) || ((_xgetbv(0)&0x6)!=0x6))
+        return false;
+
+    __cpuidex(info,7,0);
+    return ((info[1]&(1<<5))!=0);
+#else
+    __builtin_cpu_init();
+    return (__builtin_cpu_supports("avx2")!=0);
+#endif
+}
+#endif
+
+
+/************************************************************************/
+BatchLinkProductFcn selectBatchLinkProduct()
+{
+#ifdef IKIN_USE_AVX2
+    // the AVX2 kernel is compiled in a separate unit and it is
+    // used only on the CPUs supporting it
+    static const bool avx2=cpuSupportsAvx2();
+    if (avx2)
+        return &iCub::iKin::batchLinkProductAvx2;
+#endif
+    return &batchLinkProduct;
+}
+
+
+/************************************************************************/
+inline void geoJacobianCol(const double *Z, const double *PN, Matrix &J,
+                           const unsigned int c)
+{
+    // same as cross(Z,2,PN-Z,3) along with the z-axis of Z
+    double dx=PN[3]-Z[3];
+    double dy=PN[7]-Z[7];
+    double dz=PN[11]-Z[11];
+
+    J(0,c)=Z[6]*dz-Z[10]*dy;
+    J(1,c)=Z[10]*dx-Z[2]*dz;
+    J(2,c)=Z[2]*dy-Z[6]*dx;
+    J(3,c)=Z[2];
+    J(4,c)=Z[6];
+    J(5,c)=Z[10];
+}
+
+}
+
 
 /************************************************************************/
 void iCub::iKin::notImplemented(const unsigned int verbose)
@@ -54,6 +228,7 @@ iKinLink::iKinLink(double _A, double _D, double _Alpha, double _Offset,
     cumulative =false;
     constrained=true;
     verbose    =0;
+    stamp      =0;
 
     H.resize(4,4);
     H.zero();
@@ -87,6 +262,7 @@ void iKinLink::clone(const iKinLink &l)
     cumulative =l.cumulative;
     constrained=l.constrained;
     verbose    =l.verbose;
+    stamp++;
 
     H   =l.H;
     cumH=l.cumH;
@@ -97,6 +273,7 @@ void iKinLink::clone(const iKinLink &l)
 /************************************************************************/
 iKinLink::iKinLink(const iKinLink &l)
 {
+    stamp=0;
     clone(l);
 }
 
@@ -116,7 +293,10 @@ void iKinLink::setMin(const double _Min)
     Min=_Min;
 
     if (Ang<Min)
+    {
         Ang=Min;
+        stamp++;
+    }
 }
 
 
@@ -126,7 +306,10 @@ void iKinLink::setMax(const double _Max)
     Max=_Max;
 
     if (Ang>Max)
+    {
         Ang=Max;
+        stamp++;
+    }
 }
 
 
@@ -134,6 +317,7 @@ void iKinLink::setMax(const double _Max)
 void iKinLink::setD(const double _D)
 {
     H(2,3)=D=_D;
+    stamp++;
 }
 
 
@@ -144,6 +328,7 @@ void iKinLink::setAlpha(const double _Alpha)
 
     H(2,2)=c_alpha=cos(Alpha);
     H(2,1)=s_alpha=sin(Alpha);
+    stamp++;
 }
 
 
@@ -153,9 +338,15 @@ double iKinLink::setAng(double _Ang)
     if (!blocked)
     {
         if (constrained)
-            Ang=(_Ang<Min) ? Min : ((_Ang>Max) ? Max : _Ang);
-        else
+            _Ang=(_Ang<Min) ? Min : ((_Ang>Max) ? Max : _Ang);
+
+        // the stamp changes only along with the angle, so that
+        // setting the same joints again does not spoil the cache
+        if (_Ang!=Ang)
+        {
             Ang=_Ang;
+            stamp++;
+        }
     }
     else if (verbose)
         yWarning("Attempt to set joint angle to %g while blocked",_Ang);
@@ -248,6 +439,7 @@ void iKinLink::addCumH(const Matrix &_cumH)
 {
     cumulative=true;
     cumH=_cumH;
+    stamp++;
 }
 
 
@@ -256,6 +448,13 @@ iKinChain::iKinChain()
 {
     N=DOF=verbose=0;
     H0=HN=eye(4,4);
+
+    fwd_cacheOn=true;
+    fwd_hits=fwd_misses=0;
+    fwd_intH.assign(16,0.0);
+    fwd_cumul=false;
+    fwd_dirty=true;
+    fwd_JValid=false;
 }
 
 
@@ -270,6 +469,21 @@ void iKinChain::clone(const iKinChain &c)
     verbose  =c.verbose;
     hess_J   =c.hess_J;
     hess_Jlnk=c.hess_Jlnk;
+    fwd_intH      =c.fwd_intH;
+    fwd_linkH     =c.fwd_linkH;
+    fwd_quickIntH =c.fwd_quickIntH;
+    fwd_quickLinkH=c.fwd_quickLinkH;
+    fwd_stamps    =c.fwd_stamps;
+    fwd_J         =c.fwd_J;
+    fwd_batchZP   =c.fwd_batchZP;
+    fwd_cacheOn   =c.fwd_cacheOn;
+    fwd_cumul     =c.fwd_cumul;
+    fwd_hits      =c.fwd_hits;
+    fwd_misses    =c.fwd_misses;
+
+    // the links may be replaced by copies (see iKinLimb)
+    fwd_dirty =true;
+    fwd_JValid=false;
 
     allList.assign(c.allList.begin(),c.allList.end());
     quickList.assign(c.quickList.begin(),c.quickList.end());
@@ -358,6 +572,15 @@ void iKinChain::clear()
 
     N=DOF=0;
     H0=HN=eye(4,4);
+
+    fwd_intH.assign(16,0.0);
+    fwd_linkH.clear();
+    fwd_quickIntH.clear();
+    fwd_quickLinkH.clear();
+    fwd_stamps.clear();
+    fwd_cumul=false;
+    fwd_dirty=true;
+    fwd_JValid=false;
 }
 
 
@@ -418,6 +641,7 @@ bool iKinChain::setBlockingValue(const unsigned int i, double Ang)
         {
             allList[i]->blocked=false; // remove the block temporarly
             allList[i]->block(Ang);    // update the blocked link
+            fwd_dirty=true;
 
             // update the cumulative link which follows in the chain
             if (i<N-1)
@@ -554,6 +778,21 @@ void iKinChain::build()
 
     if (DOF>0)
         curr_q.resize(DOF,0);
+
+    // the pass along quickList differs from the one along
+    // allList only if some links carry a cumulative matrix
+    fwd_cumul=false;
+    for (size_t i=0; i<quickList.size(); i++)
+        fwd_cumul|=quickList[i]->isCumulative();
+
+    fwd_intH.assign(16*(N+1),0.0);
+    fwd_linkH.assign(16*N,0.0);
+    fwd_quickIntH.assign(fwd_cumul?16*(quickList.size()+1):0,0.0);
+    fwd_quickLinkH.assign(fwd_cumul?16*quickList.size():0,0.0);
+    fwd_stamps.assign(N,0);
+    fwd_batchZP.assign(6*IKINFWD_BATCH_WIDTH*DOF,0.0);
+    fwd_dirty=true;
+    fwd_JValid=false;
 }
 
 
@@ -563,6 +802,7 @@ bool iKinChain::setH0(const Matrix &_H0)
     if ((_H0.rows()==4) && (_H0.cols()==4))
     {
         H0=_H0;
+        fwd_dirty=true;
         return true;
     }
     else
@@ -581,6 +821,7 @@ bool iKinChain::setHN(const Matrix &_HN)
     if ((_HN.rows()==4) && (_HN.cols()==4))
     {
         HN=_HN;
+        fwd_dirty=true;
         return true;
     }
     else
@@ -594,14 +835,20 @@ bool iKinChain::setHN(const Matrix &_HN)
 
 
 /************************************************************************/
-Vector iKinChain::setAng(const Vector &q)
+void iKinChain::updateAng(const Vector &q)
 {
-    yAssert(DOF>0);
-
     size_t sz=std::min(q.length(),(size_t)DOF);
     for (size_t i=0; i<sz; i++)
         curr_q[i]=quickList[hash_dof[i]]->setAng(q[i]);
+}
+
 
+/************************************************************************/
+Vector iKinChain::setAng(const Vector &q)
+{
+    yAssert(DOF>0);
+
+    updateAng(q);
     return curr_q;
 }
 
@@ -730,41 +977,36 @@ Vector iKinChain::d2RotAng(const Matrix &R, const Matrix &dRi,
 /************************************************************************/
 Matrix iKinChain::getH(const unsigned int i, const bool allLink)
 {
-    Matrix H=H0;
-    unsigned int _i,n;
-    deque<iKinLink*> *l;
-    bool cumulHN=false;
-    bool c_override;
-
     if (allLink)
     {
-        n=N;
-        l=&allList;
-        c_override=true;
-
-        _i=i;
-        if (_i>=N-1)
-            cumulHN=true;
-    }
-    else
-    {
-        n=DOF;
-        l=&quickList;
-        c_override=false;
+        yAssert(i<N);
+        updateFwdKin();
 
-        if (i==DOF)
-            _i=(unsigned int)quickList.size();
+        Matrix H(4,4);
+        if (i>=N-1)
+            std::copy(fwd_endEffH,fwd_endEffH+16,H.data());
         else
-            _i=i;
+            std::copy(&fwd_intH[16*(i+1)],&fwd_intH[16*(i+2)],H.data());
 
-        if (hash[_i]>=N-1)
-            cumulHN=true;
+        return H;
     }
 
-    yAssert(i<n);
+    Matrix H=H0;
+    unsigned int _i;
+    bool cumulHN=false;
+
+    if (i==DOF)
+        _i=(unsigned int)quickList.size();
+    else
+        _i=i;
+
+    if (hash[_i]>=N-1)
+        cumulHN=true;
+
+    yAssert(i<DOF);
 
     for (unsigned int j=0; j<=_i; j++)
-        H*=((*l)[j]->getH(c_override));
+        H*=quickList[j]->getH();
 
     if (cumulHN)
         H*=HN;
@@ -777,14 +1019,12 @@ Matrix iKinChain::getH(const unsigned int i, const bool allLink)
 Matrix iKinChain::getH()
 {
     // may be different from DOF since one blocked link may lie
-    // at the end of the chain.
-    unsigned int n=(unsigned int)quickList.size();
-    Matrix H=H0;
-
-    for (unsigned int i=0; i<n; i++)
-        H*=quickList[i]->getH();
+    // at the end of the chain: the cached pass along quickList
+    // takes this into account
+    Matrix H(4,4);
+    fastGetH(H);
 
-    return H*HN;
+    return H;
 }
 
 
@@ -848,32 +1088,8 @@ Vector iKinChain::Position(const unsigned int i)
 /************************************************************************/
 Vector iKinChain::EndEffPose(const bool axisRep)
 {
-    Matrix H=getH();
     Vector v;
-
-    if (axisRep)
-    {
-        v.resize(7);
-        Vector r=dcm2axis(H);
-        v[0]=H(0,3);
-        v[1]=H(1,3);
-        v[2]=H(2,3);
-        v[3]=r[0];
-        v[4]=r[1];
-        v[5]=r[2];
-        v[6]=r[3];
-    }
-    else
-    {
-        v.resize(6);
-        Vector r=RotAng(H);
-        v[0]=H(0,3);
-        v[1]=H(1,3);
-        v[2]=H(2,3);
-        v[3]=r[0];
-        v[4]=r[1];
-        v[5]=r[2];
-    }
+    fastEndEffPose(v,axisRep);
 
     return v;
 }
@@ -892,7 +1108,15 @@ Vector iKinChain::EndEffPose(const Vector &q, const bool axisRep)
 /************************************************************************/
 Vector iKinChain::EndEffPosition()
 {
-    return getH().subcol(0,3,3);
+    updateFwdKin();
+
+    const double *H=quickEndEffH();
+    Vector v(3);
+    v[0]=H[3];
+    v[1]=H[7];
+    v[2]=H[11];
+
+    return v;
 }
 
 
@@ -912,40 +1136,16 @@ Matrix iKinChain::AnaJacobian(const unsigned int i, unsigned int col)
     yAssert(i<N);
 
     col=col>3 ? 3 : col;
+    updateFwdKin();
 
+    const double *H=(i>=N-1) ? fwd_endEffH : &fwd_intH[16*(i+1)];
     Matrix J(6,i+1);
-    Matrix H,dH,_H;
-    Vector dr;
+    double DL[16];
 
     for (unsigned int j=0; j<=i; j++)
     {
-        H=dH=H0;
-
-        for (unsigned int k=0; k<=i; k++)
-        {
-            _H=allList[k]->getH(true);
-            H*=_H;
-
-            if (j==k)
-                dH*=allList[k]->getDnH(1,true);
-            else
-                dH*=_H;
-        }
-
-        if (i>=N-1)
-        {
-            H*=HN;
-            dH*=HN;
-        }
-
-        dr=dRotAng(H,dH);
-
-        J(0,j)=dH(0,col);
-        J(1,j)=dH(1,col);
-        J(2,j)=dH(2,col);
-        J(3,j)=dr[0];
-        J(4,j)=dr[1];
-        J(5,j)=dr[2];
+        fastLinkDH(allList[j],true,DL);
+        fastAnaJacobianCol(fwd_intH.data(),fwd_linkH.data(),DL,j,i+1,i>=N-1,H,col,J,j);
     }
 
     return J;
@@ -958,39 +1158,21 @@ Matrix iKinChain::AnaJacobian(unsigned int col)
     yAssert(DOF>0);
 
     col=col>3 ? 3 : col;
+    updateFwdKin();
 
     // may be different from DOF since one blocked link may lie
     // at the end of the chain.
     unsigned int n=(unsigned int)quickList.size();
+    const double *intH=fwd_cumul ? fwd_quickIntH.data() : fwd_intH.data();
+    const double *linkH=fwd_cumul ? fwd_quickLinkH.data() : fwd_linkH.data();
     Matrix J(6,DOF);
-    Matrix H,dH,_H;
-    Vector dr;
+    double DL[16];
 
     for (unsigned int i=0; i<DOF; i++)
     {
-        H=dH=H0;
-
-        for (unsigned int j=0; j<n; j++)
-        {
-            _H=quickList[j]->getH();
-            H*=_H;
-
-            if (hash_dof[i]==j)
-                dH*=quickList[j]->getDnH();
-            else
-                dH*=_H;
-        }
-
-        H*=HN;
-        dH*=HN;
-        dr=dRotAng(H,dH);
-
-        J(0,i)=dH(0,col);
-        J(1,i)=dH(1,col);
-        J(2,i)=dH(2,col);
-        J(3,i)=dr[0];
-        J(4,i)=dr[1];
-        J(5,i)=dr[2];
+        unsigned int j=hash_dof[i];
+        fastLinkDH(quickList[j],false,DL);
+        fastAnaJacobianCol(intH,linkH,DL,j,n,true,quickEndEffH(),col,J,i);
     }
 
     return J;
@@ -1012,32 +1194,13 @@ Matrix iKinChain::GeoJacobian(const unsigned int i)
 {
     yAssert(i<N);
 
-    Matrix J(6,i+1);
-    Matrix PN,Z;
-    Vector w;
-
-    deque<Matrix> intH;
-    intH.push_back(H0);
-
-    for (unsigned int j=0; j<=i; j++)
-        intH.push_back(intH[j]*allList[j]->getH(true));
+    updateFwdKin();
 
-    PN=intH[i+1];
-    if (i>=N-1)
-        PN=PN*HN;
+    const double *PN=(i>=N-1) ? fwd_endEffH : &fwd_intH[16*(i+1)];
+    Matrix J(6,i+1);
 
     for (unsigned int j=0; j<=i; j++)
-    {
-        Z=intH[j];
-        w=cross(Z,2,PN-Z,3);
-
-        J(0,j)=w[0];
-        J(1,j)=w[1];
-        J(2,j)=w[2];
-        J(3,j)=Z(0,2);
-        J(4,j)=Z(1,2);
-        J(5,j)=Z(2,2);
-    }
+        geoJacobianCol(&fwd_intH[16*j],PN,J,j);
 
     return J;
 }
@@ -1048,34 +1211,7 @@ Matrix iKinChain::GeoJacobian()
 {
     yAssert(DOF>0);
 
-    Matrix J(6,DOF);
-    Matrix PN,Z;
-    Vector w;
-
-    deque<Matrix> intH;
-    intH.push_back(H0);
-
-    for (unsigned int i=0; i<N; i++)
-        intH.push_back(intH[i]*allList[i]->getH(true));
-
-    PN=intH[N]*HN;
-
-    for (unsigned int i=0; i<DOF; i++)
-    {
-        unsigned int j=hash[i];
-
-        Z=intH[j];
-        w=cross(Z,2,PN-Z,3);
-
-        J(0,i)=w[0];
-        J(1,i)=w[1];
-        J(2,i)=w[2];
-        J(3,i)=Z(0,2);
-        J(4,i)=Z(1,2);
-        J(5,i)=Z(2,2);
-    }
-
-    return J;
+    return updateGeoJacobian();
 }
 
 
@@ -1295,6 +1431,382 @@ Matrix iKinChain::DJacobian(const unsigned int lnk, const Vector &dq)
 }
 
 
+/************************************************************************/
+void iKinChain::fastLinkH(const iKinLink *l, const bool c_override, double *H) const
+{
+    double theta=l->Ang+l->Offset;
+    double c_theta=cos(theta);
+    double s_theta=sin(theta);
+
+    double _H[16]={ c_theta, -s_theta*l->c_alpha,  s_theta*l->s_alpha, c_theta*l->A,
+                    s_theta,  c_theta*l->c_alpha, -c_theta*l->s_alpha, s_theta*l->A,
+                        0.0,          l->s_alpha,          l->c_alpha,         l->D,
+                        0.0,                 0.0,                 0.0,          1.0 };
+
+    if (l->cumulative && !c_override)
+        mul4x4(l->cumH.data(),_H,H);
+    else
+        std::copy(_H,_H+16,H);
+}
+
+
+/************************************************************************/
+void iKinChain::fastLinkDH(const iKinLink *l, const bool c_override, double *DH) const
+{
+    double theta=l->Ang+l->Offset;
+    double c_theta=cos(theta);
+    double s_theta=sin(theta);
+
+    // first derivative as in getDnH(1,c_override)
+    double _DH[16]={ -s_theta, -(c_theta*l->c_alpha), c_theta*l->s_alpha, -(s_theta*l->A),
+                      c_theta, -(s_theta*l->c_alpha), s_theta*l->s_alpha,   c_theta*l->A,
+                          0.0,                   0.0,                0.0,            0.0,
+                          0.0,                   0.0,                0.0,            0.0 };
+
+    if (l->cumulative && !c_override)
+        mul4x4(l->cumH.data(),_DH,DH);
+    else
+        std::copy(_DH,_DH+16,DH);
+}
+
+
+/************************************************************************/
+bool iKinChain::isFwdKinValid() const
+{
+    // the chain is marked as dirty by the changes of H0, HN and
+    // of the blocked links, whereas the links stamp the changes
+    // of their angles and parameters
+    if (!fwd_cacheOn || fwd_dirty)
+        return false;
+
+    for (unsigned int i=0; i<N; i++)
+        if (allList[i]->stamp!=fwd_stamps[i])
+            return false;
+
+    return true;
+}
+
+
+/************************************************************************/
+void iKinChain::updateFwdKin()
+{
+    if (isFwdKinValid())
+    {
+        fwd_hits++;
+        return;
+    }
+
+    fwd_misses++;
+
+    for (unsigned int i=0; i<N; i++)
+        fwd_stamps[i]=allList[i]->stamp;
+
+    // the pass along allList, as in GeoJacobian()
+    double *intH=fwd_intH.data();
+    double *linkH=fwd_linkH.data();
+
+    std::copy(H0.data(),H0.data()+16,intH);
+    for (unsigned int i=0; i<N; i++)
+    {
+        fastLinkH(allList[i],true,linkH+16*i);
+        mul4x4(intH+16*i,linkH+16*i,intH+16*(i+1));
+    }
+
+    mul4x4(intH+16*N,HN.data(),fwd_endEffH);
+
+    // the pass along quickList, as in getH(), where the blocked
+    // links are accumulated in the following link
+    if (fwd_cumul)
+    {
+        unsigned int n=(unsigned int)quickList.size();
+        intH=fwd_quickIntH.data();
+        linkH=fwd_quickLinkH.data();
+
+        std::copy(H0.data(),H0.data()+16,intH);
+        for (unsigned int i=0; i<n; i++)
+        {
+            fastLinkH(quickList[i],false,linkH+16*i);
+            mul4x4(intH+16*i,linkH+16*i,intH+16*(i+1));
+        }
+
+        mul4x4(intH+16*n,HN.data(),fwd_quickEndEffH);
+    }
+
+    fwd_dirty=false;
+    fwd_JValid=false;
+}
+
+
+/************************************************************************/
+const double *iKinChain::quickEndEffH() const
+{
+    return (fwd_cumul ? fwd_quickEndEffH : fwd_endEffH);
+}
+
+
+/************************************************************************/
+const Matrix &iKinChain::updateGeoJacobian()
+{
+    updateFwdKin();
+
+    if (!fwd_JValid)
+    {
+        if (((unsigned int)fwd_J.rows()!=6) || ((unsigned int)fwd_J.cols()!=DOF))
+            fwd_J.resize(6,DOF);
+
+        for (unsigned int i=0; i<DOF; i++)
+            geoJacobianCol(&fwd_intH[16*hash[i]],fwd_endEffH,fwd_J,i);
+
+        fwd_JValid=true;
+    }
+
+    return fwd_J;
+}
+
+
+/************************************************************************/
+void iKinChain::fastAnaJacobianCol(const double *intH, const double *linkH, const double *DL,
+                                   const unsigned int j, const unsigned int n, const bool cumulHN,
+                                   const double *H, const unsigned int col, Matrix &J,
+                                   const unsigned int c)
+{
+    double T0[16],T1[16];
+    double *cur=T0,*nxt=T1;
+
+    // dH=H0*L0*...*dLj*...*L(n-1)(*HN)
+    mul4x4(&intH[16*j],DL,cur);
+
+    for (unsigned int k=j+1; k<n; k++)
+    {
+        mul4x4(cur,&linkH[16*k],nxt);
+        std::swap(cur,nxt);
+    }
+
+    if (cumulHN)
+    {
+        mul4x4(cur,HN.data(),nxt);
+        std::swap(cur,nxt);
+    }
+
+    const double *dH=cur;
+
+    J(0,c)=dH[col];
+    J(1,c)=dH[4+col];
+    J(2,c)=dH[8+col];
+
+    // same as dRotAng(H,dH)
+    J(3,c)=(H[9]*dH[10]-H[10]*dH[9]) / (H[9]*H[9]+H[10]*H[10]);
+    J(4,c)=dH[8]/sqrt(fabs(1-H[8]*H[8]));
+    J(5,c)=(H[4]*dH[0]-H[0]*dH[4]) / (H[4]*H[4]+H[0]*H[0]);
+}
+
+
+/************************************************************************/
+void iKinChain::fastGetH(Matrix &H)
+{
+    updateFwdKin();
+
+    if ((H.rows()!=4) || (H.cols()!=4))
+        H.resize(4,4);
+
+    const double *_H=quickEndEffH();
+    std::copy(_H,_H+16,H.data());
+}
+
+
+/************************************************************************/
+void iKinChain::fastEndEffPose(Vector &pose, const bool axisRep)
+{
+    updateFwdKin();
+
+    size_t len=axisRep ? 7 : 6;
+    if (pose.length()!=len)
+        pose.resize(len);
+
+    poseFromH(quickEndEffH(),pose.data(),axisRep);
+}
+
+
+/************************************************************************/
+void iKinChain::fastEndEffPose(const Vector &q, Vector &pose, const bool axisRep)
+{
+    yAssert(DOF>0);
+
+    updateAng(q);
+    fastEndEffPose(pose,axisRep);
+}
+
+
+/************************************************************************/
+void iKinChain::fastGeoJacobian(Matrix &J)
+{
+    yAssert(DOF>0);
+
+    const Matrix &_J=updateGeoJacobian();
+    if (((unsigned int)J.rows()!=6) || ((unsigned int)J.cols()!=DOF))
+        J.resize(6,DOF);
+
+    std::copy(_J.data(),_J.data()+6*DOF,J.data());
+}
+
+
+/************************************************************************/
+void iKinChain::fastGeoJacobian(const Vector &q, Matrix &J)
+{
+    yAssert(DOF>0);
+
+    updateAng(q);
+    fastGeoJacobian(J);
+}
+
+
+/************************************************************************/
+bool iKinChain::batchEndEffPose(const Matrix &Q, Matrix &poses, Matrix *J,
+                                const bool axisRep)
+{
+    if ((DOF==0) || ((unsigned int)Q.rows()!=DOF))
+    {
+        if (verbose)
+            yError("batchEndEffPose() failed due to wrong rows number: %d!=%d",Q.rows(),DOF);
+
+        return false;
+    }
+
+    const int W=IKINFWD_BATCH_WIDTH;
+    const int M=Q.cols();
+    const BatchLinkProductFcn linkProduct=selectBatchLinkProduct();
+    const int len=axisRep ? 7 : 6;
+
+    if ((poses.rows()!=len) || (poses.cols()!=M))
+        poses.resize(len,M);
+
+    if (J!=NULL)
+        if (((unsigned int)J->rows()!=6*DOF) || (J->cols()!=M))
+            J->resize(6*DOF,M);
+
+    double T[12*W],E[12*W],c_theta[W],s_theta[W];
+    double H[16],pose[7];
+    int m[W];
+
+    const double *h0=H0.data();
+    const double *hN=HN.data();
+    double *ZP=fwd_batchZP.data();
+
+    H[12]=H[13]=H[14]=0.0;
+    H[15]=1.0;
+
+    for (int m0=0; m0<M; m0+=W)
+    {
+        // lanes beyond the last configuration replicate it
+        for (int k=0; k<W; k++)
+            m[k]=std::min(m0+k,M-1);
+
+        for (int e=0; e<12; e++)
+            for (int k=0; k<W; k++)
+                T[e*W+k]=h0[e];
+
+        for (unsigned int i=0, dof=0; i<N; i++)
+        {
+            const iKinLink *l=allList[i];
+
+            if (l->blocked)
+            {
+                double theta=l->Ang+l->Offset;
+                std::fill(c_theta,c_theta+W,cos(theta));
+                std::fill(s_theta,s_theta+W,sin(theta));
+            }
+            else
+            {
+                // store z-axis and origin of the frame
+                // preceding the DOF for the Jacobian
+                double *zp=ZP+6*W*dof;
+                for (int k=0; k<W; k++)
+                {
+                    zp[k]    =T[2*W+k];
+                    zp[W+k]  =T[6*W+k];
+                    zp[2*W+k]=T[10*W+k];
+                    zp[3*W+k]=T[3*W+k];
+                    zp[4*W+k]=T[7*W+k];
+                    zp[5*W+k]=T[11*W+k];
+                }
+
+                for (int k=0; k<W; k++)
+                {
+                    double q=Q(dof,m[k]);
+                    if (l->constrained)
+                        q=(q<l->Min) ? l->Min : ((q>l->Max) ? l->Max : q);
+
+                    double theta=q+l->Offset;
+                    c_theta[k]=cos(theta);
+                    s_theta[k]=sin(theta);
+                }
+
+                dof++;
+            }
+
+            linkProduct(T,c_theta,s_theta,l->c_alpha,l->s_alpha,l->A,l->D);
+        }
+
+        // end-effector frames
+        for (int r=0; r<12; r+=4)
+            for (int c=0; c<4; c++)
+                for (int k=0; k<W; k++)
+                    E[(r+c)*W+k]=T[r*W+k]*hN[c]+T[(r+1)*W+k]*hN[4+c]+
+                                 T[(r+2)*W+k]*hN[8+c]+T[(r+3)*W+k]*hN[12+c];
+
+        for (int k=0; (k<W) && (m0+k<M); k++)
+        {
+            for (int e=0; e<12; e++)
+                H[e]=E[e*W+k];
+
+            poseFromH(H,pose,axisRep);
+            for (int r=0; r<len; r++)
+                poses(r,m0+k)=pose[r];
+
+            if (J!=NULL)
+            {
+                for (unsigned int i=0; i<DOF; i++)
+                {
+                    const double *zp=ZP+6*W*i;
+                    double zx=zp[k];
+                    double zy=zp[W+k];
+                    double zz=zp[2*W+k];
+                    double dx=H[3]-zp[3*W+k];
+                    double dy=H[7]-zp[4*W+k];
+                    double dz=H[11]-zp[5*W+k];
+
+                    (*J)(i,m0+k)      =zy*dz-zz*dy;
+                    (*J)(DOF+i,m0+k)  =zz*dx-zx*dz;
+                    (*J)(2*DOF+i,m0+k)=zx*dy-zy*dx;
+                    (*J)(3*DOF+i,m0+k)=zx;
+                    (*J)(4*DOF+i,m0+k)=zy;
+                    (*J)(5*DOF+i,m0+k)=zz;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+void iKinChain::setFwdKinCache(const bool enable)
+{
+    fwd_cacheOn=enable;
+    fwd_dirty=true;
+    fwd_JValid=false;
+}
+
+
+/************************************************************************/
+void iKinChain::getFwdKinCacheStats(size_t &hits, size_t &misses) const
+{
+    hits=fwd_hits;
+    misses=fwd_misses;
+}
+
+
 /************************************************************************/
 iKinChain::~iKinChain()
 {
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+// This unit is the only one compiled with AVX2 enabled and it is entered
+// only once the CPU has been checked at runtime (see iKinFwd.cpp).
+// Do not include here headers defining inline functions shared with the
+// rest of the library (e.g. YARP's), as the linker might pick their AVX2
+// instances for the whole library.
+
+#include <immintrin.h>
+
+namespace iCub
+{
+
+namespace iKin
+{
+
+/************************************************************************/
+void batchLinkProductAvx2(double *T, const double *c_theta, const double *s_theta,
+                          const double c_alpha, const double s_alpha,
+                          const double A, const double D)
+{
+    // same layout and sequence of operations of batchLinkProduct()
+    // in iKinFwd.cpp, with the 4 frames of the batch on the lanes
+    const int W=4;
+
+    const __m256d c=_mm256_loadu_pd(c_theta);
+    const __m256d s=_mm256_loadu_pd(s_theta);
+    const __m256d ca=_mm256_set1_pd(c_alpha);
+    const __m256d sa=_mm256_set1_pd(s_alpha);
+    const __m256d a=_mm256_set1_pd(A);
+    const __m256d d=_mm256_set1_pd(D);
+    const __m256d sgn=_mm256_set1_pd(-0.0);
+
+    const __m256d H01=_mm256_xor_pd(_mm256_mul_pd(s,ca),sgn);
+    const __m256d H11=_mm256_mul_pd(c,ca);
+    const __m256d H02=_mm256_mul_pd(s,sa);
+    const __m256d H12=_mm256_xor_pd(_mm256_mul_pd(c,sa),sgn);
+    const __m256d H03=_mm256_mul_pd(c,a);
+    const __m256d H13=_mm256_mul_pd(s,a);
+
+    for (int r=0; r<3; r++)
+    {
+        double *t=T+4*r*W;
+        const __m256d t0=_mm256_loadu_pd(t);
+        const __m256d t1=_mm256_loadu_pd(t+W);
+        const __m256d t2=_mm256_loadu_pd(t+2*W);
+        const __m256d t3=_mm256_loadu_pd(t+3*W);
+
+        _mm256_storeu_pd(t,_mm256_add_pd(_mm256_mul_pd(t0,c),_mm256_mul_pd(t1,s)));
+        _mm256_storeu_pd(t+W,_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(t0,H01),_mm256_mul_pd(t1,H11)),
+                                           _mm256_mul_pd(t2,sa)));
+        _mm256_storeu_pd(t+2*W,_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(t0,H02),_mm256_mul_pd(t1,H12)),
+                                             _mm256_mul_pd(t2,ca)));
+        _mm256_storeu_pd(t+3*W,_mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(t0,H03),_mm256_mul_pd(t1,H13)),
+                                                           _mm256_mul_pd(t2,d)),t3));
+    }
+}
+
+}
+
+}
+
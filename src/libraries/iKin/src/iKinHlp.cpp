@@ -82,6 +82,66 @@ bool CartesianHelper::getDesiredOption(const Bottle &reply, Vector &xdhat,
 }
 
 
+/************************************************************************/
+bool CartesianHelper::getDesiredBatchOption(const Bottle &reply, Matrix &xdhat,
+                                            Matrix &odhat, Matrix &qdhat,
+                                            Matrix &res)
+{
+    if (reply.size()==0)
+        return false;
+
+    if (reply.get(0).asVocab()==IKINSLV_VOCAB_REP_ACK)
+    {
+        Bottle *xData=reply.find(Vocab::decode(IKINSLV_VOCAB_OPT_XS)).asList();
+        Bottle *qData=reply.find(Vocab::decode(IKINSLV_VOCAB_OPT_QS)).asList();
+        Bottle *rData=reply.find(Vocab::decode(IKINSLV_VOCAB_OPT_RES)).asList();
+
+        if ((xData==NULL) || (qData==NULL) || (rData==NULL))
+            return false;
+
+        int n=xData->size();
+        if ((n==0) || (qData->size()!=n) || (rData->size()!=n))
+            return false;
+
+        Bottle *q_0=qData->get(0).asList();
+        if (q_0==NULL)
+            return false;
+
+        xdhat.resize(n,3);
+        odhat.resize(n,4);
+        qdhat.resize(n,q_0->size());
+        res.resize(n,2);
+
+        for (int i=0; i<n; i++)
+        {
+            Bottle *x_i=xData->get(i).asList();
+            Bottle *q_i=qData->get(i).asList();
+            Bottle *r_i=rData->get(i).asList();
+
+            if ((x_i==NULL) || (q_i==NULL) || (r_i==NULL) ||
+                (x_i->size()<7) || (q_i->size()!=(int)qdhat.cols()) || (r_i->size()<2))
+                return false;
+
+            for (int j=0; j<3; j++)
+                xdhat(i,j)=x_i->get(j).asDouble();
+
+            for (int j=0; j<4; j++)
+                odhat(i,j)=x_i->get(3+j).asDouble();
+
+            for (int j=0; j<q_i->size(); j++)
+                qdhat(i,j)=q_i->get(j).asDouble();
+
+            res(i,0)=r_i->get(0).asDouble();
+            res(i,1)=r_i->get(1).asDouble();
+        }
+
+        return true;
+    }
+    else
+        return false;
+}
+
+
 /************************************************************************/
 void CartesianHelper::addTargetOption(Bottle &b, const Vector &xd)
 {
@@ -89,6 +149,22 @@ void CartesianHelper::addTargetOption(Bottle &b, const Vector &xd)
 }
 
 
+/************************************************************************/
+void CartesianHelper::addTargetsOption(Bottle &b, const Matrix &xd)
+{
+    Bottle &part=b.addList();
+    part.addVocab(IKINSLV_VOCAB_OPT_XDS);
+    Bottle &list=part.addList();
+
+    for (int r=0; r<xd.rows(); r++)
+    {
+        Bottle &vect=list.addList();
+        for (int c=0; c<xd.cols(); c++)
+            vect.addDouble(xd(r,c));
+    }
+}
+
+
 /************************************************************************/
 void CartesianHelper::addDOFOption(Bottle &b, const Vector &dof)
 {
@@ -152,6 +228,13 @@ Bottle *CartesianHelper::getTargetOption(const Bottle &b)
 }
 
 
+/************************************************************************/
+Bottle *CartesianHelper::getTargetsOption(const Bottle &b)
+{
+    return b.find(Vocab::decode(IKINSLV_VOCAB_OPT_XDS)).asList();
+}
+
+
 /************************************************************************/
 Bottle *CartesianHelper::getEndEffectorPoseOption(const Bottle &b)
 {
@@ -320,7 +320,7 @@ Vector SteepCtrl::iterate(Vector &xd, const unsigned int verbose)
         
         calc_e();
 
-        J =chain.GeoJacobian();
+        chain.fastGeoJacobian(J);
         Jt=J.transposed();
 
         if (J.rows()>=J.cols())
@@ -343,7 +343,7 @@ Vector SteepCtrl::iterate(Vector &xd, const unsigned int verbose)
             qdot=_qdot;
 
         q=chain.setAng(I->integrate(qdot));
-        x=chain.EndEffPose();
+        chain.fastEndEffPose(x);
     }
 
     update_state();
@@ -578,7 +578,7 @@ Vector LMCtrl::iterate(Vector &xd, const unsigned int verbose)
 
         calc_e();
 
-        J=chain.GeoJacobian();
+        chain.fastGeoJacobian(J);
         Jt=J.transposed();
         grad=-1.0*(Jt*e);
 
@@ -606,7 +606,7 @@ Vector LMCtrl::iterate(Vector &xd, const unsigned int verbose)
             qdot=_qdot;
 
         q=chain.setAng(I->integrate(qdot));
-        x=chain.EndEffPose();
+        chain.fastEndEffPose(x);
 
         mu=update_mu();
     }
@@ -840,7 +840,7 @@ Vector MultiRefMinJerkCtrl::iterate(Vector &xd, Vector &qd, Vector *xdot_set,
         else
             _xdot=mjCtrlTask->computeCmd(execTime,e);
    
-        J =chain.GeoJacobian();
+        chain.fastGeoJacobian(J);
         Jt=J.transposed();
 
         computeWeight();
@@ -848,7 +848,7 @@ Vector MultiRefMinJerkCtrl::iterate(Vector &xd, Vector &qd, Vector *xdot_set,
         qdot=_qdot+W*(Jt*(pinv(Eye6+J*W*Jt)*(_xdot-J*_qdot)));        
         xdot=J*qdot;
         q=chain.setAng(I->integrate(qdot));
-        x=chain.EndEffPose();
+        chain.fastEndEffPose(x);
     }
 
     update_state();
@@ -9,8 +9,11 @@
 */
 
 #include <cstdlib>
+#include <cmath>
 #include <limits>
 #include <string>
+#include <deque>
+#include <unordered_map>
 
 #include <IpTNLP.hpp>
 #include <IpIpoptApplication.hpp>
@@ -18,7 +21,14 @@
 #include <iCub/iKin/iKinIpOpt.h>
 
 #define CAST_IPOPTAPP(x)                    (static_cast<IpoptApplication*>(x))
+#define CAST_SLVCACHE(x)                    (static_cast<iKinSolutionCache*>(x))
+#define IKINIPOPT_COLDSTART_MU_INIT         0.1     // IpOpt default
+#define IKINIPOPT_WARMSTART_MU_INIT         1e-4
+#define IKINIPOPT_WARMSTART_BOUND_PUSH      1e-6
 #define IKINIPOPT_SHOULDER_MAXABDUCTION     (100.0*CTRL_DEG2RAD)
+#define IKINANALYTIC_PROXIMITY_WEIGHT       1e-6
+#define IKINANALYTIC_REFINE_STEPS           8
+#define IKINANALYTIC_EPS                    1e-9
 
 using namespace std;
 using namespace yarp::sig;
@@ -227,6 +237,520 @@ void iCubAdditionalArmConstraints::update(void*)
 }
 
 
+namespace
+{
+
+/************************************************************************/
+struct iCubArmDH
+{
+    double a, d;
+    double ca, sa;
+    double offset;
+    double min, max;
+};
+
+
+/************************************************************************/
+// C=A*B with 3x3 row-major matrices
+inline void rotMul(const double *A, const double *B, double *C)
+{
+    for (int r=0; r<3; r++)
+        for (int c=0; c<3; c++)
+            C[3*r+c]=A[3*r]*B[c]+A[3*r+1]*B[3+c]+A[3*r+2]*B[6+c];
+}
+
+
+/************************************************************************/
+// C=A'*B with 3x3 row-major matrices
+inline void rotMulT(const double *A, const double *B, double *C)
+{
+    for (int r=0; r<3; r++)
+        for (int c=0; c<3; c++)
+            C[3*r+c]=A[r]*B[c]+A[3+r]*B[3+c]+A[6+r]*B[6+c];
+}
+
+
+/************************************************************************/
+// y=R*x
+inline void rotApply(const double *R, const double *x, double *y)
+{
+    for (int r=0; r<3; r++)
+        y[r]=R[3*r]*x[0]+R[3*r+1]*x[1]+R[3*r+2]*x[2];
+}
+
+
+/************************************************************************/
+inline void rotZ(const double theta, double *R)
+{
+    double c=cos(theta), s=sin(theta);
+    R[0]=c;   R[1]=-s;  R[2]=0.0;
+    R[3]=s;   R[4]=c;   R[5]=0.0;
+    R[6]=0.0; R[7]=0.0; R[8]=1.0;
+}
+
+
+/************************************************************************/
+inline void rotX(const double c, const double s, double *R)
+{
+    R[0]=1.0; R[1]=0.0; R[2]=0.0;
+    R[3]=0.0; R[4]=c;   R[5]=-s;
+    R[6]=0.0; R[7]=s;   R[8]=c;
+}
+
+
+/************************************************************************/
+// Rodrigues' formula, k is a unit vector
+inline void rotAxis(const double *k, const double theta, double *R)
+{
+    double c=cos(theta), s=sin(theta), v=1.0-c;
+    R[0]=k[0]*k[0]*v+c;      R[1]=k[0]*k[1]*v-k[2]*s; R[2]=k[0]*k[2]*v+k[1]*s;
+    R[3]=k[0]*k[1]*v+k[2]*s; R[4]=k[1]*k[1]*v+c;      R[5]=k[1]*k[2]*v-k[0]*s;
+    R[6]=k[0]*k[2]*v-k[1]*s; R[7]=k[1]*k[2]*v+k[0]*s; R[8]=k[2]*k[2]*v+c;
+}
+
+
+/************************************************************************/
+// retrieves the joint angle corresponding to the DH angle theta
+// within the joint bounds, if any
+inline bool toJoint(const iCubArmDH &L, const double theta, double &q)
+{
+    double t=theta-L.offset;
+    q=atan2(sin(t),cos(t));
+    if (q<L.min)
+        q+=2.0*M_PI;
+    else if (q>L.max)
+        q-=2.0*M_PI;
+
+    return ((q>=L.min) && (q<=L.max));
+}
+
+
+/************************************************************************/
+// solves R=Rz(t[0])*Rx(L1.alpha)*Rz(t[1])*Rx(L2.alpha)*Rz(t[2]),
+// where branch selects the sign of sin(t[1])
+inline void decompose(const double *R, const iCubArmDH &L1,
+                      const iCubArmDH &L2, const int branch, double *t)
+{
+    double c1=(L1.ca*L2.ca-R[8])/(L1.sa*L2.sa);
+    c1=std::max(-1.0,std::min(1.0,c1));
+    double s1=(branch>0?1.0:-1.0)*sqrt(1.0-c1*c1);
+    t[1]=atan2(s1,c1);
+
+    // R*[0 0 1]' projected on the xy plane before Rz(t[0])
+    double px=L2.sa*s1;
+    double py=-L2.sa*c1*L1.ca-L2.ca*L1.sa;
+    t[0]=atan2(R[5],R[2])-atan2(py,px);
+
+    // Rz(t[2])=(Rz(t[0])*Rx(L1.alpha)*Rz(t[1])*Rx(L2.alpha))'*R
+    double A[9], B[9], C[9];
+    rotZ(t[0],A); rotX(L1.ca,L1.sa,B); rotMul(A,B,C);
+    rotZ(t[1],A); rotMul(C,A,B);
+    rotX(L2.ca,L2.sa,A); rotMul(B,A,C);
+    rotMulT(C,R,A);
+    t[2]=atan2(A[3],A[0]);
+}
+
+
+/************************************************************************/
+// the data of one inversion problem
+struct iCubArmAnalyticProblem
+{
+    iCubArmDH L[10];
+
+    double R2[9], p2[3];    // torso's end frame
+    double R9[9], p9[3];    // desired frame of the last link
+    double c[3];            // shoulder center
+    double t[3];            // from shoulder to wrist center (torso's end frame)
+
+    int    n6;              // elbow solutions
+    double theta6[2];
+    double q6[2];
+    double R0[2][9];        // align the arm with t
+
+    const yarp::sig::Vector *q0;
+    double weight2ndTask, weight3rdTask;
+    const yarp::sig::Vector *xd_2nd, *w_2nd;
+    const yarp::sig::Vector *qd_3rd, *w_3rd;
+    iKinLinIneqConstr *LIC;
+
+    /********************************************************************/
+    double evaluate(const int i6, const double psi, const int b4,
+                    const int b8, double *q) const
+    {
+        const double inf=std::numeric_limits<double>::infinity();
+        double k[3]={t[0], t[1], t[2]};
+        double nt=sqrt(k[0]*k[0]+k[1]*k[1]+k[2]*k[2]);
+        k[0]/=nt; k[1]/=nt; k[2]/=nt;
+
+        // shoulder
+        double A[9], B[9], R_sh[9], th[3];
+        rotAxis(k,psi,A);
+        rotMul(A,R0[i6],R_sh);
+        decompose(R_sh,L[3],L[4],b4,th);
+        for (int i=0; i<3; i++)
+            if (!toJoint(L[3+i],th[i],q[i]))
+                return inf;
+
+        q[3]=q6[i6];
+
+        // wrist
+        double R6[9], Rw[9];
+        rotMul(R2,R_sh,A);
+        rotX(L[5].ca,L[5].sa,B); rotMul(A,B,R6);
+        rotZ(theta6[i6],A); rotMul(R6,A,B);
+        rotX(L[6].ca,L[6].sa,A); rotMul(B,A,R6);
+        rotX(L[9].ca,L[9].sa,A); rotMulT(R6,R9,B);
+        for (int r=0; r<3; r++)     // B*Rx(L9.alpha)'
+            for (int c_=0; c_<3; c_++)
+                Rw[3*r+c_]=B[3*r]*A[3*c_]+B[3*r+1]*A[3*c_+1]+B[3*r+2]*A[3*c_+2];
+        decompose(Rw,L[7],L[8],b8,th);
+        for (int i=0; i<3; i++)
+            if (!toJoint(L[7+i],th[i],q[4+i]))
+                return inf;
+
+        // linear inequality constraints
+        if (LIC->isActive())
+        {
+            const yarp::sig::Matrix &C=LIC->getC();
+            const yarp::sig::Vector &lB=LIC->getlB();
+            const yarp::sig::Vector &uB=LIC->getuB();
+            if (C.cols()!=7)
+                return inf;
+
+            for (int r=0; r<C.rows(); r++)
+            {
+                double v=0.0;
+                for (int i=0; i<7; i++)
+                    v+=C(r,i)*q[i];
+
+                if ((v<lB[r]) || (v>uB[r]))
+                    return inf;
+            }
+        }
+
+        double cost=0.0;
+        for (int i=0; i<7; i++)
+        {
+            double e=q[i]-(*q0)[i];
+            cost+=IKINANALYTIC_PROXIMITY_WEIGHT*e*e;
+        }
+
+        // elbow position task
+        if (weight2ndTask!=0.0)
+        {
+            double b[3]={L[5].a, 0.0, L[5].d}, e[3];
+            rotApply(R_sh,b,A);
+            rotApply(R2,A,e);
+            for (int i=0; i<3; i++)
+            {
+                double ei=(*w_2nd)[i]*((*xd_2nd)[i]-c[i]-e[i]);
+                cost+=weight2ndTask*ei*ei;
+            }
+        }
+
+        // joints rest position task
+        if (weight3rdTask!=0.0)
+        {
+            for (int i=0; i<7; i++)
+            {
+                double ei=(*w_3rd)[i]*((*qd_3rd)[i]-q[i]);
+                cost+=weight3rdTask*ei*ei;
+            }
+        }
+
+        return cost;
+    }
+};
+
+}
+
+
+/************************************************************************/
+iCubArmAnalyticSolver::iCubArmAnalyticSolver(iCubArm &arm, const int swivelSamples) :
+                                             chain(arm.asChain()), pLIC(&noLIC),
+                                             tol(IKINANALYTIC_DEFAULT_TOL)
+{
+    setSwivelSamples(swivelSamples);
+}
+
+
+/************************************************************************/
+void iCubArmAnalyticSolver::setSwivelSamples(const int samples)
+{
+    swivelSamples=std::max(4,samples);
+}
+
+
+/************************************************************************/
+void iCubArmAnalyticSolver::setTol(const double tol)
+{
+    this->tol=fabs(tol);
+}
+
+
+/************************************************************************/
+bool iCubArmAnalyticSolver::isSupported() const
+{
+    if ((chain->getN()!=10) || (chain->getDOF()!=7))
+        return false;
+
+    // torso blocked and arm released
+    for (unsigned int i=0; i<chain->getN(); i++)
+        if ((*chain)[i].isBlocked()!=(i<3))
+            return false;
+
+    // spherical shoulder and wrist
+    for (int i=3; i<=7; i+=4)
+    {
+        iKinLink &l1=(*chain)[i];
+        iKinLink &l2=(*chain)[i+1];
+        if ((fabs(l1.getA())>IKINANALYTIC_EPS) ||
+            (fabs(l2.getA())>IKINANALYTIC_EPS) ||
+            (fabs(l2.getD())>IKINANALYTIC_EPS) ||
+            (fabs(sin(l1.getAlpha()))<0.1) ||
+            (fabs(sin(l2.getAlpha()))<0.1))
+            return false;
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+bool iCubArmAnalyticSolver::solve(const Vector &q0, const Vector &xd, Vector &qd,
+                                  const double weight2ndTask, const Vector &xd_2nd,
+                                  const Vector &w_2nd, const double weight3rdTask,
+                                  const Vector &qd_3rd, const Vector &w_3rd)
+{
+    if (!isSupported() || (xd.length()<7) || (q0.length()<7))
+        return false;
+
+    iCubArmAnalyticProblem P;
+    for (int i=0; i<10; i++)
+    {
+        iKinLink &l=(*chain)[i];
+        P.L[i].a=l.getA();
+        P.L[i].d=l.getD();
+        P.L[i].ca=cos(l.getAlpha());
+        P.L[i].sa=sin(l.getAlpha());
+        P.L[i].offset=l.getOffset();
+        P.L[i].min=l.getMin();
+        P.L[i].max=l.getMax();
+    }
+
+    P.q0=&q0;
+    P.weight2ndTask=((xd_2nd.length()>=3) && (w_2nd.length()>=3))?weight2ndTask:0.0;
+    P.weight3rdTask=((qd_3rd.length()>=7) && (w_3rd.length()>=7))?weight3rdTask:0.0;
+    P.xd_2nd=&xd_2nd; P.w_2nd=&w_2nd;
+    P.qd_3rd=&qd_3rd; P.w_3rd=&w_3rd;
+    P.LIC=pLIC;
+
+    // the torso is blocked
+    Matrix H2=chain->getH(2,true);
+    for (int r=0; r<3; r++)
+    {
+        for (int c=0; c<3; c++)
+            P.R2[3*r+c]=H2(r,c);
+        P.p2[r]=H2(r,3);
+        P.c[r]=P.p2[r]+P.R2[3*r+2]*P.L[3].d;
+    }
+
+    // frame of the last link: H9=Hd*HN^-1
+    double Rd[9], RN[9], pN[3], k[3]={xd[3], xd[4], xd[5]};
+    double nk=sqrt(k[0]*k[0]+k[1]*k[1]+k[2]*k[2]);
+    if (nk>IKINANALYTIC_EPS)
+    {
+        k[0]/=nk; k[1]/=nk; k[2]/=nk;
+        rotAxis(k,xd[6],Rd);
+    }
+    else
+        rotZ(0.0,Rd);
+
+    Matrix HN=chain->getHN();
+    for (int r=0; r<3; r++)
+    {
+        for (int c=0; c<3; c++)
+            RN[3*r+c]=HN(r,c);
+        pN[r]=HN(r,3);
+    }
+
+    double v[3];
+    for (int r=0; r<3; r++)     // Rd*RN'
+        for (int c=0; c<3; c++)
+            P.R9[3*r+c]=Rd[3*r]*RN[3*c]+Rd[3*r+1]*RN[3*c+1]+Rd[3*r+2]*RN[3*c+2];
+    rotApply(P.R9,pN,v);
+    for (int i=0; i<3; i++)
+        P.p9[i]=xd[i]-v[i];
+
+    // wrist center and its location wrt the shoulder center
+    const iCubArmDH *L=P.L;
+    double r9[3]={-L[9].a, -L[9].d*L[9].sa, -L[9].d*L[9].ca}, pw[3];
+    rotApply(P.R9,r9,v);
+    for (int i=0; i<3; i++)
+        pw[i]=P.p9[i]+v[i]-P.c[i];
+    for (int i=0; i<3; i++)
+        P.t[i]=P.R2[i]*pw[0]+P.R2[3+i]*pw[1]+P.R2[6+i]*pw[2];
+    double D2=P.t[0]*P.t[0]+P.t[1]*P.t[1]+P.t[2]*P.t[2];
+    if (D2<IKINANALYTIC_EPS)
+        return false;
+
+    // elbow: |b+Rx(alpha5)*Rz(theta6)*u|^2=D2
+    double b[3]={L[5].a, 0.0, L[5].d};
+    double u[3]={L[6].a, -L[7].d*L[6].sa, L[6].d+L[7].d*L[6].ca};
+    double b_[3]={L[5].a, L[5].d*L[5].sa, L[5].d*L[5].ca};  // Rx(alpha5)'*b
+    double K=b[0]*b[0]+b[2]*b[2]+u[0]*u[0]+u[1]*u[1]+u[2]*u[2]+2.0*b_[2]*u[2];
+    double A=2.0*(b_[0]*u[0]+b_[1]*u[1]);
+    double B=2.0*(b_[1]*u[0]-b_[0]*u[1]);
+    double R=sqrt(A*A+B*B);
+    if (R<IKINANALYTIC_EPS)
+        return false;
+
+    double cs=(D2-K)/R;
+    if (fabs(cs)>1.0)
+        return false;
+
+    double phi=atan2(B,A);
+    double dphi=acos(cs);
+    double th6[2]={phi+dphi, phi-dphi};
+
+    P.n6=0;
+    double nt=sqrt(D2), kt[3]={P.t[0]/nt, P.t[1]/nt, P.t[2]/nt};
+    for (int i=0; i<((dphi>IKINANALYTIC_EPS)?2:1); i++)
+    {
+        double q6;
+        if (!toJoint(L[6],th6[i],q6))
+            continue;
+
+        // arm vector in the shoulder's end frame
+        double Rx_[9], Rz_[9], M[9], w[3];
+        rotX(L[5].ca,L[5].sa,Rx_);
+        rotZ(th6[i],Rz_);
+        rotMul(Rx_,Rz_,M);
+        rotApply(M,u,w);
+        for (int j=0; j<3; j++)
+            w[j]+=b[j];
+        double nw=sqrt(w[0]*w[0]+w[1]*w[1]+w[2]*w[2]);
+        w[0]/=nw; w[1]/=nw; w[2]/=nw;
+
+        // minimal rotation bringing w onto t
+        double ax[3]={w[1]*kt[2]-w[2]*kt[1], w[2]*kt[0]-w[0]*kt[2], w[0]*kt[1]-w[1]*kt[0]};
+        double s=sqrt(ax[0]*ax[0]+ax[1]*ax[1]+ax[2]*ax[2]);
+        double c=w[0]*kt[0]+w[1]*kt[1]+w[2]*kt[2];
+        if (s>IKINANALYTIC_EPS)
+        {
+            ax[0]/=s; ax[1]/=s; ax[2]/=s;
+            rotAxis(ax,atan2(s,c),P.R0[P.n6]);
+        }
+        else if (c>0.0)
+            rotZ(0.0,P.R0[P.n6]);
+        else
+        {
+            // any axis orthogonal to w
+            double e[3]={0.0, 0.0, 0.0};
+            e[(fabs(w[0])<fabs(w[1]))?((fabs(w[0])<fabs(w[2]))?0:2):((fabs(w[1])<fabs(w[2]))?1:2)]=1.0;
+            ax[0]=w[1]*e[2]-w[2]*e[1]; ax[1]=w[2]*e[0]-w[0]*e[2]; ax[2]=w[0]*e[1]-w[1]*e[0];
+            s=sqrt(ax[0]*ax[0]+ax[1]*ax[1]+ax[2]*ax[2]);
+            ax[0]/=s; ax[1]/=s; ax[2]/=s;
+            rotAxis(ax,M_PI,P.R0[P.n6]);
+        }
+
+        P.theta6[P.n6]=th6[i];
+        P.q6[P.n6]=q6;
+        P.n6++;
+    }
+
+    // sample the swivel angle over all the branches
+    double best=std::numeric_limits<double>::infinity();
+    double best_psi=0.0, q[7], best_q[7];
+    int best_i6=0, best_b4=1, best_b8=1;
+    double step=2.0*M_PI/swivelSamples;
+    for (int i6=0; i6<P.n6; i6++)
+    {
+        for (int n=0; n<swivelSamples; n++)
+        {
+            double psi=-M_PI+n*step;
+            for (int b4=-1; b4<=1; b4+=2)
+            {
+                for (int b8=-1; b8<=1; b8+=2)
+                {
+                    double cost=P.evaluate(i6,psi,b4,b8,q);
+                    if (cost<best)
+                    {
+                        best=cost;
+                        best_psi=psi;
+                        best_i6=i6; best_b4=b4; best_b8=b8;
+                        std::copy(q,q+7,best_q);
+                    }
+                }
+            }
+        }
+    }
+
+    if (best==std::numeric_limits<double>::infinity())
+        return false;
+
+    // local refinement of the swivel angle
+    for (int i=0; i<IKINANALYTIC_REFINE_STEPS; i++)
+    {
+        step*=0.5;
+        for (int dir=-1; dir<=1; dir+=2)
+        {
+            double psi=best_psi+dir*step;
+            double cost=P.evaluate(best_i6,psi,best_b4,best_b8,q);
+            if (cost<best)
+            {
+                best=cost;
+                best_psi=psi;
+                std::copy(q,q+7,best_q);
+                break;
+            }
+        }
+    }
+
+    // validate the solution through the forward kinematics
+    double Re[9], pe[3], T[9], Rt[9], Ra[9];
+    std::copy(P.R2,P.R2+9,Re);
+    std::copy(P.p2,P.p2+3,pe);
+    for (int i=3; i<10; i++)
+    {
+        double theta=best_q[i-3]+L[i].offset;
+        double ct=cos(theta), st=sin(theta);
+        double d[3]={L[i].a*ct, L[i].a*st, L[i].d};
+        rotApply(Re,d,v);
+        for (int j=0; j<3; j++)
+            pe[j]+=v[j];
+
+        rotZ(theta,Rt); rotX(L[i].ca,L[i].sa,Ra);
+        rotMul(Rt,Ra,T);
+        rotMul(Re,T,Rt);
+        std::copy(Rt,Rt+9,Re);
+    }
+
+    double err_pos=0.0;
+    for (int i=0; i<3; i++)
+        err_pos+=(pe[i]-P.p9[i])*(pe[i]-P.p9[i]);
+
+    rotMulT(P.R9,Re,T);
+    double err_ang=acos(std::max(-1.0,std::min(1.0,0.5*(T[0]+T[4]+T[8]-1.0))));
+    if ((sqrt(err_pos)>tol) || (err_ang>tol))
+        return false;
+
+    qd.resize(7);
+    for (int i=0; i<7; i++)
+        qd[i]=best_q[i];
+
+    return true;
+}
+
+
+/************************************************************************/
+bool iCubArmAnalyticSolver::solve(const Vector &q0, const Vector &xd, Vector &qd)
+{
+    Vector dummy;
+    return solve(q0,xd,qd,0.0,dummy,dummy,0.0,dummy,dummy);
+}
+
+
 /************************************************************************/
 class iKin_NLP : public TNLP
 {
@@ -267,6 +791,11 @@ protected:
     yarp::sig::Matrix  J_ang;
     yarp::sig::Matrix  J_2nd;
 
+    yarp::sig::Matrix  H;
+    yarp::sig::Matrix  H_2nd;
+    yarp::sig::Matrix  J1;
+    yarp::sig::Matrix  J2;
+
     yarp::sig::Vector *e_1st;
     yarp::sig::Matrix *J_1st;
     yarp::sig::Vector *e_cst;
@@ -274,6 +803,14 @@ protected:
 
     yarp::sig::Vector linC;
 
+    yarp::sig::Vector  z_L_sol;
+    yarp::sig::Vector  z_U_sol;
+    yarp::sig::Vector  lambda_sol;
+
+    const yarp::sig::Vector *z_L_warm;
+    const yarp::sig::Vector *z_U_warm;
+    const yarp::sig::Vector *lambda_warm;
+
     double __obj_scaling;
     double __x_scaling;
     double __g_scaling;
@@ -289,14 +826,18 @@ protected:
     /************************************************************************/
     virtual void computeQuantities(const Number *x)
     {
-        yarp::sig::Vector new_q(dim);
-        for (Index i=0; i<(int)dim; i++)
-            new_q[i]=x[i];
-
-        if (!(q==new_q) || firstGo)
+        // compare in place to avoid allocating a new vector
+        // at each call, since IPOPT invokes this method from
+        // every eval_* callback
+        bool changed=firstGo;
+        for (Index i=0; (i<(int)dim) && !changed; i++)
+            changed=(q[i]!=x[i]);
+
+        if (changed)
         {
             firstGo=false;
-            q=new_q;
+            for (Index i=0; i<(int)dim; i++)
+                q[i]=x[i];
 
             yarp::sig::Vector v(4,0.0);
             if (xd.length()>=7)
@@ -307,8 +848,10 @@ protected:
                 v[3]=xd[6];
             }
             
+            // the forward pass is cached by the chain and
+            // reused as well by the Hessian computation
             q=chain.setAng(q);
-            yarp::sig::Matrix H=chain.getH();
+            chain.fastGetH(H);
             yarp::sig::Matrix E=axis2dcm(v)*H.transposed();
             v=dcm2axis(E);
             
@@ -319,18 +862,18 @@ protected:
             e_ang[1]=v[3]*v[1];
             e_ang[2]=v[3]*v[2];
 
-            yarp::sig::Matrix J1=chain.GeoJacobian();
+            chain.fastGeoJacobian(J1);
             submatrix(J1,J_xyz,0,2,0,dim-1);
             submatrix(J1,J_ang,3,5,0,dim-1);
 
             if (weight2ndTask!=0.0)
             {
-                yarp::sig::Matrix H_2nd=chain2ndTask.getH();
+                chain2ndTask.fastGetH(H_2nd);
                 e_2nd[0]=w_2nd[0]*(xd_2nd[0]-H_2nd(0,3));
                 e_2nd[1]=w_2nd[1]*(xd_2nd[1]-H_2nd(1,3));
                 e_2nd[2]=w_2nd[2]*(xd_2nd[2]-H_2nd(2,3));
 
-                yarp::sig::Matrix J2=chain2ndTask.GeoJacobian();
+                chain2ndTask.fastGeoJacobian(J2);
 
                 for (unsigned int i=0; i<dim_2nd; i++)
                 {
@@ -422,11 +965,32 @@ public:
         upperBoundInf=std::numeric_limits<double>::max();
 
         callback=NULL;
+
+        z_L_warm=z_U_warm=lambda_warm=NULL;
     }
 
     /************************************************************************/
     yarp::sig::Vector get_qd() { return qd; }
 
+    /************************************************************************/
+    const yarp::sig::Vector &get_z_L() const { return z_L_sol; }
+
+    /************************************************************************/
+    const yarp::sig::Vector &get_z_U() const { return z_U_sol; }
+
+    /************************************************************************/
+    const yarp::sig::Vector &get_lambda() const { return lambda_sol; }
+
+    /************************************************************************/
+    void set_warm_start(const yarp::sig::Vector &_q0, const yarp::sig::Vector *_z_L,
+                        const yarp::sig::Vector *_z_U, const yarp::sig::Vector *_lambda)
+    {
+        q0=_q0;
+        z_L_warm=_z_L;
+        z_U_warm=_z_U;
+        lambda_warm=_lambda;
+    }
+
     /************************************************************************/
     void set_callback(iKinIterateCallback *_callback) { callback=_callback; }
 
@@ -551,6 +1115,28 @@ public:
         for (Index i=0; i<n; i++)
             x[i]=q0[i];
 
+        if (init_z)
+        {
+            if ((z_L_warm==NULL) || (z_U_warm==NULL) ||
+                ((Index)z_L_warm->length()!=n) || ((Index)z_U_warm->length()!=n))
+                return false;
+
+            for (Index i=0; i<n; i++)
+            {
+                z_L[i]=(*z_L_warm)[i];
+                z_U[i]=(*z_U_warm)[i];
+            }
+        }
+
+        if (init_lambda)
+        {
+            if ((lambda_warm==NULL) || ((Index)lambda_warm->length()!=m))
+                return false;
+
+            for (Index i=0; i<m; i++)
+                lambda[i]=(*lambda_warm)[i];
+        }
+
         return true;
     }
     
@@ -683,58 +1269,99 @@ public:
         {
             // Given the task: min f(q)=||xd-F(q)||^2
             // the Hessian Hij is: 2 * (<dF/dqi,dF/dqj> - <d2F/dqidqj,e>)
+            // where, for i<=j, d2F/dqidqj=[Jo_i x Jl_j; Jo_i x Jo_j]
+            // (ref. E.D. Pohl, H. Lipkin, "A New Method of Robotic Motion
+            // Control Near Singularities", Advanced Robotics, 1991).
+            // Since <Jo_i x Jl_j,el>=<Jo_i,Jl_j x el>, each row j of the
+            // Hessian is a linear combination of the Jacobian columns
+            // i<=j, which is assembled in one sweep over the Jacobian
+            // already available from computeQuantities().
             computeQuantities(x);
-            chain.prepareForHessian();
 
-            if (weight2ndTask!=0.0)
-                chain2ndTask.prepareForHessian();
+            // weights of the Gram terms for each Jacobian row
+            double g[6]={0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+            if (J_1st==&J_xyz)
+                g[0]=g[1]=g[2]=obj_factor;
+            else if (J_1st==&J_ang)
+                g[3]=g[4]=g[5]=obj_factor;
+
+            if (J_cst==&J_xyz)
+                g[0]=g[1]=g[2]=g[0]+lambda[0];
+            else if (J_cst==&J_ang)
+                g[3]=g[4]=g[5]=g[3]+lambda[0];
+
+            // errors weighting the second order terms
+            // in position (wl) and orientation (wo)
+            double wl[3]={0.0, 0.0, 0.0};
+            double wo[3]={0.0, 0.0, 0.0};
+            double *w_1st,*w_cst;
+            if (e_cst==&e_xyz)
+            {
+                w_1st=(ctrlPose==IKINCTRL_POSE_FULL)?wo:NULL;
+                w_cst=wl;
+            }
+            else
+            {
+                w_1st=(ctrlPose==IKINCTRL_POSE_FULL)?wl:NULL;
+                w_cst=wo;
+            }
 
+            for (int k=0; k<3; k++)
+            {
+                if (w_1st!=NULL)
+                    w_1st[k]+=obj_factor*(*e_1st)[k];
+                w_cst[k]+=lambda[0]*(*e_cst)[k];
+            }
+
+            const double *J=J1.data();
             Index idx=0;
             for (Index row=0; row<n; row++)
             {
+                const double *Jl=J+row;
+                const double *Jo=J+3*dim+row;
+                double Jl0=Jl[0], Jl1=Jl[dim], Jl2=Jl[2*dim];
+                double Jo0=Jo[0], Jo1=Jo[dim], Jo2=Jo[2*dim];
+
+                // d = g.*J_row - (Jl_row x wl + Jo_row x wo)
+                double d[6];
+                d[0]=g[0]*Jl0;
+                d[1]=g[1]*Jl1;
+                d[2]=g[2]*Jl2;
+                d[3]=g[3]*Jo0-(Jl1*wl[2]-Jl2*wl[1])-(Jo1*wo[2]-Jo2*wo[1]);
+                d[4]=g[4]*Jo1-(Jl2*wl[0]-Jl0*wl[2])-(Jo2*wo[0]-Jo0*wo[2]);
+                d[5]=g[5]*Jo2-(Jl0*wl[1]-Jl1*wl[0])-(Jo0*wo[1]-Jo1*wo[0]);
+
+                Number *h=values+idx;
                 for (Index col=0; col<=row; col++)
-                {
-                    // warning: row and col are swapped due to asymmetry
-                    // of orientation part within the hessian 
-                    yarp::sig::Vector h=chain.fastHessian_ij(col,row);
-                    yarp::sig::Vector h_xyz(3), h_ang(3), h_zero(3,0.0);
-                    h_xyz[0]=h[0];
-                    h_xyz[1]=h[1];
-                    h_xyz[2]=h[2];
-                    h_ang[0]=h[3];
-                    h_ang[1]=h[4];
-                    h_ang[2]=h[5];
-
-                    yarp::sig::Vector *h_1st,*h_cst;
-                    if (e_cst==&e_xyz)
-                    {
-                        h_1st=(ctrlPose==IKINCTRL_POSE_FULL)?&h_ang:&h_zero;
-                        h_cst=&h_xyz;
-                    }
-                    else
-                    {
-                        h_1st=(ctrlPose==IKINCTRL_POSE_FULL)?&h_xyz:&h_zero;
-                        h_cst=&h_ang;
-                    }
+                    h[col]=2.0*(d[0]*J[col]+d[1]*J[dim+col]+d[2]*J[2*dim+col]+
+                                d[3]*J[3*dim+col]+d[4]*J[4*dim+col]+d[5]*J[5*dim+col]);
 
-                    values[idx]=2.0*(obj_factor*(dot(*J_1st,row,*J_1st,col)-dot(*h_1st,*e_1st))+
-                                     lambda[0]*(dot(*J_cst,row,*J_cst,col)-dot(*h_cst,*e_cst)));
-                
-                    if ((weight2ndTask!=0.0) && (row<(int)dim_2nd) && (col<(int)dim_2nd))
-                    {    
-                        // warning: row and col are swapped due to asymmetry
-                        // of orientation part within the hessian 
-                        yarp::sig::Vector h2=chain2ndTask.fastHessian_ij(col,row);
-                        yarp::sig::Vector h_2nd(3);
-                        h_2nd[0]=(w_2nd[0]*w_2nd[0])*h2[0];
-                        h_2nd[1]=(w_2nd[1]*w_2nd[1])*h2[1];
-                        h_2nd[2]=(w_2nd[2]*w_2nd[2])*h2[2];
-                
-                        values[idx]+=2.0*obj_factor*weight2ndTask*(dot(J_2nd,row,J_2nd,col)-dot(h_2nd,e_2nd));
-                    }
-                
-                    idx++;
+                if ((weight2ndTask!=0.0) && (row<(int)dim_2nd))
+                {
+                    const double *J_=J2.data();
+                    const double *Jl_=J_+row;
+                    double k=2.0*obj_factor*weight2ndTask;
+                    double w0=w_2nd[0]*w_2nd[0];
+                    double w1=w_2nd[1]*w_2nd[1];
+                    double w2=w_2nd[2]*w_2nd[2];
+                    double we0=w0*e_2nd[0];
+                    double we1=w1*e_2nd[1];
+                    double we2=w2*e_2nd[2];
+
+                    double d_[6];
+                    d_[0]=k*w0*Jl_[0];
+                    d_[1]=k*w1*Jl_[dim_2nd];
+                    d_[2]=k*w2*Jl_[2*dim_2nd];
+                    d_[3]=-k*(Jl_[dim_2nd]*we2-Jl_[2*dim_2nd]*we1);
+                    d_[4]=-k*(Jl_[2*dim_2nd]*we0-Jl_[0]*we2);
+                    d_[5]=-k*(Jl_[0]*we1-Jl_[dim_2nd]*we0);
+
+                    for (Index col=0; col<=row; col++)
+                        h[col]+=d_[0]*J_[col]+d_[1]*J_[dim_2nd+col]+d_[2]*J_[2*dim_2nd+col]+
+                                d_[3]*J_[3*dim_2nd+col]+d_[4]*J_[4*dim_2nd+col]+d_[5]*J_[5*dim_2nd+col];
                 }
+
+                idx+=row+1;
             }
         }
         
@@ -785,6 +1412,18 @@ public:
             qd[i]=x[i];
 
         qd=chain.setAng(qd);
+
+        z_L_sol.resize(n);
+        z_U_sol.resize(n);
+        for (Index i=0; i<n; i++)
+        {
+            z_L_sol[i]=z_L[i];
+            z_U_sol[i]=z_U[i];
+        }
+
+        lambda_sol.resize(m);
+        for (Index i=0; i<m; i++)
+            lambda_sol[i]=lambda[i];
     }
 
     /************************************************************************/
@@ -792,6 +1431,201 @@ public:
 };
 
 
+
+namespace
+{
+
+/************************************************************************/
+struct iKinSolutionCacheEntry
+{
+    long long         voxel;
+    yarp::sig::Vector xd;
+    yarp::sig::Vector ctx;
+    yarp::sig::Vector aux;
+    yarp::sig::Vector qd;
+    yarp::sig::Vector x;
+    yarp::sig::Vector z_L;
+    yarp::sig::Vector z_U;
+    yarp::sig::Vector lambda;
+};
+
+
+/************************************************************************/
+double poseDistance(const yarp::sig::Vector &x1, const yarp::sig::Vector &x2,
+                    const bool useAng)
+{
+    if (x1.length()!=x2.length())
+        return std::numeric_limits<double>::max();
+
+    double dx=x1[0]-x2[0];
+    double dy=x1[1]-x2[1];
+    double dz=x1[2]-x2[2];
+    double d=sqrt(dx*dx+dy*dy+dz*dz);
+
+    // compare orientations through their rotation vectors
+    if (useAng && (x1.length()>=7))
+    {
+        double r[3];
+        for (int i=0; i<3; i++)
+            r[i]=x1[3+i]*x1[6]-x2[3+i]*x2[6];
+
+        d=std::max(d,sqrt(r[0]*r[0]+r[1]*r[1]+r[2]*r[2]));
+    }
+
+    return d;
+}
+
+
+/************************************************************************/
+double auxDistance(const yarp::sig::Vector &a1, const yarp::sig::Vector &a2)
+{
+    if (a1.length()!=a2.length())
+        return std::numeric_limits<double>::max();
+
+    double d=0.0;
+    for (size_t i=0; i<a1.length(); i++)
+        d=std::max(d,fabs(a1[i]-a2[i]));
+
+    return d;
+}
+
+
+/************************************************************************/
+class iKinSolutionCache
+{
+protected:
+    // entries are kept in insertion order, whereas the grid maps
+    // each voxel of side warmTol onto the ids of its entries
+    std::deque<iKinSolutionCacheEntry> entries;
+    std::unordered_multimap<long long,size_t> grid;
+    size_t frontId;
+
+    /************************************************************************/
+    long long cell(const double v) const
+    {
+        return (long long)std::floor(v/warmTol);
+    }
+
+    /************************************************************************/
+    long long voxelKey(const long long ix, const long long iy, const long long iz) const
+    {
+        const long long mask=0x1fffff;
+        return ((ix&mask)<<42)|((iy&mask)<<21)|(iz&mask);
+    }
+
+public:
+    bool   enabled;
+    bool   warmOpt;
+    size_t maxSize;
+    double warmTol;
+    double reuseTol;
+
+    iKinSolutionCacheStats stats;
+
+    /************************************************************************/
+    iKinSolutionCache() : frontId(0), enabled(false), warmOpt(false),
+                          maxSize(IKINIPOPT_CACHE_DEFAULT_SIZE),
+                          warmTol(IKINIPOPT_CACHE_DEFAULT_WARMTOL),
+                          reuseTol(IKINIPOPT_CACHE_DEFAULT_REUSETOL)
+    {
+        resetStats();
+    }
+
+    /************************************************************************/
+    void clear()
+    {
+        entries.clear();
+        grid.clear();
+        frontId=0;
+    }
+
+    /************************************************************************/
+    void resetStats()
+    {
+        stats.solves=stats.reuses=0;
+        stats.warmStarts=stats.coldStarts=0;
+        stats.warmIters=stats.coldIters=0;
+        stats.itersSaved=0.0;
+    }
+
+    /************************************************************************/
+    double meanColdIters() const
+    {
+        return (stats.coldStarts>0)?(double)stats.coldIters/(double)stats.coldStarts:0.0;
+    }
+
+    /************************************************************************/
+    long long voxel(const yarp::sig::Vector &xd) const
+    {
+        return voxelKey(cell(xd[0]),cell(xd[1]),cell(xd[2]));
+    }
+
+    /************************************************************************/
+    const iKinSolutionCacheEntry *find(const yarp::sig::Vector &xd,
+                                       const yarp::sig::Vector &ctx,
+                                       const bool useAng, double &dist) const
+    {
+        const iKinSolutionCacheEntry *best=NULL;
+        dist=std::numeric_limits<double>::max();
+
+        long long ix=cell(xd[0]);
+        long long iy=cell(xd[1]);
+        long long iz=cell(xd[2]);
+
+        // the voxel side equals warmTol, hence any candidate
+        // lies within the 27 voxels surrounding the target
+        for (long long i=ix-1; i<=ix+1; i++)
+            for (long long j=iy-1; j<=iy+1; j++)
+                for (long long k=iz-1; k<=iz+1; k++)
+                {
+                    auto range=grid.equal_range(voxelKey(i,j,k));
+                    for (auto it=range.first; it!=range.second; ++it)
+                    {
+                        const iKinSolutionCacheEntry &entry=entries[it->second-frontId];
+                        if (!(entry.ctx==ctx))
+                            continue;
+
+                        double d=poseDistance(entry.xd,xd,useAng);
+                        if (d<dist)
+                        {
+                            dist=d;
+                            best=&entry;
+                        }
+                    }
+                }
+
+        return (dist<=warmTol)?best:NULL;
+    }
+
+    /************************************************************************/
+    void store(const iKinSolutionCacheEntry &entry)
+    {
+        if (maxSize==0)
+            return;
+
+        while (entries.size()>=maxSize)
+        {
+            auto range=grid.equal_range(entries.front().voxel);
+            for (auto it=range.first; it!=range.second; ++it)
+            {
+                if (it->second==frontId)
+                {
+                    grid.erase(it);
+                    break;
+                }
+            }
+
+            entries.pop_front();
+            frontId++;
+        }
+
+        entries.push_back(entry);
+        grid.insert(std::make_pair(entry.voxel,frontId+entries.size()-1));
+    }
+};
+
+}
+
 /************************************************************************/
 iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const double tol,
                            const double constr_tol, const int max_iter,
@@ -808,6 +1642,7 @@ iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const dou
     chain.setAllConstraints(false); // this is required since IpOpt initially relaxes constraints
 
     App=new IpoptApplication();
+    cache=new iKinSolutionCache();
 
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("tol",tol);
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("constr_viol_tol",constr_tol);
@@ -815,6 +1650,11 @@ iKinIpOptMin::iKinIpOptMin(iKinChain &c, const unsigned int _ctrlPose, const dou
     CAST_IPOPTAPP(App)->Options()->SetStringValue("mu_strategy","adaptive");
     CAST_IPOPTAPP(App)->Options()->SetIntegerValue("print_level",verbose);
 
+    // keep the warm-start point close to the cached solution
+    CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_bound_push",IKINIPOPT_WARMSTART_BOUND_PUSH);
+    CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_mult_bound_push",IKINIPOPT_WARMSTART_BOUND_PUSH);
+    CAST_IPOPTAPP(App)->Options()->SetNumericValue("warm_start_slack_bound_push",IKINIPOPT_WARMSTART_BOUND_PUSH);
+
     getBoundsInf(lowerBoundInf,upperBoundInf);
 
     if (max_iter>0)
@@ -866,6 +1706,8 @@ void iKinIpOptMin::specify2ndTaskEndEff(const unsigned int n)
     chain2ndTask.setH0(chain.getH0());
     if (_n==chain.getN())
         chain2ndTask.setHN(chain.getHN()); 
+
+    clearSolutionCache();
 }
 
 
@@ -919,6 +1761,7 @@ void iKinIpOptMin::setTol(const double tol)
 {
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("tol",tol);
     CAST_IPOPTAPP(App)->Initialize();
+    clearSolutionCache();
 }
 
 
@@ -936,6 +1779,7 @@ void iKinIpOptMin::setConstrTol(const double constr_tol)
 {
     CAST_IPOPTAPP(App)->Options()->SetNumericValue("constr_viol_tol",constr_tol);
     CAST_IPOPTAPP(App)->Initialize();
+    clearSolutionCache();
 }
 
 
@@ -1026,6 +1870,60 @@ void iKinIpOptMin::setBoundsInf(const double lower, const double upper)
 }
 
 
+/************************************************************************/
+void iKinIpOptMin::setSolutionCache(const bool enable, const size_t maxSize,
+                                    const double warmTol, const double reuseTol)
+{
+    iKinSolutionCache *c=CAST_SLVCACHE(cache);
+
+    c->enabled=enable;
+    c->maxSize=maxSize;
+    c->warmTol=(warmTol>0.0)?warmTol:IKINIPOPT_CACHE_DEFAULT_WARMTOL;
+    c->reuseTol=std::min(std::max(reuseTol,0.0),c->warmTol);
+    c->clear();
+}
+
+
+/************************************************************************/
+bool iKinIpOptMin::getSolutionCache(size_t *maxSize, double *warmTol,
+                                    double *reuseTol) const
+{
+    iKinSolutionCache *c=CAST_SLVCACHE(cache);
+
+    if (maxSize!=NULL)
+        *maxSize=c->maxSize;
+
+    if (warmTol!=NULL)
+        *warmTol=c->warmTol;
+
+    if (reuseTol!=NULL)
+        *reuseTol=c->reuseTol;
+
+    return c->enabled;
+}
+
+
+/************************************************************************/
+void iKinIpOptMin::clearSolutionCache()
+{
+    CAST_SLVCACHE(cache)->clear();
+}
+
+
+/************************************************************************/
+iKinSolutionCacheStats iKinIpOptMin::getSolutionCacheStats() const
+{
+    return CAST_SLVCACHE(cache)->stats;
+}
+
+
+/************************************************************************/
+void iKinIpOptMin::resetSolutionCacheStats()
+{
+    CAST_SLVCACHE(cache)->resetStats();
+}
+
+
 /************************************************************************/
 yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Vector &xd,
                                       double weight2ndTask, yarp::sig::Vector &xd_2nd,
@@ -1033,6 +1931,103 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
                                       yarp::sig::Vector &qd_3rd, yarp::sig::Vector &w_3rd,
                                       int *exit_code, bool *exhalt, iKinIterateCallback *iterate)
 {
+    iKinSolutionCache *c=CAST_SLVCACHE(cache);
+    const iKinSolutionCacheEntry *hit=NULL;
+    bool useAng=(ctrlPose!=IKINCTRL_POSE_XYZ);
+    yarp::sig::Vector ctx,aux;
+    double dist;
+
+    if (c->enabled && (xd.length()>=3))
+    {
+        // discrete context the cached solutions must share
+        ctx.push_back(ctrlPose);
+        ctx.push_back(posePriority=="position"?0.0:1.0);
+        ctx.push_back(obj_scaling);
+        ctx.push_back(x_scaling);
+        ctx.push_back(g_scaling);
+        ctx.push_back(weight2ndTask);
+        ctx.push_back(weight3rdTask);
+        ctx.push_back(chain2ndTask.getN());
+        ctx.push_back(pLIC->isActive()?1.0:0.0);
+        if (pLIC->isActive())
+        {
+            const yarp::sig::Matrix &C=pLIC->getC();
+            ctx.push_back(C.rows());
+            ctx.push_back(C.cols());
+            for (int r=0; r<C.rows(); r++)
+                for (int k=0; k<C.cols(); k++)
+                    ctx.push_back(C(r,k));
+
+            ctx=cat(ctx,pLIC->getlB());
+            ctx=cat(ctx,pLIC->getuB());
+        }
+
+        // the geometry and the limits of the links
+        ctx.push_back(chain.getN());
+        for (unsigned int i=0; i<chain.getN(); i++)
+        {
+            ctx.push_back(chain[i].isBlocked()?1.0:0.0);
+            ctx.push_back(chain[i].getA());
+            ctx.push_back(chain[i].getD());
+            ctx.push_back(chain[i].getAlpha());
+            ctx.push_back(chain[i].getOffset());
+            ctx.push_back(chain[i].getMin());
+            ctx.push_back(chain[i].getMax());
+        }
+
+        const yarp::sig::Matrix &H0=chain.getH0();
+        const yarp::sig::Matrix &HN=chain.getHN();
+        for (int r=0; r<4; r++)
+            for (int k=0; k<4; k++)
+            {
+                ctx.push_back(H0(r,k));
+                ctx.push_back(HN(r,k));
+            }
+
+        // continuous quantities the reuse is subject to:
+        // the solution depends also on the starting point
+        for (unsigned int i=0; i<chain.getN(); i++)
+            if (chain[i].isBlocked())
+                aux.push_back(chain[i].getAng());
+
+        for (size_t i=0; i<q0.length(); i++)
+            aux.push_back(q0[i]);
+
+        if (weight2ndTask!=0.0)
+            for (size_t i=0; i<std::min(xd_2nd.length(),w_2nd.length()); i++)
+                aux.push_back(w_2nd[i]*xd_2nd[i]);
+
+        if (weight3rdTask!=0.0)
+            for (size_t i=0; i<std::min(qd_3rd.length(),w_3rd.length()); i++)
+                aux.push_back(w_3rd[i]*qd_3rd[i]);
+
+        c->stats.solves++;
+        hit=c->find(xd,ctx,useAng,dist);
+
+        if ((hit!=NULL) && (dist<=c->reuseTol) && (auxDistance(hit->aux,aux)<=c->reuseTol))
+        {
+            // the cached solution must still attain the same pose
+            // in the current chain before being handed out
+            yarp::sig::Vector qd=chain.setAng(hit->qd);
+            if (poseDistance(chain.EndEffPose(),hit->x,true)<=c->reuseTol)
+            {
+                c->stats.reuses++;
+                c->stats.itersSaved+=c->meanColdIters();
+
+                if (exit_code!=NULL)
+                    *exit_code=IKINIPOPT_SOLVED_FROM_CACHE;
+
+                return qd;
+            }
+        }
+
+        // multipliers are required by IpOpt to warm-start
+        if ((hit!=NULL) && ((hit->qd.length()!=chain.getDOF()) ||
+                            (hit->z_L.length()!=chain.getDOF()) ||
+                            (hit->lambda.length()==0)))
+            hit=NULL;
+    }
+
     SmartPtr<iKin_NLP> nlp=new iKin_NLP(chain,ctrlPose,q0,xd,
                                         weight2ndTask,chain2ndTask,xd_2nd,w_2nd,
                                         weight3rdTask,qd_3rd,w_3rd,
@@ -1043,11 +2038,60 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
     nlp->set_posePriority(posePriority);
     nlp->set_callback(iterate);
 
+    bool warm=(hit!=NULL);
+    if (warm)
+        nlp->set_warm_start(hit->qd,&hit->z_L,&hit->z_U,&hit->lambda);
+
+    // the options are read by IpOpt at each optimization,
+    // hence they are touched only when they need to change
+    if (warm!=c->warmOpt)
+    {
+        CAST_IPOPTAPP(App)->Options()->SetStringValue("warm_start_init_point",warm?"yes":"no");
+        CAST_IPOPTAPP(App)->Options()->SetNumericValue("mu_init",warm?IKINIPOPT_WARMSTART_MU_INIT:
+                                                                       IKINIPOPT_COLDSTART_MU_INIT);
+        c->warmOpt=warm;
+    }
+
     ApplicationReturnStatus status=CAST_IPOPTAPP(App)->OptimizeTNLP(GetRawPtr(nlp));
 
     if (exit_code!=NULL)
         *exit_code=status;
 
+    if (c->enabled && (xd.length()>=3))
+    {
+        int iters=0;
+        SmartPtr<SolveStatistics> stats=CAST_IPOPTAPP(App)->Statistics();
+        if (IsValid(stats))
+            iters=stats->IterationCount();
+
+        if (warm)
+        {
+            c->stats.warmStarts++;
+            c->stats.warmIters+=iters;
+            c->stats.itersSaved+=c->meanColdIters()-iters;
+        }
+        else
+        {
+            c->stats.coldStarts++;
+            c->stats.coldIters+=iters;
+        }
+
+        if ((status==Solve_Succeeded) || (status==Solved_To_Acceptable_Level))
+        {
+            iKinSolutionCacheEntry entry;
+            entry.voxel=c->voxel(xd);
+            entry.xd=xd;
+            entry.ctx=ctx;
+            entry.aux=aux;
+            entry.qd=nlp->get_qd();
+            entry.x=chain.EndEffPose();
+            entry.z_L=nlp->get_z_L();
+            entry.z_U=nlp->get_z_U();
+            entry.lambda=nlp->get_lambda();
+            c->store(entry);
+        }
+    }
+
     return nlp->get_qd();
 }
 
@@ -1074,6 +2118,7 @@ yarp::sig::Vector iKinIpOptMin::solve(const yarp::sig::Vector &q0, yarp::sig::Ve
 iKinIpOptMin::~iKinIpOptMin()
 {
     delete CAST_IPOPTAPP(App);
+    delete CAST_SLVCACHE(cache);
 }
 
 
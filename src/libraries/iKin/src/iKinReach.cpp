@@ -0,0 +1,733 @@
+/*
+ * Copyright (C) 2006-2018 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD-3-Clause license. See the accompanying LICENSE file for
+ * details.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+#include <limits>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#include <yarp/math/Math.h>
+#include <iCub/iKin/iKinReach.h>
+
+#define CAST_MAPPING(x)                 (static_cast<iKinReachMapping*>(x))
+#define IKINREACH_MAGIC                 "IKINRMAP"
+#define IKINREACH_VERSION               2
+#define IKINREACH_MAX_CELLS             (1<<28)
+#define IKINREACH_DIR_THRES             0.3826834323650898  // sin(22.5 deg)
+#define IKINREACH_GEOM_TOL              1e-6                // [m] and [rad]
+
+using namespace std;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::iKin;
+
+
+namespace
+{
+
+/************************************************************************/
+// the file layout is: header, voxels index, entries;
+// each entry is made up of iKinReachMapEntry followed
+// by the seed as dof floats
+struct iKinReachMapHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t N;
+    uint32_t dof;
+    uint32_t numBins;
+    uint64_t samples;
+    uint64_t blocked;
+    uint32_t dims[3];
+    uint32_t numEntries;
+    double   origin[3];
+    double   voxelSize;
+    double   blockedAng[IKINREACH_MAX_LINKS];
+    double   links[IKINREACH_MAX_LINKS][6];  // A, D, alpha, offset, min, max
+    double   H0[16];
+    double   HN[16];
+};
+
+
+/************************************************************************/
+struct iKinReachMapEntry
+{
+    uint32_t dirMask;
+    uint32_t hits;
+    float    manip;
+};
+
+
+/************************************************************************/
+struct iKinReachMapping
+{
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE map;
+#endif
+    void  *addr;
+    size_t length;
+};
+
+
+/************************************************************************/
+struct iKinReachVoxel
+{
+    uint32_t      dirMask;
+    uint32_t      hits;
+    float         manip;
+    vector<float> q;
+};
+
+
+/************************************************************************/
+inline void linkParams(const iKinLink &link, double *params)
+{
+    params[0]=link.getA();
+    params[1]=link.getD();
+    params[2]=link.getAlpha();
+    params[3]=link.getOffset();
+    params[4]=link.getMin();
+    params[5]=link.getMax();
+}
+
+
+/************************************************************************/
+inline size_t entrySize(const uint32_t dof)
+{
+    return sizeof(iKinReachMapEntry)+dof*sizeof(float);
+}
+
+
+/************************************************************************/
+inline int64_t voxelKey(const int64_t i, const int64_t j, const int64_t k)
+{
+    return ((i+(1<<20))<<42)|((j+(1<<20))<<21)|(k+(1<<20));
+}
+
+
+/************************************************************************/
+inline void voxelCoords(const int64_t key, int64_t &i, int64_t &j, int64_t &k)
+{
+    const int64_t mask=(int64_t(1)<<21)-1;
+    i=((key>>42)&mask)-(1<<20);
+    j=((key>>21)&mask)-(1<<20);
+    k=(key&mask)-(1<<20);
+}
+
+
+/************************************************************************/
+inline int dirBin(const double *z)
+{
+    int code=0;
+    for (int i=0; i<3; i++)
+        code=3*code+((z[i]>IKINREACH_DIR_THRES)?2:((z[i]<-IKINREACH_DIR_THRES)?0:1));
+
+    // code 13 corresponds to the null direction
+    return (code<13)?code:code-1;
+}
+
+
+/************************************************************************/
+inline int popCount(uint32_t x)
+{
+    int cnt=0;
+    for (; x; cnt++)
+        x&=x-1;
+
+    return cnt;
+}
+
+
+/************************************************************************/
+void sampleWorkspace(iKinLimb *limb, const double voxelSize, const size_t samples,
+                     const unsigned int seed, unordered_map<int64_t,iKinReachVoxel> *voxels)
+{
+    iKinChain &chain=*limb->asChain();
+    unsigned int dof=chain.getDOF();
+
+    mt19937 gen(seed);
+    vector<uniform_real_distribution<double>> rnd;
+    for (unsigned int i=0; i<dof; i++)
+        rnd.push_back(uniform_real_distribution<double>(chain(i).getMin(),chain(i).getMax()));
+
+    Vector q(dof);
+    for (size_t n=0; n<samples; n++)
+    {
+        for (unsigned int i=0; i<dof; i++)
+            q[i]=rnd[i](gen);
+
+        Matrix H=chain.getH(q);
+        Matrix J=chain.GeoJacobian();
+
+        int64_t key=voxelKey((int64_t)floor(H(0,3)/voxelSize),
+                             (int64_t)floor(H(1,3)/voxelSize),
+                             (int64_t)floor(H(2,3)/voxelSize));
+
+        double z[3]={H(0,2), H(1,2), H(2,2)};
+
+        // manipulability of the positional part
+        Matrix Jp=J.submatrix(0,2,0,dof-1);
+        double manip=sqrt(std::max(0.0,det(Jp*Jp.transposed())));
+
+        iKinReachVoxel &voxel=(*voxels)[key];
+        if (voxel.hits==0)
+        {
+            voxel.dirMask=0;
+            voxel.manip=-1.0f;
+            voxel.q.resize(dof);
+        }
+
+        voxel.dirMask|=(uint32_t(1)<<dirBin(z));
+        voxel.hits++;
+        if (manip>voxel.manip)
+        {
+            voxel.manip=(float)manip;
+            for (unsigned int i=0; i<dof; i++)
+                voxel.q[i]=(float)q[i];
+        }
+    }
+}
+
+}
+
+
+/************************************************************************/
+iKinReachMap::iKinReachMap() : mapping(NULL), data(NULL), length(0)
+{
+}
+
+
+/************************************************************************/
+bool iKinReachMap::setData(const char *_data, const size_t _length)
+{
+    const iKinReachMapHeader *header=reinterpret_cast<const iKinReachMapHeader*>(_data);
+    if ((_length<sizeof(iKinReachMapHeader)) ||
+        (memcmp(header->magic,IKINREACH_MAGIC,sizeof(header->magic))!=0) ||
+        (header->version!=IKINREACH_VERSION) || (header->N>IKINREACH_MAX_LINKS) ||
+        (header->dof>header->N) || (header->numBins!=IKINREACH_DIR_BINS) ||
+        !(header->voxelSize>0.0))
+        return false;
+
+    size_t cells=(size_t)header->dims[0]*header->dims[1]*header->dims[2];
+    if ((cells>IKINREACH_MAX_CELLS) ||
+        (_length!=sizeof(iKinReachMapHeader)+cells*sizeof(int32_t)+
+                  header->numEntries*entrySize(header->dof)))
+        return false;
+
+    // lookups rely on the index pointing within the entries
+    int32_t id;
+    const char *index=_data+sizeof(iKinReachMapHeader);
+    for (size_t i=0; i<cells; i++)
+    {
+        memcpy(&id,index+i*sizeof(int32_t),sizeof(id));
+        if ((id<-1) || ((id>=0) && ((uint32_t)id>=header->numEntries)))
+            return false;
+    }
+
+    data=_data;
+    length=_length;
+    return true;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::build(iKinLimb &limb, const double voxelSize,
+                         const size_t samples, const int threads,
+                         const unsigned int seed)
+{
+    clear();
+
+    iKinChain &chain=*limb.asChain();
+    unsigned int N=chain.getN();
+    unsigned int dof=chain.getDOF();
+    if ((voxelSize<=0.0) || (samples==0) || (dof==0) || (N>IKINREACH_MAX_LINKS))
+        return false;
+
+    // each thread samples its own copy of the limb
+    size_t numThreads=(threads>0)?threads:std::max(1U,thread::hardware_concurrency());
+    numThreads=std::min(numThreads,samples);
+
+    vector<iKinLimb*> limbs(numThreads);
+    vector<unordered_map<int64_t,iKinReachVoxel>> voxels(numThreads);
+    vector<thread> workers;
+    for (size_t i=0; i<numThreads; i++)
+    {
+        limbs[i]=new iKinLimb(limb);
+        size_t n=samples/numThreads+((i<samples%numThreads)?1:0);
+        workers.push_back(thread(sampleWorkspace,limbs[i],voxelSize,n,
+                                 seed+(unsigned int)i,&voxels[i]));
+    }
+
+    for (size_t i=0; i<numThreads; i++)
+    {
+        workers[i].join();
+        delete limbs[i];
+    }
+
+    // merge the partial maps
+    unordered_map<int64_t,iKinReachVoxel> &merged=voxels[0];
+    for (size_t i=1; i<numThreads; i++)
+    {
+        for (auto &it:voxels[i])
+        {
+            iKinReachVoxel &voxel=merged[it.first];
+            if (voxel.hits==0)
+                voxel=it.second;
+            else
+            {
+                voxel.dirMask|=it.second.dirMask;
+                voxel.hits+=it.second.hits;
+                if (it.second.manip>voxel.manip)
+                {
+                    voxel.manip=it.second.manip;
+                    voxel.q=it.second.q;
+                }
+            }
+        }
+
+        voxels[i].clear();
+    }
+
+    // bounding box of the occupied voxels
+    int64_t lo[3], hi[3];
+    std::fill(lo,lo+3,std::numeric_limits<int64_t>::max());
+    std::fill(hi,hi+3,std::numeric_limits<int64_t>::min());
+    for (auto &it:merged)
+    {
+        int64_t c[3];
+        voxelCoords(it.first,c[0],c[1],c[2]);
+        for (int i=0; i<3; i++)
+        {
+            lo[i]=std::min(lo[i],c[i]);
+            hi[i]=std::max(hi[i],c[i]);
+        }
+    }
+
+    iKinReachMapHeader header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,IKINREACH_MAGIC,sizeof(header.magic));
+    header.version=IKINREACH_VERSION;
+    header.N=N;
+    header.dof=dof;
+    header.numBins=IKINREACH_DIR_BINS;
+    header.samples=samples;
+    header.numEntries=(uint32_t)merged.size();
+    header.voxelSize=voxelSize;
+
+    size_t cells=1;
+    for (int i=0; i<3; i++)
+    {
+        header.dims[i]=(uint32_t)(hi[i]-lo[i]+1);
+        header.origin[i]=lo[i]*voxelSize;
+        cells*=header.dims[i];
+    }
+
+    if (cells>IKINREACH_MAX_CELLS)
+        return false;
+
+    for (unsigned int i=0; i<N; i++)
+    {
+        linkParams(chain[i],header.links[i]);
+        if (chain[i].isBlocked())
+        {
+            header.blocked|=(uint64_t(1)<<i);
+            header.blockedAng[i]=chain[i].getAng();
+        }
+    }
+
+    Matrix H0=chain.getH0();
+    Matrix HN=chain.getHN();
+    std::copy(H0.data(),H0.data()+16,header.H0);
+    std::copy(HN.data(),HN.data()+16,header.HN);
+
+    // fill in the flat representation
+    buffer.assign(sizeof(header)+cells*sizeof(int32_t)+
+                  merged.size()*entrySize(dof),0);
+    memcpy(buffer.data(),&header,sizeof(header));
+
+    int32_t *index=reinterpret_cast<int32_t*>(buffer.data()+sizeof(header));
+    std::fill(index,index+cells,-1);
+
+    char *entries=reinterpret_cast<char*>(index+cells);
+    int32_t cnt=0;
+    for (auto &it:merged)
+    {
+        int64_t c[3];
+        voxelCoords(it.first,c[0],c[1],c[2]);
+        size_t cell=((c[0]-lo[0])*header.dims[1]+(c[1]-lo[1]))*header.dims[2]+(c[2]-lo[2]);
+        index[cell]=cnt;
+
+        char *ptr=entries+cnt*entrySize(dof);
+        iKinReachMapEntry entry;
+        entry.dirMask=it.second.dirMask;
+        entry.hits=it.second.hits;
+        entry.manip=it.second.manip;
+        memcpy(ptr,&entry,sizeof(entry));
+        memcpy(ptr+sizeof(entry),it.second.q.data(),dof*sizeof(float));
+        cnt++;
+    }
+
+    return setData(buffer.data(),buffer.size());
+}
+
+
+/************************************************************************/
+bool iKinReachMap::save(const string &fileName) const
+{
+    if (data==NULL)
+        return false;
+
+    FILE *fout=fopen(fileName.c_str(),"wb");
+    if (fout==NULL)
+        return false;
+
+    bool ret=(fwrite(data,1,length,fout)==length);
+    ret&=(fclose(fout)==0);
+
+    return ret;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::load(const string &fileName)
+{
+    clear();
+
+    iKinReachMapping *m=new iKinReachMapping;
+    m->addr=NULL;
+    m->length=0;
+
+#ifdef _WIN32
+    m->file=CreateFileA(fileName.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,
+                        OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+    m->map=NULL;
+    if (m->file!=INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(m->file,&size) && (size.QuadPart>0))
+        {
+            m->map=CreateFileMappingA(m->file,NULL,PAGE_READONLY,0,0,NULL);
+            if (m->map!=NULL)
+            {
+                m->addr=MapViewOfFile(m->map,FILE_MAP_READ,0,0,0);
+                m->length=(size_t)size.QuadPart;
+            }
+        }
+    }
+#else
+    int fd=open(fileName.c_str(),O_RDONLY);
+    if (fd>=0)
+    {
+        struct stat st;
+        if ((fstat(fd,&st)==0) && (st.st_size>0))
+        {
+            void *addr=mmap(NULL,(size_t)st.st_size,PROT_READ,MAP_SHARED,fd,0);
+            if (addr!=MAP_FAILED)
+            {
+                m->addr=addr;
+                m->length=(size_t)st.st_size;
+            }
+        }
+
+        // the mapping stays valid after closing
+        close(fd);
+    }
+#endif
+
+    mapping=m;
+    if ((m->addr==NULL) || !setData(static_cast<const char*>(m->addr),m->length))
+    {
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+void iKinReachMap::clear()
+{
+    if (mapping!=NULL)
+    {
+        iKinReachMapping *m=CAST_MAPPING(mapping);
+#ifdef _WIN32
+        if (m->addr!=NULL)
+            UnmapViewOfFile(m->addr);
+        if (m->map!=NULL)
+            CloseHandle(m->map);
+        if (m->file!=INVALID_HANDLE_VALUE)
+            CloseHandle(m->file);
+#else
+        if (m->addr!=NULL)
+            munmap(m->addr,m->length);
+#endif
+        delete m;
+        mapping=NULL;
+    }
+
+    buffer.clear();
+    buffer.shrink_to_fit();
+    data=NULL;
+    length=0;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::isCompatible(iKinChain &chain) const
+{
+    if (data==NULL)
+        return false;
+
+    const iKinReachMapHeader *header=reinterpret_cast<const iKinReachMapHeader*>(data);
+    if ((chain.getN()!=header->N) || (chain.getDOF()!=header->dof))
+        return false;
+
+    // joints limits are not part of the geometry:
+    // they are dealt with at query time
+    for (unsigned int i=0; i<header->N; i++)
+    {
+        bool blocked=((header->blocked>>i)&1)!=0;
+        if (chain[i].isBlocked()!=blocked)
+            return false;
+
+        if (blocked && (fabs(chain[i].getAng()-header->blockedAng[i])>IKINREACH_GEOM_TOL))
+            return false;
+
+        double params[6];
+        linkParams(chain[i],params);
+        for (int j=0; j<4; j++)
+            if (fabs(params[j]-header->links[i][j])>IKINREACH_GEOM_TOL)
+                return false;
+    }
+
+    Matrix H0=chain.getH0();
+    Matrix HN=chain.getHN();
+    for (int i=0; i<16; i++)
+        if ((fabs(H0.data()[i]-header->H0[i])>IKINREACH_GEOM_TOL) ||
+            (fabs(HN.data()[i]-header->HN[i])>IKINREACH_GEOM_TOL))
+            return false;
+
+    return true;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::coversLimits(iKinChain &chain) const
+{
+    if (!isCompatible(chain))
+        return false;
+
+    const iKinReachMapHeader *header=reinterpret_cast<const iKinReachMapHeader*>(data);
+    for (unsigned int i=0; i<header->N; i++)
+    {
+        if (!chain[i].isBlocked() &&
+            ((chain[i].getMin()<header->links[i][4]-IKINREACH_GEOM_TOL) ||
+             (chain[i].getMax()>header->links[i][5]+IKINREACH_GEOM_TOL)))
+            return false;
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+double iKinReachMap::getVoxelSize() const
+{
+    if (data==NULL)
+        return 0.0;
+
+    return reinterpret_cast<const iKinReachMapHeader*>(data)->voxelSize;
+}
+
+
+/************************************************************************/
+unsigned int iKinReachMap::getDOF() const
+{
+    if (data==NULL)
+        return 0;
+
+    return reinterpret_cast<const iKinReachMapHeader*>(data)->dof;
+}
+
+
+/************************************************************************/
+size_t iKinReachMap::getNumVoxels() const
+{
+    if (data==NULL)
+        return 0;
+
+    return reinterpret_cast<const iKinReachMapHeader*>(data)->numEntries;
+}
+
+
+/************************************************************************/
+int iKinReachMap::getVoxel(const Vector &xd) const
+{
+    if ((data==NULL) || (xd.length()<3))
+        return -1;
+
+    const iKinReachMapHeader *header=reinterpret_cast<const iKinReachMapHeader*>(data);
+    int64_t c[3];
+    for (int i=0; i<3; i++)
+    {
+        c[i]=(int64_t)floor((xd[i]-header->origin[i])/header->voxelSize);
+        if ((c[i]<0) || (c[i]>=header->dims[i]))
+            return -1;
+    }
+
+    size_t cell=(c[0]*header->dims[1]+c[1])*header->dims[2]+c[2];
+    return reinterpret_cast<const int32_t*>(data+sizeof(iKinReachMapHeader))[cell];
+}
+
+
+/************************************************************************/
+const char *iKinReachMap::getEntry(const Vector &xd) const
+{
+    int id=getVoxel(xd);
+    if (id<0)
+        return NULL;
+
+    const iKinReachMapHeader *header=reinterpret_cast<const iKinReachMapHeader*>(data);
+    size_t cells=(size_t)header->dims[0]*header->dims[1]*header->dims[2];
+    return data+sizeof(iKinReachMapHeader)+cells*sizeof(int32_t)+id*entrySize(header->dof);
+}
+
+
+/************************************************************************/
+bool iKinReachMap::isReachable(const Vector &xd, const int margin) const
+{
+    if (margin>0)
+    {
+        if ((data==NULL) || (xd.length()<3))
+            return false;
+
+        double voxelSize=getVoxelSize();
+        Vector x=xd.subVector(0,2);
+        for (int i=-margin; i<=margin; i++)
+        {
+            for (int j=-margin; j<=margin; j++)
+            {
+                for (int k=-margin; k<=margin; k++)
+                {
+                    x[0]=xd[0]+i*voxelSize;
+                    x[1]=xd[1]+j*voxelSize;
+                    x[2]=xd[2]+k*voxelSize;
+                    if (getVoxel(x)>=0)
+                        return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    const char *ptr=getEntry(xd);
+    if (ptr==NULL)
+        return false;
+
+    if (xd.length()>=7)
+    {
+        iKinReachMapEntry entry;
+        memcpy(&entry,ptr,sizeof(entry));
+
+        // z-axis of the target orientation
+        double n=sqrt(xd[3]*xd[3]+xd[4]*xd[4]+xd[5]*xd[5]);
+        if (n>0.0)
+        {
+            double k[3]={xd[3]/n, xd[4]/n, xd[5]/n};
+            double c=cos(xd[6]), s=sin(xd[6]), v=1.0-c;
+            double z[3]={k[0]*k[2]*v+k[1]*s, k[1]*k[2]*v-k[0]*s, k[2]*k[2]*v+c};
+            return ((entry.dirMask>>dirBin(z))&1)!=0;
+        }
+        else
+        {
+            double z[3]={0.0, 0.0, 1.0};
+            return ((entry.dirMask>>dirBin(z))&1)!=0;
+        }
+    }
+
+    return true;
+}
+
+
+/************************************************************************/
+double iKinReachMap::getDexterity(const Vector &xd) const
+{
+    const char *ptr=getEntry(xd);
+    if (ptr==NULL)
+        return 0.0;
+
+    iKinReachMapEntry entry;
+    memcpy(&entry,ptr,sizeof(entry));
+    return (double)popCount(entry.dirMask)/IKINREACH_DIR_BINS;
+}
+
+
+/************************************************************************/
+double iKinReachMap::getManipulability(const Vector &xd) const
+{
+    const char *ptr=getEntry(xd);
+    if (ptr==NULL)
+        return 0.0;
+
+    iKinReachMapEntry entry;
+    memcpy(&entry,ptr,sizeof(entry));
+    return entry.manip;
+}
+
+
+/************************************************************************/
+bool iKinReachMap::getSeed(const Vector &xd, Vector &q, iKinChain *chain) const
+{
+    const char *ptr=getEntry(xd);
+    if (ptr==NULL)
+        return false;
+
+    unsigned int dof=getDOF();
+    const float *seed=reinterpret_cast<const float*>(ptr+sizeof(iKinReachMapEntry));
+    q.resize(dof);
+    for (unsigned int i=0; i<dof; i++)
+        q[i]=seed[i];
+
+    // the seed lies within the limits used to build the map,
+    // hence the clamp yields the intersection with the current ones
+    if ((chain!=NULL) && (chain->getDOF()==dof))
+        for (unsigned int i=0; i<dof; i++)
+            q[i]=std::min(std::max(q[i],(*chain)(i).getMin()),(*chain)(i).getMax());
+
+    return true;
+}
+
+
+/************************************************************************/
+iKinReachMap::~iKinReachMap()
+{
+    clear();
+}
+
+
@@ -11,6 +11,11 @@
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <IpoptConfig.h>
 
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Network.h>
@@ -26,6 +31,15 @@
 #define CARTSLV_WEIGHT_2ND_TASK             0.01
 #define CARTSLV_WEIGHT_3RD_TASK             0.01
 #define CARTSLV_UNCTRLEDJNTS_THRES          1.0     // [deg]
+#define CARTSLV_MAX_BATCH_WORKERS           8
+
+// from IpOpt 3.14 on, the calls to MUMPS are serialized
+// and the optimizers can safely run in parallel
+#if defined(IPOPT_VERSION_MAJOR) && defined(IPOPT_VERSION_MINOR)
+    #if (IPOPT_VERSION_MAJOR>3) || ((IPOPT_VERSION_MAJOR==3) && (IPOPT_VERSION_MINOR>=14))
+        #define CARTSLV_PARALLEL_BATCH
+    #endif
+#endif
 
 using namespace std;
 using namespace yarp::os;
@@ -278,10 +292,15 @@ CartesianSolver::CartesianSolver(const string &_slvName) :
     maxPartJoints=0;
     unctrlJointsNum=0;
     ping_robot_tmo=0.0;
+    batchWorkers=1;
+    exitCode=0;
+    analyticSolves=0;
 
     prt=NULL;
     slv=NULL;
     clb=NULL;
+    reachMap=NULL;
+    reachReject=false;
     inPort=NULL;
     outPort=NULL;
 
@@ -511,6 +530,270 @@ void CartesianSolver::fillDOFInfo(Bottle &reply)
 }
 
 
+/************************************************************************/
+void CartesianSolver::disposeBatchPool()
+{
+    // wait for an in-flight batch to complete
+    lock_guard<mutex> lck(mtx_batch);
+
+    for (size_t i=0; i<batchPool.size(); i++)
+    {
+        delete batchPool[i]->slv;
+        delete batchPool[i]->lmb;
+        delete batchPool[i];
+    }
+
+    batchPool.clear();
+}
+
+
+/************************************************************************/
+bool CartesianSolver::handleBatchAsk(const Bottle &command, Bottle &reply)
+{
+    Bottle *b_xds=getTargetsOption(command);
+    Bottle *b_q=getJointsOption(command);
+
+    if (b_xds==NULL)
+        return false;
+
+    int n=b_xds->size();
+    if (n==0)
+        return false;
+
+    lock_guard<mutex> lck(mtx_batch);
+
+    // the pool has been disposed and the solver
+    // is about to be destroyed by close()
+    if (closing)
+        return false;
+
+    lock();
+
+    unsigned int pose=slv->get_ctrlPose();
+    if (command.check(Vocab::decode(IKINSLV_VOCAB_OPT_POSE)))
+    {
+        int _pose=command.find(Vocab::decode(IKINSLV_VOCAB_OPT_POSE)).asVocab();
+
+        if (_pose==IKINSLV_VOCAB_VAL_POSE_FULL)
+            pose=IKINCTRL_POSE_FULL;
+        else if (_pose==IKINSLV_VOCAB_VAL_POSE_XYZ)
+            pose=IKINCTRL_POSE_XYZ;
+    }
+
+    // get the targets: at least the positional part must be
+    // given, whereas the full pose requires the orientation too
+    deque<Vector> xd(n);
+    for (int i=0; i<n; i++)
+    {
+        Bottle *b_xd=b_xds->get(i).asList();
+        if ((b_xd==NULL) || (b_xd->size()<3) ||
+            ((pose==IKINCTRL_POSE_FULL) && (b_xd->size()<7)))
+        {
+            unlock();
+            return false;
+        }
+
+        xd[i].resize(b_xd->size());
+        for (size_t j=0; j<xd[i].length(); j++)
+            xd[i][j]=b_xd->get(j).asDouble();
+    }
+
+    // get the current configuration if not provided
+    if (b_q==NULL)
+        getFeedback();
+
+    // each worker operates on its own copy of the chain
+    int nWorkers=std::max(1,std::min(batchWorkers,n));
+    while ((int)batchPool.size()<nWorkers)
+    {
+        BatchWorker *w=new BatchWorker;
+        w->lmb=new iKinLimb(*prt->lmb);
+        w->slv=new iKinIpOptMin(*w->lmb->asChain(),pose,slv->getTol(),
+                                slv->getConstrTol(),slv->getMaxIter());
+        w->slv->setUserScaling(true,100.0,100.0,100.0);
+        w->slv->attachLIC(w->cns);
+        batchPool.push_back(w);
+    }
+
+    size_t cacheSize;
+    double cacheWarmTol,cacheReuseTol;
+    bool cacheOn=slv->getSolutionCache(&cacheSize,&cacheWarmTol,&cacheReuseTol);
+
+    for (int k=0; k<nWorkers; k++)
+    {
+        BatchWorker *w=batchPool[k];
+
+        // align the chain of the worker with the one of the solver
+        // in place, since reallocating the links would require to
+        // rebuild the 2nd task chain and to empty the cache
+        iKinChain &src=*prt->lmb->asChain();
+        iKinChain &chn=*w->lmb->asChain();
+        chn.setH0(src.getH0());
+        chn.setHN(src.getHN());
+        for (unsigned int i=0; i<src.getN(); i++)
+        {
+            if (chn[i].getA()!=src[i].getA())
+                chn[i].setA(src[i].getA());
+            if (chn[i].getD()!=src[i].getD())
+                chn[i].setD(src[i].getD());
+            if (chn[i].getAlpha()!=src[i].getAlpha())
+                chn[i].setAlpha(src[i].getAlpha());
+            if (chn[i].getOffset()!=src[i].getOffset())
+                chn[i].setOffset(src[i].getOffset());
+            chn[i].setMin(src[i].getMin());
+            chn[i].setMax(src[i].getMax());
+
+            if (src[i].isBlocked())
+            {
+                if (!chn[i].isBlocked())
+                    chn.blockLink(i,src[i].getAng());
+                else if (chn[i].getAng()!=src[i].getAng())
+                    chn.setBlockingValue(i,src[i].getAng());
+            }
+            else
+            {
+                if (chn[i].isBlocked())
+                    chn.releaseLink(i);
+                chn[i].setAng(src[i].getAng());
+            }
+        }
+
+        if (b_q!=NULL)
+        {
+            size_t len=std::min((size_t)b_q->size(),(size_t)chn.getDOF());
+            for (size_t i=0; i<len; i++)
+                chn(i).setAng(CTRL_DEG2RAD*b_q->get(i).asDouble());
+        }
+
+        w->cns=slv->getLIC();
+        w->slv->set_ctrlPose(pose);
+        w->slv->set_posePriority(slv->get_posePriority());
+
+        // the setters re-initialize IpOpt and/or empty the cache
+        // of the worker, hence they are called only on changes
+        if (w->slv->get2ndTaskChain().getN()!=slv->get2ndTaskChain().getN())
+            w->slv->specify2ndTaskEndEff(slv->get2ndTaskChain().getN());
+
+        size_t wCacheSize;
+        double wCacheWarmTol,wCacheReuseTol;
+        bool wCacheOn=w->slv->getSolutionCache(&wCacheSize,&wCacheWarmTol,&wCacheReuseTol);
+        if ((wCacheOn!=cacheOn) || (wCacheSize!=cacheSize) ||
+            (wCacheWarmTol!=cacheWarmTol) || (wCacheReuseTol!=cacheReuseTol))
+            w->slv->setSolutionCache(cacheOn,cacheSize,cacheWarmTol,cacheReuseTol);
+
+        if (w->slv->getTol()!=slv->getTol())
+            w->slv->setTol(slv->getTol());
+        if (w->slv->getConstrTol()!=slv->getConstrTol())
+            w->slv->setConstrTol(slv->getConstrTol());
+        if (w->slv->getMaxIter()!=slv->getMaxIter())
+            w->slv->setMaxIter(slv->getMaxIter());
+    }
+
+    // set things for the 3rd task
+    iKinChain &chn0=*batchPool[0]->lmb->asChain();
+    Vector q0=chn0.getAng();
+    Vector qd_3rd=qd_3rdTask;
+    for (unsigned int i=0; i<chn0.getDOF(); i++)
+        if (idx_3rdTask[i]!=0.0)
+            qd_3rd[i]=q0[i];
+
+    double weight2ndTask=slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0;
+    Vector xd_2nd=xd_2ndTask;
+    Vector w_2nd=w_2ndTask;
+    Vector w_3rd=w_3rdTask;
+
+    unlock();
+
+    deque<Vector> x(n),q(n);
+    Matrix res(n,2);
+    atomic<int> next(0);
+
+    auto work=[&](BatchWorker *w)
+    {
+        iKinChain &chn=*w->lmb->asChain();
+        Vector _xd_2nd=xd_2nd;
+        Vector _w_2nd=w_2nd;
+        Vector _qd_3rd=qd_3rd;
+        Vector _w_3rd=w_3rd;
+
+        for (int i=next++; i<n; i=next++)
+        {
+            Vector _xd=xd[i];
+            Vector qd=w->slv->solve(q0,_xd,weight2ndTask,_xd_2nd,_w_2nd,
+                                    CARTSLV_WEIGHT_3RD_TASK,_qd_3rd,_w_3rd);
+            x[i]=chn.EndEffPose(qd);
+
+            q[i].resize(chn.getN());
+            for (unsigned int j=0; j<chn.getN(); j++)
+                q[i][j]=CTRL_RAD2DEG*chn.getAng(j);
+
+            res(i,0)=norm(xd[i].subVector(0,2)-x[i].subVector(0,2));
+            res(i,1)=0.0;
+            if (pose==IKINCTRL_POSE_FULL)
+            {
+                Matrix Rd=axis2dcm(xd[i].subVector(3,6));
+                Matrix R=axis2dcm(x[i].subVector(3,6));
+                res(i,1)=fabs(dcm2axis(Rd.transposed()*R)[3]);
+            }
+        }
+    };
+
+    double t0=Time::now();
+
+    vector<thread> workers;
+    for (int k=1; k<nWorkers; k++)
+        workers.push_back(thread(work,batchPool[k]));
+
+    work(batchPool[0]);
+
+    for (size_t k=0; k<workers.size(); k++)
+        workers[k].join();
+
+    double t1=Time::now();
+
+    // dump on screen
+    if (verbosity)
+    {
+        printf("   Request type       = ask (batch)\n");
+        printf("     Targets [#]      = %d\n",n);
+        printf("     Workers [#]      = %d\n",nWorkers);
+        printf("    computed in   [s] = %g\n",t1-t0);
+    }
+
+    // fill the reply accordingly
+    reply.addVocab(IKINSLV_VOCAB_REP_ACK);
+
+    Bottle &xPart=reply.addList();
+    xPart.addVocab(IKINSLV_VOCAB_OPT_XS);
+    Bottle &xList=xPart.addList();
+
+    Bottle &qPart=reply.addList();
+    qPart.addVocab(IKINSLV_VOCAB_OPT_QS);
+    Bottle &qList=qPart.addList();
+
+    Bottle &resPart=reply.addList();
+    resPart.addVocab(IKINSLV_VOCAB_OPT_RES);
+    Bottle &resList=resPart.addList();
+
+    for (int i=0; i<n; i++)
+    {
+        Bottle &x_i=xList.addList();
+        for (size_t j=0; j<x[i].length(); j++)
+            x_i.addDouble(x[i][j]);
+
+        Bottle &q_i=qList.addList();
+        for (size_t j=0; j<q[i].length(); j++)
+            q_i.addDouble(q[i][j]);
+
+        Bottle &res_i=resList.addList();
+        res_i.addDouble(res(i,0));
+        res_i.addDouble(res(i,1));
+    }
+
+    return true;
+}
+
+
 /************************************************************************/
 void CartesianSolver::respond(const Bottle &command, Bottle &reply)
 {
@@ -668,6 +951,68 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
                             break;
                         }
 
+                        //-----------------
+                        case IKINSLV_VOCAB_OPT_CACHE:
+                        {
+                            size_t maxSize;
+                            double warmTol,reuseTol;
+                            bool enabled=slv->getSolutionCache(&maxSize,&warmTol,&reuseTol);
+                            iKinSolutionCacheStats stats=slv->getSolutionCacheStats();
+
+                            reply.addVocab(IKINSLV_VOCAB_REP_ACK);
+                            Bottle &payLoad=reply.addList();
+
+                            Bottle &enable=payLoad.addList();
+                            enable.addString("enable");
+                            enable.addVocab(enabled?IKINSLV_VOCAB_VAL_ON:IKINSLV_VOCAB_VAL_OFF);
+
+                            Bottle &size=payLoad.addList();
+                            size.addString("size");
+                            size.addInt((int)maxSize);
+
+                            Bottle &warm_tol=payLoad.addList();
+                            warm_tol.addString("warm_tol");
+                            warm_tol.addDouble(warmTol);
+
+                            Bottle &reuse_tol=payLoad.addList();
+                            reuse_tol.addString("reuse_tol");
+                            reuse_tol.addDouble(reuseTol);
+
+                            Bottle &solves=payLoad.addList();
+                            solves.addString("solves");
+                            solves.addInt((int)stats.solves);
+
+                            Bottle &reuses=payLoad.addList();
+                            reuses.addString("reuses");
+                            reuses.addInt((int)stats.reuses);
+
+                            Bottle &warm_starts=payLoad.addList();
+                            warm_starts.addString("warm_starts");
+                            warm_starts.addInt((int)stats.warmStarts);
+
+                            Bottle &cold_starts=payLoad.addList();
+                            cold_starts.addString("cold_starts");
+                            cold_starts.addInt((int)stats.coldStarts);
+
+                            Bottle &warm_iters=payLoad.addList();
+                            warm_iters.addString("warm_iters");
+                            warm_iters.addInt((int)stats.warmIters);
+
+                            Bottle &cold_iters=payLoad.addList();
+                            cold_iters.addString("cold_iters");
+                            cold_iters.addInt((int)stats.coldIters);
+
+                            Bottle &iters_saved=payLoad.addList();
+                            iters_saved.addString("iters_saved");
+                            iters_saved.addDouble(stats.itersSaved);
+
+                            Bottle &analytic=payLoad.addList();
+                            analytic.addString("analytic");
+                            analytic.addInt((int)analyticSolves);
+
+                            break;
+                        }
+
                         //-----------------
                         default:
                             reply.addVocab(IKINSLV_VOCAB_REP_NACK);
@@ -924,6 +1269,57 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
                             break;
                         }
 
+                        //-----------------
+                        case IKINSLV_VOCAB_OPT_CACHE:
+                        {
+                            if (Bottle *payLoad=command.get(2).asList())
+                            {
+                                size_t maxSize;
+                                double warmTol,reuseTol;
+                                bool enabled=slv->getSolutionCache(&maxSize,&warmTol,&reuseTol);
+
+                                int cnt=0;
+                                if (payLoad->check("enable"))
+                                {
+                                    enabled=(payLoad->find("enable").asVocab()==IKINSLV_VOCAB_VAL_ON);
+                                    cnt++;
+                                }
+
+                                if (payLoad->check("size"))
+                                {
+                                    maxSize=(size_t)std::max(payLoad->find("size").asInt(),0);
+                                    cnt++;
+                                }
+
+                                if (payLoad->check("warm_tol"))
+                                {
+                                    warmTol=payLoad->find("warm_tol").asDouble();
+                                    cnt++;
+                                }
+
+                                if (payLoad->check("reuse_tol"))
+                                {
+                                    reuseTol=payLoad->find("reuse_tol").asDouble();
+                                    cnt++;
+                                }
+
+                                if (cnt>0)
+                                {
+                                    lock();
+                                    slv->setSolutionCache(enabled,maxSize,warmTol,reuseTol);
+                                    slv->resetSolutionCacheStats();
+                                    analyticSolves=0;
+                                    unlock();
+                                }
+
+                                reply.addVocab(cnt>0?IKINSLV_VOCAB_REP_ACK:IKINSLV_VOCAB_REP_NACK);
+                            }
+                            else
+                                reply.addVocab(IKINSLV_VOCAB_REP_NACK);
+
+                            break;
+                        }
+
                         //-----------------
                         default:
                             reply.addVocab(IKINSLV_VOCAB_REP_NACK);
@@ -938,6 +1334,14 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
             //-----------------
             case IKINSLV_VOCAB_CMD_ASK:
             {
+                // batch of targets
+                if (getTargetsOption(command)!=NULL)
+                {
+                    if (!handleBatchAsk(command,reply))
+                        reply.addVocab(IKINSLV_VOCAB_REP_NACK);
+                    break;
+                }
+
                 Bottle *b_xd=getTargetOption(command);
                 Bottle *b_q=getJointsOption(command);
             
@@ -991,6 +1395,14 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
                 double t0=Time::now();
                 Vector q=solve(xd);
                 double t1=Time::now();
+
+                // the target has been skipped
+                if (exitCode==IKINSLV_UNREACHABLE_TARGET)
+                {
+                    reply.addVocab(IKINSLV_VOCAB_REP_NACK);
+                    unlock();
+                    break;
+                }
             
                 Vector x=prt->chn->EndEffPose(q);
             
@@ -1091,9 +1503,11 @@ void CartesianSolver::respond(const Bottle &command, Bottle &reply)
                 reply.addVocab(IKINSLV_VOCAB_OPT_REST_WEIGHTS);
                 reply.addVocab(IKINSLV_VOCAB_OPT_TIP_FRAME);
                 reply.addVocab(IKINSLV_VOCAB_OPT_TASK2);
+                reply.addVocab(IKINSLV_VOCAB_OPT_CACHE);
                 reply.addVocab(IKINSLV_VOCAB_OPT_XD);
                 reply.addVocab(IKINSLV_VOCAB_OPT_X);
                 reply.addVocab(IKINSLV_VOCAB_OPT_Q);
+                reply.addVocab(IKINSLV_VOCAB_OPT_XDS);
                 reply.addString("***** values");
                 reply.addVocab(IKINSLV_VOCAB_VAL_POSE_FULL);
                 reply.addVocab(IKINSLV_VOCAB_VAL_POSE_XYZ);
@@ -1152,6 +1566,7 @@ void CartesianSolver::printInfo(const string &typ, const Vector &xd,
     printf("  Target rxPose   [m] = %s\n",xd.toString().c_str());
     printf("  Target txPose   [m] = %s\n",x_.toString().c_str());
     printf("Target txJoints [deg] = %s\n",q.toString().c_str());
+    printf("    exit code         = %d\n",exitCode);
     printf("    computed in   [s] = %g\n",t);
 }
 
@@ -1398,6 +1813,14 @@ bool CartesianSolver::open(Searchable &options)
     // instantiate the optimizer
     slv=new iKinIpOptMin(*prt->chn,ctrlPose,tol,constr_tol,maxIter);
 
+    // workers to solve batch requests
+#ifdef CARTSLV_PARALLEL_BATCH
+    int defBatchWorkers=std::min((int)std::thread::hardware_concurrency(),CARTSLV_MAX_BATCH_WORKERS);
+#else
+    int defBatchWorkers=1;
+#endif
+    batchWorkers=std::max(1,options.check("batch_workers",Value(defBatchWorkers)).asInt());
+
     // instantiate solver callback object if required    
     if (options.check("interPoints"))
         if (options.find("interPoints").asVocab()==IKINSLV_VOCAB_VAL_ON)
@@ -1406,6 +1829,33 @@ bool CartesianSolver::open(Searchable &options)
     // enable scaling
     slv->setUserScaling(true,100.0,100.0,100.0);
 
+    // enable the cache of solutions, if required
+    int cacheSize=options.check("cache_size",Value(0)).asInt();
+    if (cacheSize>0)
+        slv->setSolutionCache(true,(size_t)cacheSize,
+                              options.check("cache_warm_tol",Value(IKINIPOPT_CACHE_DEFAULT_WARMTOL)).asDouble(),
+                              options.check("cache_reuse_tol",Value(IKINIPOPT_CACHE_DEFAULT_REUSETOL)).asDouble());
+
+    // load the reachability map, if any
+    if (options.check("reach_map"))
+    {
+        string fileName=options.find("reach_map").asString();
+        reachMap=new iKinReachMap;
+        if (reachMap->load(fileName))
+        {
+            reachReject=(options.check("reach_reject",Value("off")).asString()=="on");
+            yInfo("%s: loaded reachability map %s (%d voxels)",
+                  slvName.c_str(),fileName.c_str(),(int)reachMap->getNumVoxels());
+        }
+        else
+        {
+            yWarning("%s: unable to load reachability map %s",
+                     slvName.c_str(),fileName.c_str());
+            delete reachMap;
+            reachMap=NULL;
+        }
+    }
+
     // enforce linear inequalities constraints, if any
     if (prt->cns!=NULL)
     {
@@ -1514,10 +1964,37 @@ void CartesianSolver::prepareJointsRestTask()
 /************************************************************************/
 Vector CartesianSolver::solve(Vector &xd)
 {
-    return slv->solve(prt->chn->getAng(),xd,
+    Vector q0=prt->chn->getAng();
+    exitCode=0;
+
+    // the map applies only to the DOF configuration it was built for;
+    // the rejection holds as long as the current joints limits lie
+    // within the ones used to build the map
+    if ((reachMap!=NULL) && reachMap->isCompatible(*prt->chn))
+    {
+        if (reachReject && reachMap->coversLimits(*prt->chn) &&
+            !reachMap->isReachable(xd,1))
+        {
+            if (verbosity)
+                yWarning("%s: target out of the reachability map, skipping",slvName.c_str());
+
+            exitCode=IKINSLV_UNREACHABLE_TARGET;
+            return q0;
+        }
+
+        Vector seed;
+        if (reachMap->getSeed(xd,seed,prt->chn))
+        {
+            Vector x=prt->chn->EndEffPose();
+            if (norm(x.subVector(0,2)-xd.subVector(0,2))>sqrt(3.0)*reachMap->getVoxelSize())
+                q0=seed;
+        }
+    }
+
+    return slv->solve(q0,xd,
                       slv->get2ndTaskChain().getN()>0?CARTSLV_WEIGHT_2ND_TASK:0.0,xd_2ndTask,w_2ndTask,
                       CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask,
-                      NULL,NULL,clb);
+                      &exitCode,NULL,clb);
 }
 
 
@@ -1555,10 +2032,14 @@ void CartesianSolver::close()
         outPort=NULL;
     }
 
+    disposeBatchPool();
+
     delete slv;
     delete clb;
+    delete reachMap;
     slv=NULL;
     clb=NULL;
+    reachMap=NULL;
 
     for (size_t i=0; i<drv.size(); i++)
     {
@@ -1821,12 +2302,64 @@ bool iCubArmCartesianSolver::open(Searchable &options)
         // try to keep elbow as low as possible
         xd_2ndTask[2]=-1.0;
         w_2ndTask[2]=1.0;
+
+        // closed-form inversion
+        if (options.check("analytic_ik",Value("off")).asString()=="on")
+        {
+            lock();
+            analyticSlv=new iCubArmAnalyticSolver(*static_cast<iCubArm*>(prt->lmb));
+            analyticSlv->attachLIC(slv->getLIC());
+            unlock();
+        }
     }
 
     return configured;
 }
 
 
+/************************************************************************/
+Vector iCubArmCartesianSolver::solve(Vector &xd)
+{
+    // the closed-form inversion deals with the elbow
+    // as 2nd task only and does not raise the callbacks;
+    // the pose control is the one of the optimizer, since
+    // the [ask] requests set it without touching ctrlPose
+    if ((analyticSlv!=NULL) && (slv->get_ctrlPose()==IKINCTRL_POSE_FULL) && (clb==NULL) &&
+        (slv->get2ndTaskChain().getN()==6) && analyticSlv->isSupported())
+    {
+        Vector qd;
+        if (analyticSlv->solve(prt->chn->getAng(),xd,qd,
+                               CARTSLV_WEIGHT_2ND_TASK,xd_2ndTask,w_2ndTask,
+                               CARTSLV_WEIGHT_3RD_TASK,qd_3rdTask,w_3rdTask))
+        {
+            prt->chn->setAng(qd);
+            exitCode=IKINIPOPT_SOLVED_ANALYTICALLY;
+            analyticSolves++;
+            return qd;
+        }
+    }
+
+    return CartesianSolver::solve(xd);
+}
+
+
+/************************************************************************/
+void iCubArmCartesianSolver::close()
+{
+    CartesianSolver::close();
+
+    delete analyticSlv;
+    analyticSlv=NULL;
+}
+
+
+/************************************************************************/
+iCubArmCartesianSolver::~iCubArmCartesianSolver()
+{
+    close();
+}
+
+
 /************************************************************************/
 bool iCubArmCartesianSolver::decodeDOF(const Vector &_dof)
 {
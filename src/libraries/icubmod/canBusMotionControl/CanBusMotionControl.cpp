@@ -17,6 +17,7 @@
 #include <cstdio>
 #include <cstring>
 #include <cmath>
+#include <thread>
 
 #include <string>
 #include <iostream>
@@ -48,6 +49,7 @@
 
 #include "canControlConstants.h"
 #include "canControlUtils.h"
+#include "canBcastDecoders.h"
 
 #ifdef WIN32
     #pragma warning(once:4355)
@@ -128,6 +130,16 @@ bool validate_optional(Bottle &input, Bottle &out, const std::string &key1, cons
 
 static can_string_generic cstring[CAN_MAX_CARDS];
 
+// the most recent of n stamps, what goes in stampEncoders
+static inline double latestStamp(const double *t, int n)
+{
+    double stamp=0;
+    for (int i=0; i<n; i++)
+        if (stamp<t[i])
+            stamp=t[i];
+    return stamp;
+}
+
 ///
 ///
 struct BCastElement
@@ -185,8 +197,14 @@ struct BCastElement
 
     inline void update(int value, double st)
     {
-        double tmpDt=st-_stamp;
         _value=value;
+        tick(st);
+    }
+
+    // statistics only
+    inline void tick(double st)
+    {
+        double tmpDt=st-_stamp;
         _stamp=st;
         _accDt+=tmpDt;
         _lastDt=tmpDt;
@@ -212,15 +230,11 @@ struct BCastElement
 class BCastBufferElement
 {
 public:
-    // msg 1
-    BCastElement _position_joint;
-    BCastElement _position_rotor;
-    BCastElement _speed_rotor;
-    BCastElement _accel_rotor;
+    // positions, velocities, pid values, currents and pid errors are
+    // decoded in the JointStateBuffer of CanBusResources.
 
-    // msg 2
-    short _pid_value;
-    double _update_v;
+    // msg 1, rate of the position messages
+    BCastElement _position_stats;
 
     // msg 3
     short _axisStatus;
@@ -233,24 +247,6 @@ public:
     unsigned char _interactionmodeStatus;
     double _update_e2;
 
-    // msg 4
-    short _current;
-    double _update_c;
-
-    // msg 4b
-    short _position_error;
-    short _torque_error;   
-    double _update_r;
-
-    // msg 4c
-    short _speed_joint;
-    short _accel_joint;
-    double _update_s;
-
-    // msg 4d (special message)
-    double _torque;
-    double _update_t;
-    
     // msg 6
     unsigned int _canTxError;
     // msg 7
@@ -313,31 +309,14 @@ public:
 
     void zero (void)
     {
-        _position_joint._value = 0;
-        _position_rotor._value = 0;
-        _speed_rotor._value = 0;
-        _accel_rotor._value = 0;
-        _pid_value = 0;
-        _current = 0;
         _axisStatus=0;
         _canStatus=0;
         _boardStatus=0;
         _controlmodeStatus=0;
         _interactionmodeStatus=0;
-        _position_error = 0;
-        _torque_error = 0;
-        _speed_joint = 0;
-        _accel_joint = 0;
 
-        _torque=0;
-        _update_t = .0;
-
-        _update_v = .0;
         _update_e = .0;
         _update_e2= .0;
-        _update_c = .0;
-        _update_r = .0;
-        _update_s = .0;
 
         _address=-1;
         _canTxError=0;
@@ -369,6 +348,10 @@ public:
     bool initialize (yarp::os::Searchable &config);
     bool uninitialize ();
     bool read ();
+    // blocking read into _rxBuffer, for the event driven reader (it runs without the mutex)
+    bool receive ();
+    // make the frames of the last receive() the content of _readBuffer (requires the mutex)
+    void swapReceived ();
 
     bool startPacket ();
     bool addMessage (int msg_id, int joint);
@@ -420,8 +403,12 @@ public:
     CanBuffer _writeBuffer;/// write buffer.
     CanBuffer _replyBuffer;/// reply buffer.
     CanBuffer _echoBuffer;/// echo buffer.
+    CanBuffer _rxBuffer;/// frames received by the event driven reader.
+    unsigned int _rxMessages;/// size of the last receive().
 
     BCastBufferElement *_bcastRecvBuffer;/// local storage for bcast messages.
+    JointStateBuffer *_state;/// joint state decoded from the bcast messages.
+    JointStateSnapshot *_jointState;/// what the getters read of _state.
 
     unsigned char _my_address;/// 
     unsigned char _destinations[CAN_MAX_CARDS];/// list of connected cards (and their addresses).
@@ -1259,6 +1246,8 @@ bool CanBusMotionControlParameters::fromConfig(yarp::os::Searchable &p)
     _txTimeout=canGroup.check("CanTxTimeout", Value(20), "tx timeout").asInt();
     _rxTimeout=canGroup.check("CanRxTimeout", Value(20), "rx timeout").asInt();
 
+    _eventDriven=canGroup.check("CanEventDriven", Value(0), "wake up the requests as soon as their replies arrive").asInt()!=0;
+
     // default values for CanTxQueueSize/CanRxQueueSize should be the 
     // maximum, difficult to pick a correct value, let the driver 
     // decide on this
@@ -1908,6 +1897,7 @@ CanBusMotionControlParameters::CanBusMotionControlParameters()
     _my_address = 0;
     _polling_interval = 10;
     _timeout = 20;
+    _eventDriven = false;
     _njoints = 0;
 
     _txQueueSize = 2047;/** max len of the buffer for the esd driver */
@@ -1967,6 +1957,7 @@ bool CanBusMotionControlParameters::alloc(int nj)
     _my_address = 0;
     _polling_interval = 10;
     _timeout = 20;
+    _eventDriven = false;
     _njoints = nj;
 
     _txQueueSize = 2047;/** max len of the buffer for the esd driver */
@@ -2050,7 +2041,10 @@ CanBusResources::CanBusResources ()
     _readMessages = 0;
     _writeMessages = 0;
     _echoMessages = 0;
+    _rxMessages = 0;
     _bcastRecvBuffer = NULL;
+    _state = NULL;
+    _jointState = NULL;
 
     _error_status = true;
     requestsQueue=0;
@@ -2139,11 +2133,10 @@ bool CanBusResources::initialize (const CanBusMotionControlParameters& parms)
     for (int j=0; j<_njoints ;j++)
         {
             _bcastRecvBuffer[j]._update_e=Time::now();
-            _bcastRecvBuffer[j]._position_joint.resetStats();
-            _bcastRecvBuffer[j]._position_rotor.resetStats();
-            _bcastRecvBuffer[j]._speed_rotor.resetStats();
-            _bcastRecvBuffer[j]._accel_rotor.resetStats();
+            _bcastRecvBuffer[j]._position_stats.resetStats();
         }
+    _state = new JointStateBuffer(_njoints);
+    _jointState = new JointStateSnapshot(_njoints);
 
     //previously initialized
     iCanBus->canSetBaudRate(_speed);
@@ -2198,6 +2191,7 @@ bool CanBusResources::initialize (const CanBusMotionControlParameters& parms)
     _writeBuffer=iBufferFactory->createBuffer(BUF_SIZE);
     _replyBuffer=iBufferFactory->createBuffer(BUF_SIZE);
     _echoBuffer=iBufferFactory->createBuffer(BUF_SIZE);
+    _rxBuffer=iBufferFactory->createBuffer(BUF_SIZE);
     yDebug("Can read/write buffers created, buffer size: %d\n", BUF_SIZE);
 
     requestsQueue = new RequestsQueue(_njoints, ICUBCANPROTO_POL_MC_CMD_MAXNUM);
@@ -2218,6 +2212,16 @@ bool CanBusResources::uninitialize ()
 
     //yTrace("CanBusResources::uninitialize\n");
     checkAndDestroy<BCastBufferElement> (_bcastRecvBuffer);
+    if (_jointState!=NULL)
+    {
+        delete _jointState;
+        _jointState=NULL;
+    }
+    if (_state!=NULL)
+    {
+        delete _state;
+        _state=NULL;
+    }
 
     if (_initialized)
     {
@@ -2225,6 +2229,7 @@ bool CanBusResources::uninitialize ()
         iBufferFactory->destroyBuffer(_writeBuffer);
         iBufferFactory->destroyBuffer(_replyBuffer);
         iBufferFactory->destroyBuffer(_echoBuffer);
+        iBufferFactory->destroyBuffer(_rxBuffer);
         _initialized=false;
     }
 
@@ -2261,6 +2266,21 @@ bool CanBusResources::read ()
     return res;
 }
 
+bool CanBusResources::receive ()
+{
+    unsigned int messages=BUF_SIZE;
+
+    _rxMessages=0;
+    return iCanBus->canRead(_rxBuffer, messages, &_rxMessages, true);
+}
+
+void CanBusResources::swapReceived ()
+{
+    std::swap(_readBuffer, _rxBuffer);
+    _readMessages=_rxMessages;
+    _rxMessages=0;
+}
+
 bool CanBusResources::startPacket ()
 {
     _writeMessages = 0;
@@ -2285,6 +2305,19 @@ bool CanBusResources::addMessage (int msg_id, int joint)
 
 bool CanBusResources::addMessage (int id, int joint, int msg_id)
 {
+    // the request goes in the queue before the message is written, the
+    // reply can arrive as soon as the message is on the bus
+    CanRequest rq;
+    rq.threadId=id;
+    rq.joint=joint;
+    rq.msg=msg_id;
+    if (!requestsQueue->append(rq, Time::now()))
+    {
+        // not sent, the caller does not wait for it and sees a missing reply
+        yError("too many threads waiting for msg %d of joint %d, request dropped\n", msg_id, joint);
+        return false;
+    }
+
     unsigned char *data=_writeBuffer[_writeMessages].getData();
     unsigned int destId= _destinations[joint/2] & 0x0f;
 
@@ -2296,12 +2329,6 @@ bool CanBusResources::addMessage (int id, int joint, int msg_id)
     _writeBuffer[_writeMessages].setLen(1);
     _writeMessages ++;
 
-    CanRequest rq;
-    rq.threadId=id;
-    rq.joint=joint;
-    rq.msg=msg_id;
-    requestsQueue->append(rq);
-
     return true;
 }
 
@@ -2425,6 +2452,8 @@ ImplementCurrentControl(this)
     _ref_torques=0;
     _last_position_move_time = 0;
     mServerLogger = NULL;
+    _eventDriven = false;
+    _stopEventReader = false;
 }
 
 
@@ -2678,6 +2707,14 @@ bool CanBusMotionControl::open (Searchable &config)
 
     threadPool = new ThreadPool2(res.iBufferFactory);
 
+    _eventDriven = p._eventDriven;
+    if (_eventDriven)
+    {
+        yInfo("%s [%d] replies dispatched as soon as they arrive (CanEventDriven)\n", canDevName.c_str(), p._networkN);
+        _stopEventReader = false;
+        _eventReader = std::thread(&CanBusMotionControl::eventLoop, this);
+    }
+
     PeriodicThread::setPeriod((double)p._polling_interval/1000.0);
     PeriodicThread::start();
 
@@ -2700,6 +2737,9 @@ bool CanBusMotionControl::open (Searchable &config)
     if (!_firmwareVersionHelper->checkFirmwareVersions())
     {
         PeriodicThread::stop();
+        _stopEventReader = true;
+        if (_eventReader.joinable())
+            _eventReader.join();
         _opened = false;
         yError() << "checkFirmwareVersions() failed. CanBusMotionControl::open returning false,";
         return false;
@@ -2993,6 +3033,10 @@ bool CanBusMotionControl::close (void)
 
         PeriodicThread::stop ();/// stops the thread first (joins too).
 
+        _stopEventReader = true;
+        if (_eventReader.joinable())
+            _eventReader.join();
+
         ImplementPositionControl2::uninitialize();
         ImplementVelocityControl2::uninitialize();
 
@@ -3059,6 +3103,7 @@ void CanBusMotionControl::handleBroadcasts()
     double before=Time::now();
     unsigned int i=0;
     const int _networkN=r._networkN;
+    const BCastDecoderTable &decoders=BCastDecoderTable::instance();
 
     for (unsigned int buff_num=0; buff_num<2; buff_num++)
     {
@@ -3104,10 +3149,8 @@ void CanBusMotionControl::handleBroadcasts()
                                 if ( attached_channel == chan+off)
                                 {
                                     double scaleFactor = 1/_axisTorqueHelper->getNewtonsToSensor(axis);
-                                    r._bcastRecvBuffer[axis]._torque=(((unsigned short)(data[2*chan+1]))<<8)+data[2*chan]-0x8000;
-                                    r._bcastRecvBuffer[axis]._torque=r._bcastRecvBuffer[axis]._torque*scaleFactor;
-                                    //r._bcastRecvBuffer[axis]._torque=0;
-                                    r._bcastRecvBuffer[axis]._update_t = before;
+                                    double torque=(((unsigned short)(data[2*chan+1]))<<8)+data[2*chan]-0x8000;
+                                    r._state->row(JointStateBuffer::TORQUE)[axis]=torque*scaleFactor;
                                 }
                             }
                         }
@@ -3154,6 +3197,22 @@ void CanBusMotionControl::handleBroadcasts()
                 {
                     j *= 2;
 
+                    // the messages with joint state are decoded straight into the state buffer
+                    BCastDecoder decode=decoders[id];
+                    if (decode!=0)
+                    {
+                        const bool second=(j+1 < r.getJoints());
+                        decode(data, j, second, before, *r._state);
+
+                        if ((id & 0x00f) == ICUBCANPROTO_PER_MC_MSG__POSITION)
+                        {
+                            r._bcastRecvBuffer[j]._position_stats.tick(before);
+                            if (second)
+                                r._bcastRecvBuffer[j+1]._position_stats.tick(before);
+                        }
+                        continue;
+                    }
+
                     /* less sign nibble specifies msg type */
                     switch (id & 0x00f)
                     {
@@ -3179,91 +3238,6 @@ void CanBusMotionControl::handleBroadcasts()
                         }
                         break;
 
-                    case ICUBCANPROTO_PER_MC_MSG__POSITION:
-                        {
-                            // r._bcastRecvBuffer[j]._position = *((int *)(data));
-                            // r._bcastRecvBuffer[j]._update_p = before;
-                            int tmp=*((int *)(data));
-                            r._bcastRecvBuffer[j]._position_joint.update(tmp, before);
-
-                            j++;
-                            if (j < r.getJoints())
-                                {
-                                    tmp =*((int *)(data+4));
-                                    //r._bcastRecvBuffer[j]._position = *((int *)(data+4));
-                                    //r._bcastRecvBuffer[j]._update_p = before;
-                                    r._bcastRecvBuffer[j]._position_joint.update(tmp, before);
-                                }
-                        }
-                        break;
-
-                    case ICUBCANPROTO_PER_MC_MSG__MOTOR_POSITION:
-                        {
-                            // r._bcastRecvBuffer[j]._position = *((int *)(data));
-                            // r._bcastRecvBuffer[j]._update_p = before;
-                            int tmp=*((int *)(data));
-                            r._bcastRecvBuffer[j]._position_rotor.update(tmp, before);
-
-                            j++;
-                            if (j < r.getJoints())
-                                {
-                                    tmp =*((int *)(data+4));
-                                    //r._bcastRecvBuffer[j]._position = *((int *)(data+4));
-                                    //r._bcastRecvBuffer[j]._update_p = before;
-                                    r._bcastRecvBuffer[j]._position_rotor.update(tmp, before);
-                                }
-                        }
-                        break;
-
-                    case ICUBCANPROTO_PER_MC_MSG__MOTOR_SPEED:
-                    {
-                        int tmp;
-                        tmp =*((short *)(data));
-                        r._bcastRecvBuffer[j]._speed_rotor.update(tmp, before);
-                        tmp =*((short *)(data+4));
-                        r._bcastRecvBuffer[j]._accel_rotor.update(tmp, before);
-                        r._bcastRecvBuffer[j]._update_s = before;
-                        j++;
-                        if (j < r.getJoints())
-                        {
-                            tmp =*((short *)(data+2));
-                            r._bcastRecvBuffer[j]._speed_rotor.update(tmp, before);
-                            tmp =*((short *)(data+6));
-                            r._bcastRecvBuffer[j]._accel_rotor.update(tmp, before);
-                            r._bcastRecvBuffer[j]._update_s = before;
-                        }
-                        break;
-                    }
-                    break;
-    #if 0
-                    case ICUBCANPROTO_PER_MC_MSG__TORQUE:
-                        {
-                            int tmp=0; //*((int *)(data));
-                            r._bcastRecvBuffer[j]._torque=tmp;
-                            r._bcastRecvBuffer[j]._update_t=before;
-
-                            j++;
-                            if (j < r.getJoints())
-                                {
-                                    tmp = 0;//*((int *)(data+4));
-                                    r._bcastRecvBuffer[j]._torque=tmp;
-                                    r._bcastRecvBuffer[j]._update_t=before;
-                                }
-                        }
-    #endif
-
-                    case ICUBCANPROTO_PER_MC_MSG__PID_VAL:
-                        r._bcastRecvBuffer[j]._pid_value = *((short *)(data));
-                        r._bcastRecvBuffer[j]._update_v = before;
-
-                        j++;
-                        if (j < r.getJoints())
-                        {
-                            r._bcastRecvBuffer[j]._pid_value = *((short *)(data+2));
-                            r._bcastRecvBuffer[j]._update_v = before;
-                        }
-                        break;
-
                     case ICUBCANPROTO_PER_MC_MSG__STATUS:
                         // fault signals.
                         r._bcastRecvBuffer[j]._axisStatus= *((short *)(data));
@@ -3397,56 +3371,136 @@ void CanBusMotionControl::handleBroadcasts()
                         }
                         break;
 
-                    case ICUBCANPROTO_PER_MC_MSG__CURRENT:
-                        r._bcastRecvBuffer[j]._current = *((short *)(data));
-                        r._bcastRecvBuffer[j]._update_c = before;
-                        j++;
-                        if (j < r.getJoints())
-                        {
-                            r._bcastRecvBuffer[j]._current = *((short *)(data+2));
-                            r._bcastRecvBuffer[j]._update_c = before;
-                        }
+                    default:
                         break;
+                    }
+                }
+            }
+        }
+    }
+}
 
-                    case ICUBCANPROTO_PER_MC_MSG__PID_ERROR:
-                        r._bcastRecvBuffer[j]._position_error = *((short *)(data));
-                        r._bcastRecvBuffer[j]._torque_error =   *((short *)(data+4));
-                        r._bcastRecvBuffer[j]._update_r = before;
-                        j++;
-                        if (j < r.getJoints())
+///
+///
+///
+//
+// handle class 0 messages - polling messages.
+// (class 0, 8 bits of the ID used to represent the source and destination).
+// the first byte of the message is the message type and motor number (0 or 1).
+// It does not need _mutex, only one thread consumes the requests queue.
+//
+void CanBusMotionControl::dispatchReplies(CanBuffer &buffer, unsigned int size)
+{
+    CanBusResources& r = RES (system_resources);
+
+    if (r.requestsQueue->getPending()<=0)
+    {
+        //DEBUG_FUNC("Thread loop: no pending messages\n");
+        return;
+    }
+
+    DEBUG_FUNC("There are %d pending messages, read msgs: %d\n", 
+            r.requestsQueue->getPending(), size);
+    for (unsigned int i = 0; i < size; i++)
+        {
+            unsigned char *msgData;
+
+            CanMessage& m = buffer[i];
+            msgData=m.getData();      
+
+            if (getClass(m) == 0) /// class 0 msg.
+                {
+                    PRINT_CAN_MESSAGE("Received \n", m);
+                    /// legitimate message directed here, checks whether replies to any message.
+                    int j=getJoint(m,r._destInv); //get joint from message
+                    int id=r.requestsQueue->pop(j, msgData[0]);
+                    if(id==-1)
                         {
-                            r._bcastRecvBuffer[j]._position_error = *((short *)(data+2));
-                            r._bcastRecvBuffer[j]._torque_error = *((short *)(data+6));
-                            r._bcastRecvBuffer[j]._update_r = before;
+                            yWarning("%s [%d] Received message but no threads waiting for it. (id: 0x%x, Class:%d MsgData[0]:%d)\n ", canDevName.c_str(), r._networkN, m.getId(), getClass(m), msgData[0]);
+                            continue;
                         }
-                        break;
-
-                    case ICUBCANPROTO_PER_MC_MSG__VELOCITY:
-                        // also receives the acceleration values.
-                        r._bcastRecvBuffer[j]._speed_joint = *((short *)(data));
-                        r._bcastRecvBuffer[j]._accel_joint = *((short *)(data+4));
-                        r._bcastRecvBuffer[j]._update_s = before;
-                        j++;
-                        if (j < r.getJoints())
+                    ThreadTable2 *t=threadPool->getThreadTable(id);
+                    if (t==0)
                         {
-                            r._bcastRecvBuffer[j]._speed_joint = *((short *)(data+2));
-                            r._bcastRecvBuffer[j]._accel_joint = *((short *)(data+6));
-                            r._bcastRecvBuffer[j]._update_s = before;
+                            yWarning("Asked a bad thread id, this is probably a bug, check threadPool\n");
+                            continue;
                         }
-                        break;
+                    DEBUG_FUNC("Pushing reply\n");
+                    //push reply to thread's list of replies
+                    if (!t->push(m))
+                        yError("error while pushing a reply, this is probably an error\n");
+                }
+        }
+}
 
-                    default:
-                        break;
+// wake up the threads whose requests have been waiting more than CanTimeout
+void CanBusMotionControl::checkTimeouts(double now)
+{
+    CanBusResources& r = RES (system_resources);
+
+    if (r.requestsQueue->getPending()<=0)
+        return;
+
+    const double timeout=r._timeout/1000.0;
+    for(int j=0;j<r.requestsQueue->getNJoints();j++)
+        {
+            for(int m=0;m<r.requestsQueue->getNMessages();m++)
+            {
+                int tid;
+                while ((tid=r.requestsQueue->popTimedOut(j, m, now, timeout))!=-1)
+                    {
+                        yError("%s [%d] thread:%d msg:%d joint:%d timed out\n", 
+                                canDevName.c_str(),
+                                r._networkN,
+                                tid, m, j);
+
+                        ThreadTable2 *t=threadPool->getThreadTable(tid);
+                        if (t!=0)
+                            t->timeout(); //notify one message timedout
                     }
-                }
             }
         }
+}
+
+// the reader of CanEventDriven: it sleeps in canRead() and it takes _mutex
+// only to update the broadcasts, the replies go straight to the waiting threads.
+void CanBusMotionControl::eventLoop()
+{
+    CanBusResources& r = RES (system_resources);
+
+    while (!_stopEventReader)
+    {
+        // returns after CanRxTimeout also if nothing arrived, so the timeouts are still checked
+        if (!r.receive())
+            r.printMessage("%s [%d] CAN: read failed\n", canDevName.c_str(), r._networkN);
+
+        dispatchReplies(r._rxBuffer, r._rxMessages);
+
+        checkTimeouts(Time::now());
+
+        std::lock_guard<std::mutex> lck(_mutex);
+
+        r.swapReceived();
+
+        handleBroadcasts();
+
+        std::list<TBR_AnalogSensor *>::iterator analogIt=analogSensors.begin();
+        while(analogIt!=analogSensors.end())
+        {
+            TBR_AnalogSensor *pAnalog=(*analogIt);
+            if (pAnalog && !pAnalog->handleAnalog(system_resources))
+            {
+                yWarning("%s [%d] analog sensor received unexpected class 0x03 messages\n", canDevName.c_str(), r._networkN);
+            }
+            analogIt++;
+        }
+
+        r._jointState->publish(*r._state);
+
+        r._echoMessages = 0; //echo buffer cleanup
     }
 }
 
-///
-///
-///
 bool CanBusMotionControl::threadInit()
 {
     CanBusResources& r = RES (system_resources);
@@ -3474,7 +3528,6 @@ void CanBusMotionControl::threadRelease()
 void CanBusMotionControl:: run()
 {
     CanBusResources& r = RES (system_resources);
-    unsigned int i = 0;
 
     myCount++;
     double before = Time::now();
@@ -3483,57 +3536,20 @@ void CanBusMotionControl:: run()
         averagePeriod+=(currentRun-previousRun)*1000;
 
     ////// HANDLE TIMEOUTS
-    // check timeout on messages
-    std::list<CanRequest> timedout;
-    for(int j=0;j<r.requestsQueue->getNJoints();j++)
-        {
-            for(int m=0;m<r.requestsQueue->getNMessages();m++)
-            {
-                ThreadFifo *fifo=r.requestsQueue->getFifo(j,m);
-                ACE_ASSERT (fifo!=0);
-                std::list<ThreadId>::iterator it=fifo->begin();
-                std::list<ThreadId>::iterator end=fifo->end();
-                while(it!=end)
-                    {
-                        //increase wait time
-                        (*it).waitTime+=r._polling_interval;
-                        if ((*it).waitTime>=r._timeout)
-                            {
-                                // ok we have it... this is a timed out message
-                                CanRequest rq;
-                                rq.joint=j;
-                                rq.msg=m;
-                                rq.threadId=(*it).id;
-                                timedout.push_back(rq); //store this request, so we can wake up the waiting thread
-                                it=fifo->erase(it); //it now points to the next element
-                                yError("%s [%d] thread:%d msg:%d joint:%d timed out\n", 
-                                        canDevName.c_str(),
-                                        r._networkN,
-                                        rq.threadId, rq.msg, rq.joint);
-
-                                // ???
-                                //logJointData(canDevName.c_str(),r._networkN,j,3,yarp::os::Value(1));
-                            }
-                        else
-                            ++it;
-                    }
-            }
-        }
+    // in event driven mode the reader thread takes care of them
+    if (!_eventDriven)
+        checkTimeouts(before);
 
-    //now go through the list of timedout requests and wake up waiting threads
-    std::list<CanRequest>::iterator it=timedout.begin();
-    std::list<CanRequest>::iterator end=timedout.end();
-    while(it!=end)
-        {
-            int tid=(*it).threadId;
-            ThreadTable2 *t=threadPool->getThreadTable(tid);
-            t->timeout(); //notify one message timedout
-            ++it;
-        }
     //////////////////////////////////////////////////////////////////
     // report error LOOP
     if ((currentRun-lastReportTime)>REPORT_PERIOD)
         {
+            // in event driven mode eventLoop() updates the broadcast statistics and
+            // the analog counters under _mutex, while here they are read and reset
+            std::unique_lock<std::mutex> lck(_mutex, std::defer_lock);
+            if (_eventDriven)
+                lck.lock();
+
             double avPeriod=1000.0*getEstimatedPeriod();
             double avThTime=1000.0*getEstimatedUsed();//averageThreadTime/myCount;
             unsigned int it=getIterations();
@@ -3661,8 +3677,8 @@ void CanBusMotionControl:: run()
                     double max;
                     double min;
                     int it;
-                    r._bcastRecvBuffer[j]._position_joint.getStats(it, dT, min, max);
-                    r._bcastRecvBuffer[j]._position_joint.resetStats();
+                    r._bcastRecvBuffer[j]._position_stats.getStats(it, dT, min, max);
+                    r._bcastRecvBuffer[j]._position_stats.resetStats();
 
                     logJointData(canDevName.c_str(),r._networkN,j,5,yarp::os::Value(max));
 
@@ -3734,6 +3750,15 @@ void CanBusMotionControl:: run()
         }
 
     //DEBUG_FUNC("CanBusMotionControl::thread running [%d]: wait\n", mycount);
+    if (_eventDriven)
+    {
+        // the bus is read by eventLoop(), here only the reports
+        double now = Time::now();
+        averageThreadTime+=(now-before)*1000;
+        previousRun=before;
+        return;
+    }
+
     _mutex.lock();
     //DEBUG_FUNC("posted\n");
 
@@ -3762,50 +3787,7 @@ void CanBusMotionControl:: run()
         analogIt++;
     }
  
-    //
-    // handle class 0 messages - polling messages.
-    // (class 0, 8 bits of the ID used to represent the source and destination).
-    // the first byte of the message is the message type and motor number (0 or 1).
-    //
-    if (r.requestsQueue->getPending()>0)
-        {
-            DEBUG_FUNC("There are %d pending messages, read msgs: %d\n", 
-                  r.requestsQueue->getPending(), r._readMessages);
-            for (i = 0; i < r._readMessages; i++)
-                {
-                    unsigned char *msgData;
-
-                    CanMessage& m = r._readBuffer[i];
-                    msgData=m.getData();      
-
-                    if (getClass(m) == 0) /// class 0 msg.
-                        {
-                            PRINT_CAN_MESSAGE("Received \n", m);
-                            /// legitimate message directed here, checks whether replies to any message.
-                            int j=getJoint(m,r._destInv); //get joint from message
-                            int id=r.requestsQueue->pop(j, msgData[0]);
-                            if(id==-1)
-                                {
-                                    yWarning("%s [%d] Received message but no threads waiting for it. (id: 0x%x, Class:%d MsgData[0]:%d)\n ", canDevName.c_str(), r._networkN, m.getId(), getClass(m), msgData[0]);
-                                    continue;
-                                }
-                            ThreadTable2 *t=threadPool->getThreadTable(id);
-                            if (t==0)
-                                {
-                                    yWarning("Asked a bad thread id, this is probably a bug, check threadPool\n");
-                                    continue;
-                                }
-                            DEBUG_FUNC("Pushing reply\n");
-                            //push reply to thread's list of replies
-                            if (!t->push(m))
-                                yError("error while pushing a reply, this is probably an error\n");
-                        }
-                }
-        }
-    else
-        {
-            //DEBUG_FUNC("Thread loop: no pending messages\n");
-        }
+    dispatchReplies(r._readBuffer, r._readMessages);
 
     //    counter ++;
     /*if (counter > r._timeout)
@@ -3815,6 +3797,8 @@ void CanBusMotionControl:: run()
       r._error_status = false;
       }*/
 
+    r._jointState->publish(*r._state);
+
     r._echoMessages = 0; //echo buffer cleanup
 
     _mutex.unlock();
@@ -4339,10 +4323,10 @@ bool CanBusMotionControl::getImpedanceRaw (int axis, double *stiff, double *damp
 
     r.startPacket();
     r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_IMPEDANCE_PARAMS);
-    r.writePacket();
 
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -4418,10 +4402,10 @@ bool CanBusMotionControl::getImpedanceOffsetRaw (int axis, double *off)
 
     r.startPacket();
     r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_IMPEDANCE_OFFSET);
-    r.writePacket();
 
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -4667,10 +4651,10 @@ bool CanBusMotionControl::helper_getTrqPidRaw (int axis, Pid *out)
 
     r.startPacket();
     r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PID);
-    r.writePacket();
 
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -4708,10 +4692,10 @@ bool CanBusMotionControl::helper_getTrqPidRaw (int axis, Pid *out)
    
     r.startPacket();
     r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_TORQUE_PIDLIMITS);
-    r.writePacket();
 
     // ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -4746,10 +4730,10 @@ bool CanBusMotionControl::helper_getTrqPidRaw (int axis, Pid *out)
    
     r.startPacket();
     r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_MODEL_PARAMS);
-    r.writePacket();
 
     // ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -4850,8 +4834,7 @@ bool CanBusMotionControl::getTorqueRaw (int j, double *trq)
         return false;
 
     int k=castToMapper(yarp::dev::ImplementTorqueControl::helper)->toUser(j);
-    std::lock_guard<std::mutex> lck(_mutex);
-    *trq = double(r._bcastRecvBuffer[k]._torque);
+    *trq = r._jointState->get(JointStateBuffer::TORQUE, k);
     return true;
 }
 
@@ -4929,17 +4912,16 @@ bool CanBusMotionControl::getTorqueRangesRaw (double *min, double *max)
 bool CanBusMotionControl::getPidErrorRaw(const PidControlTypeEnum& pidtype, int axis, double *err)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(axis >= 0 && axis <= r.getJoints()))
+    if (!(axis >= 0 && axis < r.getJoints()))
         return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
     switch (pidtype)
     {
         case VOCAB_PIDTYPE_POSITION:
-        *err = double(r._bcastRecvBuffer[axis]._position_error);
+        *err = r._jointState->get(JointStateBuffer::POSITION_ERROR, axis);
         break;
         case VOCAB_PIDTYPE_TORQUE:
-        *err = double(r._bcastRecvBuffer[axis]._torque_error);
+        *err = r._jointState->get(JointStateBuffer::TORQUE_ERROR, axis);
         break;
         case VOCAB_PIDTYPE_VELOCITY:
         *err = 0; //not yet implemented
@@ -5080,10 +5062,10 @@ bool CanBusMotionControl::getParameterRaw(int axis, unsigned int type, double* v
 
     r.startPacket();
     r.addMessage (id, axis, type);
-    r.writePacket();
 
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -5139,10 +5121,10 @@ bool CanBusMotionControl::getDebugParameterRaw(int axis, unsigned int index, dou
     r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_DEBUG_PARAM);
     *((unsigned char *)(r._writeBuffer[0].getData()+1)) = index;
     r._writeBuffer[0].setLen(2);
-    r.writePacket();
 
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -5219,10 +5201,10 @@ bool CanBusMotionControl::getFirmwareVersionRaw (int axis, can_protocol_info con
     *((unsigned char *)(r._writeBuffer[0].getData()+1)) = (unsigned char)(icub_interface_protocol.major & 0xFF);
     *((unsigned char *)(r._writeBuffer[0].getData()+2)) = (unsigned char)(icub_interface_protocol.minor & 0xFF);
     r._writeBuffer[0].setLen(3);
-    r.writePacket();
 
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -5406,23 +5388,22 @@ bool CanBusMotionControl::setDebugReferencePositionRaw(int axis, double value)
 bool CanBusMotionControl::getPidOutputRaw(const PidControlTypeEnum& pidtype, int axis, double *out)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(axis >= 0 && axis <= r.getJoints()))
+    if (!(axis >= 0 && axis < r.getJoints()))
         return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
     switch (pidtype)
     {
         case VOCAB_PIDTYPE_POSITION:
-            *(out) = double(r._bcastRecvBuffer[axis]._pid_value);
+            *(out) = r._jointState->get(JointStateBuffer::PID_VALUE, axis);
         break;
         case VOCAB_PIDTYPE_VELOCITY:
-            *(out) = double(r._bcastRecvBuffer[axis]._pid_value);
+            *(out) = r._jointState->get(JointStateBuffer::PID_VALUE, axis);
         break;
         case VOCAB_PIDTYPE_CURRENT:
-            *(out) = double(r._bcastRecvBuffer[axis]._pid_value);
+            *(out) = r._jointState->get(JointStateBuffer::PID_VALUE, axis);
         break;
         case VOCAB_PIDTYPE_TORQUE:
-            *(out) = double(r._bcastRecvBuffer[axis]._pid_value);
+            *(out) = r._jointState->get(JointStateBuffer::PID_VALUE, axis);
         break;
         default:
             yError()<<"Invalid pidtype:"<<pidtype;
@@ -5566,10 +5547,9 @@ bool CanBusMotionControl::checkMotionDoneRaw (bool *val)
         return false;
     }
 
-    r.writePacket(); //write immediatly
-
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket(); //write immediatly
     _mutex.unlock();
     t->synch();
 
@@ -5801,10 +5781,9 @@ bool CanBusMotionControl::getMotorTorqueParamsRaw (int axis, MotorTorqueParamete
     r.startPacket();
     r.addMessage (id, axis, ICUBCANPROTO_POL_MC_CMD__GET_MOTOR_PARAMS);
 
-    r.writePacket();
-
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -6018,25 +5997,20 @@ bool CanBusMotionControl::resetEncodersRaw()
 bool CanBusMotionControl::getEncodersRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
-    int i;
-
-    std::lock_guard<std::mutex> lck(_mutex);
-    
-    double stamp=0;
-    for (i = 0; i < r.getJoints(); i++) {
-        v[i] = double(r._bcastRecvBuffer[i]._position_joint._value);
 
-        if (stamp<r._bcastRecvBuffer[i]._position_joint._stamp)
-            stamp=r._bcastRecvBuffer[i]._position_joint._stamp;
-    }
+    // no _mutex, the snapshot is consistent by itself
+    double stamps[2*CAN_MAX_CARDS];
+    r._jointState->read(JointStateBuffer::POSITION, v, JointStateBuffer::POSITION_STAMP, stamps);
+    double stamp=latestStamp(stamps, r.getJoints());
 
+    std::lock_guard<std::mutex> lck(_stampMutex);
     stampEncoders.update(stamp);
     return true;
 }
 
 Stamp CanBusMotionControl::getLastInputStamp()
 {
-    std::lock_guard<std::mutex> lck(_mutex);
+    std::lock_guard<std::mutex> lck(_stampMutex);
     Stamp ret=stampEncoders;
     return ret;
 }
@@ -6044,10 +6018,9 @@ Stamp CanBusMotionControl::getLastInputStamp()
 bool CanBusMotionControl::getEncoderRaw(int axis, double *v)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(axis >= 0 && axis <= r.getJoints()))return false;
+    if (!(axis >= 0 && axis < r.getJoints()))return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
-    *v = double(r._bcastRecvBuffer[axis]._position_joint._value);
+    *v = r._jointState->get(JointStateBuffer::POSITION, axis);
     return true;
 }
 
@@ -6055,10 +6028,10 @@ bool CanBusMotionControl::getEncoderSpeedsRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    std::lock_guard<std::mutex> lck(_mutex);
+    r._jointState->read(JointStateBuffer::SPEED, v);
     for (i = 0; i < r.getJoints(); i++) {
         int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Vel_estimator_shift));
-        v[i] = (double(r._bcastRecvBuffer[i]._speed_joint)*1000.0)/vel_factor;
+        v[i] = (v[i]*1000.0)/vel_factor;
     }
     return true;
 }
@@ -6067,12 +6040,11 @@ bool CanBusMotionControl::getEncoderSpeedRaw(int j, double *v)
 {
     CanBusResources& r = RES(system_resources);
     //ACE_ASSERT (j >= 0 && j <= r.getJoints());
-    if (!(j >= 0 && j <= r.getJoints()))
+    if (!(j >= 0 && j < r.getJoints()))
         return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
     int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Vel_estimator_shift));
-    *v = (double(r._bcastRecvBuffer[j]._speed_joint)*1000.0)/vel_factor;
+    *v = (r._jointState->get(JointStateBuffer::SPEED, j)*1000.0)/vel_factor;
     return true;
 }
 
@@ -6080,11 +6052,11 @@ bool CanBusMotionControl::getEncoderAccelerationsRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    std::lock_guard<std::mutex> lck(_mutex);
+    r._jointState->read(JointStateBuffer::ACCEL, v);
     for (i = 0; i < r.getJoints(); i++) {
         int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Vel_estimator_shift));
         int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).jnt_Acc_estimator_shift));
-        v[i] = (double(r._bcastRecvBuffer[i]._accel_joint)*1000000.0)/(vel_factor*acc_factor);
+        v[i] = (v[i]*1000000.0)/(vel_factor*acc_factor);
     }
     return true;
 }
@@ -6093,13 +6065,12 @@ bool CanBusMotionControl::getEncoderAccelerationRaw(int j, double *v)
 {
     CanBusResources& r = RES(system_resources);
     //ACE_ASSERT (j >= 0 && j <= r.getJoints());
-    if (!(j >= 0 && j <= r.getJoints()))
+    if (!(j >= 0 && j < r.getJoints()))
         return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
     int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Vel_estimator_shift));
     int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(j).jnt_Acc_estimator_shift));
-    *v = (double(r._bcastRecvBuffer[j]._accel_joint)*1000000.0)/(vel_factor*acc_factor);
+    *v = (r._jointState->get(JointStateBuffer::ACCEL, j)*1000000.0)/(vel_factor*acc_factor);
     return true;
 }
 
@@ -6127,18 +6098,12 @@ bool CanBusMotionControl::resetMotorEncodersRaw()
 bool CanBusMotionControl::getMotorEncodersRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
-    int i;
-
-    std::lock_guard<std::mutex> lck(_mutex);
-    
-    double stamp=0;
-    for (i = 0; i < r.getJoints(); i++) {
-        v[i] = double(r._bcastRecvBuffer[i]._position_rotor._value);
 
-        if (stamp<r._bcastRecvBuffer[i]._position_rotor._stamp)
-            stamp=r._bcastRecvBuffer[i]._position_rotor._stamp;
-    }
+    double stamps[2*CAN_MAX_CARDS];
+    r._jointState->read(JointStateBuffer::ROTOR_POSITION, v, JointStateBuffer::ROTOR_POSITION_STAMP, stamps);
+    double stamp=latestStamp(stamps, r.getJoints());
 
+    std::lock_guard<std::mutex> lck(_stampMutex);
     stampEncoders.update(stamp);
     return true;
 }
@@ -6146,29 +6111,20 @@ bool CanBusMotionControl::getMotorEncodersRaw(double *v)
 bool CanBusMotionControl::getMotorEncoderRaw(int m, double *v)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(m >= 0 && m <= r.getJoints()))return false;
+    if (!(m >= 0 && m < r.getJoints()))return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
-    *v = double(r._bcastRecvBuffer[m]._position_rotor._value);
+    *v = r._jointState->get(JointStateBuffer::ROTOR_POSITION, m);
     return true;
 }
 
 bool CanBusMotionControl::getMotorEncodersTimedRaw(double *v, double *t)
 {
     CanBusResources& r = RES(system_resources);
-    int i;
-
-    std::lock_guard<std::mutex> lck(_mutex);
-    
-    double stamp=0;
-    for (i = 0; i < r.getJoints(); i++) {
-        v[i] = double(r._bcastRecvBuffer[i]._position_rotor._value);
-        t[i] = r._bcastRecvBuffer[i]._position_rotor._stamp;
 
-        if (stamp<r._bcastRecvBuffer[i]._position_rotor._stamp)
-            stamp=r._bcastRecvBuffer[i]._position_rotor._stamp;
-    }
+    r._jointState->read(JointStateBuffer::ROTOR_POSITION, v, JointStateBuffer::ROTOR_POSITION_STAMP, t);
+    double stamp=latestStamp(t, r.getJoints());
 
+    std::lock_guard<std::mutex> lck(_stampMutex);
     stampEncoders.update(stamp);
     return true;
 }
@@ -6176,11 +6132,9 @@ bool CanBusMotionControl::getMotorEncodersTimedRaw(double *v, double *t)
 bool CanBusMotionControl::getMotorEncoderTimedRaw(int m, double *v, double *t)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(m >= 0 && m <= r.getJoints()))return false;
+    if (!(m >= 0 && m < r.getJoints()))return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
-    *v = double(r._bcastRecvBuffer[m]._position_rotor._value);
-    *t = r._bcastRecvBuffer[m]._position_rotor._stamp;
+    r._jointState->get(JointStateBuffer::ROTOR_POSITION, *v, JointStateBuffer::ROTOR_POSITION_STAMP, *t, m);
     return true;
 }
 
@@ -6212,10 +6166,10 @@ bool CanBusMotionControl::getMotorEncoderSpeedsRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    std::lock_guard<std::mutex> lck(_mutex);
+    r._jointState->read(JointStateBuffer::ROTOR_SPEED, v);
     for (i = 0; i < r.getJoints(); i++) {
         int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Vel_estimator_shift));
-        v[i] = (double(r._bcastRecvBuffer[i]._speed_rotor._value)*1000.0)/vel_factor;
+        v[i] = (v[i]*1000.0)/vel_factor;
     }
     return true;
 }
@@ -6223,11 +6177,10 @@ bool CanBusMotionControl::getMotorEncoderSpeedsRaw(double *v)
 bool CanBusMotionControl::getMotorEncoderSpeedRaw(int m, double *v)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(m >= 0 && m <= r.getJoints()))return false;
+    if (!(m >= 0 && m < r.getJoints()))return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
     int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Vel_estimator_shift));
-    *v = (double(r._bcastRecvBuffer[m]._speed_rotor._value)*1000.0)/vel_factor;
+    *v = (r._jointState->get(JointStateBuffer::ROTOR_SPEED, m)*1000.0)/vel_factor;
     return true;
 }
 
@@ -6235,11 +6188,11 @@ bool CanBusMotionControl::getMotorEncoderAccelerationsRaw(double *accs)
 {
     CanBusResources& r = RES(system_resources);
     int i;
-    std::lock_guard<std::mutex> lck(_mutex);
+    r._jointState->read(JointStateBuffer::ROTOR_ACCEL, accs);
     for (i = 0; i < r.getJoints(); i++) {
         int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Vel_estimator_shift));
         int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(i).mot_Acc_estimator_shift));
-        accs[i] = (double(r._bcastRecvBuffer[i]._accel_rotor._value)*1000000.0)/(vel_factor*acc_factor);
+        accs[i] = (accs[i]*1000000.0)/(vel_factor*acc_factor);
     }
     return true;
 }
@@ -6247,12 +6200,11 @@ bool CanBusMotionControl::getMotorEncoderAccelerationsRaw(double *accs)
 bool CanBusMotionControl::getMotorEncoderAccelerationRaw(int m, double *acc)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(m >= 0 && m <= r.getJoints()))return false;
+    if (!(m >= 0 && m < r.getJoints()))return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
     int vel_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Vel_estimator_shift));
     int acc_factor = (1 << int(_speedEstimationHelper->getEstimationParameters(m).mot_Acc_estimator_shift));
-    *acc = (double(r._bcastRecvBuffer[m]._accel_rotor._value)*1000000.0)/(vel_factor*acc_factor);
+    *acc = (r._jointState->get(JointStateBuffer::ROTOR_ACCEL, m)*1000000.0)/(vel_factor*acc_factor);
     return true;
 }
 
@@ -6270,13 +6222,8 @@ bool CanBusMotionControl::enableAmpRaw(int axis)
 bool CanBusMotionControl::getCurrentsRaw(double *cs)
 {
     CanBusResources& r = RES(system_resources);
-    int i;
 
-    std::lock_guard<std::mutex> lck(_mutex);
-    for (i = 0; i < r.getJoints(); i++)
-    {
-        cs[i] = double(r._bcastRecvBuffer[i]._current);
-    }
+    r._jointState->read(JointStateBuffer::CURRENT, cs);
     return true;
 }
 
@@ -6284,11 +6231,10 @@ bool CanBusMotionControl::getCurrentsRaw(double *cs)
 bool CanBusMotionControl::getCurrentRaw(int axis, double *c)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(axis >= 0 && axis <= r.getJoints()))
+    if (!(axis >= 0 && axis < r.getJoints()))
         return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
-    *c = double(r._bcastRecvBuffer[axis]._current);
+    *c = r._jointState->get(JointStateBuffer::CURRENT, axis);
     return true;
 }
 
@@ -6654,7 +6600,7 @@ bool CanBusMotionControl::setPositionRaw(int j, double ref)
 {
     CanBusResources& r = RES(system_resources);
 
-    if (1/*fabs(ref-r._bcastRecvBuffer[j]._position_joint._value) < _axisPositionDirectHelper->getMaxHwStep(j)*/)
+    if (1/*fabs(ref-r._jointState->get(JointStateBuffer::POSITION, j)) < _axisPositionDirectHelper->getMaxHwStep(j)*/)
     {
 
         int mode = 0;
@@ -6671,8 +6617,8 @@ bool CanBusMotionControl::setPositionRaw(int j, double ref)
     { 
         yWarning("skipping setPosition() on %s, joint %d (req: %.1f curr %.1f) \n", networkName.c_str() , j,
         _axisPositionDirectHelper->posE2A(ref, j),
-        _axisPositionDirectHelper->posE2A(r._bcastRecvBuffer[j]._position_joint._value, j));
-        //double saturated_cmd = _axisPositionDirectHelper->getSaturatedValue(j,r._bcastRecvBuffer[j]._position_joint._value,ref);
+        _axisPositionDirectHelper->posE2A(r._jointState->get(JointStateBuffer::POSITION, j), j));
+        //double saturated_cmd = _axisPositionDirectHelper->getSaturatedValue(j,r._jointState->get(JointStateBuffer::POSITION, j),ref);
         //_writeDWord (CAN_SET_COMMAND_POSITION, j, S_32(saturated_cmd));
         return false;
     }
@@ -6953,10 +6899,9 @@ bool CanBusMotionControl::_readDWord (int msg, int axis, int& value)
     r.startPacket();
     r.addMessage (id, axis, msg);
 
-    r.writePacket();
-
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -7012,10 +6957,9 @@ bool CanBusMotionControl::_readDWordArray (int msg, double *out)
         return false;
     }
 
-    r.writePacket(); //write now
-
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket(); //write now
     _mutex.unlock();
     t->synch();
 
@@ -7071,11 +7015,11 @@ bool CanBusMotionControl::_readWord16 (int msg, int axis, short& value)
     DEBUG_FUNC("readWord16: called from thread %d, axis %d msg %d\n", id, axis, msg);
     r.startPacket();
     r.addMessage (id, axis, msg);
-    r.writePacket(); //write immediatly
 
     ThreadTable2 *t=threadPool->getThreadTable(id);
     DEBUG_FUNC("readWord16: going to wait for packet %d\n", id);
     t->setPending(r._writeMessages);
+    r.writePacket(); //write immediatly
     _mutex.unlock();
     t->synch();
     DEBUG_FUNC("readWord16: ok, wait done %d\n",id);
@@ -7123,11 +7067,11 @@ bool CanBusMotionControl::_readByte8(int msg, int axis, int& value)
     DEBUG_FUNC("_readByte8: called from thread %d, axis %d msg %d\n", id, axis, msg);
     r.startPacket();
     r.addMessage(id, axis, msg);
-    r.writePacket(); //write immediatly
 
     ThreadTable2 *t = threadPool->getThreadTable(id);
     DEBUG_FUNC("_readByte8: going to wait for packet %d\n", id);
     t->setPending(r._writeMessages);
+    r.writePacket(); //write immediatly
     _mutex.unlock();
     t->synch();
     DEBUG_FUNC("_readByte8: ok, wait done %d\n", id);
@@ -7178,11 +7122,11 @@ bool CanBusMotionControl::_readWord16Ex (int msg, int axis, short& value1, short
     DEBUG_FUNC("readWord16Ex: called from thread %d, axis %d msg %d\n", id, axis, msg);
     r.startPacket();
     r.addMessage (id, axis, msg);
-    r.writePacket(); //write immediatly
 
     ThreadTable2 *t=threadPool->getThreadTable(id);
     DEBUG_FUNC("readWord16Ex: going to wait for packet %d\n", id);
     t->setPending(r._writeMessages);
+    r.writePacket(); //write immediatly
     _mutex.unlock();
     t->synch();
     DEBUG_FUNC("readWord16Ex: ok, wait done %d\n",id);
@@ -7243,10 +7187,9 @@ bool CanBusMotionControl::_readWord16Array (int msg, double *out)
     }
 
 
-    r.writePacket();
-
     ThreadTable2 *t=threadPool->getThreadTable(id);
     t->setPending(r._writeMessages);
+    r.writePacket();
     _mutex.unlock();
     t->synch();
 
@@ -7310,19 +7253,11 @@ yarp::dev::DeviceDriver *CanBusMotionControl::createDevice(yarp::os::Searchable&
 bool CanBusMotionControl::getEncodersTimedRaw(double *v, double *t)
 {
     CanBusResources& r = RES(system_resources);
-    int i;
-
-    std::lock_guard<std::mutex> lck(_mutex);
-    
-    double stamp=0;
-    for (i = 0; i < r.getJoints(); i++) {
-        v[i] = double(r._bcastRecvBuffer[i]._position_joint._value);
-        t[i] = r._bcastRecvBuffer[i]._position_joint._stamp;
 
-        if (stamp<r._bcastRecvBuffer[i]._position_joint._stamp)
-            stamp=r._bcastRecvBuffer[i]._position_joint._stamp;
-    }
+    r._jointState->read(JointStateBuffer::POSITION, v, JointStateBuffer::POSITION_STAMP, t);
+    double stamp=latestStamp(t, r.getJoints());
 
+    std::lock_guard<std::mutex> lck(_stampMutex);
     stampEncoders.update(stamp);
     return true;
 }
@@ -7330,11 +7265,9 @@ bool CanBusMotionControl::getEncodersTimedRaw(double *v, double *t)
 bool CanBusMotionControl::getEncoderTimedRaw(int axis, double *v, double *t)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(axis >= 0 && axis <= r.getJoints()))return false;
+    if (!(axis >= 0 && axis < r.getJoints()))return false;
 
-    std::lock_guard<std::mutex> lck(_mutex);
-    *v = double(r._bcastRecvBuffer[axis]._position_joint._value);
-    *t = r._bcastRecvBuffer[axis]._position_joint._stamp;
+    r._jointState->get(JointStateBuffer::POSITION, *v, JointStateBuffer::POSITION_STAMP, *t, axis);
     return true;
 }
 
@@ -7481,23 +7414,17 @@ bool CanBusMotionControl::getRefDutyCyclesRaw(double *v)
 bool CanBusMotionControl::getDutyCycleRaw(int j, double *v)
 {
     CanBusResources& r = RES(system_resources);
-    if (!(j >= 0 && j <= r.getJoints()))
+    if (!(j >= 0 && j < r.getJoints()))
         return false;
-    std::lock_guard<std::mutex> lck(_mutex);
-    *(v) = double(r._bcastRecvBuffer[j]._pid_value);
+    *(v) = r._jointState->get(JointStateBuffer::PID_VALUE, j);
     return true;
 }
 
 bool CanBusMotionControl::getDutyCyclesRaw(double *v)
 {
     CanBusResources& r = RES(system_resources);
-    int i;
 
-    std::lock_guard<std::mutex> lck(_mutex);
-    for (i = 0; i < r.getJoints(); i++)
-    {
-        v[i] = double(r._bcastRecvBuffer[i]._pid_value);
-    }
+    r._jointState->read(JointStateBuffer::PID_VALUE, v);
     return true;
 }
 
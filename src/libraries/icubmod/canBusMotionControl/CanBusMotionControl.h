@@ -23,6 +23,8 @@
 #include <string>
 #include <list>
 #include <mutex>
+#include <atomic>
+#include <thread>
 
 #include <iCub/FactoryInterface.h>
 #include <iCub/LoggerInterfaces.h>
@@ -155,6 +157,7 @@ public:
     unsigned char _my_address;                  /** my address */
     int _polling_interval;                      /** thread polling interval [ms] */
     int _timeout;                               /** number of cycles before timing out */
+    bool _eventDriven;                          /** read the bus in a thread woken up by the frames */
 
     std::string *_axisName;                     /** axis name */
     std::string *_axisType;                     /** axis type */
@@ -643,6 +646,14 @@ class axisTorqueHelper
  * the motor control boards. A thread monitors the bus for incoming
  * messages and dispatches replies to calling threads.
  *
+ * By default the thread polls the bus every CanPollingInterval ms.
+ * With CanEventDriven set in the CAN group a second thread blocks on
+ * the bus instead and wakes up the calling threads as soon as their
+ * replies arrive; the polling thread then only prints the reports.
+ * This needs a driver whose canRead() and canWrite() can be called
+ * concurrently and whose blocking read times out after CanRxTimeout
+ * (e.g. sharedcan, socketcan).
+ *
  * Communication with the CAN bus is done through the standard
  * YARP ICanBus interface.
  *
@@ -729,6 +740,9 @@ private:
     void operator=(const CanBusMotionControl&);
 
     void handleBroadcasts();
+    void dispatchReplies(CanBuffer &buffer, unsigned int size);
+    void checkTimeouts(double now);
+    void eventLoop();
  
     double previousRun;
     double averagePeriod;
@@ -737,6 +751,11 @@ private:
     int myCount;
     double lastReportTime;
     os::Stamp stampEncoders;
+    std::mutex _stampMutex;   // stampEncoders, the encoders are read without _mutex
+
+    bool _eventDriven;
+    std::thread _eventReader;
+    std::atomic<bool> _stopEventReader;
 
     char _buff[256];
 
@@ -36,7 +36,6 @@ private:
     int _timedOut;
     yarp::dev::CanBuffer _replies;
     yarp::dev::ICanBufferFactory *ic;
-    std::mutex mtx_synch;
     std::condition_variable cv_synch;
     int _replied;
     ACE_thread_t _handle;
@@ -58,15 +57,18 @@ public:
     // messages which will store replies
     void init(yarp::dev::ICanBufferFactory *i);
 
-    // set number of pending requests, reset
+    // set number of pending requests, reset.
+    // call it before the requests are written: the replies can be
+    // pushed as soon as they are on the bus.
     inline void setPending(int pend);
 
     // wait on semaphore, usually thread sleeps here after
-    // has issued a list of requests to the can 
+    // has issued a list of requests to the can. Returns at once if
+    // all the replies (or timeouts) arrived before we got here.
     void synch()
     {
-        std::unique_lock<std::mutex> lck(mtx_synch);
-        cv_synch.wait(lck);
+        std::unique_lock<std::mutex> lck(_mutex);
+        cv_synch.wait(lck, [this]{ return _pending<=0; });
     }
 
     // true if there are pending requests
@@ -675,6 +675,72 @@ bool ClientCartesianController::askForPosition(const Vector &q0, const Vector &x
 }
 
 
+/************************************************************************/
+bool ClientCartesianController::askForBatch(const Vector *q0, const Matrix &xd,
+                                            const unsigned int pose, Matrix &xdhat,
+                                            Matrix &odhat, Matrix &qdhat, Matrix &res)
+{
+    if (!connected)
+        return false;
+
+    Bottle command, reply;
+    command.addVocab(IKINCARTCTRL_VOCAB_CMD_ASK);
+    addTargetsOption(command,xd);
+    if (q0!=NULL)
+        addVectorOption(command,IKINCARTCTRL_VOCAB_OPT_Q,*q0);
+    addPoseOption(command,pose);
+
+    if (!portRpc.write(command,reply))
+    {
+        yError("unable to get reply from server!");
+        return false;
+    }
+
+    return getDesiredBatchOption(reply,xdhat,odhat,qdhat,res);
+}
+
+
+/************************************************************************/
+bool ClientCartesianController::askForPoses(const Matrix &xd, const Matrix &od,
+                                            Matrix &xdhat, Matrix &odhat, Matrix &qdhat,
+                                            Matrix &res)
+{
+    if (xd.rows()!=od.rows())
+        return false;
+
+    return askForBatch(NULL,cat(xd,od),IKINCTRL_POSE_FULL,xdhat,odhat,qdhat,res);
+}
+
+
+/************************************************************************/
+bool ClientCartesianController::askForPoses(const Vector &q0, const Matrix &xd,
+                                            const Matrix &od, Matrix &xdhat, Matrix &odhat,
+                                            Matrix &qdhat, Matrix &res)
+{
+    if (xd.rows()!=od.rows())
+        return false;
+
+    return askForBatch(&q0,cat(xd,od),IKINCTRL_POSE_FULL,xdhat,odhat,qdhat,res);
+}
+
+
+/************************************************************************/
+bool ClientCartesianController::askForPositions(const Matrix &xd, Matrix &xdhat,
+                                                Matrix &odhat, Matrix &qdhat, Matrix &res)
+{
+    return askForBatch(NULL,xd,IKINCTRL_POSE_XYZ,xdhat,odhat,qdhat,res);
+}
+
+
+/************************************************************************/
+bool ClientCartesianController::askForPositions(const Vector &q0, const Matrix &xd,
+                                                Matrix &xdhat, Matrix &odhat, Matrix &qdhat,
+                                                Matrix &res)
+{
+    return askForBatch(&q0,xd,IKINCTRL_POSE_XYZ,xdhat,odhat,qdhat,res);
+}
+
+
 /************************************************************************/
 bool ClientCartesianController::getDOF(Vector &curDof)
 {
@@ -2756,6 +2756,75 @@ bool ServerCartesianController::askForPosition(const Vector &q0, const Vector &x
 }
 
 
+/************************************************************************/
+bool ServerCartesianController::askForBatch(const Vector *q0, const Matrix &xd,
+                                            const unsigned int pose, Matrix &xdhat,
+                                            Matrix &odhat, Matrix &qdhat, Matrix &res)
+{
+    if (!connected)
+        return false;
+
+    lock_guard<mutex> lck(mtx);
+
+    Bottle command, reply;
+    command.addVocab(IKINSLV_VOCAB_CMD_ASK);
+    addTargetsOption(command,xd);
+    if (q0!=NULL)
+        addVectorOption(command,IKINSLV_VOCAB_OPT_Q,*q0);
+    addPoseOption(command,pose);
+
+    // send command and wait for reply
+    bool ret=false;
+    if (portSlvRpc.write(command,reply))
+        ret=getDesiredBatchOption(reply,xdhat,odhat,qdhat,res);
+    else
+        yError("%s: unable to get reply from solver!",ctrlName.c_str());
+
+    return ret;
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::askForPoses(const Matrix &xd, const Matrix &od,
+                                            Matrix &xdhat, Matrix &odhat, Matrix &qdhat,
+                                            Matrix &res)
+{
+    if (xd.rows()!=od.rows())
+        return false;
+
+    return askForBatch(NULL,cat(xd,od),IKINCTRL_POSE_FULL,xdhat,odhat,qdhat,res);
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::askForPoses(const Vector &q0, const Matrix &xd,
+                                            const Matrix &od, Matrix &xdhat, Matrix &odhat,
+                                            Matrix &qdhat, Matrix &res)
+{
+    if (xd.rows()!=od.rows())
+        return false;
+
+    return askForBatch(&q0,cat(xd,od),IKINCTRL_POSE_FULL,xdhat,odhat,qdhat,res);
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::askForPositions(const Matrix &xd, Matrix &xdhat,
+                                                Matrix &odhat, Matrix &qdhat, Matrix &res)
+{
+    return askForBatch(NULL,xd,IKINCTRL_POSE_XYZ,xdhat,odhat,qdhat,res);
+}
+
+
+/************************************************************************/
+bool ServerCartesianController::askForPositions(const Vector &q0, const Matrix &xd,
+                                                Matrix &xdhat, Matrix &odhat, Matrix &qdhat,
+                                                Matrix &res)
+{
+    return askForBatch(&q0,xd,IKINCTRL_POSE_XYZ,xdhat,odhat,qdhat,res);
+}
+
+
 /************************************************************************/
 bool ServerCartesianController::getDOF(Vector &curDof)
 {
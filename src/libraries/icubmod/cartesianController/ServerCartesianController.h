@@ -265,6 +265,9 @@ protected:
     bool setTask2ndOptions(const yarp::os::Value &v);
     bool getSolverConvergenceOptions(yarp::os::Bottle &options);
     bool setSolverConvergenceOptions(const yarp::os::Bottle &options);
+    bool askForBatch(const yarp::sig::Vector *q0, const yarp::sig::Matrix &xd, const unsigned int pose,
+                     yarp::sig::Matrix &xdhat, yarp::sig::Matrix &odhat, yarp::sig::Matrix &qdhat,
+                     yarp::sig::Matrix &res);
 
 public:
     ServerCartesianController();
@@ -300,6 +303,15 @@ public:
                         yarp::sig::Vector &qdhat);
     bool askForPosition(const yarp::sig::Vector &q0, const yarp::sig::Vector &xd, yarp::sig::Vector &xdhat,
                         yarp::sig::Vector &odhat, yarp::sig::Vector &qdhat);
+    bool askForPoses(const yarp::sig::Matrix &xd, const yarp::sig::Matrix &od, yarp::sig::Matrix &xdhat,
+                     yarp::sig::Matrix &odhat, yarp::sig::Matrix &qdhat, yarp::sig::Matrix &res);
+    bool askForPoses(const yarp::sig::Vector &q0, const yarp::sig::Matrix &xd, const yarp::sig::Matrix &od,
+                     yarp::sig::Matrix &xdhat, yarp::sig::Matrix &odhat, yarp::sig::Matrix &qdhat,
+                     yarp::sig::Matrix &res);
+    bool askForPositions(const yarp::sig::Matrix &xd, yarp::sig::Matrix &xdhat, yarp::sig::Matrix &odhat,
+                         yarp::sig::Matrix &qdhat, yarp::sig::Matrix &res);
+    bool askForPositions(const yarp::sig::Vector &q0, const yarp::sig::Matrix &xd, yarp::sig::Matrix &xdhat,
+                         yarp::sig::Matrix &odhat, yarp::sig::Matrix &qdhat, yarp::sig::Matrix &res);
     bool getDOF(yarp::sig::Vector &curDof);
     bool setDOF(const yarp::sig::Vector &newDof, yarp::sig::Vector &curDof);
     bool getRestPos(yarp::sig::Vector &curRestPos);
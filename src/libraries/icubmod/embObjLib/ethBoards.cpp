@@ -33,7 +33,7 @@
 // --------------------------------------------------------------------------------------------------------------------
 
 
-//#include <yarp/os/SystemClock.h>
+#include <yarp/os/SystemClock.h>
 //#include <yarp/os/Log.h>
 //#include <yarp/os/LogStream.h>
 //using yarp::os::Log;
@@ -72,6 +72,7 @@ const string eth::EthBoards::errorname[1] =
 eth::EthBoards::EthBoards()
 {
     memset(LUT, 0, sizeof(LUT));
+    memset(stats, 0, sizeof(stats));
     sizeofLUT = 0;
 }
 
@@ -133,11 +134,15 @@ bool eth::EthBoards::add(eth::AbstractEthResource* res)
         return false;
     }
 
+    std::lock_guard<std::mutex> lcktx(txLocks[index]);
+    std::lock_guard<std::mutex> lckrx(rxLocks[index]);
+
     if(NULL != LUT[index].resource)
     {
         return false;
     }
 
+    memset(&stats[index], 0, sizeof(stats[index]));
     LUT[index].resource = res;
     LUT[index].ipv4 = ipv4;
     LUT[index].boardnumber = index;
@@ -178,6 +183,9 @@ bool eth::EthBoards::add(eth::AbstractEthResource* res, eth::IethResource* inter
         return false;
     }
 
+    std::lock_guard<std::mutex> lcktx(txLocks[index]);
+    std::lock_guard<std::mutex> lckrx(rxLocks[index]);
+
     if(res != LUT[index].resource)
     {
         return false;
@@ -214,6 +222,9 @@ bool eth::EthBoards::rem(eth::AbstractEthResource* res)
         return false;
     }
 
+    std::lock_guard<std::mutex> lcktx(txLocks[index]);
+    std::lock_guard<std::mutex> lckrx(rxLocks[index]);
+
     if(res != LUT[index].resource)
     {
         return false;
@@ -252,6 +263,9 @@ bool eth::EthBoards::rem(eth::AbstractEthResource* res, iethresType_t type)
         return false;
     }
 
+    std::lock_guard<std::mutex> lcktx(txLocks[index]);
+    std::lock_guard<std::mutex> lckrx(rxLocks[index]);
+
     if(res != LUT[index].resource)
     {
         return false;
@@ -300,6 +314,15 @@ bool eth::EthBoards::get_LUTindex(eOipv4addr_t ipv4, uint8_t &index)
     return true;
 }
 
+bool eth::EthBoards::get_index(eOipv4addr_t ipv4, uint8_t &index)
+{
+    index = 0;
+    eo_common_ipv4addr_to_decimal(ipv4, NULL, NULL, NULL, &index);
+    index --;
+
+    return (index<maxEthBoards);
+}
+
 eth::IethResource* eth::EthBoards::get_interface(eOipv4addr_t ipv4, iethresType_t type)
 {
     eth::IethResource *dev = NULL;
@@ -417,44 +440,109 @@ const string & eth::EthBoards::name(eOipv4addr_t ipv4)
 
 
 
-bool eth::EthBoards::execute(void (*action)(eth::AbstractEthResource* res, void* p), void* par)
+void eth::EthBoards::lock(uint8_t index, lockType_t type, bool on)
 {
-    if(NULL == action)
+    // the tx lock is always taken before the rx lock, as in add() and rem()
+    if(on)
     {
-        return(false);
+        if(type & lockTX) txLocks[index].lock();
+        if(type & lockRX) rxLocks[index].lock();
     }
+    else
+    {
+        if(type & lockRX) rxLocks[index].unlock();
+        if(type & lockTX) txLocks[index].unlock();
+    }
+}
 
-    for(int i=0; i<maxEthBoards; i++)
+
+bool eth::EthBoards::run(uint8_t index, void (*action)(eth::AbstractEthResource* res, void* p), void* par, lockType_t type)
+{
+    lock(index, type, true);
+
+    eth::AbstractEthResource* res = LUT[index].resource;
+    if(NULL != res)
     {
-        eth::AbstractEthResource* res = LUT[i].resource;
-        if(NULL != res)
+        if((lockTX == type) || (lockRX == type))
+        {
+            double t0 = yarp::os::SystemClock::nowSystem();
+            action(res, par);
+            double dt = yarp::os::SystemClock::nowSystem() - t0;
+
+            // the statistics of rx (tx) are protected by the rx (tx) lock that we hold
+            Statistics &s = stats[index];
+            if(lockRX == type)
+            {
+                s.rxnumberof++;
+                s.rxtime += dt;
+                s.rxmaxtime = (dt > s.rxmaxtime) ? dt : s.rxmaxtime;
+            }
+            else
+            {
+                s.txnumberof++;
+                s.txtime += dt;
+                s.txmaxtime = (dt > s.txmaxtime) ? dt : s.txmaxtime;
+            }
+        }
+        else
         {
             action(res, par);
         }
+    }
+
+    lock(index, type, false);
+
+    return(NULL != res);
+}
 
+
+bool eth::EthBoards::execute(void (*action)(eth::AbstractEthResource* res, void* p), void* par, lockType_t lock)
+{
+    if(NULL == action)
+    {
+        return(false);
+    }
+
+    for(int i=0; i<maxEthBoards; i++)
+    {
+        run(i, action, par, lock);
     }
 
     return(true);
 }
 
 
-bool eth::EthBoards::execute(eOipv4addr_t ipv4, void (*action)(eth::AbstractEthResource* res, void* p), void* par)
+bool eth::EthBoards::execute(eOipv4addr_t ipv4, void (*action)(eth::AbstractEthResource* res, void* p), void* par, lockType_t lock)
 {
     if(NULL == action)
     {
         return(false);
     }
 
-    eth::AbstractEthResource* res = get_resource(ipv4);
+    uint8_t index = 0;
+    if(!get_index(ipv4, index))
+    {
+        return(false);
+    }
 
-    if(NULL == res)
+    return(run(index, action, par, lock));
+}
+
+
+bool eth::EthBoards::statistics(eOipv4addr_t ipv4, Statistics &s)
+{
+    uint8_t index = 0;
+    if(!get_index(ipv4, index))
     {
         return(false);
     }
 
-    action(res, par);
+    lock(index, lockTXRX, true);
+    bool ret = (NULL != LUT[index].resource);
+    s = stats[index];
+    lock(index, lockTXRX, false);
 
-    return(true);
+    return(ret);
 }
 
 
@@ -28,14 +28,18 @@
 #include "EoProtocol.h"
 #include <abstractEthResource.h>
 
+#include <atomic>
+#include <mutex>
+
 namespace eth {
 
     // -- class EthBoards
     // -- it collects all the ETH boards managed by ethManager.
     // -- each board surely has an EthResource object associated to it. and it may have one or more interfaces which use the
     // -- services of EthResource to transmit or receive.
-    // -- it is responsibility of the object which owns EthBoards (it is ethManager) to protect the class EthBoards vs concurrent use.
-    // -- examples of concurrent use are: transmit or receive using an ethresource and ... attempting to create or destroy a resource.
+    // -- every board has its own tx and rx locks, which are held while an action is executed on it and while its resource or
+    // -- its interfaces are added or removed. in this way the transmission or the reception of a board does not block the others.
+    // -- it is responsibility of the object which owns EthBoards (it is ethManager) to serialize the adding and removing of boards.
 
     typedef struct
     {
@@ -50,6 +54,20 @@ namespace eth {
 
         enum { maxEthBoards = 32 };
 
+        // the locks that execute() holds on each board
+        typedef enum { lockNone = 0, lockTX = 1, lockRX = 2, lockTXRX = 3 } lockType_t;
+
+        // the time spent by the actions executed with lockTX / lockRX on a board
+        typedef struct
+        {
+            uint64_t    rxnumberof;     // number of actions executed with lockRX (i.e., received packets)
+            double      rxtime;         // total time in [sec]
+            double      rxmaxtime;      // max time in [sec]
+            uint64_t    txnumberof;     // number of actions executed with lockTX
+            double      txtime;
+            double      txmaxtime;
+        } Statistics;
+
     public:
 
         EthBoards();
@@ -70,11 +88,14 @@ namespace eth {
         // the name of the board
         const string & name(eOipv4addr_t ipv4);
 
-        // executes an action on all EthResource which have been added in the class.
-        bool execute(void (*action)(eth::AbstractEthResource* res, void* p), void* par);
+        // executes an action on all EthResource which have been added in the class. each board is locked only while the action is executed on it.
+        bool execute(void (*action)(eth::AbstractEthResource* res, void* p), void* par, lockType_t lock = lockNone);
+
+        // executes an action on the ethResource having a specific ipv4, with the board locked.
+        bool execute(eOipv4addr_t ipv4, void (*action)(eth::AbstractEthResource* res, void* p), void* par, lockType_t lock = lockNone);
 
-        // executes an action on the ethResource having a specific ipv4.
-        bool execute(eOipv4addr_t ipv4, void (*action)(eth::AbstractEthResource* res, void* p), void* par);
+        // retrieves the processing-time statistics of a board
+        bool statistics(eOipv4addr_t ipv4, Statistics &stats);
 
 
     private:
@@ -99,13 +120,20 @@ namespace eth {
         static const string defaultnames[EthBoards::maxEthBoards];
         static const string errorname[1];
 
-        int sizeofLUT;
+        std::atomic<int> sizeofLUT;
         ethboardProperties_t LUT[EthBoards::maxEthBoards];
 
+        std::mutex txLocks[EthBoards::maxEthBoards];
+        std::mutex rxLocks[EthBoards::maxEthBoards];
+        Statistics stats[EthBoards::maxEthBoards];
+
     private:
 
         // private functions
         bool get_LUTindex(eOipv4addr_t ipv4, uint8_t &index);
+        bool get_index(eOipv4addr_t ipv4, uint8_t &index);
+        void lock(uint8_t index, lockType_t type, bool on);
+        bool run(uint8_t index, void (*action)(eth::AbstractEthResource* res, void* p), void* par, lockType_t lock);
     };
 
 } // namespace eth
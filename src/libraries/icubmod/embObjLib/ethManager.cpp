@@ -81,8 +81,8 @@ using namespace eth;
 // marco.accame: std::mutex is in unlocked state after the constructor completes
 //               that is the same behaviour of the former yarp::os::Semaphore initted w/ value 1
 std::mutex TheEthManager::managerSem {}; 
-std::mutex TheEthManager::txSem {};
-std::mutex TheEthManager::rxSem {};
+std::mutex TheEthManager::boardsSem {};
+std::mutex TheEthManager::transmissionSem {};
 
 TheEthManager* TheEthManager::handle {nullptr};
 
@@ -145,7 +145,7 @@ TheEthManager::~TheEthManager()
 
     lock(true);
 
-    // remove all ethresource ... we dont need to call lockTXRX() because we are not transmitting now
+    // remove all ethresource ... we dont need to call lockBoards() because we are not transmitting now
     ethBoards->execute(delete_resources, NULL);
     delete ethBoards;
 
@@ -220,7 +220,7 @@ void ethEvalTXropframe(eth::AbstractEthResource *r, void* p)
         return;
     }
 
-    TheEthManager *ethman = reinterpret_cast<TheEthManager*>(p);
+    eth::EthSender *sender = reinterpret_cast<eth::EthSender*>(p);
 
 #if 0
     uint16_t numofbytes = 0;
@@ -232,7 +232,7 @@ void ethEvalTXropframe(eth::AbstractEthResource *r, void* p)
     {
         eOipv4addressing_t ipv4addressing;
         r->getIPv4addressing(ipv4addressing);
-        ethman->sendPacket(data2send, static_cast<size_t>(numofbytes), ipv4addressing);
+        sender->add(data2send, static_cast<size_t>(numofbytes), ipv4addressing);
     }
 #else
 
@@ -242,8 +242,8 @@ void ethEvalTXropframe(eth::AbstractEthResource *r, void* p)
     const void * data2send = r->getUDPtransmit(ipv4addressing, numofbytes, numofrops);
 
     if(nullptr != data2send)
-    {
-        ethman->sendPacket(data2send, numofbytes, ipv4addressing);
+    {   // the sender either transmits the ropframe now or keeps a pointer to it until the end of the tick
+        sender->add(data2send, numofbytes, ipv4addressing);
     }
 
 #endif
@@ -252,11 +252,12 @@ void ethEvalTXropframe(eth::AbstractEthResource *r, void* p)
 
 bool TheEthManager::Transmission(void)
 {
-    lockTX(true);
-
-    ethBoards->execute(ethEvalTXropframe, this);
+    // the ropframes queued by the sender stay inside the transceivers of their boards until transmit(), thus no resource
+    // can be deleted in the meantime. every board is instead locked only while its ropframe is formed.
+    std::lock_guard<std::mutex> lck(transmissionSem);
 
-    lockTX(false);
+    ethBoards->execute(ethEvalTXropframe, sender, eth::EthBoards::lockTX);
+    sender->transmit();
 
     return true;
 }
@@ -274,7 +275,8 @@ void ethEvalPresence(eth::AbstractEthResource *r, void* p)
 
 bool TheEthManager::CheckPresence(void)
 {
-    ethBoards->execute(ethEvalPresence, this);
+    // the board is locked so that its resource cannot be removed meanwhile. the check is not accounted in its tx / rx statistics
+    ethBoards->execute(ethEvalPresence, this, eth::EthBoards::lockTXRX);
     return true;
 }
 
@@ -355,9 +357,10 @@ eth::AbstractEthResource *TheEthManager::requestResource2(IethResource *interfac
 
     eOipv4addr_t ipv4addr = bdata.properties.ipv4addressing.addr;
 
-    // i want to lock the use of resources managed by ethBoards to avoid that we attempt to use for TX a ethres not completely initted
+    // i want to serialize the changes of ethBoards. the resource is added to ethBoards (under the tx and rx locks of its board)
+    // only after it is completely initted, so that tx and rx of the other boards can go on meanwhile.
 
-    lockTXRX(true);
+    lockBoards(true);
 
     // i do an attempt to get the resource.
     eth::AbstractEthResource *rr = ethBoards->get_resource(ipv4addr);
@@ -389,6 +392,7 @@ eth::AbstractEthResource *TheEthManager::requestResource2(IethResource *interfac
             }
 
             rr = NULL;
+            lockBoards(false);
             return NULL;
         }
 
@@ -399,7 +403,7 @@ eth::AbstractEthResource *TheEthManager::requestResource2(IethResource *interfac
     ethBoards->add(rr, interface);
 
 
-    lockTXRX(false);
+    lockBoards(false);
 
     return(rr);
 }
@@ -482,18 +486,21 @@ int TheEthManager::releaseResource2(eth::AbstractEthResource* ethresource, IethR
     // the ropframe sent now do not contain any regular for the interface anymore, thus we can just removing the interface in list of those assciated
     // to the resource, without any harm. only thing is: protect ethBoards with a mutex.
 
-    // now we change internal data structure of ethBoards, thus .. must disable tx and rx
-    lockTXRX(true);
+    // now we change internal data structure of ethBoards, thus .. must disable tx and rx of this board. ethBoards does it for us.
+    lockBoards(true);
 
     // remove the interface
     ethBoards->rem(rr, type);
 
     int remaining = ethBoards->number_of_interfaces(rr);
     if(0 == remaining)
-    {   // remove also the resource
-        rr->close();
+    {   // remove also the resource. after rem() neither tx nor rx can use it anymore, thus we can delete it
+        // as soon as the sender has transmitted the ropframes it may still hold
         ethBoards->rem(rr);
+        transmissionSem.lock();
+        rr->close();
         delete rr;
+        transmissionSem.unlock();
     }
 
     if(0 == ethBoards->number_of_resources())
@@ -501,7 +508,7 @@ int TheEthManager::releaseResource2(eth::AbstractEthResource* ethresource, IethR
         ret = -1;
     }
 
-    lockTXRX(false);
+    lockBoards(false);
 
 
     return(ret);
@@ -661,32 +668,75 @@ ACE_INET_Addr TheEthManager::toaceinet(const eOipv4addressing_t &ipv4addressing)
 }
 
 
-bool TheEthManager::Reception(eOipv4addr_t from, uint64_t* data, ssize_t size)
+typedef struct
 {
-    lockRX(true);
+    uint64_t*   data;
+    ssize_t     size;
+} ethRXpacket_t;
+
 
-    eth::AbstractEthResource* r = ethBoards->get_resource(from);
+void ethProcessRXpacket(eth::AbstractEthResource *r, void* p)
+{
+    ethRXpacket_t *pkt = reinterpret_cast<ethRXpacket_t*>(p);
 
-    if((size >=0) && (NULL != r) && (!r->isFake()))
+    if((NULL == r) || (NULL == pkt) || (pkt->size < 0) || (r->isFake()))
     {
-        r->Tick();
+        return;
+    }
 
-        if(false == r->processRXpacket(data, size))
-        {   // cannot give packet to ethresource
-            yError() << "TheEthManager::Reception() cannot give a received packet of size" << size << "to EthResource because EthResource::processRXpacket() returns false.";
-        }
+    r->Tick();
 
+    if(false == r->processRXpacket(pkt->data, pkt->size))
+    {   // cannot give packet to ethresource
+        yError() << "TheEthManager::Reception() cannot give a received packet of size" << pkt->size << "to EthResource because EthResource::processRXpacket() returns false.";
     }
-    else
+}
+
+
+bool TheEthManager::Reception(eOipv4addr_t from, uint64_t* data, ssize_t size)
+{
+    // only the board which has sent the packet is locked, thus packets of different boards can be parsed in parallel
+    ethRXpacket_t pkt = { data, size };
+    ethBoards->execute(from, ethProcessRXpacket, &pkt, eth::EthBoards::lockRX);
+
+    return(true);
+}
+
+
+
+bool TheEthManager::getBoardStatistics(eOipv4addr_t ipv4, eth::EthBoards::Statistics &stats)
+{
+    return ethBoards->statistics(ipv4, stats);
+}
+
+
+
+bool TheEthManager::getReceptionStatistics(eth::EthReceiver::Statistics &stats)
+{
+    lock(true);
+    bool ret = communicationIsInitted && (NULL != receiver);
+    if(ret)
     {
-    //    adr.addr_to_string(address, sizeof(address));
-    //    yError() << "TheEthManager::Reception cannot get a ethres associated to address" << address;
+        receiver->getStatistics(stats);
     }
+    lock(false);
+
+    return ret;
+}
 
-    lockRX(false);
 
 
-    return(true);
+bool TheEthManager::getTransmissionStatistics(eth::EthSender::Statistics &stats)
+{
+    lock(true);
+    bool ret = communicationIsInitted && (NULL != sender);
+    if(ret)
+    {
+        sender->getStatistics(stats);
+    }
+    lock(false);
+
+    return ret;
 }
 
 
@@ -724,46 +774,15 @@ bool TheEthManager::lock(bool on)
 }
 
 
-bool TheEthManager::lockTX(bool on)
-{
-    if(on)
-    {
-        txSem.lock();
-    }
-    else
-    {
-        txSem.unlock();
-    }
-
-    return true;
-}
-
-
-bool TheEthManager::lockRX(bool on)
-{
-    if(on)
-    {
-        rxSem.lock();
-    }
-    else
-    {
-        rxSem.unlock();
-    }
-
-    return true;
-}
-
-bool TheEthManager::lockTXRX(bool on)
+bool TheEthManager::lockBoards(bool on)
 {
     if(on)
     {
-        txSem.lock();
-        rxSem.lock();
+        boardsSem.lock();
     }
     else
     {
-        rxSem.unlock();
-        txSem.unlock();
+        boardsSem.unlock();
     }
 
     return true;
@@ -89,7 +89,7 @@ namespace eth {
 
         enum { maxRXpacketsize = 1496, maxTXpacketsize = 1496 };
 
-        // these are the boards, their use is protected by txSem or rxSem or both of them.
+        // these are the boards, their tx and rx are protected board by board by ethBoards itself. changes are serialized by boardsSem.
         eth::EthBoards* ethBoards;
 
     private:
@@ -125,6 +125,15 @@ namespace eth {
 
         bool Reception(eOipv4addr_t from, uint64_t* data, ssize_t size);
 
+        // it gives the statistics of the reception thread. it returns false if the communication is not initted.
+        bool getReceptionStatistics(eth::EthReceiver::Statistics &stats);
+
+        // it gives the statistics of the transmission thread. it returns false if the communication is not initted.
+        bool getTransmissionStatistics(eth::EthSender::Statistics &stats);
+
+        // it gives the time spent in processing the rx packets and in forming the tx packets of a board. it returns false if the board is not managed.
+        bool getBoardStatistics(eOipv4addr_t ipv4, eth::EthBoards::Statistics &stats);
+
         eth::AbstractEthResource* getEthResource(eOipv4addr_t ipv4);
 
         IethResource* getInterface(eOipv4addr_t ipv4, eOprotID32_t id32);
@@ -152,9 +161,7 @@ namespace eth {
 
         bool lock(bool on);
 
-        bool lockTX(bool on);
-        bool lockRX(bool on);
-        bool lockTXRX(bool on);
+        bool lockBoards(bool on);
 
 
     private:
@@ -163,9 +170,10 @@ namespace eth {
 
         // this semaphore is used to ....
         static std::mutex managerSem;
-        // the following two semaphore are used separately or together to stop tx and rx if a change is done on ethboards (in startup and shutdown phases)
-        static std::mutex txSem;
-        static std::mutex rxSem;
+        // this semaphore serializes the changes done on ethboards (in startup and shutdown phases). tx and rx are stopped board by board by ethboards.
+        static std::mutex boardsSem;
+        // this semaphore keeps the resources alive while the sender holds pointers to the ropframes of their transceivers
+        static std::mutex transmissionSem;
 
         static eth::TheEthManager* handle;
 
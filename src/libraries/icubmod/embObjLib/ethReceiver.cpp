@@ -44,6 +44,20 @@ using yarp::os::Log;
 #include "ethManager.h"
 #include "ethResource.h"
 
+#include <algorithm>
+#include <cstring>
+
+#if defined(ETHRECEIVER_USE_RECVMMSG)
+#include <time.h>
+#include <arpa/inet.h>
+#endif
+
+#if defined(ETHRECEIVER_USE_EPOLL)
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+
 
 // --------------------------------------------------------------------------------------------------------------------
 // - pimpl: private implementation (see scott meyers: item 22 of effective modern c++, item 31 of effective c++
@@ -56,46 +70,205 @@ using yarp::os::Log;
 // --------------------------------------------------------------------------------------------------------------------
 
 
-// - class eth::EthReceiver
-
 using namespace eth;
 
 
+// - class eth::EthReceptionWorker
+
+static_assert(static_cast<int>(EthReceptionWorker::maxPacketSize) == static_cast<int>(TheEthManager::maxRXpacketsize), "EthReceptionWorker must hold the biggest packet");
+static_assert(0 == (EthReceptionWorker::ringSize & (EthReceptionWorker::ringSize-1)), "the ring size must be a power of two");
+
+EthReceptionWorker::EthReceptionWorker(TheEthManager* _ethManager) : ethManager(_ethManager), ring(ringSize)
+{
+    head = 0;
+    tail = 0;
+    sleeping = false;
+    stopping = false;
+}
+
+EthReceptionWorker::~EthReceptionWorker()
+{
+    stop();
+}
+
+bool EthReceptionWorker::start()
+{
+    stopping = false;
+    thread = std::thread(&EthReceptionWorker::loop, this);
+    return true;
+}
+
+void EthReceptionWorker::stop()
+{
+    if(!thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        stopping = true;
+    }
+    cv.notify_one();
+    thread.join();
+}
+
+bool EthReceptionWorker::push(eOipv4addr_t from, const uint64_t* data, ssize_t size)
+{
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    bool waited = false;
+
+    // if the ring is full we wait for the worker: the packets in excess stay queued in the socket as when we parse them ourselves
+    while((h - tail.load(std::memory_order_acquire)) >= ringSize)
+    {
+        waited = true;
+        std::this_thread::yield();
+    }
+
+    packet_t &pkt = ring[h & (ringSize-1)];
+    pkt.from = from;
+    pkt.size = (size > maxPacketSize) ? maxPacketSize : size;
+    if(pkt.size > 0)
+    {
+        memcpy(pkt.data, data, pkt.size);
+    }
+
+    // the store of head must be visible before we read sleeping (and vice-versa in loop()), hence seq_cst on both sides
+    head.store(h+1, std::memory_order_seq_cst);
+
+    if(sleeping.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        cv.notify_one();
+    }
+
+    return !waited;
+}
+
+void EthReceptionWorker::loop()
+{
+#if defined(__unix__)
+    // the same priority of the receiver thread
+    struct sched_param thread_param;
+    thread_param.sched_priority = sched_get_priority_max(SCHED_FIFO)/2;
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &thread_param);
+#endif
+
+    // before sleeping we keep on looking at the ring for a while, as the packets of the boards come in bursts
+    const int maxspins = 64;
+    int spins = 0;
+
+    for(;;)
+    {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        if(t != head.load(std::memory_order_acquire))
+        {
+            packet_t &pkt = ring[t & (ringSize-1)];
+            ethManager->Reception(pkt.from, pkt.data, pkt.size);
+            tail.store(t+1, std::memory_order_release);
+            spins = 0;
+            continue;
+        }
+
+        if(stopping)
+        {
+            break;
+        }
+
+        if(++spins < maxspins)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lck(mtx);
+        sleeping.store(true, std::memory_order_seq_cst);
+        if((t == head.load(std::memory_order_seq_cst)) && !stopping)
+        {
+            cv.wait_for(lck, std::chrono::milliseconds(100));
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+        spins = 0;
+    }
+}
+
+
+// - class eth::EthReceiver
+
+
 
 EthReceiver::EthReceiver(int raterx): PeriodicThread((double)raterx/1000.0)
 {
     rateofthread = raterx;
+    recv_socket = NULL;
+    ethManager = NULL;
     yDebug() << "EthReceiver is a PeriodicThread with rxrate =" << rateofthread << "ms";
     // ok, and now i get it from xml file ... if i find it.
 
-//    std::string tmp = NetworkBase::getEnvironment("ETHSTAT_PRINT_INTERVAL");
-//    if (tmp != "")
-//    {
-//        statPrintInterval = (double)NetType::toInt(tmp);
-//    }
-//    else
-//    {
-//        statPrintInterval = 0.0;
-//    }
+    // the user can have the statistics of reception printed every ETHSTAT_PRINT_INTERVAL seconds
+    std::string tmp = yarp::conf::environment::getEnvironment("ETHSTAT_PRINT_INTERVAL");
+    if (tmp != "")
+    {
+        statPrintInterval = (double)NetType::toInt(tmp);
+    }
+    else
+    {
+        statPrintInterval = 0.0;
+    }
+    statPrintTime = 0.0;
+
+    memset(&stats, 0, sizeof(stats));
+    numofdelays = 0;
+
+#if defined(ETHRECEIVER_USE_RECVMMSG)
+    // the user can go back to one recv() per packet with ETHRECEIVER_RECVMMSG=0 and can ask for kernel timestamps with ETHRECEIVER_TIMESTAMPS=1
+    tmp = yarp::conf::environment::getEnvironment("ETHRECEIVER_RECVMMSG");
+    useBatch = (tmp != "") ? (0 != NetType::toInt(tmp)) : true;
+    tmp = yarp::conf::environment::getEnvironment("ETHRECEIVER_TIMESTAMPS");
+    useTimestamps = (tmp != "") ? (0 != NetType::toInt(tmp)) : false;
+#endif
+
+#if defined(ETHRECEIVER_USE_EPOLL)
+    // the user can have the packets processed as soon as they arrive with ETHRECEIVER_MODE=event
+    tmp = yarp::conf::environment::getEnvironment("ETHRECEIVER_MODE");
+    eventDriven = (tmp == "event");
+    stopping = false;
+    epollfd = -1;
+    timerfd = -1;
+#endif
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
     /* We would like to verify if the receiver thread is ticked(running) every 5 millisecond, with a tollerance of 0.05 millisec.
        the m_perEvtVerifier object after 1 second, prints an istogram with values from 4 to 6 millisec with a step of 0.1 millisec
      */
     //m_perEvtVerifier.init(0.005, 0.00005, 0.004, 0.006, 0.0001, 1);
-    m_perEvtVerifier.init(raterx, (raterx/100), raterx-0.001, raterx+0.001, 0.0001, 1);
+    m_perEvtVerifier.init((double)raterx/1000.0, (double)raterx/100000.0, (double)raterx/1000.0-0.001, (double)raterx/1000.0+0.001, 0.0001, 1, "RX");
 #endif
 }
 
 void EthReceiver::onStop()
 {
-    // in here i send a small packet to ... myself ?
+#if defined(ETHRECEIVER_USE_EPOLL)
+    stopping = true;
+#endif
+    // in here i send a small packet to ... myself ? yes: it wakes up the thread if it is waiting for packets
     uint8_t tmp = 0;
     ethManager->sendPacket( &tmp, 1, ethManager->getLocalIPV4addressing());
 }
 
 EthReceiver::~EthReceiver()
 {
+    threadRelease();
 
+#if defined(ETHRECEIVER_USE_EPOLL)
+    if(epollfd >= 0)
+    {
+        close(epollfd);
+    }
+    if(timerfd >= 0)
+    {
+        close(timerfd);
+    }
+#endif
 }
 
 bool EthReceiver::config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager)
@@ -132,10 +305,314 @@ bool EthReceiver::config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager)
 
     yWarning() << "in EthReceiver::config() the config socket has queue size = "<< sock_input_buf_size<< "; you request ETHRECEIVER_BUFFER_SIZE=" << _dgram_buffer_size;
 
+#if defined(ETHRECEIVER_USE_RECVMMSG)
+    if(useBatch)
+    {
+        useBatch = configBatch(sockfd);
+    }
+#endif
+
+#if defined(ETHRECEIVER_USE_EPOLL)
+    if(eventDriven)
+    {
+        eventDriven = configEvents(sockfd);
+    }
+#endif
+
+    // the user can have the packets parsed by a number of worker threads with ETHRECEIVER_PARSERS
+    std::string _parsers = yarp::conf::environment::getEnvironment("ETHRECEIVER_PARSERS");
+    int numofparsers = (_parsers != "") ? NetType::toInt(_parsers) : 0;
+    for(int i=0; i<numofparsers; i++)
+    {
+        EthReceptionWorker *w = new EthReceptionWorker(ethManager);
+        w->start();
+        workers.push_back(w);
+    }
+    if(numofparsers > 0)
+    {
+        yDebug() << "EthReceiver::config() parses the packets with" << numofparsers << "worker threads";
+    }
+
     return true;
 }
 
 
+#if defined(ETHRECEIVER_USE_EPOLL)
+
+bool EthReceiver::configEvents(ACE_HANDLE sockfd)
+{
+    epollfd = epoll_create1(EPOLL_CLOEXEC);
+    timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if((epollfd < 0) || (timerfd < 0))
+    {
+        yError() << "EthReceiver::config() cannot create epoll / timerfd: the thread stays periodic";
+        return false;
+    }
+
+    // the timer replaces the period of the thread for the check on presence
+    struct itimerspec period;
+    period.it_interval.tv_sec = rateofthread / 1000;
+    period.it_interval.tv_nsec = (rateofthread % 1000) * 1000000;
+    period.it_value = period.it_interval;
+
+    struct epoll_event evsock;
+    evsock.events = EPOLLIN;
+    evsock.data.fd = sockfd;
+
+    struct epoll_event evtimer;
+    evtimer.events = EPOLLIN;
+    evtimer.data.fd = timerfd;
+
+    if((0 != timerfd_settime(timerfd, 0, &period, NULL)) ||
+       (0 != epoll_ctl(epollfd, EPOLL_CTL_ADD, sockfd, &evsock)) ||
+       (0 != epoll_ctl(epollfd, EPOLL_CTL_ADD, timerfd, &evtimer)))
+    {
+        yError() << "EthReceiver::config() cannot configure epoll / timerfd: the thread stays periodic";
+        return false;
+    }
+
+    yDebug() << "EthReceiver::config() waits for packets on epoll and checks the presence of the boards every" << rateofthread << "ms";
+
+    return true;
+}
+
+
+void EthReceiver::runEvents()
+{
+    // we take at most this number of packets per wake up, so that the timer is served also under heavy load.
+    // epoll is level-triggered, thus the packets left in the socket wake us up again straight away.
+    const int maxUDPpackets = 2 + ethManager->getNumberOfResources();
+    // a safety timeout, so that we notice a stop request even if the wake up packet is lost
+    const int timeout = 100;
+
+    struct epoll_event events[2];
+
+    while(!stopping)
+    {
+        int n = epoll_wait(epollfd, events, 2, timeout);
+
+        for(int i=0; (i<n) && !stopping; i++)
+        {
+            if(timerfd == events[i].data.fd)
+            {
+                uint64_t expirations = 0;
+                if(sizeof(expirations) == read(timerfd, &expirations, sizeof(expirations)))
+                {
+                    ethManager->CheckPresence();
+                    printStatistics();
+                }
+            }
+            else
+            {
+#if defined(ETHRECEIVER_USE_RECVMMSG)
+                if(useBatch)
+                {
+                    receiveBatch(maxUDPpackets);
+                }
+                else
+#endif
+                {
+                    receiveSingle(maxUDPpackets);
+                }
+            }
+        }
+    }
+}
+
+#endif
+
+
+#if defined(ETHRECEIVER_USE_RECVMMSG)
+
+bool EthReceiver::configBatch(ACE_HANDLE sockfd)
+{
+    const size_t stride = TheEthManager::maxRXpacketsize/8;
+    const size_t controlstride = rxControlSize/8;
+
+    rxBuffers.assign(rxBatchSize*stride, 0);
+    rxMsgs.resize(rxBatchSize);
+    rxIovecs.resize(rxBatchSize);
+    rxAddrs.resize(rxBatchSize);
+    rxControls.assign(rxBatchSize*controlstride, 0);
+
+    for(int i=0; i<rxBatchSize; i++)
+    {
+        rxIovecs[i].iov_base = &rxBuffers[i*stride];
+        rxIovecs[i].iov_len = TheEthManager::maxRXpacketsize;
+
+        memset(&rxMsgs[i], 0, sizeof(rxMsgs[i]));
+        rxMsgs[i].msg_hdr.msg_name = &rxAddrs[i];
+        rxMsgs[i].msg_hdr.msg_namelen = sizeof(rxAddrs[i]);
+        rxMsgs[i].msg_hdr.msg_iov = &rxIovecs[i];
+        rxMsgs[i].msg_hdr.msg_iovlen = 1;
+        rxMsgs[i].msg_hdr.msg_control = &rxControls[i*controlstride];
+        rxMsgs[i].msg_hdr.msg_controllen = rxControlSize;
+    }
+
+    // the kernel tells in every packet how many packets it has dropped so far on this socket
+    int on = 1;
+    if(0 != setsockopt(sockfd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)))
+    {
+        yWarning() << "EthReceiver::config() cannot enable SO_RXQ_OVFL: the drops of the kernel will not be counted";
+    }
+
+    if(useTimestamps && (0 != setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on))))
+    {
+        yWarning() << "EthReceiver::config() cannot enable SO_TIMESTAMPNS: the kernel timestamps will not be used";
+        useTimestamps = false;
+    }
+
+    yDebug() << "EthReceiver::config() drains the socket with recvmmsg() in batches of" << rxBatchSize << "packets" << (useTimestamps ? "with" : "without") << "kernel timestamps";
+
+    return true;
+}
+
+
+bool EthReceiver::receiveBatch(int maxUDPpackets)
+{
+    const size_t stride = TheEthManager::maxRXpacketsize/8;
+    ACE_HANDLE sockfd = recv_socket->get_handle();
+    Statistics local;
+    memset(&local, 0, sizeof(local));
+    double sumofdelays = 0.0;
+    uint64_t numdelays = 0;
+    bool kerneldrops = false;
+    bool earlyexit = false;
+
+    int received = 0;
+    while(received < maxUDPpackets)
+    {
+        const unsigned int n = std::min(maxUDPpackets - received, static_cast<int>(rxBatchSize));
+
+        // recvmmsg() overwrites the lengths, hence we restore them before every call
+        for(unsigned int i=0; i<n; i++)
+        {
+            rxMsgs[i].msg_hdr.msg_namelen = sizeof(rxAddrs[i]);
+            rxMsgs[i].msg_hdr.msg_controllen = rxControlSize;
+            rxMsgs[i].msg_hdr.msg_flags = 0;
+        }
+
+        int r = recvmmsg(sockfd, &rxMsgs[0], n, MSG_DONTWAIT, NULL);
+        if(r <= 0)
+        {
+            earlyexit = true;
+            break;
+        }
+
+        local.syscalls++;
+        local.packets += r;
+        local.maxbatch = std::max(local.maxbatch, static_cast<uint32_t>(r));
+
+        for(int i=0; i<r; i++)
+        {
+            struct msghdr *hdr = &rxMsgs[i].msg_hdr;
+            struct timespec ts = {0, 0};
+            bool stamped = false;
+            for(struct cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); NULL != cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg))
+            {
+                if(SOL_SOCKET != cmsg->cmsg_level)
+                {
+                    continue;
+                }
+
+                if(SO_RXQ_OVFL == cmsg->cmsg_type)
+                {
+                    uint32_t drops = 0;
+                    memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+                    local.kerneldrops = drops;
+                    kerneldrops = true;
+                }
+                else if(SCM_TIMESTAMPNS == cmsg->cmsg_type)
+                {
+                    memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    stamped = true;
+                }
+            }
+
+            if(0 != (hdr->msg_flags & MSG_TRUNC))
+            {
+                local.truncated++;
+                continue;
+            }
+
+            uint32_t a32 = ntohl(rxAddrs[i].sin_addr.s_addr);
+            eOipv4addr_t from = eo_common_ipv4addr((a32 >> 24) & 0xff, (a32 >> 16) & 0xff, (a32 >> 8) & 0xff, a32 & 0xff);
+
+            dispatch(from, &rxBuffers[i*stride], rxMsgs[i].msg_len);
+
+            // when the packet is parsed here, its values are in the NVs as soon as dispatch() returns, hence this
+            // is the delay after which getLocalValue() sees them. with the parser workers it would be only the handoff
+            if(stamped && workers.empty())
+            {
+                struct timespec now = {0, 0};
+                clock_gettime(CLOCK_REALTIME, &now);
+                double delay = (double)(now.tv_sec - ts.tv_sec) + 1e-9*(double)(now.tv_nsec - ts.tv_nsec);
+                sumofdelays += delay;
+                numdelays++;
+                local.maxdelay = std::max(local.maxdelay, delay);
+            }
+        }
+
+        received += r;
+        if(r < static_cast<int>(n))
+        {   // the socket is drained: we dont need another call to know it
+            earlyexit = true;
+            break;
+        }
+    }
+
+    // we merge the statistics of this cycle
+    std::lock_guard<std::mutex> lck(statMutex);
+    stats.syscalls += local.syscalls;
+    stats.packets += local.packets;
+    stats.maxbatch = std::max(stats.maxbatch, local.maxbatch);
+    stats.truncated += local.truncated;
+    if(kerneldrops)
+    {
+        stats.kerneldrops = local.kerneldrops;
+    }
+    if(numdelays > 0)
+    {
+        stats.meandelay = (stats.meandelay*numofdelays + sumofdelays) / (numofdelays + numdelays);
+        numofdelays += numdelays;
+        stats.maxdelay = std::max(stats.maxdelay, local.maxdelay);
+    }
+
+    return earlyexit;
+}
+
+#endif
+
+
+void EthReceiver::getStatistics(Statistics &statistics)
+{
+    std::lock_guard<std::mutex> lck(statMutex);
+    statistics = stats;
+}
+
+
+void EthReceiver::printStatistics()
+{
+    if(statPrintInterval <= 0.0)
+    {
+        return;
+    }
+
+    double now = yarp::os::Time::now();
+    if(now - statPrintTime < statPrintInterval)
+    {
+        return;
+    }
+    statPrintTime = now;
+
+    Statistics s;
+    getStatistics(s);
+    double average = (s.syscalls > 0) ? (double)s.packets/(double)s.syscalls : 0.0;
+    yDebug() << "EthReceiver: received" << s.packets << "packets with" << s.syscalls << "system calls (" << average << "per call, max" << s.maxbatch << ")"
+             << s.truncated << "truncated," << s.kerneldrops << "dropped by the kernel," << s.workerwaits << "waited for a parser; delay from kernel timestamp to parsed NVs: mean" << 1e6*s.meandelay << "us, max" << 1e6*s.maxdelay << "us";
+}
+
+
 bool EthReceiver::threadInit()
 {
     yTrace() << "Do some initialization here if needed";
@@ -162,23 +639,90 @@ uint64_t getRopFrameAge(char *pck)
 
 
 
-void EthReceiver::run()
+void EthReceiver::dispatch(eOipv4addr_t from, uint64_t* data, ssize_t size)
+{
+    if(workers.empty())
+    {
+        ethManager->Reception(from, data, size);
+        return;
+    }
+
+    // the board is always given to the same worker, so that its packets are parsed in order
+    uint8_t ip4 = 0;
+    eo_common_ipv4addr_to_decimal(from, NULL, NULL, NULL, &ip4);
+    if(false == workers[ip4 % workers.size()]->push(from, data, size))
+    {
+        std::lock_guard<std::mutex> lck(statMutex);
+        stats.workerwaits++;
+    }
+}
+
+
+void EthReceiver::threadRelease()
+{
+    // the workers parse what they still have and then they stop
+    for(size_t i=0; i<workers.size(); i++)
+    {
+        delete workers[i];
+    }
+    workers.clear();
+}
+
+
+bool EthReceiver::receiveSingle(int maxUDPpackets)
 {
     ssize_t       incoming_msg_size = 0;
     ACE_INET_Addr sender_addr;
     uint64_t      incoming_msg_data[TheEthManager::maxRXpacketsize/8];   // 8-byte aligned local buffer for incoming packet: it must be able to accomodate max size of packet
     const ssize_t incoming_msg_capacity = TheEthManager::maxRXpacketsize;
 
-#ifdef NETWORK_PERFORMANCE_BENCHMARK
-    m_perEvtVerifier.tick(yarp::os::Time::now());
-#endif
-    
-    
     int flags = 0;
 #ifndef WIN32
     flags |= MSG_DONTWAIT;
 #endif
 
+    bool earlyexit = false;
+    int received = 0;
+    for(int i=0; i<maxUDPpackets; i++)
+    {
+        incoming_msg_size = recv_socket->recv((void *) incoming_msg_data, incoming_msg_capacity, sender_addr, flags);
+        if(incoming_msg_size <= 0)
+        { // marco.accame: i prefer using <= 0.
+            earlyexit = true; // yes, we have an early exit
+            break; // we break and do not return because we want to be sure to execute what is after the for() loop
+        }
+
+        // we have a packet ... we give it to the ethmanager for it parsing
+        received++;
+        dispatch(ethManager->toipv4addr(sender_addr), incoming_msg_data, incoming_msg_size);
+    }
+
+    if(received > 0)
+    {
+        std::lock_guard<std::mutex> lck(statMutex);
+        stats.syscalls += received;
+        stats.packets += received;
+        stats.maxbatch = 1;
+    }
+
+    return earlyexit;
+}
+
+
+void EthReceiver::run()
+{
+#if defined(ETHRECEIVER_USE_EPOLL)
+    if(eventDriven)
+    {   // it returns only when the thread is stopped
+        runEvents();
+        return;
+    }
+#endif
+
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+    m_perEvtVerifier.tick(yarp::os::Time::now());
+#endif
+
     static uint8_t earlyexit_prev = 0;
     static uint8_t earlyexit_prevprev = 0;
 
@@ -195,29 +739,24 @@ void EthReceiver::run()
     earlyexit_prevprev = earlyexit_prev;    // save previous early exit
     earlyexit_prev = 0;                     // consider no early exit this time
 
-    for(int i=0; i<maxUDPpackets; i++)
+#if defined(ETHRECEIVER_USE_RECVMMSG)
+    if(useBatch)
     {
-        incoming_msg_size = recv_socket->recv((void *) incoming_msg_data, incoming_msg_capacity, sender_addr, flags);
-        if(incoming_msg_size <= 0)
-        { // marco.accame: i prefer using <= 0.
-            earlyexit_prev = 1; // yes, we have an early exit
-            break; // we break and do not return because we want to be sure to execute what is after the for() loop
-        }
-
-        // we have a packet ... we give it to the ethmanager for it parsing
-        //bool collectStatistics = (statPrintInterval > 0) ? true : false;
-        ethManager->Reception(ethManager->toipv4addr(sender_addr), incoming_msg_data, incoming_msg_size);
+        earlyexit_prev = receiveBatch(maxUDPpackets) ? 1 : 0;
+    }
+    else
+#endif
+    {
+        earlyexit_prev = receiveSingle(maxUDPpackets) ? 1 : 0;
     }
 
     // execute the check on presence of all eth boards.
     ethManager->CheckPresence();
+
+    printStatistics();
 }
 
 
 
 // - end-of-file (leave a blank line after)----------------------------------------------------------------------------
 
-
-
-
-
@@ -33,6 +33,23 @@
 
 #include <yarp/os/PeriodicThread.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "EoCommon.h"
+
+// on linux the socket is drained with recvmmsg(), i.e., with many packets per system call,
+// and the thread can also wait for packets on epoll rather than polling the socket periodically
+#if defined(__linux__)
+#define ETHRECEIVER_USE_RECVMMSG
+#define ETHRECEIVER_USE_EPOLL
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
 
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
 #include <./tools/include/PeriodicEventsVerifier.h>
@@ -43,18 +60,119 @@ namespace eth {
 
     class TheEthManager;
 
+    // -- class EthReceptionWorker
+    // -- it is a thread which parses with TheEthManager::Reception() the packets of a subset of the boards on behalf of EthReceiver.
+    // -- EthReceiver is the only producer and the worker is the only consumer of a lock-free ring of preallocated packets, thus
+    // -- the packets of a board keep their order. the worker sleeps on a condition variable only when the ring stays empty.
+
+    class EthReceptionWorker
+    {
+    public:
+
+        enum { ringSize = 256, maxPacketSize = 1496 };
+
+        EthReceptionWorker(eth::TheEthManager* _ethManager);
+        ~EthReceptionWorker();
+
+        bool start();
+        // it parses the packets still in the ring and then it stops the thread
+        void stop();
+
+        // to be called only by the thread of EthReceiver. it waits if the ring is full and in such a case it returns false.
+        bool push(eOipv4addr_t from, const uint64_t* data, ssize_t size);
+
+    private:
+
+        typedef struct
+        {
+            eOipv4addr_t    from;
+            ssize_t         size;
+            uint64_t        data[maxPacketSize/8];
+        } packet_t;
+
+        eth::TheEthManager *ethManager;
+        std::vector<packet_t> ring;
+
+        // head is written only by the producer and tail only by the consumer: we keep them on different cache lines
+        std::atomic<uint32_t> head;
+        uint8_t padding[64];
+        std::atomic<uint32_t> tail;
+
+        std::atomic<bool> sleeping;
+        std::atomic<bool> stopping;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::thread thread;
+
+        void loop();
+    };
+
     class EthReceiver : public yarp::os::PeriodicThread
     {
+    public:
+
+        // the statistics of reception, cumulated since the start of the thread
+        struct Statistics
+        {
+            uint64_t syscalls;      // number of receive system calls which returned at least one packet
+            uint64_t packets;       // number of received packets (packets/syscalls is the average batch)
+            uint32_t maxbatch;      // the maximum number of packets returned by a single system call
+            uint64_t truncated;     // packets discarded because bigger than TheEthManager::maxRXpacketsize
+            uint32_t kerneldrops;   // packets dropped by the kernel because the queue of the socket was full
+            double   meandelay;     // mean time in [sec] from the kernel timestamp to the values of the packet parsed into the NVs (only with timestamps and without parser workers)
+            double   maxdelay;      // max time in [sec] from the kernel timestamp to the values of the packet parsed into the NVs (only with timestamps and without parser workers)
+            uint64_t workerwaits;   // packets for which the reception had to wait for a full ring of a parser worker
+        };
+
     private:
         int rateofthread;
 
         ACE_SOCK_Dgram *recv_socket;
         eth::TheEthManager *ethManager;
         double statPrintInterval;
+        double statPrintTime;
 #ifdef NETWORK_PERFORMANCE_BENCHMARK 
         Tools::Emb_PeriodicEventVerifier m_perEvtVerifier;
 #endif
 
+        std::mutex statMutex;
+        Statistics stats;
+        uint64_t numofdelays;
+
+#if defined(ETHRECEIVER_USE_RECVMMSG)
+        enum { rxBatchSize = 32, rxControlSize = 64 };
+
+        // the ring of packet buffers is preallocated in config() and reused by every call of recvmmsg()
+        bool useBatch;
+        bool useTimestamps;
+        std::vector<uint64_t>           rxBuffers;
+        std::vector<struct mmsghdr>     rxMsgs;
+        std::vector<struct iovec>       rxIovecs;
+        std::vector<struct sockaddr_in> rxAddrs;
+        std::vector<uint64_t>           rxControls;
+
+        bool configBatch(ACE_HANDLE sockfd);
+        bool receiveBatch(int maxUDPpackets);
+#endif
+
+#if defined(ETHRECEIVER_USE_EPOLL)
+        // in event-driven mode run() blocks on epoll until a packet arrives and returns only when the thread
+        // is stopped. the check on presence of the boards is driven by a timerfd with period rateofthread
+        bool eventDriven;
+        std::atomic<bool> stopping;
+        int epollfd;
+        int timerfd;
+
+        bool configEvents(ACE_HANDLE sockfd);
+        void runEvents();
+#endif
+        // with ETHRECEIVER_PARSERS=n the packets are parsed by n workers, each one serving the boards whose ip address modulo n selects it
+        std::vector<EthReceptionWorker*> workers;
+
+        void dispatch(eOipv4addr_t from, uint64_t* data, ssize_t size);
+        bool receiveSingle(int maxUDPpackets);
+        void printStatistics();
+
     public:
 
         enum { EthReceiverDefaultRate = 5, EthReceiverMaxRate = 20 };
@@ -65,6 +183,10 @@ namespace eth {
         bool threadInit();
         void run();
         void onStop();
+        void threadRelease();
+
+        // it copies the statistics of reception
+        void getStatistics(Statistics &statistics);
     };
 
 } // namespace eth
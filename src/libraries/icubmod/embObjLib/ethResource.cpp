@@ -780,6 +780,12 @@ bool EthResource::setcheckRemoteValue(const eOprotID32_t id32, void *value, cons
     return nvman.setcheck(properties.ipv4addr, id32, value, retries, waitbeforecheck, timeout);
 }
 
+bool EthResource::setcheckRemoteValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, const double waitbeforecheck, const double timeout)
+{
+    theNVmanager& nvman = theNVmanager::getInstance();
+    return nvman.setcheck(&transceiver, id32s, values, retries, waitbeforecheck, timeout);
+}
+
 bool EthResource::CANPrintHandler(eOmn_info_basic_t *infobasic)
 {
     char str[256];
@@ -970,6 +976,12 @@ bool EthResource::getLocalValue(const eOprotID32_t id32, void *data)
 }
 
 
+bool EthResource::getLocalValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values)
+{
+    return transceiver.read(id32s, values);
+}
+
+
 bool EthResource::setLocalValue(eOprotID32_t id32, const void *value, bool overrideROprotection)
 {
     return transceiver.write(id32, value, overrideROprotection);
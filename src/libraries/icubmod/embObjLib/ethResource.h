@@ -71,9 +71,15 @@ namespace eth {
         // FAKE: it just returns true.
         bool setcheckRemoteValue(const eOprotID32_t id32, void *value, const unsigned int retries = 10, const double waitbeforecheck = 0.001, const double timeout = 0.050);
 
+        // it sets all the values and verifies them together, with all the asks in flight at the same time.
+        bool setcheckRemoteValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries = 10, const double waitbeforecheck = 0.001, const double timeout = 0.050);
+
         // FAKE: it just returns true.
         bool getLocalValue(const eOprotID32_t id32, void *value);
 
+        // it reads all the values with a single acquisition of the lock of the transceiver.
+        bool getLocalValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values);
+
         // FAKE: it just returns true.
         bool setLocalValue(eOprotID32_t id32, const void *value, bool overrideROprotection = false);
 
@@ -36,7 +36,17 @@
 //#include <yarp/os/SystemClock.h>
 #include <yarp/os/Log.h>
 #include <yarp/os/LogStream.h>
+#include <yarp/os/NetType.h>
+#include <yarp/os/Time.h>
+#include <yarp/conf/environment.h>
 using yarp::os::Log;
+using yarp::os::NetType;
+
+#include <cstring>
+#include <cerrno>
+#if defined(ETHSENDER_USE_SENDMMSG)
+#include <arpa/inet.h>
+#endif
 
 #include "ethManager.h"
 
@@ -62,21 +72,45 @@ using namespace eth;
 EthSender::EthSender(int txrate) : PeriodicThread((double)txrate/1000.0)
 {
     rateofthread = txrate;
+    send_socket = NULL;
+    ethManager = NULL;
     yDebug() << "EthSender is a PeriodicThread with txrate =" << rateofthread << "ms";
     yTrace();
 
-#ifdef NETWORK_PERFORMANCE_BENCHMARK 
-    /* We would like to verify if the receiver thread is ticked(running) every 1 millisecond, with a tollerance of 0.05 millisec.
-       The m_perEvtVerifier object after 1 second, prints an istogram with values from 0 to 3 millisec with a step of 0.1 millisec
-    */
-    //m_perEvtVerifier.init(0.001, 0.00005, 0.0, 0.003, 0.0001, 1);
-    m_perEvtVerifier.init(txrate, 5*txrate/100, 0.0, txrate+0.002, 0.0001, 1);
+    memset(&stats, 0, sizeof(stats));
+
+    // the user can ask for the histogram of the period of transmission also without recompiling with ETHSENDER_TXHISTOGRAM=1
+    std::string tmp = yarp::conf::environment::getEnvironment("ETHSENDER_TXHISTOGRAM");
+#ifdef NETWORK_PERFORMANCE_BENCHMARK
+    bool useHistogram = (tmp != "") ? (0 != NetType::toInt(tmp)) : true;
+#else
+    bool useHistogram = (tmp != "") ? (0 != NetType::toInt(tmp)) : false;
+#endif
+    m_perEvtVerifier = NULL;
+    if(useHistogram)
+    {
+        /* We would like to verify if the sender thread is ticked(running) every txrate millisecond, with a tollerance of 5%.
+           The m_perEvtVerifier object after 1 second, prints an istogram with values from 0 to txrate+2 millisec with a step of 0.1 millisec
+        */
+        double period = (double)txrate/1000.0;
+        m_perEvtVerifier = new Tools::Emb_PeriodicEventVerifier;
+        m_perEvtVerifier->init(period, 5*period/100, 0.0, period+0.002, 0.0001, 1, "TX");
+    }
+
+#if defined(ETHSENDER_USE_SENDMMSG)
+    // the user can go back to one send() per board with ETHSENDER_SENDMMSG=0
+    tmp = yarp::conf::environment::getEnvironment("ETHSENDER_SENDMMSG");
+    useBatch = (tmp != "") ? (0 != NetType::toInt(tmp)) : true;
+    txNumber = 0;
 #endif
 }
 
 EthSender::~EthSender()
 {
-
+    if(NULL != m_perEvtVerifier)
+    {
+        delete m_perEvtVerifier;
+    }
 }
 
 bool EthSender::config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager)
@@ -85,9 +119,129 @@ bool EthSender::config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager)
     send_socket = pSocket;
     ethManager  = _ethManager;
 
+#if defined(ETHSENDER_USE_SENDMMSG)
+    if(useBatch)
+    {
+        // every board has at most one ropframe per tick, thus a batch never holds more than maxBoards packets
+        txMsgs.resize(TheEthManager::maxBoards);
+        txIovecs.resize(TheEthManager::maxBoards);
+        txAddrs.resize(TheEthManager::maxBoards);
+
+        for(size_t i=0; i<txMsgs.size(); i++)
+        {
+            memset(&txMsgs[i], 0, sizeof(txMsgs[i]));
+            memset(&txAddrs[i], 0, sizeof(txAddrs[i]));
+            txMsgs[i].msg_hdr.msg_name = &txAddrs[i];
+            txMsgs[i].msg_hdr.msg_namelen = sizeof(txAddrs[i]);
+            txMsgs[i].msg_hdr.msg_iov = &txIovecs[i];
+            txMsgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        yDebug() << "EthSender::config() sends the ropframes of every tick with a single sendmmsg()";
+    }
+#endif
+
+    return true;
+}
+
+
+bool EthSender::isBatching() const
+{
+#if defined(ETHSENDER_USE_SENDMMSG)
+    return useBatch;
+#else
+    return false;
+#endif
+}
+
+
+bool EthSender::add(const void *udpframe, size_t len, const eOipv4addressing_t &toaddressing)
+{
+#if defined(ETHSENDER_USE_SENDMMSG)
+    if(useBatch)
+    {
+        if(txNumber == txMsgs.size())
+        {
+            transmit();
+        }
+
+        uint8_t ip1, ip2, ip3, ip4;
+        eo_common_ipv4addr_to_decimal(toaddressing.addr, &ip1, &ip2, &ip3, &ip4);
+
+        struct sockaddr_in &addr = txAddrs[txNumber];
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(toaddressing.port);
+        addr.sin_addr.s_addr = htonl((ip1 << 24) | (ip2 << 16) | (ip3 << 8) | (ip4));
+
+        txIovecs[txNumber].iov_base = const_cast<void*>(udpframe);
+        txIovecs[txNumber].iov_len = len;
+        txNumber++;
+
+        return true;
+    }
+#endif
+
+    std::lock_guard<std::mutex> lck(statMutex);
+    stats.syscalls++;
+    if(ethManager->sendPacket(udpframe, len, toaddressing) < 0)
+    {
+        stats.failures++;
+        return false;
+    }
+    stats.packets++;
     return true;
 }
 
+
+void EthSender::transmit()
+{
+#if defined(ETHSENDER_USE_SENDMMSG)
+    if(0 == txNumber)
+    {
+        return;
+    }
+
+    ACE_HANDLE sockfd = send_socket->get_handle();
+    size_t sent = 0;
+    uint64_t syscalls = 0;
+    uint64_t failures = 0;
+
+    while(sent < txNumber)
+    {
+        int ret = sendmmsg(sockfd, &txMsgs[sent], txNumber-sent, 0);
+        syscalls++;
+
+        if(ret > 0)
+        {
+            sent += ret;
+        }
+        else if((ret < 0) && (EINTR == errno))
+        {
+            continue;
+        }
+        else
+        {   // the packet at position sent is refused: we skip it as the send() of the single packet would do
+            failures++;
+            sent++;
+        }
+    }
+
+    std::lock_guard<std::mutex> lck(statMutex);
+    stats.packets += (txNumber - failures);
+    stats.syscalls += syscalls;
+    stats.failures += failures;
+
+    txNumber = 0;
+#endif
+}
+
+
+void EthSender::getStatistics(Statistics &statistics)
+{
+    std::lock_guard<std::mutex> lck(statMutex);
+    statistics = stats;
+}
+
 bool EthSender::threadInit()
 {
     yTrace() << "Do some initialization here if needed";
@@ -113,11 +267,18 @@ void EthSender::run()
     // by calling this metod of ethManager, we put protection vs concurrency internal to the class.
     // for tx we must protect the EthResource not being changed. they can be changed by a device such as
     // embObjMotionControl etc which adds or releases its resources.
+    // in batch mode the ropframes are queued with add() and transmit() sends them all together at the end of Transmission().
     ethManager->Transmission();
 
-#ifdef NETWORK_PERFORMANCE_BENCHMARK
-    m_perEvtVerifier.tick(yarp::os::Time::now());
-#endif
+    {
+        std::lock_guard<std::mutex> lck(statMutex);
+        stats.ticks++;
+    }
+
+    if(NULL != m_perEvtVerifier)
+    {
+        m_perEvtVerifier->tick(yarp::os::Time::now());
+    }
 }
 
 
@@ -33,10 +33,20 @@
 
 #include <yarp/os/PeriodicThread.h>
 
-#ifdef NETWORK_PERFORMANCE_BENCHMARK 
-#include <./tools/include/PeriodicEventsVerifier.h>
+#include <mutex>
+#include <vector>
+
+#include "EoCommon.h"
+
+// on linux the ropframes of all the boards can be sent in a single system call with sendmmsg()
+#if defined(__linux__)
+#define ETHSENDER_USE_SENDMMSG
+#include <sys/socket.h>
+#include <netinet/in.h>
 #endif
 
+#include <./tools/include/PeriodicEventsVerifier.h>
+
 
 namespace eth {
 
@@ -44,6 +54,18 @@ namespace eth {
 
     class EthSender : public yarp::os::PeriodicThread
     {
+    public:
+
+        enum { EthSenderDefaultRate = 1, EthSenderMaxRate = 20 };
+
+        struct Statistics
+        {
+            uint64_t    ticks;          // number of executions of run()
+            uint64_t    packets;        // number of ropframes given to the socket
+            uint64_t    syscalls;       // number of system calls used to transmit them
+            uint64_t    failures;       // number of ropframes which the socket has refused
+        };
+
     private:
         int rateofthread;
 
@@ -51,21 +73,42 @@ namespace eth {
         TheEthManager *ethManager;
         ACE_SOCK_Dgram *send_socket;
 
-#ifdef NETWORK_PERFORMANCE_BENCHMARK 
-        Tools::Emb_PeriodicEventVerifier m_perEvtVerifier;
+        Statistics stats;
+        std::mutex statMutex;
+
+        // the histogram of the period of transmission is printed if NETWORK_PERFORMANCE_BENCHMARK is defined or if ETHSENDER_TXHISTOGRAM=1
+        Tools::Emb_PeriodicEventVerifier *m_perEvtVerifier;
+
+#if defined(ETHSENDER_USE_SENDMMSG)
+        // the ropframes are not copied: the iovecs point to the packets that the transceivers of the boards have just formed
+        bool useBatch;
+        size_t txNumber;
+        std::vector<struct mmsghdr> txMsgs;
+        std::vector<struct iovec> txIovecs;
+        std::vector<struct sockaddr_in> txAddrs;
 #endif
+
         void run();
 
 
     public:
 
-        enum { EthSenderDefaultRate = 1, EthSenderMaxRate = 20 };
-
         EthSender(int txrate);
         ~EthSender();
         bool config(ACE_SOCK_Dgram *pSocket, TheEthManager* _ethManager);
         bool threadInit();
 
+        // true if the ropframes of a tick are collected with add() and sent all together at the end of the tick
+        bool isBatching() const;
+
+        // it queues a ropframe for the transmission at the end of the tick. the ropframe must stay valid until then.
+        bool add(const void *udpframe, size_t len, const eOipv4addressing_t &toaddressing);
+
+        // it sends the ropframes queued by add(). it does nothing if the sender is not batching.
+        void transmit();
+
+        void getStatistics(Statistics &statistics);
+
     };
 
 } // namespace eth
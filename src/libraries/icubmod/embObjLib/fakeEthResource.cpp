@@ -249,6 +249,11 @@ bool FakeEthResource::setcheckRemoteValue(const eOprotID32_t id32, void *value,
     return true;
 }
 
+bool FakeEthResource::setcheckRemoteValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, const double waitbeforecheck, const double timeout)
+{
+    return true;
+}
+
 
 
 bool FakeEthResource::CANPrintHandler(eOmn_info_basic_t *infobasic)
@@ -298,6 +303,20 @@ bool FakeEthResource::getLocalValue(const eOprotID32_t id32, void *data)
     return ret;
 }
 
+bool FakeEthResource::getLocalValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values)
+{
+    // we go through getLocalValue() so that the special cases are managed in the same way
+    if(id32s.size() != values.size())
+        return false;
+
+    bool ret = true;
+    for(size_t i=0; i<id32s.size(); i++)
+    {
+        ret &= getLocalValue(id32s[i], values[i]);
+    }
+    return ret;
+}
+
 bool FakeEthResource::setLocalValue(eOprotID32_t id32, const void *value, bool overrideROprotection)
 {
     return transceiver.write(id32, value, overrideROprotection);
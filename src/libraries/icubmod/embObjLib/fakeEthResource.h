@@ -61,8 +61,12 @@ namespace eth {
 
         bool setcheckRemoteValue(const eOprotID32_t id32, void *value, const unsigned int retries = 10, const double waitbeforecheck = 0.001, const double timeout = 0.050);
 
+        bool setcheckRemoteValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries = 10, const double waitbeforecheck = 0.001, const double timeout = 0.050);
+
         bool getLocalValue(const eOprotID32_t id32,  void *value);
 
+        bool getLocalValues(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values);
+
         bool setLocalValue(const eOprotID32_t id32,  const void *value, bool overrideROprotection = false);
 
         bool verifyEPprotocol(eOprot_endpoint_t ep);
@@ -59,6 +59,22 @@ using namespace std;
 
 using namespace eth;
 
+namespace {
+
+    // the acquisitions of the NV locks and of the reception lock made by the calling thread. they are
+    // thread-local so that the reads of the other threads (e.g. the worker of theNVmanager) do not add up
+    thread_local uint64_t nvlocksOfThread = 0;
+    thread_local uint64_t rxlocksOfThread = 0;
+
+    // with the internal mutexes, every eo_nv_Get() / eo_nv_Set() takes the mutex of the endpoint once
+    inline void countInternalNVlock()
+    {
+#if defined(HOSTTRANSCEIVER_USE_INTERNAL_MUTEXES)
+        nvlocksOfThread++;
+#endif
+    }
+}
+
 bool HostTransceiver::lock_transceiver(bool on)
 {
 #if !defined(HOSTTRANSCEIVER_USE_INTERNAL_MUTEXES)
@@ -77,7 +93,10 @@ bool HostTransceiver::lock_nvs(bool on)
 {
 #if !defined(HOSTTRANSCEIVER_USE_INTERNAL_MUTEXES)
     if(on)
+    {
         nvmtx.lock();
+        nvlocksOfThread++;
+    }
     else
         nvmtx.unlock();
 #endif
@@ -264,6 +283,7 @@ bool HostTransceiver::write(const eOprotID32_t id32, const void* data, bool forc
 
 
     lock_nvs(true);
+    countInternalNVlock();
     eores = eo_nv_Set(&nv, data, forcewriteOfReadOnly, eo_nv_upd_dontdo);
     lock_nvs(false);
 
@@ -326,6 +346,7 @@ bool HostTransceiver::addSetROP__(const eOprotID32_t id32, const void* data, con
         }
 
         lock_nvs(true);
+        countInternalNVlock();
         eores = eo_nv_Set(&nv, data, eobool_false, eo_nv_upd_dontdo);
         lock_nvs(false);
 
@@ -522,6 +543,69 @@ bool HostTransceiver::read(const eOprotID32_t id32, void *data)
 }
 
 
+bool HostTransceiver::read(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &data)
+{
+    if(id32s.size() != data.size())
+    {
+        yError() << "HostTransceiver::read() called w/ different number of ids and data: BOARD w/ IP" << remoteipstring;
+        return false;
+    }
+
+    if(id32s.empty())
+    {
+        return true;
+    }
+
+    // the lookup of the NVs is a constant-time access to the tables of the nvset, hence it is done inside
+    // the lock. in this way we do not need any temporary storage and we stay allocation-free.
+    // the protection of the nvs (either internal or ours) covers only one nv at a time, thus we also hold
+    // the reception lock: parseUDP() cannot update any value until all of them have been copied.
+    const size_t n = id32s.size();
+    bool ret = true;
+    uint16_t size = 0;
+    EOnv nv;
+
+    std::lock_guard<std::mutex> rxlck(rxmtx);
+    rxlocksOfThread++;
+
+    lock_nvs(true);
+    for(size_t i=0; i<n; i++)
+    {
+        EOnv *nv_ptr = NULL;
+        if((eobool_true == eoprot_id_isvalid(protboardnumber, id32s[i])) && (NULL != data[i]))
+        {
+            nv_ptr = getnvhandler(id32s[i], &nv);
+            countInternalNVlock();
+        }
+
+        if((NULL == nv_ptr) || (eores_OK != eo_nv_Get(nv_ptr, eo_nv_strg_volatile, reinterpret_cast<uint8_t *>(data[i]), &size)))
+        {
+            ret = false;
+        }
+    }
+    lock_nvs(false);
+
+    if(false == ret)
+    {
+        yError() << "HostTransceiver::read() could not read all the" << n << "requested values: BOARD w/ IP" << remoteipstring;
+    }
+
+    return ret;
+}
+
+
+uint64_t HostTransceiver::getNVlockCount()
+{
+    return nvlocksOfThread;
+}
+
+
+uint64_t HostTransceiver::getRXlockCount()
+{
+    return rxlocksOfThread;
+}
+
+
 
 // somebody passes the received packet - this is used just as an interface
 bool HostTransceiver::parseUDP(const void *data, const uint16_t size)
@@ -560,8 +644,11 @@ bool HostTransceiver::parseUDP(const void *data, const uint16_t size)
     // for the above reason, we could avoid protection.
     // HOWEVER: it is a good thing to protect the nvs as the receiver writes them and someone else reads them to retrieve values for yarp ports
     // for this reason, we use eo_trans_protection_enabled and eo_nvset_protection_one_per_endpoint when we initialise the transceiver.
-    // that solves concurrency problems for the transceiver
+    // that solves concurrency problems for the transceiver.
+    // the reception lock keeps instead the whole packet atomic w.r.t. read() of a group of values.
+    rxmtx.lock();
     eo_transceiver_Receive(pc104txrx, p_RxPkt, &numofrops, &txtime);
+    rxmtx.unlock();
 
     return true;
 }
@@ -670,6 +757,7 @@ bool HostTransceiver::getNVvalue(EOnv *nv, uint8_t* data, uint16_t* size)
         return false;
     }
     lock_nvs(true);
+    countInternalNVlock();
     (eores_OK == eo_nv_Get(nv, eo_nv_strg_volatile, data, size)) ? ret = true : ret = false;
     lock_nvs(false);
 
@@ -46,6 +46,8 @@
 #include "EoProtocol.h"
 
 #include <mutex>
+#include <atomic>
+#include <vector>
 
 #include <yarp/os/Searchable.h>
 
@@ -82,6 +84,15 @@ namespace eth {
         // reads locally.
         bool read(const eOprotID32_t id32, void *data);
 
+        // reads locally a group of values while holding the reception lock only once, so that they all
+        // belong to the same reception. it returns false if any of them cannot be read.
+        bool read(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &data);
+
+        // return how many times the calling thread has acquired the NV locks (the mutexes of the endpoints, or
+        // ours when the internal ones are not used) and the reception lock, on any transceiver.
+        static uint64_t getNVlockCount();
+        static uint64_t getRXlockCount();
+
         // writes locally
         bool write(const eOprotID32_t id32, const void* data, bool forcewriteOfReadOnly);
 
@@ -147,6 +158,9 @@ namespace eth {
         bool lock_nvs(bool on);
         std::mutex nvmtx;
 
+        // held by parseUDP() and by read() of a group of values, whatever the protection of the nvs
+        std::mutex rxmtx;
+
 
         bool addSetROP__(const eOprotID32_t id32, const void* data, const uint32_t signature, bool writelocalrxcache = false);
 //        bool addGetROP__(eOprotID32_t id32, uint32_t signature);
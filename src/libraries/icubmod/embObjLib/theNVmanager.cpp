@@ -38,8 +38,15 @@
 #include <condition_variable>
 #include <chrono>
 #include <map>
+#include <deque>
+#include <thread>
+#include <algorithm>
+#include <memory>
 #include <cstring>
 
+#include <yarp/conf/environment.h>
+#include <yarp/os/NetType.h>
+
 #include "EoProtocol.h"
 #include "EoProtocolMN.h"
 
@@ -127,6 +134,28 @@ struct eth::theNVmanager::Impl
     };
 
 
+    // an ask<> of many variables whose caller does not wait. it is completed by the worker thread, which copies the replies into
+    // values and sets the promise, or which sets the promise to false when the deadline expires.
+    struct asyncTransaction
+    {
+        eth::HostTransceiver*       transceiver {nullptr};
+        eOprotIP_t                  ipv4 {0};
+        std::vector<eOprotID32_t>   id32s {};
+        std::vector<void*>          values {};
+        std::uint16_t               receivedrops {0};
+        size_t                      pendingbytes {0};
+        std::uint32_t               signature {eo_rop_SIGNATUREdummy};
+        double                      deadline {0};
+        std::promise<bool>          promise {};
+    };
+
+    // the bytes that the say<> reply to an ask<> takes in the ropframe of the board: header, signature, time and data
+    static size_t sizeofreply(const eOprotID32_t id32)
+    {
+        return 20 + eoprot_variable_sizeof_get(eoprot_board_localboard, id32);
+    }
+
+
     struct Data
     {
         std::mutex locker {};
@@ -135,10 +164,24 @@ struct eth::theNVmanager::Impl
         std::uint32_t sequence {0};
         std::uint32_t filler {0};
 
+        // the asynchronous transactions are searched by signature only
+        std::map<std::uint32_t, asyncTransaction*> asyncmap {};
+        // the bytes of the replies in flight from every board
+        std::map<eOprotIP_t, size_t> inflight {};
+        // the transactions with all their replies, waiting for the worker
+        std::deque<asyncTransaction*> completed {};
+        // it wakes up the worker when a transaction is completed or added
+        std::condition_variable cvworker {};
+        // it wakes up who waits for some room in the window of a board
+        std::condition_variable cvwindow {};
+
         Data() { reset(); }
         void reset()
         {
             themap.clear();
+            asyncmap.clear();
+            inflight.clear();
+            completed.clear();
             sequence = 0;
         }
 
@@ -204,6 +247,38 @@ struct eth::theNVmanager::Impl
             return true;
         }
 
+        bool alertasync(const std::uint32_t signature, const eOprotID32_t id)
+        {
+            std::map<std::uint32_t, asyncTransaction*>::iterator it = asyncmap.find(signature);
+
+            if(asyncmap.end() == it)
+            {
+                return false;
+            }
+
+            asyncTransaction *transaction = (*it).second;
+            size_t bytes = std::min(sizeofreply(id), transaction->pendingbytes);
+            transaction->pendingbytes -= bytes;
+            release(transaction->ipv4, bytes);
+
+            transaction->receivedrops++;
+            if(transaction->receivedrops == transaction->id32s.size())
+            {
+                asyncmap.erase(it);
+                completed.push_back(transaction);
+                cvworker.notify_one();
+            }
+
+            return true;
+        }
+
+        void release(const eOprotIP_t ip, const size_t bytes)
+        {
+            size_t &n = inflight[ip];
+            n = (n > bytes) ? (n - bytes) : 0;
+            cvwindow.notify_all();
+        }
+
         void remove(const eOprotIP_t ip, const eOprotID32_t id)
         {
             std::uint64_t key = (static_cast<std::uint64_t>(ip) << 32) | static_cast<std::uint64_t>(id);
@@ -253,6 +328,12 @@ struct eth::theNVmanager::Impl
            
     Data data;
 
+    // max bytes of replies in flight from every board. the default stays within a ropframe of the board
+    size_t askwindow {1024};
+    // the worker which completes the asynchronous transactions is started at the first ask_async() and joined by ~Impl()
+    std::thread workerthread {};
+    bool workerstop {false};
+
     // we can use: std::map, std::multimap, std::set, std::multiset because therya re ordered and thus quicker. they have teh find method.
     // strategy: find by signature. in such a way every transaction is unique. it must have ....
     // see https://www.fluentcpp.com/2017/01/26/searching-an-stl-container/
@@ -260,6 +341,39 @@ struct eth::theNVmanager::Impl
     Impl() 
     {   
         data.reset();
+
+        std::string tmp = yarp::conf::environment::getEnvironment("NVMANAGER_ASK_WINDOW");
+        if((tmp != "") && (yarp::os::NetType::toInt(tmp) > 0))
+        {
+            askwindow = static_cast<size_t>(yarp::os::NetType::toInt(tmp));
+        }
+    }
+
+    ~Impl()
+    {
+        {
+            std::lock_guard<std::mutex> lck(data.locker);
+            workerstop = true;
+            data.cvworker.notify_one();
+        }
+
+        if(true == workerthread.joinable())
+        {
+            workerthread.join();
+        }
+
+        // the transactions still pending are failed: their boards may be gone already, so we do not touch them
+        for(std::map<std::uint32_t, asyncTransaction*>::iterator it = data.asyncmap.begin(); it != data.asyncmap.end(); it++)
+        {
+            (*it).second->promise.set_value(false);
+            delete (*it).second;
+        }
+        for(size_t i=0; i<data.completed.size(); i++)
+        {
+            data.completed[i]->promise.set_value(false);
+            delete data.completed[i];
+        }
+        data.reset();
     }
 
 
@@ -299,6 +413,11 @@ struct eth::theNVmanager::Impl
 
     bool ask(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout);
 
+    std::future<bool> ask_async(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout);
+    void worker();
+
+    bool setcheck(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, double waitbeforecheck, double timeout);
+
     bool check(eth::HostTransceiver *t, const eOprotID32_t id32, const void *value, const double timeout, const unsigned int retries);
 
     bool signatureisvalid(const std::uint32_t signature);
@@ -909,83 +1028,251 @@ bool eth::theNVmanager::Impl::ask(eth::HostTransceiver *t, const eOprotID32_t id
 
 bool eth::theNVmanager::Impl::ask(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout)
 {
-    const eOprotIP_t ipv4 = t->getIPv4();
+    // the asynchronous version already does it all: we just wait for its result
+    return ask_async(t, id32s, values, timeout).get();
+}
+
+
+std::future<bool> eth::theNVmanager::Impl::ask_async(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout)
+{
+    asyncTransaction* transaction = new asyncTransaction;
+    std::future<bool> future = transaction->promise.get_future();
 
     if(false == validparameters(t, id32s, values))
     {
-        return false;
+        transaction->promise.set_value(false);
+        delete transaction;
+        return future;
     }
 
+    const eOprotIP_t ipv4 = t->getIPv4();
+    std::uint32_t signature = eo_rop_SIGNATUREdummy;
 
-    // 2. must prepare wait data etc.
-
-
-    askTransaction* transaction = new askTransaction;
-    std::uint32_t assignedsignature = 0;
+    transaction->transceiver = t;
+    transaction->ipv4 = ipv4;
+    transaction->id32s = id32s;
+    transaction->values = values;
+    for(int i=0; i<id32s.size(); i++)
+    {
+        transaction->pendingbytes += sizeofreply(id32s[i]);
+    }
+    const size_t numofbytes = transaction->pendingbytes;
 
-    data.lock();
+    // 1. must wait for room in the window of the board. a request bigger than the window is accepted when nothing else is in flight
+    {
+        std::unique_lock<std::mutex> lck(data.locker);
 
-    data.insert(transaction, ipv4, id32s, assignedsignature);
+        if(false == workerthread.joinable())
+        {
+            workerthread = std::thread(&Impl::worker, this);
+        }
 
-    data.unlock();
+        // the wait is bounded: the bytes in flight are released by the replies or by the worker at the deadline of their transactions
+        size_t &n = data.inflight[ipv4];
+        data.cvwindow.wait(lck, [&]{ return (0 == n) || ((n + numofbytes) <= askwindow); });
 
-    // 3. must send a request to all the id32s
+        n += numofbytes;
+        signature = data.uniquesignature();
+        transaction->signature = signature;
+        transaction->deadline = SystemClock::nowSystem() + timeout;
+        data.asyncmap[signature] = transaction;
+        data.cvworker.notify_one();
+    }
 
+    // 2. must send a request to all the id32s. from now on the transaction belongs to the worker, which may also delete it
     for(int i=0; i<id32s.size(); i++)
     {
-        if(false == t->addROPask(id32s[i], assignedsignature))
+        if(false == t->addROPask(id32s[i], signature))
         {
             const AbstractEthResource::Properties & props = getboardproperties(t);
-            yError() << "theNVmanager::Impl::ask() fails t->addROPask() to BOARD" << props.boardnameString << "IP" << props.ipv4addrString << "for nv" << getid32string(id32s[i]);
+            yError() << "theNVmanager::Impl::ask_async() fails t->addROPask() to BOARD" << props.boardnameString << "IP" << props.ipv4addrString << "for nv" << getid32string(id32s[i]);
+
+            // we expire the transaction, so that the worker fails it at once
+            std::lock_guard<std::mutex> lck(data.locker);
+            std::map<std::uint32_t, asyncTransaction*>::iterator it = data.asyncmap.find(signature);
+            if(data.asyncmap.end() != it)
+            {
+                (*it).second->deadline = 0;
+                data.cvworker.notify_one();
+            }
+            break;
+        }
+    }
+
+    return future;
+}
+
+
+void eth::theNVmanager::Impl::worker()
+{
+    std::unique_lock<std::mutex> lck(data.locker);
+
+    while(false == workerstop)
+    {
+        // 1. the completed transactions: the values are read outside the lock because the reception thread may need it
+        while((false == data.completed.empty()) && (false == workerstop))
+        {
+            asyncTransaction *transaction = data.completed.front();
+            data.completed.pop_front();
+            lck.unlock();
 
-            // remove the transaction
-            data.lock();
-            data.remove(assignedsignature);
-            data.unlock();
-            // and delete it
+            bool ok = transaction->transceiver->read(transaction->id32s, transaction->values);
+            if(false == ok)
+            {
+                const AbstractEthResource::Properties & props = getboardproperties(transaction->transceiver);
+                yError() << "theNVmanager::Impl::worker() fails t->read() for BOARD" << props.boardnameString << "IP" << props.ipv4addrString << "w/ multiple NVs";
+            }
+            transaction->promise.set_value(ok);
             delete transaction;
 
-            return false;
+            lck.lock();
+        }
+
+        // 2. the expired transactions: late replies will not find them anymore
+        double now = SystemClock::nowSystem();
+        double next = now + 1.0;
+        std::vector<asyncTransaction*> expired;
+
+        for(std::map<std::uint32_t, asyncTransaction*>::iterator it = data.asyncmap.begin(); it != data.asyncmap.end(); )
+        {
+            asyncTransaction *transaction = (*it).second;
+            if(transaction->deadline <= now)
+            {
+                data.release(transaction->ipv4, transaction->pendingbytes);
+                expired.push_back(transaction);
+                it = data.asyncmap.erase(it);
+            }
+            else
+            {
+                next = std::min(next, transaction->deadline);
+                it++;
+            }
+        }
+
+        if(false == expired.empty())
+        {
+            lck.unlock();
+            for(size_t i=0; i<expired.size(); i++)
+            {
+                const AbstractEthResource::Properties & props = getboardproperties(expired[i]->transceiver);
+                yError() << "theNVmanager::Impl::ask_async() had a timeout for BOARD" << props.boardnameString << "IP" << props.ipv4addrString << "w/ multiple NVs. Received only" << expired[i]->receivedrops << "out of" << expired[i]->id32s.size();
+                expired[i]->promise.set_value(false);
+                delete expired[i];
+            }
+            lck.lock();
+            continue;
+        }
+
+        if((true == data.completed.empty()) && (false == workerstop))
+        {
+            data.cvworker.wait_for(lck, std::chrono::microseconds(static_cast<int>(1000000.0 * (next - now)) + 1));
         }
     }
+}
 
-    // 4. must wait now and manage a possible timeout
-    std::uint16_t numberOfReceivedROPs = 0;
 
-    if(false == transaction->wait(numberOfReceivedROPs))
+bool eth::theNVmanager::Impl::setcheck(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, double waitbeforecheck, double timeout)
+{
+    if(false == validparameters(t, id32s, values))
     {
-        // a timeout occurred .... manage it.
+        return false;
+    }
 
-        // remove the transaction
-        data.lock();
-        data.remove(assignedsignature);
-        data.unlock();
-        // and delete it
-        delete transaction;
+    // the values read back for verification
+    std::vector<std::vector<std::uint8_t>> readback(id32s.size());
+    for(int i=0; i<id32s.size(); i++)
+    {
+        readback[i].resize(sizeofnv(id32s[i]));
+    }
 
-        const AbstractEthResource::Properties & props = getboardproperties(t);
-        yError() << "theNVmanager::Impl::ask() had a timeout for BOARD" << props.boardnameString << "IP" << props.ipv4addrString << "w/ multiple NVs. Received only" << numberOfReceivedROPs << "out of" << id32s.size();
-        return false;
+    // the indices of the variables still to be verified
+    std::vector<size_t> pending(id32s.size());
+    for(size_t i=0; i<pending.size(); i++)
+    {
+        pending[i] = i;
     }
 
-    //yDebug() << "received" << numberOfReceivedROPs << "numberOfReceivedROPs";
+    int maxattempts = retries + 1;
+    int attempt = 0;
 
-    // remove the transaction
-    data.lock();
-    data.remove(assignedsignature);
-    data.unlock();
-    // and delete it
-    delete transaction;
+    for(attempt=0; (attempt<maxattempts) && (false == pending.empty()); attempt++)
+    {
+        for(size_t i=0; i<pending.size(); i++)
+        {
+            if(false == set(t, id32s[pending[i]], values[pending[i]]))
+            {
+                const AbstractEthResource::Properties & props = getboardproperties(t);
+                yWarning() << "theNVmanager::Impl::setcheck() had an error while calling set() in BOARD" << props.boardnameString << "with IP" << props.ipv4addrString << "for nv" << getid32string(id32s[pending[i]]) << "at attempt #" << attempt+1;
+            }
+        }
 
-    // 5. can retrieve values now
-    for(int i=0; i<id32s.size(); i++)
+        // ok, now i wait some time before asking the values back for verification. the asks are split in chunks which fit the
+        // window of the board, so that a chunk is sent as soon as the replies of the previous one have arrived
+        SystemClock::delaySystem(waitbeforecheck);
+
+        std::vector<std::vector<size_t>> chunks(1);
+        size_t chunkbytes = 0;
+        for(size_t i=0; i<pending.size(); i++)
+        {
+            size_t bytes = sizeofreply(id32s[pending[i]]);
+            if((false == chunks.back().empty()) && ((chunkbytes + bytes) > askwindow))
+            {
+                chunks.push_back(std::vector<size_t>());
+                chunkbytes = 0;
+            }
+            chunks.back().push_back(pending[i]);
+            chunkbytes += bytes;
+        }
+
+        std::vector<std::future<bool>> futures;
+        for(size_t c=0; c<chunks.size(); c++)
+        {
+            std::vector<eOprotID32_t> ids;
+            std::vector<void*> vals;
+            for(size_t i=0; i<chunks[c].size(); i++)
+            {
+                ids.push_back(id32s[chunks[c][i]]);
+                vals.push_back(readback[chunks[c][i]].data());
+            }
+            futures.push_back(ask_async(t, ids, vals, timeout));
+        }
+
+        std::vector<size_t> notverified;
+        for(size_t c=0; c<chunks.size(); c++)
+        {
+            bool replied = futures[c].get();
+            if(false == replied)
+            {
+                const AbstractEthResource::Properties & props = getboardproperties(t);
+                yWarning() << "theNVmanager::Impl::setcheck() had an error while asking back" << chunks[c].size() << "nvs in BOARD" << props.boardnameString << "with IP" << props.ipv4addrString << "at attempt #" << attempt+1;
+            }
+
+            for(size_t i=0; i<chunks[c].size(); i++)
+            {
+                size_t n = chunks[c][i];
+                if((false == replied) || (0 != std::memcmp(values[n], readback[n].data(), readback[n].size())))
+                {
+                    notverified.push_back(n);
+                }
+            }
+        }
+        pending.swap(notverified);
+    }
+
+    const AbstractEthResource::Properties & props = getboardproperties(t);
+
+    if(false == pending.empty())
     {
-        if(false == t->read(id32s[i], values[i]))
+        for(size_t i=0; i<pending.size(); i++)
         {
-            const AbstractEthResource::Properties & props = getboardproperties(t);
-            yError() << "theNVmanager::Impl::ask() fails res->getLocalValue() for BOARD" << props.boardnameString << "IP" << props.ipv4addrString << "and nv" << getid32string(id32s[i]);
-            return false;
+            yError() << "FATAL: theNVmanager::Impl::setcheck() could not set and verify ID" << getid32string(id32s[pending[i]]) << "in BOARD" << props.boardnameString << "with IP" << props.ipv4addrString << " even after " << attempt << "attempts";
         }
+        return false;
+    }
+
+    if(attempt > 1)
+    {
+        yWarning() << "theNVmanager::Impl::setcheck() has set and verified" << id32s.size() << "nvs in BOARD" << props.boardnameString << "with IP" << props.ipv4addrString << "at attempt #" << attempt;
     }
 
     return true;
@@ -1054,10 +1341,13 @@ bool eth::theNVmanager::Impl::onarrival(const ropCode ropcode, const eOprotIP_t
             return false;
         }
 
-        // 1. alert the thread which is waiting
+        // 1. alert the thread which is waiting or the asynchronous transaction
         data.lock();
 
-        data.alert(signature);
+        if(false == data.alertasync(signature, id32))
+        {
+            data.alert(signature);
+        }
 
         data.unlock();
 
@@ -1089,12 +1379,13 @@ bool eth::theNVmanager::Impl::onarrival(const ropCode ropcode, const eOprotIP_t
 
 eth::theNVmanager& eth::theNVmanager::getInstance()
 {
-    static theNVmanager* p = nullptr;
+    // it is destroyed at exit, so that ~Impl() can stop the worker thread
+    static std::unique_ptr<theNVmanager> p {nullptr};
 
     std::lock_guard<std::mutex> lck(eth::theNVmanager::Impl::mtx);
     if(nullptr == p)
     {
-        p = new theNVmanager();
+        p.reset(new theNVmanager());
     }
 
     return *p;
@@ -1109,6 +1400,12 @@ eth::theNVmanager::theNVmanager()
 
 }
 
+
+eth::theNVmanager::~theNVmanager()
+{
+    delete pImpl;
+}
+
          
 //bool eth::theNVmanager::initialise(const Config &config)
 //{
@@ -1183,6 +1480,17 @@ bool eth::theNVmanager::ask(eth::HostTransceiver *t, const std::vector<eOprotID3
     return pImpl->ask(t, id32s, values, timeout);
 }
 
+std::future<bool> eth::theNVmanager::ask_async(const eOprotIP_t ipv4, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout)
+{
+    eth::HostTransceiver *t = pImpl->transceiver(ipv4);
+    return pImpl->ask_async(t, id32s, values, timeout);
+}
+
+std::future<bool> eth::theNVmanager::ask_async(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout)
+{
+    return pImpl->ask_async(t, id32s, values, timeout);
+}
+
 bool eth::theNVmanager::set(eth::HostTransceiver *t, const eOprotID32_t id32, const void *value)
 {
     return pImpl->set(t, id32, value);
@@ -1218,6 +1526,17 @@ bool eth::theNVmanager::setcheck(eth::HostTransceiver *t, const eOprotID32_t id3
     return pImpl->setcheck(t, id32, value, retries, waitbeforecheck, timeout);
 }
 
+bool eth::theNVmanager::setcheck(const eOprotIP_t ipv4, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, double waitbeforecheck, double timeout)
+{
+    eth::HostTransceiver *t = pImpl->transceiver(ipv4);
+    return pImpl->setcheck(t, id32s, values, retries, waitbeforecheck, timeout);
+}
+
+bool eth::theNVmanager::setcheck(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries, double waitbeforecheck, double timeout)
+{
+    return pImpl->setcheck(t, id32s, values, retries, waitbeforecheck, timeout);
+}
+
 bool eth::theNVmanager::onarrival(const ropCode ropcode, const eOprotIP_t ipv4, const eOprotID32_t id32, const std::uint32_t signature)
 {
     return pImpl->onarrival(ropcode, ipv4, id32, signature);
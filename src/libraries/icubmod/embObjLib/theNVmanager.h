@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <cstdint>
+#include <future>
 
 #include "EoProtocol.h"
 #include <hostTransceiver.hpp>
@@ -97,6 +98,18 @@ namespace eth {
         bool ask(const eOprotIP_t ipv4, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout = 0.5);
         bool ask(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout = 0.5);
 
+        // it sends the ask<> ROPs for many network variables of the same board and returns without waiting. the future becomes true
+        // when all the replies are copied into values, or false after timeout seconds. values must stay valid until the future is ready.
+        // many boards can be asked at the same time in this way. the bytes of the replies in flight from a board are bounded by a
+        // window (1024 by default, or NVMANAGER_ASK_WINDOW) and the function waits for some replies if the window is full.
+        std::future<bool> ask_async(const eOprotIP_t ipv4, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout = 0.5);
+        std::future<bool> ask_async(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const double timeout = 0.5);
+
+        // it sends set<> ROPs to many variables of the same board and it checks them all together with ask_async(). the variables which
+        // are not verified are set and checked again, at most retries + 1 times.
+        bool setcheck(const eOprotIP_t ipv4, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries = 10, double waitbeforecheck = 0.001, double timeout = 0.5);
+        bool setcheck(eth::HostTransceiver *t, const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values, const unsigned int retries = 10, double waitbeforecheck = 0.001, double timeout = 0.5);
+
 
         // tobedone: i want to group several requests before i start to wait.
         // i need:
@@ -124,6 +137,8 @@ namespace eth {
         theNVmanager(); 
 
     public:
+        ~theNVmanager();
+
         // remove copy constructors and copy assignment operators
         theNVmanager(const theNVmanager&) = delete;
         theNVmanager(theNVmanager&) = delete;
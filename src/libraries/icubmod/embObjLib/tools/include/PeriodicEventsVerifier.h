@@ -62,11 +62,12 @@ class Tools::Emb_PeriodicEventVerifier
      * \param max is the maximum period you expected [expressed in seconds].
      * \param step is the step of the histogram. [expressed in seconds].
      * \param reportPeriod the class prints the histogram every @reportPeriod seconds. [expressed in seconds].
+     * \param name is the label of the printed histogram (e.g. RX or TX).
      * \return true/false on success/failure.
      *
      * \note the number of histogram columns are: ((@max-@min)/@step ) +2 
      */
-        bool init(double period, double tolerance, double min, double max, double step, double reportPeriod);
+        bool init(double period, double tolerance, double min, double max, double step, double reportPeriod, const char *name = "RX");
         
         
     /*!
@@ -15,6 +15,7 @@
 
 #include "../include/PeriodicEventsVerifier.h"
 #include "embot_tools.h"
+#include <string>
 #include <yarp/os/LogStream.h>
 
 
@@ -30,6 +31,7 @@ struct Tools::Emb_PeriodicEventVerifier::Impl
 {
 
     embot::tools::PeriodValidator m_perVal;
+    std::string m_name;
 
 
     Impl()
@@ -37,8 +39,10 @@ struct Tools::Emb_PeriodicEventVerifier::Impl
 
     }
 
-    bool init(double period, double tolerance, double min, double max, double step, double reportPeriod)
+    bool init(double period, double tolerance, double min, double max, double step, double reportPeriod, const char *name)
     {
+        m_name = (NULL != name) ? name : "";
+
         // now transform each parameter expressed in seconds to microseconds
         uint64_t period_us=period*1000000;
         uint64_t tolerance_us=tolerance*1000000;
@@ -56,7 +60,7 @@ struct Tools::Emb_PeriodicEventVerifier::Impl
     void tick(double currentTime)
     {
         
-        uint64_t tnow = static_cast<std::uint64_t>(currentTime);
+        uint64_t tnow = static_cast<std::uint64_t>(1000000.0*currentTime);
         uint64_t delta = 0;
         m_perVal.tick(tnow, delta);
         if(true == m_perVal.report())
@@ -65,15 +69,15 @@ struct Tools::Emb_PeriodicEventVerifier::Impl
             m_perVal.histogram()->probabilitydensityfunction(vect_prob);
             uint32_t min = m_perVal.histogram()->getconfig()->min;
             uint32_t step = m_perVal.histogram()->getconfig()->step;
-            yWarning() << "---------- PRINT HISTO RECEIVER ---------------";
+            yWarning() << "---------- PRINT HISTO" << m_name << "---------------";
             for(int i=0; i<vect_prob.size(); i++)
             {
                 if(vect_prob[i]==0)
                     continue;
 
-                yWarning() << "-- histo RX [" << min+step*i << "]="<< vect_prob[i];
+                yWarning() << "-- histo" << m_name << "[" << min+step*i << "]="<< vect_prob[i];
             }
-            yWarning() << "---------- END PRINT HISTO RECEIVER ---------------";
+            yWarning() << "---------- END PRINT HISTO" << m_name << "---------------";
             m_perVal.reset();
         }
 
@@ -149,18 +153,10 @@ Tools::Emb_PeriodicEventVerifier::~Emb_PeriodicEventVerifier()
 }
 
 
-bool Tools::Emb_PeriodicEventVerifier::init(double period, double tolerance, double min, double max, double step, double reportPeriod)
+bool Tools::Emb_PeriodicEventVerifier::init(double period, double tolerance, double min, double max, double step, double reportPeriod, const char *name)
 {
-    // now transform each parameter expressed in seconds to microseconds
-    uint64_t period_us=period*1000000;
-    uint64_t tolerance_us=tolerance*1000000;
-    uint64_t min_us=min*1000000;
-    uint64_t max_us=max*1000000;
-    uint64_t step_us=step*1000000;
-    uint64_t reportPeriod_us=reportPeriod*1000000;
-    
-    
-    return pImpl->init(period_us, tolerance_us, min_us, max_us, step_us, reportPeriod_us);
+    // the parameters are transformed from seconds to microseconds by the Impl
+    return pImpl->init(period, tolerance, min, max, step, reportPeriod, name);
 }
 
 void Tools::Emb_PeriodicEventVerifier::tick(double currentTime)
@@ -134,6 +134,24 @@ bool embObjMotionControl::alloc(int nj)
     _axesInfo.resize(nj);
     _jointEncs.resize(nj);
     _motorEncs.resize(nj);
+
+    // the snapshot keeps its destinations fixed, so that refreshing it does not allocate
+    _snapshot.jcore.resize(nj);
+    _snapshot.mbasic.resize(nj);
+    _snapshot.jcoreIDs.resize(nj);
+    _snapshot.jcorePtrs.resize(nj);
+    _snapshot.mbasicIDs.resize(nj);
+    _snapshot.mbasicPtrs.resize(nj);
+    for(int j=0; j<nj; j++)
+    {
+        _snapshot.jcoreIDs[j] = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, j, eoprot_tag_mc_joint_status_core);
+        _snapshot.jcorePtrs[j] = &_snapshot.jcore[j];
+        _snapshot.mbasicIDs[j] = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_status_basic);
+        _snapshot.mbasicPtrs[j] = &_snapshot.mbasic[j];
+    }
+    _snapshot.reads = 0;
+    _snapshot.nvlocks = 0;
+    _snapshot.rxlocks = 0;
     
     //debug purpose
 
@@ -250,6 +268,10 @@ embObjMotionControl::embObjMotionControl() :
     _calibrated       = NULL;
     _last_position_move_time = NULL;
 
+    _snapshot.reads   = 0;
+    _snapshot.nvlocks = 0;
+    _snapshot.rxlocks = 0;
+
     behFlags.useRawEncoderData = false;
     behFlags.pwmIsLimited     = false;
 
@@ -1185,12 +1207,20 @@ bool embObjMotionControl::init()
     //////////////////////////////////////////
     // invia la configurazione dei GIUNTI   //
     //////////////////////////////////////////
+
+    // the configurations of all the joints and of all the motors are sent together and then verified all together with
+    // asynchronous asks, so that we dont pay a round trip to the board for every single one of them
+    std::vector<eOmc_joint_config_t> jconfigs(_njoints);
+    std::vector<eOmc_motor_config_t> motorconfigs(_njoints);
+    std::vector<eOprotID32_t> configids;
+    std::vector<void*> configvalues;
+
     for(int logico=0; logico< _njoints; logico++)
     {
         int fisico = _axisMap[logico];
         protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, fisico, eoprot_tag_mc_joint_config);
 
-        eOmc_joint_config_t jconfig = {0};
+        eOmc_joint_config_t &jconfig = jconfigs[logico];
         memset(&jconfig, 0, sizeof(eOmc_joint_config_t));
         yarp::dev::Pid tmp; 
         tmp = _measureConverter->convert_pid_to_machine(yarp::dev::VOCAB_PIDTYPE_POSITION,_trj_pids[logico].pid, fisico);
@@ -1234,19 +1264,8 @@ bool embObjMotionControl::init()
 
         jconfig.tcfiltertype=_trq_pids[logico].filterType;
 
-
-        if(false == res->setcheckRemoteValue(protid, &jconfig, 10, 0.010, 0.050))
-        {
-            yError() << "FATAL: embObjMotionControl::init() had an error while calling setcheckRemoteValue() for joint config fisico #" << fisico << "in "<< getBoardInfo();
-            return false;
-        }
-        else
-        {
-            if(behFlags.verbosewhenok)
-            {
-                yDebug() << "embObjMotionControl::init() correctly configured joint config fisico #" << fisico << "in "<< getBoardInfo();
-            }
-        }
+        configids.push_back(protid);
+        configvalues.push_back(&jconfig);
     }
 
     //////////////////////////////////////////
@@ -1259,7 +1278,8 @@ bool embObjMotionControl::init()
         int fisico = _axisMap[logico];
 
         protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, fisico, eoprot_tag_mc_motor_config);
-        eOmc_motor_config_t motor_cfg = {0};
+        eOmc_motor_config_t &motor_cfg = motorconfigs[logico];
+        memset(&motor_cfg, 0, sizeof(eOmc_motor_config_t));
         motor_cfg.maxvelocityofmotor = 0;//_maxMotorVelocity[logico]; //unused yet!
         motor_cfg.currentLimits.nominalCurrent = _currentLimits[logico].nominalCurrent;
         motor_cfg.currentLimits.overloadCurrent = _currentLimits[logico].overloadCurrent;
@@ -1287,17 +1307,20 @@ bool embObjMotionControl::init()
         tmp = _measureConverter->convert_pid_to_machine(yarp::dev::VOCAB_PIDTYPE_VELOCITY, _spd_pids[logico].pid, fisico);
         copyPid_iCub2eo(&tmp, &motor_cfg.pidspeed);
 
-        if (false == res->setcheckRemoteValue(protid, &motor_cfg, 10, 0.010, 0.050))
-        {
-            yError() << "FATAL: embObjMotionControl::init() had an error while calling setcheckRemoteValue() for motor config fisico #" << fisico << "in "<< getBoardInfo(); 
-            return false;
-        }
-        else
+        configids.push_back(protid);
+        configvalues.push_back(&motor_cfg);
+    }
+
+    if(false == res->setcheckRemoteValues(configids, configvalues, 10, 0.010, 0.050))
+    {
+        yError() << "FATAL: embObjMotionControl::init() had an error while calling setcheckRemoteValues() for joint and motor configs in "<< getBoardInfo();
+        return false;
+    }
+    else
+    {
+        if(behFlags.verbosewhenok)
         {
-            if (behFlags.verbosewhenok)
-            {
-                yDebug() << "embObjMotionControl::init() correctly configured motor config fisico #" << fisico << "in "<< getBoardInfo();
-            }
+            yDebug() << "embObjMotionControl::init() correctly configured" << _njoints << "joint configs and" << _njoints << "motor configs in "<< getBoardInfo();
         }
     }
 
@@ -1337,6 +1360,12 @@ bool embObjMotionControl::close()
 
     if (_measureConverter)  {delete _measureConverter; _measureConverter=0;}
 
+    if(behFlags.verbosewhenok && (_snapshot.reads > 0))
+    {
+        yDebug() << "embObjMotionControl::close() served the multi-joint getters of" << getBoardInfo() << "with" << _snapshot.reads << "snapshots, which took"
+                 << _snapshot.nvlocks << "acquisitions of the NV locks and" << _snapshot.rxlocks << "of the reception lock";
+    }
+
     // in cleanup, at date of 23feb2016 there is a call to ethManager->releaseResource() which ...
     // send to config all the boards and stops tx and rx treads.
     // thus, in here we cannot call serviceStop(mc) because there will be tx/rx activity only for the first call of ::close().
@@ -2396,22 +2425,30 @@ bool embObjMotionControl::getControlModeRaw(int j, int *v)
 // IControl Mode 2
 bool embObjMotionControl::getControlModesRaw(int* v)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(!readJointsSnapshot())
+        return false;
+
     for(int j=0; j< _njoints; j++)
     {
-        ret = ret && getControlModeRaw(j, &v[j]);
+        v[j] = controlModeStatusConvert_embObj2yarp((eOmc_controlmode_t) _snapshot.jcore[j].modes.controlmodestatus);
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::getControlModesRaw(const int n_joint, const int *joints, int *modes)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    if(!readJointsSnapshot())
+        return false;
+
     for(int j=0; j< n_joint; j++)
     {
-        ret = ret && getControlModeRaw(joints[j], &modes[j]);
+        if((joints[j] < 0) || (joints[j] >= _njoints))
+            return false;
+        modes[j] = controlModeStatusConvert_embObj2yarp((eOmc_controlmode_t) _snapshot.jcore[joints[j]].modes.controlmodestatus);
     }
-    return ret;
+    return true;
 }
 
 
@@ -2557,6 +2594,30 @@ bool embObjMotionControl::resetEncodersRaw()
     return NOT_YET_IMPLEMENTED("resetEncoders");
 }
 
+bool embObjMotionControl::readSnapshot(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values)
+{
+    // the counters of the transceiver are per thread, so they measure only the acquisitions of this read
+    uint64_t nvlocks = eth::HostTransceiver::getNVlockCount();
+    uint64_t rxlocks = eth::HostTransceiver::getRXlockCount();
+
+    bool ret = res->getLocalValues(id32s, values);
+
+    _snapshot.reads++;
+    _snapshot.nvlocks += eth::HostTransceiver::getNVlockCount() - nvlocks;
+    _snapshot.rxlocks += eth::HostTransceiver::getRXlockCount() - rxlocks;
+    return ret;
+}
+
+bool embObjMotionControl::readJointsSnapshot(void)
+{
+    return readSnapshot(_snapshot.jcoreIDs, _snapshot.jcorePtrs);
+}
+
+bool embObjMotionControl::readMotorsSnapshot(void)
+{
+    return readSnapshot(_snapshot.mbasicIDs, _snapshot.mbasicPtrs);
+}
+
 bool embObjMotionControl::getEncoderRaw(int j, double *value)
 {
     eOmc_joint_status_core_t core;
@@ -2579,11 +2640,15 @@ bool embObjMotionControl::getEncoderRaw(int j, double *value)
 
 bool embObjMotionControl::getEncodersRaw(double *encs)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    bool ret = readJointsSnapshot();
+    if(!ret)
+    {
+        yError() << "embObjMotionControl while reading encoders";
+    }
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getEncoderRaw(j, &encs[j]);
-
+        encs[j] = ret ? (double) _snapshot.jcore[j].measures.meas_position : 0;
     }
     return ret;
 }
@@ -2604,10 +2669,11 @@ bool embObjMotionControl::getEncoderSpeedRaw(int j, double *sp)
 
 bool embObjMotionControl::getEncoderSpeedsRaw(double *spds)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    bool ret = readJointsSnapshot();
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getEncoderSpeedRaw(j, &spds[j]);
+        spds[j] = ret ? (double) _snapshot.jcore[j].measures.meas_velocity : 0;
     }
     return ret;
 }
@@ -2627,10 +2693,11 @@ bool embObjMotionControl::getEncoderAccelerationRaw(int j, double *acc)
 
 bool embObjMotionControl::getEncoderAccelerationsRaw(double *accs)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    bool ret = readJointsSnapshot();
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getEncoderAccelerationRaw(j, &accs[j]);
+        accs[j] = ret ? (double) _snapshot.jcore[j].measures.meas_acceleration : 0;
     }
     return ret;
 }
@@ -2713,11 +2780,15 @@ bool embObjMotionControl::getMotorEncoderRaw(int m, double *value)
 
 bool embObjMotionControl::getMotorEncodersRaw(double *encs)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    bool ret = readMotorsSnapshot();
+    if(!ret)
+    {
+        yError() << "embObjMotionControl while reading motor encoders position";
+    }
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getMotorEncoderRaw(j, &encs[j]);
-
+        encs[j] = ret ? (double) _snapshot.mbasic[j].mot_position : 0;
     }
     return ret;
 }
@@ -2741,12 +2812,17 @@ bool embObjMotionControl::getMotorEncoderSpeedRaw(int m, double *sp)
 
 bool embObjMotionControl::getMotorEncoderSpeedsRaw(double *spds)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    bool ret = readMotorsSnapshot();
+    if(!ret)
+    {
+        yError() << "embObjMotionControl while reading motor encoders speed";
+    }
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getMotorEncoderSpeedRaw(j, &spds[j]);
+        spds[j] = ret ? (double) _snapshot.mbasic[j].mot_velocity : 0;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::getMotorEncoderAccelerationRaw(int m, double *acc)
@@ -2768,12 +2844,17 @@ bool embObjMotionControl::getMotorEncoderAccelerationRaw(int m, double *acc)
 
 bool embObjMotionControl::getMotorEncoderAccelerationsRaw(double *accs)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    bool ret = readMotorsSnapshot();
+    if(!ret)
+    {
+        yError() << "embObjMotionControl while reading motor encoders acceleration";
+    }
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getMotorEncoderAccelerationRaw(j, &accs[j]);
+        accs[j] = ret ? (double) _snapshot.mbasic[j].mot_acceleration : 0;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::getMotorEncodersTimedRaw(double *encs, double *stamps)
@@ -2818,12 +2899,13 @@ bool embObjMotionControl::getCurrentRaw(int j, double *value)
 
 bool embObjMotionControl::getCurrentsRaw(double *vals)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    readMotorsSnapshot();
     for(int j=0; j< _njoints; j++)
     {
-        ret &= getCurrentRaw(j, &vals[j]);
+        vals[j] = (double) _snapshot.mbasic[j].mot_current;
     }
-    return ret;
+    return true;
 }
 
 bool embObjMotionControl::setMaxCurrentRaw(int j, double val)
@@ -2863,6 +2945,19 @@ bool embObjMotionControl::getMaxCurrentRaw(int j, double *val)
     return true;
 }
 
+bool embObjMotionControl::getMaxCurrentsRaw(double *val)
+{
+    std::vector <eOmc_current_limits_params_t> limits_list(_njoints);
+    if(! askRemoteValues<eOmc_current_limits_params_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config_currentlimits, limits_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        val[j] = (double) limits_list[j].overloadCurrent;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getAmpStatusRaw(int j, int *st)
 {
  //VALE: can i set this func like deprecated? none sets _enabledAmp!!
@@ -2929,6 +3024,20 @@ bool embObjMotionControl::getLimitsRaw(int j, double *min, double *max)
     return true;
 }
 
+bool embObjMotionControl::getLimitsRaw(double *min, double *max)
+{
+    std::vector <eOmeas_position_limits_t> limits_list(_njoints);
+    if(! askRemoteValues<eOmeas_position_limits_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, eoprot_tag_mc_joint_config_userlimits, limits_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        min[j] = (double)limits_list[j].min + SAFETY_THRESHOLD;
+        max[j] = (double)limits_list[j].max - SAFETY_THRESHOLD;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getGearboxRatioRaw(int j, double *gearbox)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -2943,6 +3052,19 @@ bool embObjMotionControl::getGearboxRatioRaw(int j, double *gearbox)
     return true;
 }
 
+bool embObjMotionControl::getGearboxRatiosRaw(double *gearbox)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        gearbox[j] = (double)motor_cfg_list[j].gearbox_M2J;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getRotorLimitsRaw(int j, double *rotorMin, double *rotorMax)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -2955,6 +3077,20 @@ bool embObjMotionControl::getRotorLimitsRaw(int j, double *rotorMin, double *rot
     return true;
 }
 
+bool embObjMotionControl::getRotorLimitsRaw(double *rotorMin, double *rotorMax)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        rotorMax[j] = (double)( motor_cfg_list[j].limitsofrotor.max);
+        rotorMin[j] = (double)( motor_cfg_list[j].limitsofrotor.min);
+    }
+    return true;
+}
+
 bool embObjMotionControl::getTorqueControlFilterType(int j, int& type)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, j, eoprot_tag_mc_joint_config);
@@ -2968,6 +3104,19 @@ bool embObjMotionControl::getTorqueControlFilterType(int j, int& type)
     return true;
 }
 
+bool embObjMotionControl::getTorqueControlFilterTypes(int *type)
+{
+    std::vector <eOmc_joint_config_t> joint_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_joint_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, eoprot_tag_mc_joint_config, joint_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        type[j] = (int)joint_cfg_list[j].tcfiltertype;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getRotorEncoderResolutionRaw(int j, double &rotres)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -2982,6 +3131,19 @@ bool embObjMotionControl::getRotorEncoderResolutionRaw(int j, double &rotres)
     return true;
 }
 
+bool embObjMotionControl::getRotorEncoderResolutionsRaw(double *rotres)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        rotres[j] = (double)motor_cfg_list[j].rotorEncoderResolution;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getJointEncoderResolutionRaw(int j, double &jntres)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, j, eoprot_tag_mc_joint_config);
@@ -2996,6 +3158,19 @@ bool embObjMotionControl::getJointEncoderResolutionRaw(int j, double &jntres)
     return true;
 }
 
+bool embObjMotionControl::getJointEncoderResolutionsRaw(double *jntres)
+{
+    std::vector <eOmc_joint_config_t> joint_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_joint_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, eoprot_tag_mc_joint_config, joint_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        jntres[j] = (double)joint_cfg_list[j].jntEncoderResolution;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getJointEncoderTypeRaw(int j, int &type)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, j, eoprot_tag_mc_joint_config);
@@ -3010,6 +3185,19 @@ bool embObjMotionControl::getJointEncoderTypeRaw(int j, int &type)
     return true;
 }
 
+bool embObjMotionControl::getJointEncoderTypesRaw(int *type)
+{
+    std::vector <eOmc_joint_config_t> joint_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_joint_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, eoprot_tag_mc_joint_config, joint_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        type[j] = (int)joint_cfg_list[j].jntEncoderType;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getRotorEncoderTypeRaw(int j, int &type)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -3024,6 +3212,19 @@ bool embObjMotionControl::getRotorEncoderTypeRaw(int j, int &type)
     return true;
 }
 
+bool embObjMotionControl::getRotorEncoderTypesRaw(int *type)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        type[j] = (int)motor_cfg_list[j].rotorEncoderType;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getKinematicMJRaw(int j, double &rotres)
 {
     yError("getKinematicMJRaw not yet  implemented");
@@ -3044,6 +3245,19 @@ bool embObjMotionControl::getHasTempSensorsRaw(int j, int& ret)
     return true;
 }
 
+bool embObjMotionControl::getHasTempSensorsRaw(int *ret)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        ret[j] = (int)motor_cfg_list[j].hasTempSensor;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getHasHallSensorRaw(int j, int& ret)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -3058,6 +3272,19 @@ bool embObjMotionControl::getHasHallSensorRaw(int j, int& ret)
     return true;
 }
 
+bool embObjMotionControl::getHasHallSensorsRaw(int *ret)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        ret[j] = (int)motor_cfg_list[j].hasHallSensor;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getHasRotorEncoderRaw(int j, int& ret)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -3072,6 +3299,19 @@ bool embObjMotionControl::getHasRotorEncoderRaw(int j, int& ret)
     return true;
 }
 
+bool embObjMotionControl::getHasRotorEncodersRaw(int *ret)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        ret[j] = (int)motor_cfg_list[j].hasRotorEncoder;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getHasRotorEncoderIndexRaw(int j, int& ret)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -3086,6 +3326,19 @@ bool embObjMotionControl::getHasRotorEncoderIndexRaw(int j, int& ret)
     return true;
 }
 
+bool embObjMotionControl::getHasRotorEncoderIndexesRaw(int *ret)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        ret[j] = (int)motor_cfg_list[j].hasRotorEncoderIndex;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getMotorPolesRaw(int j, int& poles)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -3101,6 +3354,19 @@ bool embObjMotionControl::getMotorPolesRaw(int j, int& poles)
     return true;
 }
 
+bool embObjMotionControl::getMotorPolesRaw(int *poles)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        poles[j] = (int)motor_cfg_list[j].motorPoles;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getRotorIndexOffsetRaw(int j, double& rotorOffset)
 {
     eOprotID32_t protoid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, j, eoprot_tag_mc_motor_config);
@@ -3115,6 +3381,19 @@ bool embObjMotionControl::getRotorIndexOffsetRaw(int j, double& rotorOffset)
     return true;
 }
 
+bool embObjMotionControl::getRotorIndexOffsetsRaw(double *rotorOffset)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        rotorOffset[j] = (double)motor_cfg_list[j].rotorIndexOffset;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getAxisNameRaw(int axis, std::string& name)
 {
     if (axis >= 0 && axis < _njoints)
@@ -3156,6 +3435,19 @@ bool embObjMotionControl::getJointDeadZoneRaw(int j, double &jntDeadZone)
     return true;
 }
 
+bool embObjMotionControl::getJointDeadZonesRaw(double *jntDeadZone)
+{
+    std::vector <eOmc_joint_config_t> joint_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_joint_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, eoprot_tag_mc_joint_config, joint_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        jntDeadZone[j] = _measureConverter->posE2A((double)joint_cfg_list[j].deadzone, _axisMap[j]);
+    }
+    return true;
+}
+
 // IRemoteVariables
 bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle& val)
 {
@@ -3191,80 +3483,95 @@ bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle
     }
     else if (key == "rotorEncoderResolution")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getRotorEncoderResolutionRaw(i, tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getRotorEncoderResolutionsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "jointEncoderResolution")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getJointEncoderResolutionRaw(i, tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getJointEncoderResolutionsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "gearbox_M2J")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp=0; getGearboxRatioRaw(i, &tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getGearboxRatiosRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "gearbox_E2J")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp=0; getGerabox_E2J(i, &tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getGerabox_E2J(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "hasHallSensor")
     {
-        Bottle& r = val.addList(); for (int i = 0; i < _njoints; i++) { int tmp = 0; getHasHallSensorRaw(i, tmp); r.addInt(tmp); }
+        std::vector<int> tmp(_njoints); if (!getHasHallSensorsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addInt(tmp[i]); }
         return true;
     }
     else if (key == "hasTempSensor")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { int tmp = 0; getHasTempSensorsRaw(i, tmp); r.addInt(tmp); }
+        std::vector<int> tmp(_njoints); if (!getHasTempSensorsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addInt(tmp[i]); }
         return true;
     }
     else if (key == "hasRotorEncoder")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { int tmp = 0; getHasRotorEncoderRaw(i, tmp); r.addInt(tmp); }
+        std::vector<int> tmp(_njoints); if (!getHasRotorEncodersRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addInt(tmp[i]); }
         return true;
     }
     else if (key == "hasRotorEncoderIndex")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { int tmp = 0; getHasRotorEncoderIndexRaw(i, tmp); r.addInt(tmp); }
+        std::vector<int> tmp(_njoints); if (!getHasRotorEncoderIndexesRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addInt(tmp[i]); }
         return true;
     }
     else if (key == "rotorIndexOffset")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getRotorIndexOffsetRaw(i, tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getRotorIndexOffsetsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "motorPoles")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { int tmp = 0; getMotorPolesRaw(i, tmp); r.addInt(tmp); }
+        std::vector<int> tmp(_njoints); if (!getMotorPolesRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addInt(tmp[i]); }
         return true;
     }
     else if (key == "pidCurrentKp")
     {
-        Bottle& r = val.addList(); for (int i = 0; i < _njoints; i++) { Pid p; getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_CURRENT, i, &p); r.addDouble(p.kp); }
+        std::vector<Pid> pids(_njoints); if (!helper_getCurPidsRaw(pids.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(pids[i].kp); }
         return true;
     }
     else if (key == "pidCurrentKi")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { Pid p; getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_CURRENT, i, &p); r.addDouble(p.ki); }
+        std::vector<Pid> pids(_njoints); if (!helper_getCurPidsRaw(pids.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(pids[i].ki); }
         return true;
     }
     else if (key == "pidCurrentShift")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++)  { Pid p; getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_CURRENT, i, &p); r.addDouble(p.scale); }
+        std::vector<Pid> pids(_njoints); if (!helper_getCurPidsRaw(pids.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(pids[i].scale); }
         return true;
     }
     else if (key == "pidCurrentOutput")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++)  { Pid p; getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_CURRENT, i, &p); r.addDouble(p.max_output); }
+        std::vector<Pid> pids(_njoints); if (!helper_getCurPidsRaw(pids.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(pids[i].max_output); }
         return true;
     }
     else if (key == "jointEncoderType")
     {
+        std::vector<int> t(_njoints); if (!getJointEncoderTypesRaw(t.data())) return false;
         Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++)
         {
-            int t; string s;
-            getJointEncoderTypeRaw(i, t); uint8_t tt = t; bool b = EncoderType_eo2iCub(&tt, &s);
+            string s;
+            uint8_t tt = t[i]; bool b = EncoderType_eo2iCub(&tt, &s);
             if (b == false)
             {
                 yError("Invalid jointEncoderType");
@@ -3275,10 +3582,11 @@ bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle
     }
     else if (key == "rotorEncoderType")
     {
+        std::vector<int> t(_njoints); if (!getRotorEncoderTypesRaw(t.data())) return false;
         Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++)
         {
-            int t; string s;
-            getRotorEncoderTypeRaw(i, t); uint8_t tt = t; bool b = EncoderType_eo2iCub(&tt, &s);
+            string s;
+            uint8_t tt = t[i]; bool b = EncoderType_eo2iCub(&tt, &s);
             if (b == false)
             {
                 yError("Invalid motorEncoderType");
@@ -3294,7 +3602,8 @@ bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle
     }
     else if (key == "torqueControlFilterType")
     {
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++)  { int t; getTorqueControlFilterType(i, t); r.addDouble(t); }
+        std::vector<int> t(_njoints); if (!getTorqueControlFilterTypes(t.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++)  { r.addDouble(t[i]); }
         return true;
     }
     else if (key == "torqueControlEnabled")
@@ -3309,77 +3618,83 @@ bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle
     }
     else if (key == "PWMLimit")
     {
-        Bottle& r = val.addList(); for (int i = 0; i< _njoints; i++) { double tmp = 0; getPWMLimitRaw(i, &tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getPWMLimitsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "motOverloadCurr")
     {
-        Bottle& r = val.addList(); for (int i = 0; i< _njoints; i++) { double tmp = 0; getMaxCurrentRaw(i, &tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getMaxCurrentsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "motNominalCurr")
     {
-        Bottle& r = val.addList(); for (int i = 0; i< _njoints; i++) { double tmp = 0; getNominalCurrentRaw(i, &tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getNominalCurrentsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "motPeakCurr")
     {
-        Bottle& r = val.addList(); for (int i = 0; i< _njoints; i++) { double tmp = 0; getPeakCurrentRaw(i, &tmp);  r.addDouble(tmp); }
+        std::vector<double> tmp(_njoints); if (!getPeakCurrentsRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "PowerSuppVoltage")
     {
-        Bottle& r = val.addList(); for (int i = 0; i< _njoints; i++) { double tmp = 0; getPowerSupplyVoltageRaw(i, &tmp);  r.addDouble(tmp); }
+        // the supply voltage is a status of the controller, the same for all the motors of the board
+        double tmp = 0; getPowerSupplyVoltageRaw(0, &tmp);
+        Bottle& r = val.addList(); for (int i = 0; i< _njoints; i++) { r.addDouble(tmp); }
         return true;
     }
     else if (key == "rotorMax")
     {
-        double tmp1, tmp2;
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getRotorLimitsRaw(i, &tmp1, &tmp2);  r.addDouble(tmp2); }
+        std::vector<double> tmp1(_njoints), tmp2(_njoints); if (!getRotorLimitsRaw(tmp1.data(), tmp2.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp2[i]); }
         return true;
     }
     else if (key == "rotorMin")
     {
-        double tmp1, tmp2;
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getRotorLimitsRaw(i, &tmp1, &tmp2);  r.addDouble(tmp1); }
+        std::vector<double> tmp1(_njoints), tmp2(_njoints); if (!getRotorLimitsRaw(tmp1.data(), tmp2.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp1[i]); }
         return true;
     }
     else if (key == "jointMax")
     {
-        double tmp1, tmp2;
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getLimitsRaw(i, &tmp1, &tmp2);  r.addDouble(tmp2); }
+        std::vector<double> tmp1(_njoints), tmp2(_njoints); if (!getLimitsRaw(tmp1.data(), tmp2.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp2[i]); }
         return true;
     }
     else if (key == "jointMin")
     {
-        double tmp1, tmp2;
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getLimitsRaw(i, &tmp1, &tmp2);  r.addDouble(tmp1); }
+        std::vector<double> tmp1(_njoints), tmp2(_njoints); if (!getLimitsRaw(tmp1.data(), tmp2.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp1[i]); }
         return true;
     }
     else if (key == "jointEncTolerance")
     {
-        double tmp1;
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getJointEncTolerance(i, &tmp1);  r.addDouble(tmp1); }
+        std::vector<double> tmp(_njoints); if (!getJointEncTolerance(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "motorEncTolerance")
     {
-        double tmp1;
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getMotorEncTolerance(i, &tmp1);  r.addDouble(tmp1); }
+        std::vector<double> tmp(_njoints); if (!getMotorEncTolerance(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "jointDeadZone")
     {
-        double tmp1;
-        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { double tmp = 0; getJointDeadZoneRaw(i, tmp1);  r.addDouble(tmp1); }
+        std::vector<double> tmp(_njoints); if (!getJointDeadZonesRaw(tmp.data())) return false;
+        Bottle& r = val.addList(); for (int i = 0; i<_njoints; i++) { r.addDouble(tmp[i]); }
         return true;
     }
     else if (key == "readonly_position_PIDraw")
     {
+        std::vector<Pid> pids(_njoints); getPidsRaw(PidControlTypeEnum::VOCAB_PIDTYPE_POSITION, pids.data());
         Bottle& r = val.addList();
         for (int i = 0; i < _njoints; i++)
-        { Pid p;
-          getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_POSITION, i, &p);
+        { Pid &p = pids[i];
           char buff[1000];
           snprintf(buff, 1000, "J %d : kp %+3.3f ki %+3.3f kd %+3.3f maxint %+3.3f maxout %+3.3f off %+3.3f scale %+3.3f up %+3.3f dwn %+3.3f kff %+3.3f", i, p.kp, p.ki, p.kd, p.max_int, p.max_output, p.offset, p.scale, p.stiction_up_val, p.stiction_down_val, p.kff);
           r.addString(buff);
@@ -3388,9 +3703,10 @@ bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle
     }
     else if (key == "readonly_velocity_PIDraw")
     {
+        std::vector<Pid> pids(_njoints); getPidsRaw(PidControlTypeEnum::VOCAB_PIDTYPE_VELOCITY, pids.data());
         Bottle& r = val.addList();
         for (int i = 0; i < _njoints; i++)
-        { Pid p; getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_VELOCITY, i, &p);
+        { Pid &p = pids[i];
           char buff[1000];
           snprintf(buff, 1000, "J %d : kp %+3.3f ki %+3.3f kd %+3.3f maxint %+3.3f maxout %+3.3f off %+3.3f scale %+3.3f up %+3.3f dwn %+3.3f kff %+3.3f", i, p.kp, p.ki, p.kd, p.max_int, p.max_output, p.offset, p.scale, p.stiction_up_val, p.stiction_down_val, p.kff);
           r.addString(buff);
@@ -3399,9 +3715,10 @@ bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle
     }
     else if (key == "readonly_torque_PIDraw")
     {
+        std::vector<Pid> pids(_njoints); getPidsRaw(PidControlTypeEnum::VOCAB_PIDTYPE_TORQUE, pids.data());
         Bottle& r = val.addList();
         for (int i = 0; i < _njoints; i++)
-        { Pid p; getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_TORQUE, i, &p);
+        { Pid &p = pids[i];
          char buff[1000];
          snprintf(buff, 1000, "J %d : kp %+3.3f ki %+3.3f kd %+3.3f maxint %+3.3f maxout %+3.3f off %+3.3f scale %+3.3f up %+3.3f dwn %+3.3f kff %+3.3f", i, p.kp, p.ki, p.kd, p.max_int, p.max_output, p.offset, p.scale, p.stiction_up_val, p.stiction_down_val, p.kff);
          r.addString(buff);
@@ -3410,9 +3727,10 @@ bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle
     }
     else if (key == "readonly_current_PIDraw")
     {
+        std::vector<Pid> pids(_njoints); getPidsRaw(PidControlTypeEnum::VOCAB_PIDTYPE_CURRENT, pids.data());
         Bottle& r = val.addList();
         for (int i = 0; i < _njoints; i++)
-        { Pid p; getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_CURRENT, i, &p);
+        { Pid &p = pids[i];
          char buff[1000];
          snprintf(buff, 1000, "J %d : kp %+3.3f ki %+3.3f kd %+3.3f maxint %+3.3f maxout %+3.3f off %+3.3f scale %+3.3f up %+3.3f dwn %+3.3f kff %+3.3f", i, p.kp, p.ki, p.kd, p.max_int, p.max_output, p.offset, p.scale, p.stiction_up_val, p.stiction_down_val, p.kff);
          r.addString(buff);
@@ -3421,10 +3739,11 @@ bool embObjMotionControl::getRemoteVariableRaw(std::string key, yarp::os::Bottle
     }
     else if (key == "readonly_llspeed_PIDraw")
     {
+        std::vector<Pid> pids(_njoints); getPidsRaw(PidControlTypeEnum::VOCAB_PIDTYPE_VELOCITY, pids.data());
         Bottle& r = val.addList();
         for (int i = 0; i < _njoints; i++)
         {
-            Pid p; getPidRaw(PidControlTypeEnum::VOCAB_PIDTYPE_VELOCITY, i, &p);
+            Pid &p = pids[i];
             char buff[1000];
             snprintf(buff, 1000, "J %d : kp %+3.3f ki %+3.3f kd %+3.3f maxint %+3.3f maxout %+3.3f off %+3.3f scale %+3.3f up %+3.3f dwn %+3.3f kff %+3.3f", i, p.kp, p.ki, p.kd, p.max_int, p.max_output, p.offset, p.scale, p.stiction_up_val, p.stiction_down_val, p.kff);
             r.addString(buff);
@@ -3629,9 +3948,12 @@ bool embObjMotionControl::getTorqueRaw(int j, double *t)
 
 bool embObjMotionControl::getTorquesRaw(double *t)
 {
-    bool ret = true;
+    std::lock_guard<std::mutex> lck(_snapshotMutex);
+    readJointsSnapshot();
     for(int j=0; j<_njoints; j++)
-        ret = ret && getTorqueRaw(j, &t[j]);
+    {
+        t[j] = (double) _measureConverter->trqS2N(_snapshot.jcore[j].measures.meas_torque, j);
+    }
     return true;
 }
 
@@ -4491,6 +4813,19 @@ bool embObjMotionControl::getPeakCurrentRaw(int m, double *val)
     return true;
 }
 
+bool embObjMotionControl::getPeakCurrentsRaw(double *val)
+{
+    std::vector <eOmc_current_limits_params_t> limits_list(_njoints);
+    if(! askRemoteValues<eOmc_current_limits_params_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config_currentlimits, limits_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        val[j] = (double) limits_list[j].peakCurrent;
+    }
+    return true;
+}
+
 bool embObjMotionControl::setPeakCurrentRaw(int m, const double val)
 {
     eOprotID32_t protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, m, eoprot_tag_mc_motor_config_currentlimits);
@@ -4531,6 +4866,19 @@ bool embObjMotionControl::getNominalCurrentRaw(int m, double *val)
     return true;
 }
 
+bool embObjMotionControl::getNominalCurrentsRaw(double *val)
+{
+    std::vector <eOmc_current_limits_params_t> limits_list(_njoints);
+    if(! askRemoteValues<eOmc_current_limits_params_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config_currentlimits, limits_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        val[j] = (double) limits_list[j].nominalCurrent;
+    }
+    return true;
+}
+
 bool embObjMotionControl::setNominalCurrentRaw(int m, const double val)
 {
     eOprotID32_t protid = eoprot_ID_get(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, m, eoprot_tag_mc_motor_config_currentlimits);
@@ -4596,6 +4944,19 @@ bool embObjMotionControl::getPWMLimitRaw(int j, double* val)
     return ret;
 }
 
+bool embObjMotionControl::getPWMLimitsRaw(double *val)
+{
+    std::vector <eOmeas_pwm_t> limits_list(_njoints);
+    if(! askRemoteValues<eOmeas_pwm_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config_pwmlimit, limits_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        val[j] = (double) limits_list[j];
+    }
+    return true;
+}
+
 bool embObjMotionControl::setPWMLimitRaw(int j, const double val)
 {
     if (val < 0)
@@ -5071,6 +5432,19 @@ bool embObjMotionControl::getGerabox_E2J(int joint, double *gearbox_E2J_ptr)
     return true;
 }
 
+bool embObjMotionControl::getGerabox_E2J(double *gearbox_E2J_ptr)
+{
+    std::vector <eOmc_joint_config_t> joint_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_joint_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, eoprot_tag_mc_joint_config, joint_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        gearbox_E2J_ptr[j] = joint_cfg_list[j].gearbox_E2J;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getJointEncTolerance(int joint, double *jEncTolerance_ptr)
 {
     eOmc_joint_config_t jntCfg;
@@ -5084,6 +5458,19 @@ bool embObjMotionControl::getJointEncTolerance(int joint, double *jEncTolerance_
     return true;
 }
 
+bool embObjMotionControl::getJointEncTolerance(double *jEncTolerance_ptr)
+{
+    std::vector <eOmc_joint_config_t> joint_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_joint_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_joint, eoprot_tag_mc_joint_config, joint_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        jEncTolerance_ptr[j] = joint_cfg_list[j].jntEncTolerance;
+    }
+    return true;
+}
+
 bool embObjMotionControl::getMotorEncTolerance(int axis, double *mEncTolerance_ptr)
 {
     eOmc_motor_config_t motorCfg;
@@ -5096,4 +5483,17 @@ bool embObjMotionControl::getMotorEncTolerance(int axis, double *mEncTolerance_p
     return true;
 }
 
+bool embObjMotionControl::getMotorEncTolerance(double *mEncTolerance_ptr)
+{
+    std::vector <eOmc_motor_config_t> motor_cfg_list(_njoints);
+    if(! askRemoteValues<eOmc_motor_config_t>(eoprot_endpoint_motioncontrol, eoprot_entity_mc_motor, eoprot_tag_mc_motor_config, motor_cfg_list))
+        return false;
+
+    for(int j=0; j<_njoints; j++)
+    {
+        mEncTolerance_ptr[j] = motor_cfg_list[j].rotEncTolerance;
+    }
+    return true;
+}
+
 // eof
@@ -100,6 +100,19 @@ typedef struct
     bool pwmIsLimited;          /** set to true if pwm is limited */
 }behaviour_flags_t;
 
+typedef struct
+{
+    std::vector<eOmc_joint_status_core_t>  jcore;       /** copy of the status core of all the joints of the board */
+    std::vector<eOmc_motor_status_basic_t> mbasic;      /** copy of the basic status of all the motors of the board */
+    std::vector<eOprotID32_t>              jcoreIDs;    /** ids of the joint status core, in joint order */
+    std::vector<void*>                     jcorePtrs;   /** destination of each joint status core */
+    std::vector<eOprotID32_t>              mbasicIDs;   /** ids of the motor basic status, in motor order */
+    std::vector<void*>                     mbasicPtrs;  /** destination of each motor basic status */
+    uint64_t                               reads;       /** number of snapshots taken */
+    uint64_t                               nvlocks;     /** acquisitions of the NV locks spent by the snapshots */
+    uint64_t                               rxlocks;     /** acquisitions of the reception lock spent by the snapshots */
+}statusSnapshot_t;
+
 }}};
 
 namespace yarp {
@@ -246,6 +259,8 @@ private:
     double  *_ref_positions;    // used for direct position control.
     double  *_ref_accs;         // for velocity control, in position min jerk eq is used.
     double  *_encodersStamp;                    /** keep information about acquisition time for encoders read */
+    eomc::statusSnapshot_t _snapshot;           /** status of all joints/motors, refreshed in one pass by the multi-joint getters */
+    std::mutex             _snapshotMutex;      /** protects _snapshot */
     bool  *checking_motiondone;                 /* flag telling if I'm already waiting for motion done */
     #define MAX_POSITION_MOVE_INTERVAL 0.080
     double *_last_position_move_time;           /** time stamp for last received position move command*/    
@@ -289,6 +304,30 @@ private:
     void updateDeadZoneWithDefaultValues(void);
     bool getJointDeadZoneRaw(int j, double &jntDeadZone);
 
+    //multi-joint versions of the getters above and below: they ask the variable of all the joints at once
+    bool getLimitsRaw(double *min, double *max);
+    bool getGearboxRatiosRaw(double *gearbox);
+    bool getMaxCurrentsRaw(double *val);
+    bool getPeakCurrentsRaw(double *val);
+    bool getNominalCurrentsRaw(double *val);
+    bool getPWMLimitsRaw(double *val);
+    bool getGerabox_E2J(double *gearbox_E2J_ptr);
+    bool getJointEncTolerance(double *jEncTolerance_ptr);
+    bool getMotorEncTolerance(double *mEncTolerance_ptr);
+    bool getJointDeadZonesRaw(double *jntDeadZone);
+    bool getRotorEncoderResolutionsRaw(double *rotres);
+    bool getJointEncoderResolutionsRaw(double *jntres);
+    bool getJointEncoderTypesRaw(int *type);
+    bool getRotorEncoderTypesRaw(int *type);
+    bool getHasTempSensorsRaw(int *ret);
+    bool getHasHallSensorsRaw(int *ret);
+    bool getHasRotorEncodersRaw(int *ret);
+    bool getHasRotorEncoderIndexesRaw(int *ret);
+    bool getMotorPolesRaw(int *poles);
+    bool getRotorIndexOffsetsRaw(double *rotorOffset);
+    bool getTorqueControlFilterTypes(int *type);
+    bool getRotorLimitsRaw(double *rotorMin, double *rotorMax);
+
 private:
     
     //functions used in init this object
@@ -304,6 +343,11 @@ private:
     //function used in the closing this object
     void cleanup(void);
     
+    //used by the multi-joint getters: they must be called with _snapshotMutex locked
+    bool readJointsSnapshot(void);
+    bool readMotorsSnapshot(void);
+    bool readSnapshot(const std::vector<eOprotID32_t> &id32s, const std::vector<void*> &values);
+
     //used in pid interface
     bool helper_setPosPidRaw( int j, const Pid &pid);
     bool helper_getPosPidRaw(int j, Pid *pid);
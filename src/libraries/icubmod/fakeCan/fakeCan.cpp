@@ -7,6 +7,8 @@
 
 #include "fakeCan.h"
 #include <iostream>
+#include <stdio.h>
+#include <string.h>
 
 #include <yarp/os/Bottle.h>
 #include <yarp/os/Value.h>
@@ -16,7 +18,9 @@ using namespace yarp::dev;
 using namespace yarp::os;
 
 FakeCan::FakeCan()
-{}
+{
+    captureNext=0;
+}
 
 FakeCan::~FakeCan()
 {}
@@ -67,6 +71,19 @@ bool FakeCan::canRead(CanBuffer &msgs,
 
     replies.clear();
     replies.unlock();
+
+    // the rest of the buffer goes to the capture, if any
+    if (!capture.empty())
+    {
+        for (k=l; k<size; k++)
+        {
+            FCMSG *r=reinterpret_cast<FCMSG *>(msgs[k].getPointer());
+            *r=capture[captureNext];
+            if (++captureNext==capture.size())
+                captureNext=0;
+        }
+        *read=size;
+    }
     return true;
 }
 
@@ -105,6 +122,19 @@ bool FakeCan::open(yarp::os::Searchable &par)
     Bottle &can = par.findGroup("CAN");
     Bottle ids=can.findGroup("CanAddresses");
 
+    // period [ms] at which every fake board replies and sends its broadcasts
+    int period=100;
+    if (can.check("FakeBoardPeriod"))
+        period=can.find("FakeBoardPeriod").asInt();
+
+    if (can.check("FakeCanReplay"))
+    {
+        std::string file=can.find("FakeCanReplay").asString();
+        if (!loadCapture(file))
+            return false;
+        fprintf(stderr, "FakeCan: replaying %d frames from %s\n", (int)capture.size(), file.c_str());
+    }
+
     if (ids.size()<njoints/2)
     {
         fprintf(stderr, "Check ini file, wrong number of board ids or joints\n");
@@ -113,7 +143,7 @@ bool FakeCan::open(yarp::os::Searchable &par)
     
     for(int i=1;i<=njoints/2;i++)
     {
-        FakeBoard *tmp=new FakeBoard;
+        FakeBoard *tmp=new FakeBoard(0, period);
         int id=ids.get(i).asInt();
         tmp->setId(id);   //just as a test
         tmp->setReplyFifo(&replies);
@@ -124,6 +154,62 @@ bool FakeCan::open(yarp::os::Searchable &par)
     return true;
 }
 
+bool FakeCan::loadCapture(const std::string &file)
+{
+    FILE *fp=fopen(file.c_str(), "r");
+    if (fp==0)
+    {
+        fprintf(stderr, "FakeCan: cannot open capture %s\n", file.c_str());
+        return false;
+    }
+
+    capture.clear();
+    captureNext=0;
+
+    // (stamp) interface id#data, id and data in hex
+    char line[256];
+    int lineN=0;
+    while (fgets(line, sizeof(line), fp)!=0)
+    {
+        lineN++;
+        char *hash=strchr(line, '#');
+        if (hash==0)
+            continue;
+
+        char *start=hash;
+        while (start>line && *(start-1)!=' ')
+            start--;
+
+        FCMSG m;
+        memset(&m, 0, sizeof(m));
+        unsigned int id=0;
+        *hash=0;
+        if (sscanf(start, "%x", &id)!=1)
+        {
+            fprintf(stderr, "FakeCan: skipping line %d of %s\n", lineN, file.c_str());
+            continue;
+        }
+        m.id=id;
+
+        const char *p=hash+1;
+        unsigned int byte;
+        while (m.len<8 && sscanf(p, "%2x", &byte)==1)
+        {
+            m.data[m.len++]=(unsigned char)byte;
+            p+=2;
+        }
+        capture.push_back(m);
+    }
+    fclose(fp);
+
+    if (capture.empty())
+    {
+        fprintf(stderr, "FakeCan: no frames in capture %s\n", file.c_str());
+        return false;
+    }
+    return true;
+}
+
 bool FakeCan::close()
 {
     cerr<<"Closing FakeCan network" << endl;
@@ -139,6 +225,7 @@ bool FakeCan::close()
     }
 
     boardList.clear();
+    capture.clear();
 
     return true;
 }
@@ -17,6 +17,8 @@
 
 #include <memory.h>
 #include <list>
+#include <vector>
+#include <string>
 
 namespace yarp
 {
@@ -98,6 +100,13 @@ typedef std::list<FakeBoard *>::const_iterator BoardsConstIt;
  * The behavior of the fake boards is very simplified, this module
  * is not simulating a real robot.
  *
+ * With `FakeCanReplay <file>` in the CAN group the bus also replays a
+ * capture in the candump log format (`(stamp) can0 1A1#0102030405060708`,
+ * one frame per line, what `candump -l` writes): every canRead() fills the
+ * space left by the replies of the fake boards with the next frames of the
+ * capture, which starts over at the end. Frames come as fast as they are
+ * read, to measure what a device can decode.
+ *
  * | YARP device name |
  * |:-----------------:|
  * | `fakecan` |
@@ -109,6 +118,11 @@ class yarp::dev::FakeCan: public ImplementCanBufferFactory<FakeCanMessage, FCMSG
 private:
     Boards boardList;
     MsgList replies;
+
+    std::vector<FCMSG> capture;
+    size_t captureNext;
+
+    bool loadCapture(const std::string &file);
 public:
     FakeCan();
     ~FakeCan();
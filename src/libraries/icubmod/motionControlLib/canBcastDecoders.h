@@ -0,0 +1,322 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/*
+ * Copyright (C) 2020 iCub Facility - Istituto Italiano di Tecnologia
+ * CopyPolicy: Released under the terms of the GNU GPL v2.0.
+ *
+ */
+
+#ifndef __CANBCASTDECODERS__
+#define __CANBCASTDECODERS__
+
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <stdint.h>
+
+#include "messages.h"
+
+/**
+ * The joint state carried by the periodic messages of the control boards
+ * (class 1), as a structure of arrays: one row of njoints doubles for each
+ * quantity, all the rows in a single block. A row is what a getter of the
+ * device returns; the getters read it from a JointStateSnapshot.
+ */
+class JointStateBuffer
+{
+public:
+    enum Field
+    {
+        POSITION=0,
+        POSITION_STAMP,
+        ROTOR_POSITION,
+        ROTOR_POSITION_STAMP,
+        ROTOR_SPEED,
+        ROTOR_ACCEL,
+        SPEED,
+        ACCEL,
+        PID_VALUE,
+        CURRENT,
+        POSITION_ERROR,
+        TORQUE_ERROR,
+        TORQUE,
+        NFIELDS
+    };
+
+    JointStateBuffer(int n): njoints(n)
+    {
+        data=new double[NFIELDS*njoints];
+        zero();
+    }
+
+    ~JointStateBuffer()
+    {
+        delete [] data;
+    }
+
+    void zero()
+    { memset(data, 0, bytes()); }
+
+    inline double *row(int field)
+    { return data+field*njoints; }
+
+    inline const double *row(int field) const
+    { return data+field*njoints; }
+
+    inline double *block()
+    { return data; }
+
+    inline const double *block() const
+    { return data; }
+
+    inline size_t bytes() const
+    { return NFIELDS*njoints*sizeof(double); }
+
+    inline int joints() const
+    { return njoints; }
+
+private:
+    JointStateBuffer(const JointStateBuffer&);
+    void operator=(const JointStateBuffer&);
+
+    double *data;
+    int njoints;
+};
+
+/*
+ * Decoders of the periodic messages. Every message carries the same quantities
+ * for the two channels of a board, j is the first joint of the board and second
+ * is false if the board drives a single joint. The layouts below are the ones of
+ * the firmware (see iCubCanProtocol.h), each message gets its decoder at compile
+ * time from the list of its fields.
+ */
+
+// a quantity of type T, at OFFSET0 for the first channel and at OFFSET1 for the second one
+template <int FIELD, typename T, int OFFSET0, int OFFSET1>
+struct BCastPair
+{
+    static inline void decode(const unsigned char *data, int j, bool second, double now, JointStateBuffer &s)
+    {
+        double *row=s.row(FIELD);
+        T v;
+        memcpy(&v, data+OFFSET0, sizeof(T));
+        row[j]=double(v);
+        if (second)
+        {
+            memcpy(&v, data+OFFSET1, sizeof(T));
+            row[j+1]=double(v);
+        }
+    }
+};
+
+// the arrival time of the message, for both the channels
+template <int FIELD>
+struct BCastStamp
+{
+    static inline void decode(const unsigned char *data, int j, bool second, double now, JointStateBuffer &s)
+    {
+        double *row=s.row(FIELD);
+        row[j]=now;
+        if (second)
+            row[j+1]=now;
+    }
+};
+
+template <class... Fields>
+struct BCastLayout
+{
+    static void decode(const unsigned char *data, int j, bool second, double now, JointStateBuffer &s)
+    {
+        int expand[]={ (Fields::decode(data, j, second, now, s), 0)... };
+        (void)expand;
+    }
+};
+
+// only the messages which carry joint state have a layout: status, print
+// and overflow messages are handled one by one by the device.
+template <int MSGTYPE>
+struct BCastMessage;
+
+template <>
+struct BCastMessage<ICUBCANPROTO_PER_MC_MSG__POSITION>:
+    BCastLayout<BCastPair<JointStateBuffer::POSITION, int32_t, 0, 4>,
+                BCastStamp<JointStateBuffer::POSITION_STAMP> >
+{};
+
+template <>
+struct BCastMessage<ICUBCANPROTO_PER_MC_MSG__MOTOR_POSITION>:
+    BCastLayout<BCastPair<JointStateBuffer::ROTOR_POSITION, int32_t, 0, 4>,
+                BCastStamp<JointStateBuffer::ROTOR_POSITION_STAMP> >
+{};
+
+template <>
+struct BCastMessage<ICUBCANPROTO_PER_MC_MSG__MOTOR_SPEED>:
+    BCastLayout<BCastPair<JointStateBuffer::ROTOR_SPEED, int16_t, 0, 2>,
+                BCastPair<JointStateBuffer::ROTOR_ACCEL, int16_t, 4, 6> >
+{};
+
+template <>
+struct BCastMessage<ICUBCANPROTO_PER_MC_MSG__VELOCITY>:
+    BCastLayout<BCastPair<JointStateBuffer::SPEED, int16_t, 0, 2>,
+                BCastPair<JointStateBuffer::ACCEL, int16_t, 4, 6> >
+{};
+
+template <>
+struct BCastMessage<ICUBCANPROTO_PER_MC_MSG__PID_VAL>:
+    BCastLayout<BCastPair<JointStateBuffer::PID_VALUE, int16_t, 0, 2> >
+{};
+
+template <>
+struct BCastMessage<ICUBCANPROTO_PER_MC_MSG__CURRENT>:
+    BCastLayout<BCastPair<JointStateBuffer::CURRENT, int16_t, 0, 2> >
+{};
+
+template <>
+struct BCastMessage<ICUBCANPROTO_PER_MC_MSG__PID_ERROR>:
+    BCastLayout<BCastPair<JointStateBuffer::POSITION_ERROR, int16_t, 0, 2>,
+                BCastPair<JointStateBuffer::TORQUE_ERROR, int16_t, 4, 6> >
+{};
+
+typedef void (*BCastDecoder)(const unsigned char *data, int j, bool second, double now, JointStateBuffer &s);
+
+// the decoders indexed by message type (4 lsb of the id), null if the message has none
+class BCastDecoderTable
+{
+public:
+    BCastDecoderTable()
+    {
+        for (int i=0; i<16; i++)
+            decoders[i]=0;
+
+        add<ICUBCANPROTO_PER_MC_MSG__POSITION>();
+        add<ICUBCANPROTO_PER_MC_MSG__MOTOR_POSITION>();
+        add<ICUBCANPROTO_PER_MC_MSG__MOTOR_SPEED>();
+        add<ICUBCANPROTO_PER_MC_MSG__VELOCITY>();
+        add<ICUBCANPROTO_PER_MC_MSG__PID_VAL>();
+        add<ICUBCANPROTO_PER_MC_MSG__CURRENT>();
+        add<ICUBCANPROTO_PER_MC_MSG__PID_ERROR>();
+    }
+
+    inline BCastDecoder operator[](unsigned int id) const
+    { return decoders[id&0x0f]; }
+
+    static const BCastDecoderTable &instance()
+    {
+        static const BCastDecoderTable table;
+        return table;
+    }
+
+private:
+    template <int MSGTYPE>
+    void add()
+    { decoders[MSGTYPE&0x0f]=&BCastMessage<MSGTYPE>::decode; }
+
+    BCastDecoder decoders[16];
+};
+
+/**
+ * The copy of a JointStateBuffer seen by the readers. There is a single writer,
+ * which copies the whole block after every batch of frames; the readers copy the
+ * rows they need and retry if a publish ran in the meantime (sequence lock), so
+ * they never wait for the writer nor for each other. The copy is made of relaxed
+ * atomics, element by element rather than with one memcpy, since a reader may run
+ * concurrently with a publish and only then finds out that its copy has to be
+ * thrown away: a plain copy would be a data race even if it is never used.
+ */
+class JointStateSnapshot
+{
+public:
+    JointStateSnapshot(int n): seq(0), njoints(n), size(JointStateBuffer::NFIELDS*n)
+    {
+        state=new std::atomic<double>[size];
+        for (int i=0; i<size; i++)
+            state[i].store(0.0, std::memory_order_relaxed);
+    }
+
+    ~JointStateSnapshot()
+    {
+        delete [] state;
+    }
+
+    void publish(const JointStateBuffer &s)
+    {
+        unsigned int v=seq.load(std::memory_order_relaxed);
+        seq.store(v+1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const double *in=s.block();
+        for (int i=0; i<size; i++)
+            state[i].store(in[i], std::memory_order_relaxed);
+
+        seq.store(v+2, std::memory_order_release);
+    }
+
+    void read(int field, double *out) const
+    {
+        consistent([&]{ copyRow(field, out); });
+    }
+
+    void read(int field0, double *out0, int field1, double *out1) const
+    {
+        consistent([&]
+        {
+            copyRow(field0, out0);
+            copyRow(field1, out1);
+        });
+    }
+
+    double get(int field, int j) const
+    {
+        double ret;
+        consistent([&]{ ret=row(field)[j].load(std::memory_order_relaxed); });
+        return ret;
+    }
+
+    void get(int field0, double &out0, int field1, double &out1, int j) const
+    {
+        consistent([&]
+        {
+            out0=row(field0)[j].load(std::memory_order_relaxed);
+            out1=row(field1)[j].load(std::memory_order_relaxed);
+        });
+    }
+
+private:
+    JointStateSnapshot(const JointStateSnapshot&);
+    void operator=(const JointStateSnapshot&);
+
+    inline const std::atomic<double> *row(int field) const
+    { return state+field*njoints; }
+
+    inline void copyRow(int field, double *out) const
+    {
+        const std::atomic<double> *in=row(field);
+        for (int j=0; j<njoints; j++)
+            out[j]=in[j].load(std::memory_order_relaxed);
+    }
+
+    // a copy which overlapped a publish is thrown away and done again
+    template <class Copy>
+    inline void consistent(Copy copy) const
+    {
+        unsigned int before, after;
+        do
+        {
+            while ((before=seq.load(std::memory_order_acquire)) & 1)
+                std::this_thread::yield();
+
+            copy();
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after=seq.load(std::memory_order_relaxed);
+        }
+        while (before!=after);
+    }
+
+    std::atomic<unsigned int> seq;
+    std::atomic<double> *state;
+    int njoints;
+    int size;
+};
+
+#endif
@@ -44,4 +44,14 @@ const int CANCONTROL_MAX_THREADS=500;
  */
 const int PLXCAN_MAX_CARDS= 16;
 
+/**
+ * Id of the periodic message msg of the control board at address board:
+ * 0x100 | (board << 4) | msg. The address takes 4 bits, thus only the
+ * boards from 0 to 15 have distinct ids.
+ */
+inline unsigned int bcastId(const int board, const int msg)
+{
+    return 0x100|(board<<4)|msg;
+}
+
 #endif
@@ -21,7 +21,7 @@
 #ifndef __CANUTILS__
 #define __CANUTILS__
 
-#include <list>
+#include <atomic>
 
 #include "yarp/dev/CanBusInterface.h"
 
@@ -151,38 +151,60 @@ inline void DEBUG_FUNC(const char *fmt, ...)
 struct ThreadId
 {
     int id;
-    unsigned int waitTime;  //ms
+    double issued;  // time of the request [s]
 };
 
 // A fifo of threads. There is one on each entry in the RequestsQueue.
-class ThreadFifo: public std::list<ThreadId>
+// It is a fixed ring: it is filled by the threads which send the requests (they
+// are serialized by the mutex of the device) and it is emptied only by the thread
+// which receives the replies, so the two sides do not need to share a lock.
+class ThreadFifo
 {
  public:
-    ThreadFifo(){}
+    enum { CAPACITY = 16 };  // power of two, so that the indexes can wrap around
+
+    ThreadFifo(): head(0), tail(0) {}
+
+    // Get the oldest waiting thread, without removing it
+    inline bool front(ThreadId &ret) const
+    {
+        unsigned int t=tail.load(std::memory_order_relaxed);
+        if (t==head.load(std::memory_order_acquire))
+            return false;
+
+        ret=slots[t%CAPACITY];
+        return true;
+    }
 
     // A pop function; get and destroy from front, just get thread id
     inline bool pop(int &ret)
     {
-        ThreadId tmp;
-        if (empty())
+        unsigned int t=tail.load(std::memory_order_relaxed);
+        if (t==head.load(std::memory_order_acquire))
             return false;
 
-        tmp=front();
-        pop_front();
-        
-        ret=tmp.id;
+        ret=slots[t%CAPACITY].id;
+        tail.store(t+1, std::memory_order_release);
         return true;
     }
 
-    // Push a thread id from back. waitTime is initialized to zero
-    inline bool push(int id)
+    // Push a thread id from back, with the time of the request. Fails if the fifo is full.
+    inline bool push(int id, double now)
     {
-        ThreadId tmp;
-        tmp.id=id;
-        tmp.waitTime=0;
-        push_back(tmp);
+        unsigned int h=head.load(std::memory_order_relaxed);
+        if (h-tail.load(std::memory_order_acquire)>=CAPACITY)
+            return false;
+
+        slots[h%CAPACITY].id=id;
+        slots[h%CAPACITY].issued=now;
+        head.store(h+1, std::memory_order_release);
         return true;
     }
+
+ private:
+    ThreadId slots[CAPACITY];
+    std::atomic<unsigned int> head;
+    std::atomic<unsigned int> tail;
 };
 
 // A structure to hold a request (joint, msg and waiting thread)
@@ -204,7 +226,7 @@ private:
     ThreadFifo *requests;
     int njoints;
     int num_of_messages;
-    int pendings;
+    std::atomic<int> pendings;
     int elements;
 public:
     RequestsQueue(int joints, int num_msgs)
@@ -255,20 +277,44 @@ public:
         return ret;
     }
 
+    // pop the oldest request of an entry if it has been waiting for more than timeout [s]
+    int popTimedOut(int j, int msg, double now, double timeout)
+    {
+        ThreadFifo *fifo=getFifo(j, msg);
+        if (!fifo)
+            return -1;
+
+        ThreadId oldest;
+        if (!fifo->front(oldest) || (now-oldest.issued)<timeout)
+            return -1;
+
+        int ret;
+        if (!fifo->pop(ret))
+            return -1;
+        pendings--;
+        return ret;
+    }
+
     int getPending()
     {
         return pendings;
     }
 
-    // append requests
-    void append(const CanRequest &rqst)
+    // append requests, false if too many threads are already waiting on the same entry
+    bool append(const CanRequest &rqst, double now)
     {
         ThreadFifo *fifo=getFifo(rqst.joint, rqst.msg);
         if (!fifo)
-            return;
+            return false;
 
-        fifo->push(rqst.threadId);
+        // counted before it becomes visible, so that pop() never sees the request without its pending
         pendings++;
+        if (!fifo->push(rqst.threadId, now))
+            {
+                pendings--;
+                return false;
+            }
+        return true;
     }
 
     inline int getNJoints()
@@ -7,9 +7,11 @@
  *
  */
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <vector>
+#include <thread>
 
 #include <yarp/os/Time.h>
 #include <yarp/os/Log.h>
@@ -21,6 +23,11 @@
 
 const int CAN_DRIVER_BUFFER_SIZE = 500;
 const int DEFAULT_THREAD_PERIOD = 10;
+const int CAN_ID_RANGE = 0x800;
+
+// the access points which have requested a given id. an entry of the dispatch table is never modified:
+// it is replaced by a new one when an access point adds or deletes the id.
+typedef std::vector<yarp::dev::CanBusAccessPoint*> Subscribers;
 
 class SharedCanBus : public yarp::os::PeriodicThread
 {
@@ -34,6 +41,12 @@ public:
         reqIdsUnion=new char[0x800];
 
         for (int i=0; i<0x800; ++i) reqIdsUnion[i]=UNREQ;
+
+        for (int i=0; i<CAN_ID_RANGE; ++i) dispatchTable[i]=NULL;
+
+        dispatchEpoch=0;
+        dispatchReaders[0]=0;
+        dispatchReaders[1]=0;
     }
 
     ~SharedCanBus()
@@ -43,6 +56,8 @@ public:
         polyDriver.close();
 
         delete [] reqIdsUnion;
+
+        for (int i=0; i<CAN_ID_RANGE; ++i) delete dispatchTable[i].load();
     }
 
     int getBufferSize()
@@ -98,15 +113,22 @@ public:
         {
             if (ap==accessPoints[i])
             {
-                for (int id=0; id<0x800; ++id)
-                {
-                    if (ap->hasId(id)) canIdDeleteUnsafe(id);
-                }
-                
                 accessPoints[i]=accessPoints[n-1];
                 
                 accessPoints.pop_back();
 
+                for (int id=0; id<0x800; ++id)
+                {
+                    if (ap->hasId(id))
+                    {
+                        updateSubscribersUnsafe(id);
+                        canIdDeleteUnsafe(id);
+                    }
+                }
+
+                // once we return nobody dispatches to ap anymore, so it can be destroyed
+                synchronizeDispatch();
+
                 break;
             }
         }
@@ -122,27 +144,38 @@ public:
         static const bool NOWAIT=false;
         unsigned int msgsNum=0;
 
-        std::lock_guard<std::mutex> lck(configMutex);
-
-        bool ret=theCanBus->canRead(readBufferUnion,mBufferSize,&msgsNum,NOWAIT);
+        bool ret;
+        {
+            // the driver is not touched by canIdAdd() / canIdDelete() while we read from it
+            std::lock_guard<std::mutex> lck(configMutex);
+            ret=theCanBus->canRead(readBufferUnion,mBufferSize,&msgsNum,NOWAIT);
+        }
 
         if (ret)
         {
+            // the dispatch does not take configMutex: the subscribers of each id are looked up in the table
+            unsigned int epoch=enterDispatch();
+
             for (unsigned int i=0; i<msgsNum; ++i)
             {
                 unsigned int id=readBufferUnion[i].getId();
 
-                for (unsigned int p=0; p<accessPoints.size(); ++p)
+                if (id>=(unsigned int)CAN_ID_RANGE) continue;
+
+                const Subscribers *subscribers=dispatchTable[id].load(std::memory_order_acquire);
+
+                if (!subscribers) continue;
+
+                for (unsigned int p=0; p<subscribers->size(); ++p)
                 {
-                    if (accessPoints[p]->hasId(id))
+                    if ((*subscribers)[p]->pushReadMsg(readBufferUnion[i])==false)
                     {
-                        if (accessPoints[p]->pushReadMsg(readBufferUnion[i])==false)
-                        {
-                            yError("run()-pushReadMsg() failed on CAN bus %d", mCanDeviceNum);
-                        }
+                        yError("run()-pushReadMsg() failed on CAN bus %d", mCanDeviceNum);
                     }
                 }
             }
+
+            exitDispatch(epoch);
         } 
     }
 
@@ -152,31 +185,40 @@ public:
         bool ret=theCanBus->canWrite(msgs,size,sent,wait);
 
         //this allows other istances to read back the sent message (echo)
+        unsigned int epoch=enterDispatch();
+
         yarp::dev::CanBuffer buff=msgs;
         for (unsigned int m=0; m<size; ++m)
         {
             unsigned int id=buff[m].getId();
-            if (reqIdsUnion[id])
+
+            if (id>=(unsigned int)CAN_ID_RANGE) continue;
+
+            const Subscribers *subscribers=dispatchTable[id].load(std::memory_order_acquire);
+
+            if (!subscribers) continue;
+
+            for (unsigned int p=0; p<subscribers->size(); ++p)
             {
-                for (unsigned int p=0; p<accessPoints.size(); ++p)
+                if ((*subscribers)[p]!=pFrom)
                 {
-                    if (accessPoints[p]!=pFrom && accessPoints[p]->hasId(id))
+                    if ((*subscribers)[p]->pushReadMsg(buff[m])==false)
                     {
-                        if (accessPoints[p]->pushReadMsg(buff[m])==false)
-                        {
-                            yError("canWrite()-pushReadMsg() failed on CAN bus %d", mCanDeviceNum);
-                        }
+                        yError("canWrite()-pushReadMsg() failed on CAN bus %d", mCanDeviceNum);
                     }
                 }
             }
         }
 
+        exitDispatch(epoch);
+
         return ret;
     }
 
     void canIdAdd(unsigned int id)
     {
         std::lock_guard<std::mutex> lck(configMutex);
+        updateSubscribersUnsafe(id);
         if (reqIdsUnion[id]==UNREQ)
         {
             reqIdsUnion[id]=REQST;
@@ -187,6 +229,7 @@ public:
     void canIdDelete(unsigned int id)
     {
         std::lock_guard<std::mutex> lck(configMutex);
+        updateSubscribersUnsafe(id);
         canIdDeleteUnsafe(id);
     }
     
@@ -281,6 +324,60 @@ public:
     }
 
 private:
+    // it rebuilds the entry of id in the dispatch table from the access points which have requested it.
+    // it must be called with configMutex taken.
+    void updateSubscribersUnsafe(unsigned int id)
+    {
+        Subscribers *subscribers=new Subscribers;
+
+        for (unsigned int i=0; i<accessPoints.size(); ++i)
+        {
+            if (accessPoints[i]->hasId(id)) subscribers->push_back(accessPoints[i]);
+        }
+
+        if (subscribers->empty())
+        {
+            delete subscribers;
+            subscribers=NULL;
+        }
+
+        const Subscribers *old=dispatchTable[id].exchange(subscribers, std::memory_order_acq_rel);
+
+        if (old)
+        {
+            // the old entry may still be walked by a dispatch which started before the exchange
+            synchronizeDispatch();
+            delete old;
+        }
+    }
+
+    // readers of the dispatch table (the receive thread and the echo in canWrite()) never block.
+    // they count themselves in one of two counters selected by the epoch, so that a writer can wait
+    // for the readers which may see an old entry without being starved by the new ones.
+    unsigned int enterDispatch()
+    {
+        for (;;)
+        {
+            unsigned int epoch=dispatchEpoch.load();
+            dispatchReaders[epoch&1]++;
+            if (dispatchEpoch.load()==epoch) return epoch;
+            dispatchReaders[epoch&1]--;
+        }
+    }
+
+    void exitDispatch(unsigned int epoch)
+    {
+        dispatchReaders[epoch&1]--;
+    }
+
+    // it returns when every dispatch started before the call is over. it must be called with configMutex taken.
+    void synchronizeDispatch()
+    {
+        unsigned int epoch=dispatchEpoch.fetch_add(1);
+
+        while (dispatchReaders[epoch&1].load()!=0) std::this_thread::yield();
+    }
+
     void canIdDeleteUnsafe(unsigned int id)
     {
         if (reqIdsUnion[id]==REQST)
@@ -318,6 +415,10 @@ private:
     yarp::dev::CanBuffer readBufferUnion;
 
     char *reqIdsUnion; //[0x800];
+
+    std::atomic<const Subscribers*> dispatchTable[CAN_ID_RANGE];
+    std::atomic<unsigned int> dispatchEpoch;
+    std::atomic<int> dispatchReaders[2];
 };
 
 class SharedCanBusManager // singleton
@@ -395,7 +496,14 @@ bool yarp::dev::CanBusAccessPoint::open(yarp::os::Searchable& config)
 
     mBufferSize=(unsigned int)(mSharedPhysDevice->getBufferSize());
 
-    readBuffer=createBuffer(mBufferSize);
+    unsigned int ringSize=1;
+    while (ringSize<mBufferSize) ringSize<<=1;
+    ringMask=ringSize-1;
+
+    readBuffer=createBuffer(ringSize);
+
+    // lets a blocked reader (e.g. the event driven reader of canBusMotionControl) check periodically whether it has to stop
+    mRxTimeout=config.check("canRxTimeout", yarp::os::Value(0), "timeout on blocking reads [ms], 0 waits forever").asInt();
 
     mSharedPhysDevice->attachAccessPoint(this);
 
@@ -459,6 +567,27 @@ bool yarp::dev::CanBusAccessPoint::canIdDelete(unsigned int id)
     return true;
 }
 
+bool yarp::dev::CanBusAccessPoint::canGetErrors(CanErrors &err)
+{
+    if (!mSharedPhysDevice) return false;
+
+    yarp::dev::ICanBusErrors* phys = mSharedPhysDevice->getCanBusErrors();
+
+    if (phys)
+    {
+        if (!phys->canGetErrors(err)) return false;
+    }
+    else
+    {
+        err = CanErrors();
+    }
+
+    // the frames dropped by this access point add to those dropped by the driver
+    err.rxBufferOvr += nOverruns.load();
+
+    return true;
+}
+
 yarp::dev::CanBuffer yarp::dev::CanBusAccessPoint::createBuffer(int nmessage)
 {
     yarp::dev::CanBuffer cb;
@@ -15,8 +15,11 @@
 #ifndef __SHARED_CAN_BUS_H__
 #define __SHARED_CAN_BUS_H__
 
+#include <atomic>
+#include <algorithm>
 #include <mutex>
 #include <condition_variable>
+#include <chrono>
 
 #include <yarp/os/Time.h>
 #include <yarp/os/Log.h>
@@ -43,6 +46,10 @@ class SharedCanBus;
  * It wraps the low level device driver (physdevice in the configuration file) in a higher level, multiple
  * access virtual device driver.
  *
+ * The frames received for an access point are queued in a bounded ring which the bus thread fills and the
+ * user of the access point drains without taking a common lock. The frames lost because the ring is full
+ * are counted in the rxBufferOvr field given by canGetErrors().
+ *
  * | YARP device name |
  * |:-----------------:|
  * | `sharedcan` |
@@ -50,6 +57,7 @@ class SharedCanBus;
 class yarp::dev::CanBusAccessPoint : 
     public ICanBus, 
     public ICanBufferFactory,
+    public ICanBusErrors,
     public DeviceDriver
 {
 public:
@@ -64,8 +72,12 @@ public:
         waitingOnRead=false;
 
         mBufferSize=0;
+        mRxTimeout=0;
 
-        nRecv=0;
+        ringHead=0;
+        ringTail=0;
+        ringMask=0;
+        nOverruns=0;
     }
 
     ~CanBusAccessPoint()
@@ -80,21 +92,33 @@ public:
         return reqIds[id]==REQST;
     }
 
+    // called by the bus thread and by the echo of the other access points. they are serialized by pushMutex,
+    // which the reader never takes.
     bool pushReadMsg(CanMessage& msg)
     {
-        std::lock_guard<std::mutex> lck(synchroMutex);
-
-        if (nRecv>=mBufferSize)
         {
-            yError("recv buffer overrun (%4d > %4d)", nRecv, mBufferSize);
-            return false;
+            std::lock_guard<std::mutex> lck(pushMutex);
+
+            unsigned int head=ringHead.load(std::memory_order_relaxed);
+
+            if (head-ringTail.load(std::memory_order_acquire)>ringMask)
+            {
+                nOverruns++;
+                yError("recv buffer overrun (%4d messages)", ringMask+1);
+                return false;
+            }
+
+            readBuffer[head&ringMask]=msg;
+
+            ringHead.store(head+1, std::memory_order_release);
         }
 
-        readBuffer[nRecv++]=msg;
-        
-        if (waitingOnRead)
+        // the reader is woken up only if it is blocked in canRead()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (waitingOnRead.load())
         {
-            waitingOnRead=false;
+            std::lock_guard<std::mutex> lck(mtx_waitRead);
             cv_waitRead.notify_one();
         }
         
@@ -115,35 +139,37 @@ public:
 
     virtual bool canRead(CanBuffer &msgs, unsigned int size, unsigned int *nmsg, bool wait=false)
     {
-        synchroMutex.lock();
+        // it only serializes concurrent readers of the same access point
+        std::lock_guard<std::mutex> rd(synchroMutex);
+
+        unsigned int tail=ringTail.load(std::memory_order_relaxed);
+        unsigned int head=ringHead.load(std::memory_order_acquire);
 
-        if (wait && !nRecv)
+        if (wait && head==tail)
         {
-            waitingOnRead=true;
-            synchroMutex.unlock();
             std::unique_lock<std::mutex> lck(mtx_waitRead);
-            cv_waitRead.wait(lck);
-            synchroMutex.lock();
+            waitingOnRead.store(true);
+            auto arrived=[&]{ head=ringHead.load(); return head!=tail; };
+            // a timeout of 0 waits forever, as before
+            if (mRxTimeout>0)
+                cv_waitRead.wait_for(lck, std::chrono::milliseconds(mRxTimeout), arrived);
+            else
+                cv_waitRead.wait(lck, arrived);
+            waitingOnRead.store(false);
         }
 
-        if (nRecv)
-        {
-            for (unsigned int i=0; i<nRecv && i<size; ++i)
-            {
-                msgs[i]=readBuffer[i];
-            }
+        // the frames which do not fit in msgs stay in the ring for the next call
+        unsigned int n=std::min(head-tail, size);
 
-            *nmsg=nRecv;
-            nRecv=0;
-            synchroMutex.unlock();
-            return true;
-        }
-        else
+        for (unsigned int i=0; i<n; ++i)
         {
-            *nmsg=0;
-            synchroMutex.unlock();
-            return true;
+            msgs[i]=readBuffer[(tail+i)&ringMask];
         }
+
+        ringTail.store(tail+n, std::memory_order_release);
+
+        *nmsg=n;
+        return true;
     }
 
     virtual bool canWrite(const CanBuffer &msgs, unsigned int size, unsigned int *sent, bool wait=false);
@@ -157,6 +183,12 @@ public:
     // ICanBufferFactory
     //////////////////////
 
+    //////////////////////
+    // ICanBusErrors
+    virtual bool canGetErrors(CanErrors &err);
+    // ICanBusErrors
+    //////////////////////
+
     /////////////////
     // DeviceDriver
     virtual bool open(yarp::os::Searchable& config);
@@ -168,15 +200,23 @@ protected:
     std::mutex mtx_waitRead;
     std::condition_variable cv_waitRead;
     std::mutex synchroMutex;
+    std::mutex pushMutex;
     
-    bool waitingOnRead;
+    std::atomic<bool> waitingOnRead;
 
-    unsigned int nRecv;
+    // ring of received frames: readBuffer holds ringMask+1 messages, a power of two not smaller than mBufferSize.
+    // ringHead is moved only by pushReadMsg(), ringTail only by canRead().
+    std::atomic<unsigned int> ringHead;
+    std::atomic<unsigned int> ringTail;
+    unsigned int ringMask;
     CanBuffer readBuffer;
+
+    std::atomic<unsigned int> nOverruns;
     
     char *reqIds; //[0x800];
 
     unsigned int mBufferSize;
+    int mRxTimeout; // [ms] for canRead() with wait
 
     SharedCanBus* mSharedPhysDevice;
 };
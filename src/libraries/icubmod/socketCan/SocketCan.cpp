@@ -39,6 +39,12 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <linux/net_tstamp.h>
 
 
 /* At time of writing, these constants are not defined in the headers */
@@ -58,14 +64,77 @@ using namespace yarp::os;
 const int TX_QUEUE_SIZE=2047;
 const int RX_QUEUE_SIZE=2047;
 
+// max number of frames moved by a single recvmmsg() / sendmmsg()
+const unsigned int MAX_BATCH=1024;
+// what a queued frame costs to the socket buffer: the kernel accounts
+// the whole skb (truesize), not only the 16 bytes of the can_frame
+const int SKB_FRAME_SIZE=1024;
+// room for the SCM_TIMESTAMPING control message of one frame
+const size_t CONTROL_SIZE=CMSG_SPACE(3*sizeof(struct timespec));
+
 SocketCan::SocketCan()
 {
-    skt = 0;
+    skt = -1;
+    txTimeout = 500;
+    rxTimeout = 500;
+    timestamps = false;
 }
 
 SocketCan::~SocketCan()
 {
- 
+    close();
+}
+
+void SocketCan::allocBatches()
+{
+    // allocated once in open() and never resized: canRead() and canWrite() may run concurrently
+    // (e.g. the bus thread of sharedcan reads while the access points write), each on its own headers
+    rxHeaders.assign(MAX_BATCH, mmsghdr());
+    rxVectors.assign(MAX_BATCH, iovec());
+    rxControls.assign(MAX_BATCH*CONTROL_SIZE, 0);
+    txHeaders.assign(MAX_BATCH, mmsghdr());
+    txVectors.assign(MAX_BATCH, iovec());
+
+    for (unsigned int i=0; i<MAX_BATCH; i++)
+    {
+        rxVectors[i].iov_len = sizeof(struct can_frame);
+        rxHeaders[i].msg_hdr.msg_iov = &rxVectors[i];
+        rxHeaders[i].msg_hdr.msg_iovlen = 1;
+
+        txVectors[i].iov_len = sizeof(struct can_frame);
+        txHeaders[i].msg_hdr.msg_iov = &txVectors[i];
+        txHeaders[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+void SocketCan::raiseBuffer(int option, int bytes)
+{
+    // getsockopt() reports the doubled value the kernel keeps for its own bookkeeping
+    int current = 0;
+    socklen_t len = sizeof(current);
+    if (getsockopt(skt, SOL_SOCKET, option, &current, &len) < 0)
+        return;
+    if (bytes <= current/2)
+        return;
+
+    if (setsockopt(skt, SOL_SOCKET, option, &bytes, sizeof(bytes)) < 0)
+    {
+        fprintf(stderr, "Warning: SocketCan::open() cannot raise the socket buffer to %d bytes: %s\n", bytes, strerror(errno));
+        return;
+    }
+
+    // the kernel silently clamps the request to net.core.rmem_max / net.core.wmem_max
+    len = sizeof(current);
+    if ((getsockopt(skt, SOL_SOCKET, option, &current, &len) == 0) && (current/2 < bytes))
+        fprintf(stderr, "Warning: SocketCan::open() asked a socket buffer of %d bytes but got %d: raise net.core.%s\n",
+                bytes, current/2, (option == SO_RCVBUF) ? "rmem_max" : "wmem_max");
+}
+
+double SocketCan::getRxTimestamp(unsigned int index) const
+{
+    if (index >= rxTimestamps.size())
+        return 0;
+    return rxTimestamps[index];
 }
 
 bool SocketCan::canSetBaudRate(unsigned int rate)
@@ -97,79 +166,93 @@ bool SocketCan::canRead(CanBuffer &msgs,
                      unsigned int *readout,
                      bool wait)
 {
-/*
-    int res;
-    #ifdef WIN32
-        long lRead=size;
-    #else
-        int32_t lRead=size;
-    #endif
-
-    CMSG *tmp=reinterpret_cast<CMSG *>(msgs[0].getPointer());
-    if (wait)
-        res=::canRead(*handle, tmp, &lRead, 0);
-    else
-        res=::canTake(*handle, tmp, &lRead);
-
-    *readout=lRead;
-
-    if ( (res==NTCAN_SUCCESS)||(res==NTCAN_RX_TIMEOUT))
+    *readout=0;
+    if (size==0)
         return true;
 
-    fprintf(stderr, "Error: canRead returned with code:%.8X\n", res);*/
+    if (timestamps && (rxTimestamps.size() < size))
+        rxTimestamps.resize(size);
+
+    if (wait)
+    {
+        // block until the first frame arrives or rxTimeout expires. then we drain whatever is queued.
+        struct pollfd pfd;
+        pfd.fd = skt;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ret = poll(&pfd, 1, rxTimeout);
+        if ((ret < 0) && (errno != EINTR))
+        {
+            fprintf(stderr, "Error: SocketCan::canRead() poll() failed: %s\n", strerror(errno));
+            return false;
+        }
+        if (ret <= 0)
+            return true;
+    }
 
-    int i=0;
-    int bytes_read=0;
     #if SOCK_DEBUG
         printf("Asked for %d messages\n", size);
     #endif
-    for (i=0; i<size; i++)
+    while (*readout < size)
     {
-        can_frame *frm=reinterpret_cast<can_frame *>(msgs[i].getPointer());
-        //printf("start reading\n");
-        bytes_read = 0;
-        bytes_read = read( skt, frm, sizeof(*frm) );
-        #if SOCK_DEBUG
-            printf("finished reading. read %d bytes\n",bytes_read);
-        #endif
-        if (bytes_read<=0) break;
+        unsigned int chunk = std::min(size-*readout, (unsigned int)rxHeaders.size());
+        for (unsigned int k=0; k<chunk; k++)
+        {
+            rxVectors[k].iov_base = msgs[*readout+k].getPointer();
+            if (timestamps)
+            {
+                rxHeaders[k].msg_hdr.msg_control = &rxControls[k*CONTROL_SIZE];
+                rxHeaders[k].msg_hdr.msg_controllen = CONTROL_SIZE;
+            }
+        }
+
+        int n = recvmmsg(skt, &rxHeaders[0], chunk, MSG_DONTWAIT, NULL);
+        if (n < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+                break;
+            fprintf(stderr, "Error: SocketCan::canRead() recvmmsg() failed: %s\n", strerror(errno));
+            return false;
+        }
+
+        for (int k=0; timestamps && (k<n); k++)
+        {
+            double stamp = 0;
+            struct msghdr &hdr = rxHeaders[k].msg_hdr;
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+            {
+                if ((cmsg->cmsg_level != SOL_SOCKET) || (cmsg->cmsg_type != SO_TIMESTAMPING))
+                    continue;
+                // ts[0] is the kernel time, ts[2] is the raw hardware time (zero if the interface has none)
+                struct timespec ts[3];
+                memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+                const struct timespec &t = ((ts[2].tv_sec != 0) || (ts[2].tv_nsec != 0)) ? ts[2] : ts[0];
+                stamp = t.tv_sec + 1e-9*t.tv_nsec;
+            }
+            rxTimestamps[*readout+k] = stamp;
+        }
 
         #if SOCK_DEBUG
-            printf("Read: %d \n ",bytes_read);
-            printf("len %d ", frm->can_dlc);
-            printf("id %d ", frm->can_id);
-            printf("data: ");
-            for(int j=0;j<frm->can_dlc;j++)
-                printf("%2x ", frm->data[j]);
-            printf("\n");
+            for (int k=0; k<n; k++)
+            {
+                const can_frame *frm=reinterpret_cast<const can_frame *>(msgs[*readout+k].getPointer());
+                printf("len %d ", frm->can_dlc);
+                printf("id %d ", frm->can_id);
+                printf("data: ");
+                for(int j=0;j<frm->can_dlc;j++)
+                    printf("%2x ", frm->data[j]);
+                printf("\n");
+            }
         #endif
 
-        //yarp::os::Time::delay(0.010); //test only
+        *readout += n;
+        if ((unsigned int)n < chunk)
+            break;
     }
-    *readout=i;
     #if SOCK_DEBUG
         printf("Read %d messages\n", *readout);
     #endif
     return true;
-
-	/*
-	//debug
-	//struct can_frame frame;
-    can_frame *frame=reinterpret_cast<can_frame *>(msgs[0].getPointer());
-    bytes_read = read( skt, frame, sizeof(*frame) );
-    *readout=1;
-
-    printf("Read: %d \n ",bytes_read);
-
-    printf("len %d ", frame->can_dlc);
-    printf("id %d ", frame->can_id);
-    printf("data: ");
-    for(i=0;i<frame->can_dlc;i++)
-        printf("%2x ", frame->data[i]);
-    printf("\n");
-
-    return true;
-	*/
 }
 
 bool SocketCan::canWrite(const CanBuffer &msgs,
@@ -177,61 +260,69 @@ bool SocketCan::canWrite(const CanBuffer &msgs,
                       unsigned int *sent,
                       bool wait)
 {
-    int res;
-    int32_t lRead=size;
-    int bytes_sent=0;
-
-/*
-    //debug
-    struct can_frame frame2;
-    frame2.can_id = 0x123;
-    strcpy( (char*)(&frame2.data), "YAY" );
-    frame2.can_dlc = strlen( (char*)(&frame2.data) );
-    bytes_sent = write( skt, &frame2, sizeof(frame2) );
-*/
-/*
-    //debug
-    can_frame frame3;
-    frame3.can_id = 0x123;
-    frame3.data[0] = 'Y';
-    frame3.can_dlc = 1;
-    bytes_sent = write( skt, &frame3, sizeof(frame3) );
-*/
+    (*sent)=0;
+    if (size==0)
+        return true;
+
+    // the tx headers are shared: concurrent writers would overwrite each other's iovecs
+    std::lock_guard<std::mutex> lck(txMutex);
+
+    //@@@ IMPORTANT (RANDAZ): a lot of CAN messages were lost when iCubInterface starts and sends the
+    //configuration parameters (PIDs etc.) to the control boards, so every call was delayed by one millisecond.
+    //the frames are lost when the tx queue of the interface is full (EAGAIN / ENOBUFS on a non blocking socket),
+    //so now we back off only in that case and only with wait=true, until the whole buffer is sent or txTimeout
+    //expires. with wait=false we return at once with the frames sent so far.
+    double deadline = Time::now() + 0.001*txTimeout;
 
-    //debug
-    //fprintf(stderr, "id:%d data:%d size:%d\n", tmp->can_id, tmp->data[0], tmp->can_dlc );
-   
-    //@@@ IMPORTANT (RANDAZ): I'm putting here a delay of one millisecond.
-	//I noticed that without this delay a lot CAN messages are lost when iCubInterface starts and
-	//sends the configuration parameters (PIDs etc.) to the control boards.
-	//Further investigation is required in order to understand how the internal buffer is handled 
-	//when the function write( skt, tmp, sizeof(*tmp) ); is called.
-	Time::delay(0.001);
-	
-    int i=0;
-	(*sent)=0;
-	for (i=0; i<size; i++)
+    CanBuffer &buffer=const_cast<CanBuffer &>(msgs);
+    while (*sent < size)
     {
-		CanBuffer &buffer=const_cast<CanBuffer &>(msgs);
-		const struct can_frame *tmp=reinterpret_cast<const struct can_frame*>(buffer[i].getPointer());   
-		bytes_sent = write( skt, tmp, sizeof(*tmp) );
-		if (bytes_sent>0) 
-		{
-			(*sent)++;
-		}
+        unsigned int chunk = std::min(size-*sent, (unsigned int)txHeaders.size());
+        for (unsigned int k=0; k<chunk; k++)
+            txVectors[k].iov_base = buffer[*sent+k].getPointer();
+
+        int n = sendmmsg(skt, &txHeaders[0], chunk, MSG_DONTWAIT);
+        if (n > 0)
+        {
+            (*sent) += n;
+            continue;
+        }
+
+        if ((n < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != ENOBUFS) && (errno != EINTR))
+        {
+            fprintf(stderr, "Error: SocketCan::canWrite() was unable to send message: %s\n", strerror(errno));
+            break;
+        }
+
+        // the tx queue is full
+        if (!wait)
+            break;
+        double remaining = deadline - Time::now();
+        if (remaining <= 0)
+            break;
+
+        if (n < 0 && errno == EAGAIN)
+        {
+            // the socket buffer is full: it becomes writable when the driver consumes frames
+            struct pollfd pfd;
+            pfd.fd = skt;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            poll(&pfd, 1, std::max(1, (int)(1000*remaining)));
+        }
         else
-		{
-			fprintf(stderr, "Error: SocketCan::canWrite() was unable to send message.\n");
-			//break;
-		}
-	}
-	
+        {
+            // ENOBUFS comes from the queue of the interface, which poll() does not see
+            Time::delay(0.001);
+        }
+    }
+
     if (*sent <size)
-       {
-           fprintf(stderr, "Error: SocketCan::canWrite() not all messages were sent.\n");
-           return false;
-       }
-   
+    {
+        fprintf(stderr, "Error: SocketCan::canWrite() not all messages were sent.\n");
+        return false;
+    }
+
     return true;
 }
 
@@ -240,11 +331,13 @@ bool SocketCan::open(yarp::os::Searchable &par)
     int canTxQueue=TX_QUEUE_SIZE;
     int canRxQueue=RX_QUEUE_SIZE;
     int netId =-1;
-    int txTimeout=500;
-    int rxTimeout=500;
+    std::string netName;
 
                          netId=par.check("CanDeviceNum", Value(-1), "numeric identifier of the can device").asInt();
     if  (netId == -1)    netId=par.check("canDeviceNum", Value(-1), "numeric identifier of the can device").asInt();
+
+                         netName=par.check("CanDeviceName", Value(""), "name of the can interface, e.g. vcan0").asString();
+    if  (netName.empty()) netName=par.check("canDeviceName", Value(""), "name of the can interface, e.g. vcan0").asString();
     
                            txTimeout=par.check("CanTxTimeout", Value(500), "timeout on transmission [ms]").asInt();
     if  (txTimeout == 500) txTimeout=par.check("canTxTimeout", Value(500), "timeout on transmission [ms]").asInt();
@@ -258,48 +351,73 @@ bool SocketCan::open(yarp::os::Searchable &par)
                                       canRxQueue=par.check("CanRxQueue", Value(RX_QUEUE_SIZE), "length of rx buffer").asInt() ;
     if  (canRxQueue == RX_QUEUE_SIZE) canRxQueue=par.check("canRxQueue", Value(RX_QUEUE_SIZE), "length of rx buffer").asInt() ;
 
-   int so_timestamping_flags = 0;
+                         timestamps=par.check("CanTimestamps", Value(false), "enables SO_TIMESTAMPING on received frames").asBool();
+    if  (!timestamps)    timestamps=par.check("canTimestamps", Value(false), "enables SO_TIMESTAMPING on received frames").asBool();
+
+    if (netName.empty())
+        netName = "can" + std::to_string(netId);
+
    /* Create the socket */
    skt = socket( PF_CAN, SOCK_RAW, CAN_RAW );
+   if (skt < 0)
+   {
+       fprintf(stderr, "Error: SocketCan::open() cannot create the socket: %s\n", strerror(errno));
+       return false;
+   }
  
    /* Locate the interface you wish to use */
    struct ifreq ifr;
-   sprintf (ifr.ifr_name, "can%d",netId);
-   ioctl(skt, SIOCGIFINDEX, &ifr); // ifr.ifr_ifindex gets filled with that device's index
+   memset(&ifr, 0, sizeof(ifr));
+   strncpy(ifr.ifr_name, netName.c_str(), IFNAMSIZ-1);
+   if (ioctl(skt, SIOCGIFINDEX, &ifr) < 0) // ifr.ifr_ifindex gets filled with that device's index
+   {
+       fprintf(stderr, "Error: SocketCan::open() cannot find interface %s: %s\n", netName.c_str(), strerror(errno));
+       close();
+       return false;
+   }
+
+   /* Raise the socket buffers to hold the configured queues, never shrink the system defaults */
+   raiseBuffer(SO_RCVBUF, canRxQueue*SKB_FRAME_SIZE);
+   raiseBuffer(SO_SNDBUF, canTxQueue*SKB_FRAME_SIZE);
+
+   if (timestamps)
+   {
+       int so_timestamping_flags = SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE |
+                                   SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+       if (setsockopt(skt, SOL_SOCKET, SO_TIMESTAMPING, &so_timestamping_flags, sizeof(so_timestamping_flags)) < 0)
+       {
+           fprintf(stderr, "Warning: SocketCan::open() cannot enable SO_TIMESTAMPING on %s: %s\n", netName.c_str(), strerror(errno));
+           timestamps = false;
+       }
+   }
  
    /* Select that CAN interface, and bind the socket to it. */
    struct sockaddr_can addr;
+   memset(&addr, 0, sizeof(addr));
    addr.can_family = AF_CAN;
    addr.can_ifindex = ifr.ifr_ifindex;
-   bind( skt, (struct sockaddr*)&addr, sizeof(addr) );
+   if (bind( skt, (struct sockaddr*)&addr, sizeof(addr) ) < 0)
+   {
+       fprintf(stderr, "Error: SocketCan::open() cannot bind to %s: %s\n", netName.c_str(), strerror(errno));
+       close();
+       return false;
+   }
 
     int flags;
     if (-1 == (flags = fcntl(skt, F_GETFL, 0))) flags = 0;
     fcntl(skt, F_SETFL, flags | O_NONBLOCK);
 
+    allocBatches();
 
    return true;
 }
 
 bool SocketCan::close()
 {
-/*
-    int res;
-    if (!handle)
-        return false;
-
-    res=::canClose (*handle);
-
-    if (res!=NTCAN_SUCCESS)
+    if (skt < 0)
         return false;
 
-    delete handle;
-    handle=0;
-*/
-
-    if (!skt)
-        return false;
-
-    //not yet implemented 
+    ::close(skt);
+    skt = -1;
     return true;
 }
@@ -29,6 +29,9 @@
 #include <yarp/dev/DeviceDriver.h>
 #include <yarp/dev/CanBusInterface.h>
 
+#include <vector>
+#include <mutex>
+
 #include "memory.h"
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -102,6 +105,18 @@ public:
  * | YARP device name |
  * |:-----------------:|
  * | `socketcan` |
+ *
+ * Frames are moved in batches with recvmmsg() / sendmmsg() directly into / from the CanBuffer.
+ *
+ * | Parameter name | Type   | Units | Default Value | Description |
+ * |:--------------:|:------:|:-----:|:-------------:|:-----------:|
+ * | CanDeviceNum   | int    | -     | -1            | the socket is bound to interface can<CanDeviceNum> |
+ * | CanDeviceName  | string | -     | -             | name of the interface (e.g. vcan0). if present it is used instead of CanDeviceNum |
+ * | CanTxTimeout   | int    | ms    | 500           | max time canWrite() waits for room in the tx queue when called with wait=true |
+ * | CanRxTimeout   | int    | ms    | 500           | max time canRead() waits for the first frame when called with wait=true |
+ * | CanTxQueue     | int    | -     | 2047          | size of the socket send buffer in frames. the buffer is only raised, never below the system default |
+ * | CanRxQueue     | int    | -     | 2047          | size of the socket receive buffer in frames. the buffer is only raised, never below the system default |
+ * | CanTimestamps  | bool   | -     | false         | enables SO_TIMESTAMPING. see getRxTimestamp() |
  */
 class yarp::dev::SocketCan: public ImplementCanBufferFactory<SocketCanMessage, can_frame>,
     public ICanBus, 
@@ -109,6 +124,21 @@ class yarp::dev::SocketCan: public ImplementCanBufferFactory<SocketCanMessage, c
 {
 private:
     int skt;
+    int txTimeout;          // [ms], used by canWrite() with wait=true
+    int rxTimeout;          // [ms], used by canRead() with wait=true
+    bool timestamps;        // SO_TIMESTAMPING is active on the socket
+
+    // headers of recvmmsg() / sendmmsg(), MAX_BATCH each. their iovecs point directly into the frames of the CanBuffer
+    std::vector<struct mmsghdr> rxHeaders;
+    std::vector<struct iovec>   rxVectors;
+    std::vector<char>           rxControls;
+    std::vector<double>         rxTimestamps;
+    std::vector<struct mmsghdr> txHeaders;
+    std::vector<struct iovec>   txVectors;
+    std::mutex                  txMutex;    // serializes canWrite() on the tx headers
+
+    void allocBatches();
+    void raiseBuffer(int option, int bytes);
 public:
     SocketCan();
     ~SocketCan();
@@ -129,6 +159,10 @@ public:
         unsigned int *sent,
         bool wait=false);
 
+    // it gives the time [s] at which the index-th frame returned by the last canRead() was received.
+    // it is the hardware time if the interface supports it, else the kernel time. it is 0 if the option CanTimestamps is off.
+    double getRxTimestamp(unsigned int index) const;
+
     /*Device Driver*/
     virtual bool open(yarp::os::Searchable &par);
     virtual bool close();
@@ -69,6 +69,14 @@ http://wiki.icub.org/wiki/Force_Control
 --no_legs   
 - this option disables the dynamics computation for the legs joints
 
+--solver_threads \e n
+- the limbs attached to the upper and lower torso are solved
+  concurrently on \e n worker threads, in addition to the module
+  thread. If not specified, the computation is sequential.
+
+--solver_cpus "(\e c0 \e c1 ...)"
+- the CPUs the worker threads are pinned to (Linux only).
+
 \section portsa_sec Ports Accessed
 The port the service is listening to.
 
@@ -76,6 +84,13 @@ The port the service is listening to.
  
 - \e <name>/<part>/FT:i (e.g. /wholeBodyDynamics/right_arm/FT:i) 
   receives the input data vector.
+
+- \e <name>/stats:o publishes once per second the latency statistics
+  of the computation stages (read, estimate, upper_ne, lower_ne, skin,
+  broadcast and the whole tick) as a list of (name count p50 p99 max
+  mean) per stage, with latencies in microseconds. The same content is
+  returned by the rpc command \e stats, while \e "stats reset" clears
+  the statistics.
  
 \section in_files_sec Input Data Files
 None.
@@ -338,6 +353,24 @@ public:
                 reply.addString("calib arms");
                 reply.addString("calib legs");
                 reply.addString("calib feet");
+                reply.addString("stats");
+                reply.addString("stats reset");
+                return true;
+            }
+            else if (command.get(0).asString()=="stats")
+            {
+                if (inv_dyn)
+                {
+                    if (command.get(1).asString()=="reset")
+                    {
+                        inv_dyn->resetStats();
+                        reply.addVocab(Vocab::encode("ok"));
+                    }
+                    else
+                        inv_dyn->getStats(reply);
+                }
+                else
+                    reply.addVocab(Vocab::encode("fail"));
                 return true;
             }
             else if (command.get(0).asString()=="calib")
@@ -672,6 +705,22 @@ public:
         inv_dyn->dumpvel_enabled=dump_vel_enabled;
         inv_dyn->default_ee_cont=default_ee_cont;
 
+        //---------------------PARALLEL SOLVER-----------------//
+        if (rf.check("solver_threads"))
+        {
+            int solver_threads = rf.find("solver_threads").asInt();
+            std::vector<int> solver_cpus;
+            if (Bottle *b = rf.find("solver_cpus").asList())
+                for (int i=0; i<b->size(); i++)
+                    solver_cpus.push_back(b->get(i).asInt());
+
+            if (solver_threads>0)
+            {
+                inv_dyn->icub->setParallelSolver(solver_threads,solver_cpus);
+                yInfo("Solving the limbs with %d worker threads\n", solver_threads);
+            }
+        }
+
         yInfo("ft thread istantiated...\n");
         Time::delay(5.0);
 
@@ -834,6 +883,8 @@ int main(int argc, char * argv[])
         cout << "\t--dumpvel         dumps joint velocities and accelerations (debug use only)"                                  << endl;
         cout << "\t--experimental_com_vel  enables com velocity computation (experimental)"                                      << endl;
         cout << "\t--auto_drift_comp  enables automatic drift compensation  (experimental, under debug)"                         << endl;
+        cout << "\t--solver_threads n  solves the limbs concurrently on n worker threads. default: 0 (sequential)"             << endl;
+        cout << "\t--solver_cpus \"(c0 c1 ..)\"  pins the worker threads to the given CPUs"                                      << endl;
         return 0;
     }
 
@@ -20,8 +20,10 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <algorithm>
 
 #include <yarp/os/all.h>
+#include <yarp/os/SystemClock.h>
 #include <yarp/sig/all.h>
 #include <yarp/dev/all.h>
 #include <iCub/ctrl/math.h>
@@ -261,6 +263,8 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     dumpvel_enabled = false;
     auto_drift_comp = false;
     add_legs_once = false;
+    lastEstimateTime = 0.0;
+    lastStatsTime = 0.0;
 
     icub      = new iCubWholeBody(icub_type, DYNAMIC, VERBOSE);
     icub_sens = new iCubWholeBody(icub_type, DYNAMIC, VERBOSE);
@@ -347,6 +351,7 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     port_all_positions = new BufferedPort<Vector>;
     port_root_position_mat = new BufferedPort<Matrix>;
     port_root_position_vec = new BufferedPort<Vector>;
+    port_stats = new BufferedPort<Bottle>;
 
     port_inertial_thread->open(string("/"+local_name+"/inertial:i").c_str());
     port_ft_arm_left->open(string("/"+local_name+"/left_arm/FT:i").c_str());
@@ -406,6 +411,7 @@ inverseDynamics::inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR
     port_all_positions->open(string("/"+local_name+"/all_positions:o").c_str());
     port_root_position_mat->open(string("/"+local_name+"/root_position_mat:o").c_str());
     port_root_position_vec->open(string("/"+local_name+"/root_position_vec:o").c_str());
+    port_stats->open(string("/"+local_name+"/stats:o").c_str());
 
     yInfo ("Waiting for port connections");
     if (autoconnect)
@@ -538,13 +544,113 @@ void iCubStatus::dump (FILE* f)
     fprintf (f, "%s \n", inertial_d2p0.toString().c_str());
 }
 
+static const char *stage_names[STAGE_NUM] = {"read", "estimate", "upper_ne", "lower_ne", "skin", "broadcast", "tick"};
+
+latencyHistogram::latencyHistogram()
+{
+    reset();
+}
+
+int latencyHistogram::bucketOf(uint64_t ns)
+{
+    // bucket 0 collects everything below 256 ns, then each octave
+    // is split into 8 buckets according to the 3 most significant bits
+    if (ns<256)
+        return 0;
+
+    int octave=0;
+    while ((ns>>(octave+9))>0)
+        octave++;
+
+    int bucket=1+8*octave+(int)((ns>>(octave+5))&7);
+    return std::min(bucket,LATENCY_BUCKETS-1);
+}
+
+double latencyHistogram::upperBoundOf(int bucket)
+{
+    if (bucket==0)
+        return 256e-9;
+
+    int octave=(bucket-1)/8;
+    int sub=(bucket-1)%8;
+    return 1e-9*(double)((uint64_t)(9+sub)<<(octave+5));
+}
+
+void latencyHistogram::add(double dt)
+{
+    uint64_t ns=(uint64_t)(std::max(dt,0.0)*1e9);
+    buckets[bucketOf(ns)].fetch_add(1,std::memory_order_relaxed);
+    sum_ns.fetch_add(ns,std::memory_order_relaxed);
+    count.fetch_add(1,std::memory_order_relaxed);
+
+    uint64_t m=max_ns.load(std::memory_order_relaxed);
+    while ((ns>m) && !max_ns.compare_exchange_weak(m,ns,std::memory_order_relaxed));
+}
+
+void latencyHistogram::reset()
+{
+    for (int i=0; i<LATENCY_BUCKETS; i++)
+        buckets[i].store(0,std::memory_order_relaxed);
+    count.store(0,std::memory_order_relaxed);
+    sum_ns.store(0,std::memory_order_relaxed);
+    max_ns.store(0,std::memory_order_relaxed);
+}
+
+uint64_t latencyHistogram::getCount() const
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+double latencyHistogram::getMean() const
+{
+    uint64_t n=count.load(std::memory_order_relaxed);
+    return (n>0 ? 1e-9*(double)sum_ns.load(std::memory_order_relaxed)/(double)n : 0.0);
+}
+
+double latencyHistogram::getMax() const
+{
+    return 1e-9*(double)max_ns.load(std::memory_order_relaxed);
+}
+
+double latencyHistogram::getPercentile(double p) const
+{
+    // the buckets are read while being filled: the total is taken
+    // from the snapshot itself to keep the result consistent
+    uint32_t snapshot[LATENCY_BUCKETS];
+    uint64_t total=0;
+    for (int i=0; i<LATENCY_BUCKETS; i++)
+    {
+        snapshot[i]=buckets[i].load(std::memory_order_relaxed);
+        total+=snapshot[i];
+    }
+    if (total==0)
+        return 0.0;
+
+    uint64_t target=(uint64_t)ceil(p*(double)total);
+    uint64_t cumulated=0;
+    for (int i=0; i<LATENCY_BUCKETS; i++)
+    {
+        cumulated+=snapshot[i];
+        if (cumulated>=std::max(target,(uint64_t)1))
+            return (i<LATENCY_BUCKETS-1 ? std::min(upperBoundOf(i),getMax()) : getMax());
+    }
+    return getMax();
+}
+
 void inverseDynamics::run()
 {
+    // latencies are measured on the system clock, also when running on a network clock
+    double t_tick = SystemClock::nowSystem();
     timestamp.update();
 
     thread_status = STATUS_OK;
     static int delay_check=0;
-    if(!readAndUpdate(false))
+    lastEstimateTime = 0.0;
+    bool read_ok = readAndUpdate(false);
+    double t_read = SystemClock::nowSystem();
+    stats[STAGE_READ].add(t_read-t_tick-lastEstimateTime);
+    stats[STAGE_ESTIMATE].add(lastEstimateTime);
+    if(!read_ok)
     {
         delay_check++;
         yWarning ("network delays detected (%d/10)\n", delay_check);
@@ -599,19 +705,14 @@ void inverseDynamics::run()
     icub->upperTorso->setInertialMeasure(current_status.inertial_w0,current_status.inertial_dw0,current_status.inertial_d2p0);
     icub->upperTorso->setSensorMeasurement(F_RArm,F_LArm,F_up);
 
-//#define DEBUG_PERFORMANCE
-#ifdef DEBUG_PERFORMANCE
-    static double meanTime = 0.0;
-    static double startTime = 0;
-    startTime = Time::now();
-#endif
+    double t_upper = SystemClock::nowSystem();
     icub->upperTorso->solveKinematics();
+    double t_skin = SystemClock::nowSystem();
     addSkinContacts();
+    double t_skin_end = SystemClock::nowSystem();
+    double skin_time = t_skin_end-t_skin;
     icub->upperTorso->solveWrench();
-#ifdef DEBUG_PERFORMANCE
-    meanTime += Time::now()-startTime;
-    yDebug("Mean uppertorso NE time: %.4f\n", meanTime/getIterations());
-#endif
+    stats[STAGE_UPPER_NE].add(SystemClock::nowSystem()-t_upper-skin_time);
 
 //#define DEBUG_KINEMATICS
 #ifdef DEBUG_KINEMATICS
@@ -621,9 +722,11 @@ void inverseDynamics::run()
     yDebug ("UPTORSO: %s \n", icub->upperTorso->getTorsoLinAcc().toString().c_str());
 #endif
 
+    double t_lower = SystemClock::nowSystem();
     icub->attachLowerTorso(F_RLeg,F_LLeg);
     icub->lowerTorso->solveKinematics();
     icub->lowerTorso->solveWrench();
+    stats[STAGE_LOWER_NE].add(SystemClock::nowSystem()-t_lower);
 
 //#define DEBUG_KINEMATICS
 #ifdef DEBUG_KINEMATICS
@@ -684,6 +787,7 @@ void inverseDynamics::run()
     yDebug ("TORQUES:     %s ***  \n\n", TOTorques.toString().c_str());
 #endif
 
+    double t_broadcast = SystemClock::nowSystem();
     writeTorque(RATorques, 1, port_RATorques); //arm
     writeTorque(LATorques, 1, port_LATorques); //arm
     writeTorque(TOTorques, 4, port_TOTorques); //torso
@@ -693,6 +797,7 @@ void inverseDynamics::run()
     if (ddLL) writeTorque(LLTorques, 2, port_LLTorques); //leg
     writeTorque(RATorques, 3, port_RWTorques); //wrist
     writeTorque(LATorques, 3, port_LWTorques); //wrist
+    double broadcast_time = SystemClock::nowSystem()-t_broadcast;
 
     Vector com_all(7), com_ll(7), com_rl(7), com_la(7),com_ra(7), com_hd(7), com_to(7), com_lb(7), com_ub(7);
     double mass_all  , mass_ll  , mass_rl  , mass_la  ,mass_ra  , mass_hd,   mass_to, mass_lb, mass_ub;
@@ -778,6 +883,7 @@ void inverseDynamics::run()
     }
 
     // DYN/SKIN CONTACTS
+    t_skin = SystemClock::nowSystem();
     dynContacts = icub->upperTorso->leftSensor->getContactList();
     const dynContactList& contactListR = icub->upperTorso->rightSensor->getContactList();
     dynContacts.insert(dynContacts.begin(), contactListR.begin(), contactListR.end());
@@ -838,6 +944,7 @@ void inverseDynamics::run()
     if (!skin_lleg_found) {skinContacts.push_back(left_leg_contact);} 
     
 	//*********************************************** add the legs contacts JUST TEMP FIX!! *******************
+    stats[STAGE_SKIN].add(skin_time+SystemClock::nowSystem()-t_skin);
 
     F_ext_cartesian_left_arm = F_ext_cartesian_right_arm = zeros(6);
     F_ext_cartesian_left_leg = F_ext_cartesian_right_leg = zeros(6);
@@ -957,6 +1064,7 @@ void inverseDynamics::run()
     // *** DUMP VEL DATA ***
     //sendVelAccData();
 
+    t_broadcast = SystemClock::nowSystem();
     if (com_vel_enabled)
     {
         // com_jac = M_PI/180.0 * (com_jac);
@@ -1005,6 +1113,48 @@ void inverseDynamics::run()
 
     broadcastData<Matrix> (foot_root_mat,                           port_root_position_mat);
     broadcastData<Vector> (foot_root_vec,                           port_root_position_vec);
+
+    double t_end = SystemClock::nowSystem();
+    stats[STAGE_BROADCAST].add(broadcast_time+t_end-t_broadcast);
+    stats[STAGE_TICK].add(t_end-t_tick);
+    if (t_end-lastStatsTime>=STATS_PERIOD)
+    {
+        publishStats();
+        lastStatsTime = t_end;
+    }
+}
+
+void inverseDynamics::getStats(Bottle &b)
+{
+    // one list per stage: (name count p50 p99 max mean), latencies in [us]
+    for (int i=0; i<STAGE_NUM; i++)
+    {
+        Bottle &stage = b.addList();
+        stage.addString(stage_names[i]);
+        stage.addInt((int)stats[i].getCount());
+        stage.addDouble(1e6*stats[i].getPercentile(0.50));
+        stage.addDouble(1e6*stats[i].getPercentile(0.99));
+        stage.addDouble(1e6*stats[i].getMax());
+        stage.addDouble(1e6*stats[i].getMean());
+    }
+}
+
+void inverseDynamics::resetStats()
+{
+    for (int i=0; i<STAGE_NUM; i++)
+        stats[i].reset();
+}
+
+void inverseDynamics::publishStats()
+{
+    if (port_stats && port_stats->getOutputCount()>0)
+    {
+        Bottle &b = port_stats->prepare();
+        b.clear();
+        getStats(b);
+        port_stats->setEnvelope(this->timestamp);
+        port_stats->write();
+    }
 }
 
 void inverseDynamics::threadRelease()
@@ -1139,6 +1289,8 @@ void inverseDynamics::threadRelease()
     yInfo("Closing Foot/Root port\n");
     closePort(port_root_position_mat);
     closePort(port_root_position_vec);
+    yInfo("Closing stats port\n");
+    closePort(port_stats);
 
     if (icub)      {delete icub; icub=0;}
     if (icub_sens) {delete icub_sens; icub=0;}
@@ -1291,7 +1443,9 @@ bool inverseDynamics::readAndUpdate(bool waitMeasure, bool _init)
         }
         if (waitMeasure) yInfo("done. \n");
     }
+    double t_estimate = SystemClock::nowSystem();
     b &= getUpperEncodersSpeedAndAcceleration();
+    lastEstimateTime = SystemClock::nowSystem()-t_estimate;
     setUpperMeasure(_init);
 
     // legs
@@ -1370,7 +1524,9 @@ bool inverseDynamics::readAndUpdate(bool waitMeasure, bool _init)
         if (waitMeasure) yInfo("done. \n");
     }
 
+    t_estimate = SystemClock::nowSystem();
     b &= getLowerEncodersSpeedAndAcceleration();
+    lastEstimateTime += SystemClock::nowSystem()-t_estimate;
     setLowerMeasure(_init);
 
     //inertial sensor
@@ -32,6 +32,8 @@
 #include <iomanip>
 #include <cstring>
 #include <list>
+#include <atomic>
+#include <cstdint>
 
 using namespace yarp::os;
 using namespace yarp::sig;
@@ -47,6 +49,10 @@ constexpr float_t SKIN_EVENTS_TIMEOUT = 0.2;     // max time (in sec) a contact
 
 enum thread_status_enum {STATUS_OK=0, STATUS_DISCONNECTED}; 
 enum calib_enum {CALIB_ALL=0, CALIB_ARMS, CALIB_LEGS, CALIB_FEET};
+enum stage_enum {STAGE_READ=0, STAGE_ESTIMATE, STAGE_UPPER_NE, STAGE_LOWER_NE, STAGE_SKIN, STAGE_BROADCAST, STAGE_TICK, STAGE_NUM};
+
+constexpr int    LATENCY_BUCKETS = 192;      // 8 log-spaced buckets per octave, from 256 ns up to ~4 s
+constexpr double STATS_PERIOD    = 1.0;      // publishing period (in sec) of the latency statistics
 
 // struct version
 // {
@@ -125,6 +131,28 @@ class iCubStatus
 
 };
 
+// class latencyHistogram: lock-free histogram of latencies, filled by the
+// computation thread and read concurrently by the rpc/monitoring side
+class latencyHistogram
+{
+    std::atomic<uint32_t> buckets[LATENCY_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum_ns;
+    std::atomic<uint64_t> max_ns;
+
+    static int    bucketOf(uint64_t ns);
+    static double upperBoundOf(int bucket);
+
+public:
+    latencyHistogram();
+    void     add(double dt);
+    void     reset();
+    uint64_t getCount() const;
+    double   getMean() const;
+    double   getMax() const;
+    double   getPercentile(double p) const;
+};
+
 // class inverseDynamics: class for reading from Vrow and providing FT on an output port
 class inverseDynamics: public PeriodicThread
 {
@@ -230,6 +258,7 @@ private:
     BufferedPort<Vector> *port_all_positions;
     BufferedPort<Matrix> *port_root_position_mat;
     BufferedPort<Vector> *port_root_position_vec;
+    BufferedPort<Bottle> *port_stats;
 
     // ports outputing the external dynamics seen at the F/T sensor
     BufferedPort<Vector> *port_external_ft_arm_left;
@@ -308,6 +337,12 @@ private:
 
     void addSkinContacts();
 
+    // per-stage latency statistics
+    latencyHistogram stats[STAGE_NUM];
+    double lastEstimateTime;
+    double lastStatsTime;
+    void publishStats();
+
 public:
     inverseDynamics(int _rate, PolyDriver *_ddAL, PolyDriver *_ddAR, PolyDriver *_ddH, PolyDriver *_ddLL, PolyDriver *_ddLR, PolyDriver *_ddT, string _robot_name, string _local_name, version_tag icub_type, bool _autoconnect=false );
     bool threadInit() override;
@@ -329,6 +364,8 @@ public:
     void setZeroJntAngVelAcc();
     void sendMonitorData();
     void sendVelAccData();
+    void getStats(Bottle &b);
+    void resetStats();
 
 };
 
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+*/
+
+/**
+\defgroup icub_canBcastBenchmark canBcastBenchmark
+@ingroup icub_tools
+
+Measures the decoding throughput of the broadcast messages of the
+control boards, as done by the \e canmotioncontrol device.
+
+\section intro_sec Description
+The tool opens a \e fakecan device which replays a capture of a
+bus in the candump log format and reads it in batches, as fast as
+it can. The periodic messages of the control boards (positions,
+velocities, pid values, currents, pid errors) go through the
+decoders of motionControlLib into a structure of arrays joint
+state; after every batch the state is published to a snapshot and
+copied back, as the getters of the device do. The tool reports
+the decoded frames per second.
+
+A synthetic capture can be written with \e --record, when a real
+one (e.g. from \e candump \e -l) is not at hand.
+
+\section lib_sec Libraries
+- YARP libraries.
+- The \e fakecan device.
+- icub_firmware_shared (canProtocolLib).
+
+\section parameters_sec Parameters
+--capture \e file
+- the capture to replay.
+
+--boards \e num
+- the number of control boards, with addresses from 1 to \e num;
+  board \e b drives joints 2(b-1) and 2(b-1)+1 (default 8, max 15).
+
+--batch \e num
+- the number of frames read at once (default 500).
+
+--duration \e s
+- the duration of the test (default 5).
+
+--record \e file
+- writes a synthetic capture of \e --boards boards to \e file
+  and quits.
+
+--periods \e num
+- the number of periods of the synthetic capture, every period
+  has the periodic messages and the status of all the boards
+  (default 1000).
+
+\section tested_os_sec Tested OS
+Linux.
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/CanBusInterface.h>
+
+#include <canBcastDecoders.h>
+#include <canControlConstants.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::dev;
+
+namespace
+{
+    /********************************************************************/
+    bool record(const string &file, const int boards, const int periods)
+    {
+        FILE *fp=fopen(file.c_str(),"w");
+        if (fp==NULL)
+        {
+            printf("unable to write %s\n",file.c_str());
+            return false;
+        }
+
+        const int msgs[]={ ICUBCANPROTO_PER_MC_MSG__POSITION,
+                           ICUBCANPROTO_PER_MC_MSG__MOTOR_POSITION,
+                           ICUBCANPROTO_PER_MC_MSG__VELOCITY,
+                           ICUBCANPROTO_PER_MC_MSG__MOTOR_SPEED,
+                           ICUBCANPROTO_PER_MC_MSG__PID_VAL,
+                           ICUBCANPROTO_PER_MC_MSG__CURRENT,
+                           ICUBCANPROTO_PER_MC_MSG__PID_ERROR,
+                           ICUBCANPROTO_PER_MC_MSG__STATUS };
+
+        double stamp=Time::now();
+        for (int p=0; p<periods; p++, stamp+=0.001)
+        {
+            for (int b=1; b<=boards; b++)
+            {
+                for (size_t m=0; m<sizeof(msgs)/sizeof(msgs[0]); m++)
+                {
+                    fprintf(fp,"(%.6f) can0 %03X#",stamp,bcastId(b,msgs[m]));
+                    for (int k=0; k<8; k++)
+                        fprintf(fp,"%02X",(p*7+b*13+(int)m*3+k)&0xff);
+                    fprintf(fp,"\n");
+                }
+            }
+        }
+
+        fclose(fp);
+        printf("written %d frames to %s\n",8*boards*periods,file.c_str());
+        return true;
+    }
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Network::init();
+
+    Property opt;
+    opt.fromCommand(argc,argv);
+
+    int boards=std::min(std::max(opt.check("boards",Value(8)).asInt(),1),15);
+    int batch=std::max(opt.check("batch",Value(500)).asInt(),1);
+    double duration=std::max(opt.check("duration",Value(5.0)).asDouble(),0.1);
+
+    if (opt.check("record"))
+    {
+        int periods=std::max(opt.check("periods",Value(1000)).asInt(),1);
+        bool ok=record(opt.find("record").asString(),boards,periods);
+        Network::fini();
+        return (ok?0:1);
+    }
+
+    if (!opt.check("capture"))
+    {
+        printf("missing --capture, or --record to write one\n");
+        Network::fini();
+        return 1;
+    }
+
+    // no fake boards, only the capture
+    Property config;
+    config.fromString("(device fakecan) (GENERAL (Joints 0))"
+                      " (CAN (CanAddresses) (FakeCanReplay \""+opt.find("capture").asString()+"\"))");
+
+    PolyDriver driver;
+    ICanBus *bus=NULL;
+    ICanBufferFactory *factory=NULL;
+    if (!driver.open(config) || !driver.view(bus) || !driver.view(factory))
+    {
+        printf("unable to open fakecan with the capture\n");
+        Network::fini();
+        return 1;
+    }
+
+    const int joints=2*boards;
+    CanBuffer buffer=factory->createBuffer(batch);
+    JointStateBuffer state(joints);
+    JointStateSnapshot snapshot(joints);
+    vector<double> readout(joints);
+    const BCastDecoderTable &decoders=BCastDecoderTable::instance();
+
+    printf("decoding the broadcasts of %d boards in batches of %d frames for %g [s] ...\n",
+           boards,batch,duration);
+
+    unsigned long frames=0,decoded=0;
+    double readTime=0.0;
+    double t0=Time::now();
+    double now=t0;
+    while (now-t0<duration)
+    {
+        unsigned int n=0;
+        double t1=Time::now();
+        bus->canRead(buffer,batch,&n,false);
+        double t2=Time::now();
+        readTime+=t2-t1;
+
+        for (unsigned int i=0; i<n; i++)
+        {
+            CanMessage &m=buffer[i];
+            unsigned int id=m.getId();
+            if ((id&0x700)!=0x100)
+                continue;
+
+            int b=(id&0x0f0)>>4;
+            if ((b<1) || (b>boards))
+                continue;
+
+            BCastDecoder decode=decoders[id];
+            if (decode!=NULL)
+            {
+                int j=2*(b-1);
+                decode(m.getData(),j,j+1<joints,t2,state);
+                decoded++;
+            }
+        }
+        frames+=n;
+
+        // what the device does after a batch, and a getter afterwards
+        snapshot.publish(state);
+        snapshot.read(JointStateBuffer::POSITION,readout.data());
+
+        now=Time::now();
+    }
+    double elapsed=now-t0;
+
+    printf("read %.0f [frames/s], decoded %.0f [frames/s] (%.1f%% of the frames), %.1f [ns/frame] without the reads\n",
+           frames/elapsed,decoded/elapsed,frames>0?100.0*decoded/frames:0.0,
+           frames>0?1e9*(elapsed-readTime)/frames:0.0);
+
+    factory->destroyBuffer(buffer);
+    driver.close();
+
+    Network::fini();
+    return 0;
+}
@@ -72,6 +72,7 @@ BoardTransceiver::BoardTransceiver()
     nvset               = NULL;
 
     pApplStatus         = NULL;
+    txPeriod            = 1.0;
 
     oneNV               = eo_nv_New();
 
@@ -106,6 +107,9 @@ bool BoardTransceiver::configure(yarp::os::ResourceFinder &rf)
     }
 
     yDebug() << " I have all params I need!!";
+
+    // use e.g. --period 0.001 to emulate the 1 ms regulars of a real board (useful to benchmark the receiver of the host)
+    txPeriod = rf.check("period", Value(1.0)).asDouble();
     Bottle parameter1( rf.find("PC104IpAddress").asString() );
 
     int port      = rf.find("port").asInt();              // .get(1).asInt();
@@ -234,13 +238,20 @@ void fromDouble(ACE_Time_Value &v, double x,int unit) {
 #endif
 }
 
+// updateModule() is called every txPeriod and its recv() waits at most txPeriod, thus in running state
+// a ropframe is sent every txPeriod (RFModule would otherwise call it once per second)
+double BoardTransceiver::getPeriod()
+{
+    return txPeriod;
+}
+
 // Main loop here!!!
 bool BoardTransceiver::updateModule()
 {
     ACE_INET_Addr   sender_addr;
     ssize_t         recv_size;
     ACE_Time_Value  recvTimeOut;
-    fromDouble(recvTimeOut, 1.0);
+    fromDouble(recvTimeOut, txPeriod);
 
     uint8_t         *p_sendData;
     uint16_t        bytes_to_send = 0;
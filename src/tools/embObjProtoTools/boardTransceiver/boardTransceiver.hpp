@@ -84,6 +84,8 @@ protected:
     eOmn_appl_status_t*         pApplStatus;
     EOnv*                       oneNV;
 
+    double                      txPeriod;       // in running state a ropframe is sent at least every txPeriod seconds
+
 public:
     BoardTransceiver();
     ~BoardTransceiver();
@@ -91,6 +93,7 @@ public:
     // yarp module methods
     bool createSocket(ACE_INET_Addr local_addr);
     bool configure(yarp::os::ResourceFinder &rf);
+    double getPeriod();
     bool updateModule();
 
     // Transceiver class
@@ -0,0 +1,438 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+*/
+
+/**
+\defgroup icub_iDynBenchmark iDynBenchmark
+@ingroup icub_tools
+
+Measures the per-tick latency of the whole-body Newton-Euler
+computations of the iCub and of the estimation of the external
+contacts.
+
+\section intro_sec Description
+The tool reproduces the computations carried out at each cycle
+by \ref wholeBodyDynamics "wholeBodyDynamics": the upper and the
+lower torso of an \ref iDynBody "iCubWholeBody" are fed with
+random joints states, inertial and force/torque measurements,
+then kinematics and wrenches are propagated and the joint
+torques retrieved. The same sequence of inputs is processed by
+the allocation-free Newton-Euler engine and by the original one,
+reporting the latency statistics of both along with the largest
+discrepancy found between the estimated torques; the tool exits
+with 1 if it is above the tolerance, as well as if the contact
+wrenches estimated with and without the factorization cache
+differ by more than the tolerance. Optionally, the
+limbs of the allocation-free engine are solved concurrently on a
+pool of worker threads.
+
+The tool also validates the Composite Rigid Body Algorithm of
+iDynChain::computeMassMatrixCRBA() against the Newton-Euler
+construction of iDynChain::computeMassMatrix(), over random
+configurations of every limb of the iCubWholeBody, and exits with
+1 if the two mass matrices differ by more than the tolerance.
+
+\section lib_sec Libraries
+- YARP libraries.
+- \ref iDyn "iDyn" library.
+
+\section parameters_sec Parameters
+--ticks \e num
+- the number of cycles to be timed (default 10000).
+
+--mode \e mode
+- the Newton-Euler mode among static, dynamic (default),
+  dynamic_w_rotor and dynamic_coriolis_gravity.
+
+--seed \e num
+- the seed of the random generator (default 0).
+
+--threads \e num
+- the number of worker threads solving the limbs concurrently
+  (default 0, i.e. sequential computation).
+
+--cpus "(\e cpu0 \e cpu1 ...)"
+- the CPUs the worker threads are pinned to.
+
+--contacts \e num
+- if positive, also times the upper torso computations with the
+  given number of skin contacts on each arm, held while the robot
+  keeps its posture and the force/torque measurements change at
+  every cycle, with and without the factorization cache of the
+  contact solvers (default 0).
+
+--hold \e num
+- the number of cycles the posture is held in the contacts test
+  (default 100, i.e. 1 s at the rate of wholeBodyDynamics).
+
+--mass_trials \e num
+- the number of random configurations of each limb the mass
+  matrices are compared on (default 1000).
+
+--tol \e tol
+- the largest discrepancy tolerated between the torques of the
+  two engines, between the contact wrenches with and without the
+  factorization cache and between the mass matrices (default 1e-6).
+
+\section tested_os_sec Tested OS
+Linux and Windows.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/os/Property.h>
+#include <yarp/os/Bottle.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+#include <yarp/math/Math.h>
+
+#include <iCub/iDyn/iDyn.h>
+#include <iCub/iDyn/iDynBody.h>
+#include <iCub/iDyn/iDynContact.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace iCub::iDyn;
+
+namespace
+{
+    const char *upperLimbs[3]={"left_arm","right_arm","head"};
+    const char *lowerLimbs[3]={"left_leg","right_leg","torso"};
+    const iCub::skinDynLib::BodyPart upperParts[3]={iCub::skinDynLib::LEFT_ARM,iCub::skinDynLib::RIGHT_ARM,iCub::skinDynLib::HEAD};
+    const iCub::skinDynLib::BodyPart lowerParts[3]={iCub::skinDynLib::LEFT_LEG,iCub::skinDynLib::RIGHT_LEG,iCub::skinDynLib::TORSO};
+
+    /********************************************************************/
+    struct Inputs
+    {
+        Vector q[6],dq[6],ddq[6];
+        Vector w0,dw0,ddp0;
+        Vector FM_ra,FM_la,FM_up,FM_rl,FM_ll;
+    };
+
+    /********************************************************************/
+    Vector randVector(const size_t n, const double range)
+    {
+        Vector v(n);
+        for (size_t i=0; i<n; i++)
+            v[i]=range*(2.0*rand()/(double)RAND_MAX-1.0);
+        return v;
+    }
+
+    /********************************************************************/
+    void setFastNewtonEuler(iCubWholeBody &body, const bool sw)
+    {
+        body.upperTorso->left->setFastNewtonEuler(sw);
+        body.upperTorso->right->setFastNewtonEuler(sw);
+        body.upperTorso->up->setFastNewtonEuler(sw);
+        body.lowerTorso->left->setFastNewtonEuler(sw);
+        body.lowerTorso->right->setFastNewtonEuler(sw);
+        body.lowerTorso->up->setFastNewtonEuler(sw);
+    }
+
+    /********************************************************************/
+    Vector tick(iCubWholeBody &body, const Inputs &in)
+    {
+        for (int i=0; i<3; i++)
+        {
+            body.upperTorso->setAng(upperLimbs[i],in.q[i]);
+            body.upperTorso->setDAng(upperLimbs[i],in.dq[i]);
+            body.upperTorso->setD2Ang(upperLimbs[i],in.ddq[i]);
+            body.lowerTorso->setAng(lowerLimbs[i],in.q[3+i]);
+            body.lowerTorso->setDAng(lowerLimbs[i],in.dq[3+i]);
+            body.lowerTorso->setD2Ang(lowerLimbs[i],in.ddq[3+i]);
+        }
+
+        body.upperTorso->setInertialMeasure(in.w0,in.dw0,in.ddp0);
+        body.upperTorso->setSensorMeasurement(in.FM_ra,in.FM_la,in.FM_up);
+        body.upperTorso->solveKinematics();
+        body.upperTorso->solveWrench();
+
+        body.attachLowerTorso(in.FM_rl,in.FM_ll);
+        body.lowerTorso->solveKinematics();
+        body.lowerTorso->solveWrench();
+
+        Vector tau;
+        for (int i=0; i<3; i++)
+        {
+            tau=yarp::math::cat(tau,body.upperTorso->getTorques(upperLimbs[i]));
+            tau=yarp::math::cat(tau,body.lowerTorso->getTorques(lowerLimbs[i]));
+        }
+        return tau;
+    }
+
+    /********************************************************************/
+    void addContacts(iCubWholeBody &body, const vector<iCub::skinDynLib::dynContact> &contacts)
+    {
+        body.upperTorso->clearContactList();
+        for (size_t i=0; i<contacts.size(); i++)
+        {
+            if (contacts[i].getBodyPart()==iCub::skinDynLib::LEFT_ARM)
+                body.upperTorso->leftSensor->addContact(contacts[i]);
+            else
+                body.upperTorso->rightSensor->addContact(contacts[i]);
+        }
+    }
+
+    /********************************************************************/
+    double contactsTick(iCubWholeBody &body, const Inputs &in, Vector &wrenches)
+    {
+        double t0=Time::now();
+        body.upperTorso->setInertialMeasure(in.w0,in.dw0,in.ddp0);
+        body.upperTorso->setSensorMeasurement(in.FM_ra,in.FM_la,in.FM_up);
+        body.upperTorso->solveKinematics();
+        body.upperTorso->solveWrench();
+        double t1=Time::now();
+
+        wrenches.resize(0);
+        const iCub::skinDynLib::dynContactList &l=body.upperTorso->leftSensor->getContactList();
+        const iCub::skinDynLib::dynContactList &r=body.upperTorso->rightSensor->getContactList();
+        for (size_t i=0; i<l.size(); i++)
+            wrenches=yarp::math::cat(wrenches,l[i].getForceMoment());
+        for (size_t i=0; i<r.size(); i++)
+            wrenches=yarp::math::cat(wrenches,r[i].getForceMoment());
+
+        return t1-t0;
+    }
+
+    /********************************************************************/
+    // the largest discrepancy between the mass matrices computed through
+    // the CRBA and through Newton-Euler, over random configurations
+    double massMatrixDiscrepancy(iCubWholeBody &body, const unsigned int *dof, const int trials)
+    {
+        double maxErr=0.0;
+        Matrix M,Mcrba;
+        for (int t=0; t<trials; t++)
+        {
+            for (int i=0; i<3; i++)
+            {
+                body.upperTorso->setAng(upperLimbs[i],randVector(dof[i],M_PI/4.0));
+                body.lowerTorso->setAng(lowerLimbs[i],randVector(dof[3+i],M_PI/4.0));
+            }
+
+            for (int i=0; i<6; i++)
+            {
+                iCub::skinDynLib::BodyPart part=(i<3?upperParts[i]:lowerParts[i-3]);
+                body.computeMassMatrix(part,M,false);
+                body.computeMassMatrix(part,Mcrba,true);
+                for (size_t r=0; r<M.rows(); r++)
+                    for (size_t c=0; c<M.cols(); c++)
+                        maxErr=std::max(maxErr,fabs(M(r,c)-Mcrba(r,c)));
+            }
+        }
+        return maxErr;
+    }
+
+    /********************************************************************/
+    void report(const string &name, vector<double> &lat)
+    {
+        sort(lat.begin(),lat.end());
+        double mean=0.0;
+        for (size_t i=0; i<lat.size(); i++)
+            mean+=lat[i];
+        mean/=lat.size();
+
+        printf("%-10s mean %8.2f [us]  median %8.2f [us]  p99 %8.2f [us]  max %8.2f [us]\n",
+               name.c_str(),1e6*mean,1e6*lat[lat.size()/2],
+               1e6*lat[(size_t)(0.99*(lat.size()-1))],1e6*lat.back());
+    }
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property opt;
+    opt.fromCommand(argc,argv);
+
+    int ticks=std::max(opt.check("ticks",Value(10000)).asInt(),1);
+    string modeStr=opt.check("mode",Value("dynamic")).asString();
+    srand(opt.check("seed",Value(0)).asInt());
+    int threads=std::max(opt.check("threads",Value(0)).asInt(),0);
+    int numContacts=std::max(opt.check("contacts",Value(0)).asInt(),0);
+    int hold=std::max(opt.check("hold",Value(100)).asInt(),1);
+    int massTrials=std::max(opt.check("mass_trials",Value(1000)).asInt(),1);
+    double tol=opt.check("tol",Value(1e-6)).asDouble();
+
+    vector<int> cpus;
+    if (Bottle *b=opt.find("cpus").asList())
+        for (int i=0; i<b->size(); i++)
+            cpus.push_back(b->get(i).asInt());
+
+    NewEulMode mode;
+    if (modeStr=="static")
+        mode=STATIC;
+    else if (modeStr=="dynamic")
+        mode=DYNAMIC;
+    else if (modeStr=="dynamic_w_rotor")
+        mode=DYNAMIC_W_ROTOR;
+    else if (modeStr=="dynamic_coriolis_gravity")
+        mode=DYNAMIC_CORIOLIS_GRAVITY;
+    else
+    {
+        printf("unknown mode %s\n",modeStr.c_str());
+        return 1;
+    }
+
+    version_tag tag;
+    iCubWholeBody fastBody(tag,mode,iCub::skinDynLib::NO_VERBOSE);
+    iCubWholeBody origBody(tag,mode,iCub::skinDynLib::NO_VERBOSE);
+    setFastNewtonEuler(fastBody,true);
+    setFastNewtonEuler(origBody,false);
+    fastBody.setParallelSolver(threads,cpus);
+
+    unsigned int dof[6];
+    for (int i=0; i<3; i++)
+    {
+        dof[i]=fastBody.upperTorso->getNLinks(upperLimbs[i]);
+        dof[3+i]=fastBody.lowerTorso->getNLinks(lowerLimbs[i]);
+    }
+
+    printf("timing %d ticks of the whole-body Newton-Euler (%s mode, %d worker threads) ...\n",
+           ticks,modeStr.c_str(),threads);
+
+    vector<double> latFast,latOrig;
+    latFast.reserve(ticks);
+    latOrig.reserve(ticks);
+    double maxErr=0.0;
+
+    Inputs in;
+    for (int t=0; t<ticks; t++)
+    {
+        for (int i=0; i<6; i++)
+        {
+            in.q[i]=randVector(dof[i],M_PI/4.0);
+            in.dq[i]=randVector(dof[i],1.0);
+            in.ddq[i]=randVector(dof[i],1.0);
+        }
+        in.w0=randVector(3,0.1);
+        in.dw0=randVector(3,0.1);
+        in.ddp0=randVector(3,0.5);
+        in.ddp0[2]+=9.81;
+        in.FM_ra=randVector(6,5.0);
+        in.FM_la=randVector(6,5.0);
+        in.FM_up=randVector(6,0.0);
+        in.FM_rl=randVector(6,5.0);
+        in.FM_ll=randVector(6,5.0);
+
+        double t0=Time::now();
+        Vector tauFast=tick(fastBody,in);
+        double t1=Time::now();
+        Vector tauOrig=tick(origBody,in);
+        double t2=Time::now();
+
+        latFast.push_back(t1-t0);
+        latOrig.push_back(t2-t1);
+        for (size_t i=0; i<tauFast.length(); i++)
+            maxErr=std::max(maxErr,fabs(tauFast[i]-tauOrig[i]));
+    }
+
+    report("fast",latFast);
+    report("original",latOrig);
+    printf("max torque discrepancy %g [Nm]\n",maxErr);
+
+    bool ok=true;
+    if (maxErr>tol)
+    {
+        printf("torque discrepancy above the tolerance %g\n",tol);
+        ok=false;
+    }
+
+    if (numContacts>0)
+    {
+        printf("timing %d ticks of the upper torso with %d contacts per arm, posture held for %d ticks ...\n",
+               ticks,numContacts,hold);
+
+        iCubWholeBody cachedBody(tag,mode,iCub::skinDynLib::NO_VERBOSE);
+        iCubWholeBody plainBody(tag,mode,iCub::skinDynLib::NO_VERBOSE);
+        plainBody.upperTorso->leftSensor->setFactorizationCache(false);
+        plainBody.upperTorso->rightSensor->setFactorizationCache(false);
+
+        // skin contacts are spread on the forearm and on the hand, with
+        // unknown force and null moment as done by wholeBodyDynamics
+        vector<iCub::skinDynLib::dynContact> contacts;
+        for (int i=0; i<numContacts; i++)
+        {
+            for (int j=0; j<2; j++)
+            {
+                iCub::skinDynLib::dynContact c(j==0?iCub::skinDynLib::LEFT_ARM:iCub::skinDynLib::RIGHT_ARM,
+                                               (i%2==0)?4:6,randVector(3,0.03));
+                c.fixMoment();
+                contacts.push_back(c);
+            }
+        }
+        addContacts(cachedBody,contacts);
+        addContacts(plainBody,contacts);
+
+        vector<double> latCached,latPlain;
+        latCached.reserve(ticks);
+        latPlain.reserve(ticks);
+        double maxWrenchErr=0.0;
+
+        Vector wCached,wPlain;
+        for (int t=0; t<ticks; t++)
+        {
+            if (t%hold==0)
+            {
+                for (int i=0; i<3; i++)
+                {
+                    in.q[i]=randVector(dof[i],M_PI/4.0);
+                    cachedBody.upperTorso->setAng(upperLimbs[i],in.q[i]);
+                    plainBody.upperTorso->setAng(upperLimbs[i],in.q[i]);
+                }
+            }
+            in.w0=randVector(3,0.1);
+            in.dw0=randVector(3,0.1);
+            in.ddp0=randVector(3,0.5);
+            in.ddp0[2]+=9.81;
+            in.FM_ra=randVector(6,5.0);
+            in.FM_la=randVector(6,5.0);
+            in.FM_up=randVector(6,0.0);
+
+            latCached.push_back(contactsTick(cachedBody,in,wCached));
+            latPlain.push_back(contactsTick(plainBody,in,wPlain));
+            for (size_t i=0; i<wCached.length(); i++)
+                maxWrenchErr=std::max(maxWrenchErr,fabs(wCached[i]-wPlain[i]));
+        }
+
+        report("cached",latCached);
+        report("uncached",latPlain);
+        printf("factorizations %lu, cache hits %lu\n",
+               cachedBody.upperTorso->leftSensor->getFactorizationNumber()+
+               cachedBody.upperTorso->rightSensor->getFactorizationNumber(),
+               cachedBody.upperTorso->leftSensor->getCacheHitNumber()+
+               cachedBody.upperTorso->rightSensor->getCacheHitNumber());
+        printf("max contact wrench discrepancy %g\n",maxWrenchErr);
+
+        if (maxWrenchErr>tol)
+        {
+            printf("contact wrench discrepancy above the tolerance %g\n",tol);
+            ok=false;
+        }
+    }
+
+    // the mass matrices are computed on a body of their own, since the
+    // Newton-Euler construction switches the limbs to the dynamic mode
+    iCubWholeBody massBody(tag,mode,iCub::skinDynLib::NO_VERBOSE);
+    double maxMassErr=massMatrixDiscrepancy(massBody,dof,massTrials);
+    printf("max mass matrix discrepancy (CRBA vs Newton-Euler, %d configurations per limb) %g\n",
+           massTrials,maxMassErr);
+
+    if (maxMassErr>tol)
+    {
+        printf("mass matrix discrepancy above the tolerance %g\n",tol);
+        ok=false;
+    }
+
+    return (ok?0:1);
+}
@@ -0,0 +1,624 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+*/
+
+/**
+\defgroup icub_iKinBenchmark iKinBenchmark
+@ingroup icub_tools
+
+Measures the latency of the forward kinematics of the iCub limbs
+computed by \ref iKin "iKin" and the cost of the exact Hessian in
+the inverse kinematics, along with the hit rate and the latency
+of the closed-form inversion of the arm.
+
+\section intro_sec Description
+The tool feeds an \ref iKinFwd "iCubArm" and an iCubLeg with
+random joints configurations and times the end-effector pose and
+the geometric Jacobian computed in three ways: with the products
+of the link matrices as yarp::sig::Matrix temporaries (the way
+iKinChain used to compute them), through the methods of the
+chain returning new objects (getH(), EndEffPose(),
+GeoJacobian()) and through the fixed-size methods filling
+preallocated buffers (fastEndEffPose(), fastGeoJacobian()). The
+results of the last two ways must be bit-identical to the first
+one: the number of mismatching elements and the largest
+discrepancy are reported, and the tool exits with 1 if any
+element differs.
+The cache of the forward kinematics is disabled, so that every
+call pays for the whole forward pass.
+
+With \e --test \e batch the tool times the end-effector poses
+and the geometric Jacobians of batches of random configurations
+computed at once by batchEndEffPose() against the same
+quantities computed one configuration at a time with the
+fixed-size methods, and reports the latency per configuration
+along with the largest discrepancy. The batch kernel exploits
+the sparsity of the DH matrices, so the results are not meant to
+be bit-identical. The AVX2 kernel is used if iKin is built with
+ICUB_IKIN_USE_AVX2 and the CPU supports it.
+
+With \e --test \e hessian the tool solves the same set of
+reachable targets (full pose) with \ref iKinIpOpt "iKinIpOptMin",
+once with the exact Hessian and once with the limited-memory
+approximation of IPOPT, for the arm alone and for the arm with
+the torso, and reports the iterations, the solving time and the
+position error of both. 
+With \e --test \e analytic the tool solves random reachable
+targets (full pose) of the arm with the torso blocked, which
+also satisfy the \ref iKinIpOpt "iCubAdditionalArmConstraints",
+with the iCubArmAnalyticSolver and with iKinIpOptMin, as done by
+the \ref iKinSlv "Cartesian Solver" for the full pose requests.
+The tool reports the fraction of targets solved in closed form,
+the latency of both the solvers and the position error.
+
+The hessian and analytic tests are available only if iKin is
+built with IPOPT.
+
+\section lib_sec Libraries
+- YARP libraries.
+- \ref iKin "iKin" library.
+
+\section parameters_sec Parameters
+--test \e name
+- the test among fwd (default), batch, hessian and analytic.
+
+--trials \e num
+- the number of random configurations (default 100000); for the
+  hessian and analytic tests, the number of targets (default
+  100 and 1000, respectively).
+
+--torso \e switch
+- if "on", the torso joints are released for the arm in the fwd
+  and batch tests (default "on").
+
+--batch \e num
+- the number of configurations of a batch in the batch test
+  (default 64).
+
+--seed \e num
+- the seed of the random generator (default 0).
+
+\section tested_os_sec Tested OS
+Linux and Windows.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/sig/Vector.h>
+#include <yarp/sig/Matrix.h>
+#include <yarp/math/Math.h>
+
+#include <iCub/ctrl/math.h>
+#include <iCub/iKin/iKinFwd.h>
+#ifdef IKINBENCHMARK_USE_IPOPT
+    #include <iCub/iKin/iKinIpOpt.h>
+#endif
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::sig;
+using namespace yarp::math;
+using namespace iCub::ctrl;
+using namespace iCub::iKin;
+
+namespace
+{
+    /********************************************************************/
+    Vector randConfiguration(iKinChain &chain)
+    {
+        Vector q(chain.getDOF());
+        for (size_t i=0,j=0; i<chain.getN(); i++)
+        {
+            if (!chain[i].isBlocked())
+            {
+                double min=chain[i].getMin();
+                double max=chain[i].getMax();
+                q[j++]=min+(max-min)*rand()/(double)RAND_MAX;
+            }
+        }
+        return q;
+    }
+
+    /********************************************************************/
+    // the end-effector pose as computed by iKinChain with dynamic-size matrices:
+    // the blocked links are folded into the following free link (or into the
+    // last link), as build() does with the cumulative matrices
+    Vector refEndEffPose(iKinChain &chain)
+    {
+        const unsigned int N=chain.getN();
+        Matrix H=chain.getH0();
+        Matrix C=eye(4,4);
+        bool cumulOn=false;
+
+        for (unsigned int i=0; i<N; i++)
+        {
+            if (chain[i].isBlocked())
+            {
+                if (i==N-1)
+                    H*=C*chain[i].getH(true);
+                else
+                {
+                    C*=chain[i].getH(true);
+                    cumulOn=true;
+                }
+            }
+            else
+            {
+                if (cumulOn)
+                    H*=C*chain[i].getH(true);
+                else
+                    H*=chain[i].getH(true);
+
+                C.eye();
+                cumulOn=false;
+            }
+        }
+        H*=chain.getHN();
+
+        Vector r=dcm2axis(H);
+        Vector v(7);
+        v[0]=H(0,3);
+        v[1]=H(1,3);
+        v[2]=H(2,3);
+        v[3]=r[0];
+        v[4]=r[1];
+        v[5]=r[2];
+        v[6]=r[3];
+        return v;
+    }
+
+    /********************************************************************/
+    // the geometric Jacobian as computed by iKinChain with dynamic-size matrices
+    Matrix refGeoJacobian(iKinChain &chain)
+    {
+        const unsigned int N=chain.getN();
+        Matrix J(6,chain.getDOF());
+
+        deque<Matrix> intH;
+        intH.push_back(chain.getH0());
+        for (unsigned int i=0; i<N; i++)
+            intH.push_back(intH[i]*chain[i].getH(true));
+
+        Matrix PN=intH[N]*chain.getHN();
+        for (unsigned int i=0,c=0; i<N; i++)
+        {
+            if (chain[i].isBlocked())
+                continue;
+
+            Matrix Z=intH[i];
+            Vector w=cross(Z,2,PN-Z,3);
+            J(0,c)=w[0];
+            J(1,c)=w[1];
+            J(2,c)=w[2];
+            J(3,c)=Z(0,2);
+            J(4,c)=Z(1,2);
+            J(5,c)=Z(2,2);
+            c++;
+        }
+        return J;
+    }
+
+    /********************************************************************/
+    // the number of elements which are not exactly equal
+    size_t mismatches(const double *a, const double *b, const size_t n)
+    {
+        size_t cnt=0;
+        for (size_t i=0; i<n; i++)
+            if (!(a[i]==b[i]))
+                cnt++;
+        return cnt;
+    }
+
+    /********************************************************************/
+    double maxDiff(const double *a, const double *b, const size_t n)
+    {
+        double d=0.0;
+        for (size_t i=0; i<n; i++)
+            d=std::max(d,fabs(a[i]-b[i]));
+        return d;
+    }
+
+    /********************************************************************/
+    void report(const string &name, vector<double> &lat)
+    {
+        sort(lat.begin(),lat.end());
+        double mean=0.0;
+        for (size_t i=0; i<lat.size(); i++)
+            mean+=lat[i];
+        mean/=lat.size();
+
+        printf("%-18s mean %8.3f [us]  median %8.3f [us]  p99 %8.3f [us]  max %8.3f [us]\n",
+               name.c_str(),1e6*mean,1e6*lat[lat.size()/2],
+               1e6*lat[(size_t)(0.99*(lat.size()-1))],1e6*lat.back());
+    }
+
+    /********************************************************************/
+    bool testFwd(iKinLimb &limb, const string &name, const int trials)
+    {
+        iKinChain &chain=*limb.asChain();
+        const unsigned int dof=chain.getDOF();
+
+        // every call pays for the whole forward pass
+        chain.setFwdKinCache(false);
+
+        printf("timing %d configurations of the %s (%u DOF) ...\n",trials,name.c_str(),dof);
+
+        vector<double> latRefPose,latApiPose,latFastPose;
+        vector<double> latRefJ,latApiJ,latFastJ;
+        latRefPose.reserve(trials); latApiPose.reserve(trials); latFastPose.reserve(trials);
+        latRefJ.reserve(trials); latApiJ.reserve(trials); latFastJ.reserve(trials);
+
+        Vector poseFast(7);
+        Matrix JFast(6,dof);
+        double errPose=0.0,errJ=0.0;
+        size_t badPose=0,badJ=0;
+
+        for (int t=0; t<trials; t++)
+        {
+            Vector q=randConfiguration(chain);
+            chain.setAng(q);
+
+            double t0=Time::now();
+            Vector poseRef=refEndEffPose(chain);
+            double t1=Time::now();
+            Matrix JRef=refGeoJacobian(chain);
+            double t2=Time::now();
+
+            double t3=Time::now();
+            Vector poseApi=chain.EndEffPose();
+            double t4=Time::now();
+            double t5=Time::now();
+            Matrix JApi=chain.GeoJacobian();
+            double t6=Time::now();
+
+            double t7=Time::now();
+            chain.fastEndEffPose(poseFast);
+            double t8=Time::now();
+            double t9=Time::now();
+            chain.fastGeoJacobian(JFast);
+            double t10=Time::now();
+
+            latRefPose.push_back(t1-t0);
+            latRefJ.push_back(t2-t1);
+            latApiPose.push_back(t4-t3);
+            latApiJ.push_back(t6-t5);
+            latFastPose.push_back(t8-t7);
+            latFastJ.push_back(t10-t9);
+
+            badPose+=mismatches(poseRef.data(),poseApi.data(),7);
+            badPose+=mismatches(poseRef.data(),poseFast.data(),7);
+            badJ+=mismatches(JRef.data(),JApi.data(),6*dof);
+            badJ+=mismatches(JRef.data(),JFast.data(),6*dof);
+
+            errPose=std::max(errPose,maxDiff(poseRef.data(),poseApi.data(),7));
+            errPose=std::max(errPose,maxDiff(poseRef.data(),poseFast.data(),7));
+            errJ=std::max(errJ,maxDiff(JRef.data(),JApi.data(),6*dof));
+            errJ=std::max(errJ,maxDiff(JRef.data(),JFast.data(),6*dof));
+        }
+
+        report("pose matrices",latRefPose);
+        report("pose EndEffPose",latApiPose);
+        report("pose fast",latFastPose);
+        report("jacobian matrices",latRefJ);
+        report("jacobian GeoJac",latApiJ);
+        report("jacobian fast",latFastJ);
+        printf("mismatching elements: pose %zu (max discrepancy %g), jacobian %zu (max discrepancy %g)\n",
+               badPose,errPose,badJ,errJ);
+
+        bool ok=(badPose==0) && (badJ==0);
+        printf("%s\n\n",ok?"results are bit-identical":"FAILED: results are not bit-identical");
+        return ok;
+    }
+
+    /********************************************************************/
+    void testBatch(iKinLimb &limb, const string &name, const int trials, const int M)
+    {
+        iKinChain &chain=*limb.asChain();
+        const unsigned int dof=chain.getDOF();
+        const int batches=std::max(trials/M,1);
+
+        chain.setFwdKinCache(false);
+
+        printf("timing %d batches of %d configurations of the %s (%u DOF) ...\n",
+               batches,M,name.c_str(),dof);
+
+        vector<double> latBatchPose,latBatchJ,latLoopPose,latLoopJ;
+        latBatchPose.reserve(batches); latBatchJ.reserve(batches);
+        latLoopPose.reserve(batches); latLoopJ.reserve(batches);
+
+        vector<Vector> qs(M);
+        Matrix Q(dof,M),poses,J;
+        Matrix posesLoop(7,M),JLoop(6*dof,M);
+        Vector pose(7);
+        Matrix JFast(6,dof);
+        double errPose=0.0,errJ=0.0;
+
+        for (int b=0; b<batches; b++)
+        {
+            for (int m=0; m<M; m++)
+            {
+                qs[m]=randConfiguration(chain);
+                Q.setCol(m,qs[m]);
+            }
+
+            double t0=Time::now();
+            chain.batchEndEffPose(Q,poses);
+            double t1=Time::now();
+            chain.batchEndEffPose(Q,poses,&J);
+            double t2=Time::now();
+
+            double t3=Time::now();
+            for (int m=0; m<M; m++)
+            {
+                chain.fastEndEffPose(qs[m],pose);
+                posesLoop.setCol(m,pose);
+            }
+            double t4=Time::now();
+            for (int m=0; m<M; m++)
+            {
+                chain.setAng(qs[m]);
+                chain.fastEndEffPose(pose);
+                chain.fastGeoJacobian(JFast);
+                posesLoop.setCol(m,pose);
+                for (unsigned int r=0; r<6; r++)
+                    for (unsigned int c=0; c<dof; c++)
+                        JLoop(r*dof+c,m)=JFast(r,c);
+            }
+            double t5=Time::now();
+
+            // per configuration
+            latBatchPose.push_back((t1-t0)/M);
+            latBatchJ.push_back((t2-t1)/M);
+            latLoopPose.push_back((t4-t3)/M);
+            latLoopJ.push_back((t5-t4)/M);
+
+            errPose=std::max(errPose,maxDiff(poses.data(),posesLoop.data(),7*M));
+            errJ=std::max(errJ,maxDiff(J.data(),JLoop.data(),6*dof*M));
+        }
+
+        report("pose loop",latLoopPose);
+        report("pose batch",latBatchPose);
+        report("pose+jac loop",latLoopJ);
+        report("pose+jac batch",latBatchJ);
+        printf("max discrepancy: pose %g, jacobian %g\n\n",errPose,errJ);
+    }
+
+#ifdef IKINBENCHMARK_USE_IPOPT
+    /********************************************************************/
+    class IterationsCounter : public iKinIterateCallback
+    {
+    public:
+        int n;
+        IterationsCounter() : n(0) { }
+        void exec(const Vector &xd, const Vector &q) override { n++; }
+    };
+
+    /********************************************************************/
+    Vector midConfiguration(iKinChain &chain)
+    {
+        Vector q(chain.getDOF());
+        for (size_t i=0,j=0; i<chain.getN(); i++)
+            if (!chain[i].isBlocked())
+                q[j++]=0.5*(chain[i].getMin()+chain[i].getMax());
+        return q;
+    }
+
+    /********************************************************************/
+    void testHessian(iKinLimb &limb, const string &name, const int trials)
+    {
+        iKinChain &chain=*limb.asChain();
+        Vector q0=midConfiguration(chain);
+
+        // the targets are reached by random configurations
+        vector<Vector> targets;
+        for (int t=0; t<trials; t++)
+            targets.push_back(chain.EndEffPose(randConfiguration(chain)));
+
+        printf("solving %d targets with the %s (%u DOF) ...\n",trials,name.c_str(),chain.getDOF());
+
+        const char *hessians[2]={"exact","limited-memory"};
+        for (int h=0; h<2; h++)
+        {
+            iKinIpOptMin slv(chain,IKINCTRL_POSE_FULL,1e-3,1e-6,200);
+            slv.setHessianOpt(h==0);
+            slv.setSolutionCache(false);
+
+            vector<double> lat;
+            lat.reserve(trials);
+            double iters=0.0,err=0.0;
+            int maxIters=0;
+
+            Vector dummy(1,0.0);
+            for (int t=0; t<trials; t++)
+            {
+                Vector xd=targets[t];
+                IterationsCounter counter;
+                chain.setAng(q0);
+
+                double t0=Time::now();
+                Vector q=slv.solve(q0,xd,0.0,dummy,dummy,0.0,dummy,dummy,NULL,NULL,&counter);
+                double t1=Time::now();
+
+                lat.push_back(t1-t0);
+                iters+=counter.n;
+                maxIters=std::max(maxIters,counter.n);
+
+                Vector x=chain.EndEffPose(q);
+                err+=norm(x.subVector(0,2)-xd.subVector(0,2));
+            }
+
+            printf("%-14s iterations mean %6.1f max %3d, position error mean %.2e [m]\n",
+                   hessians[h],iters/trials,maxIters,err/trials);
+            report(hessians[h],lat);
+        }
+        printf("\n");
+    }
+
+    /********************************************************************/
+    bool satisfies(iKinLinIneqConstr &lic, const Vector &q)
+    {
+        if (!lic.isActive())
+            return true;
+
+        Vector c=lic.getC()*q;
+        for (size_t i=0; i<c.length(); i++)
+            if ((c[i]<lic.getlB()[i]) || (c[i]>lic.getuB()[i]))
+                return false;
+        return true;
+    }
+
+    /********************************************************************/
+    void testAnalytic(iCubArm &arm, const string &name, const int trials)
+    {
+        iKinChain &chain=*arm.asChain();
+        Vector q0=midConfiguration(chain);
+
+        iCubAdditionalArmConstraints lic(arm);
+        iCubArmAnalyticSolver analytic(arm);
+        analytic.attachLIC(lic);
+        if (!analytic.isSupported())
+        {
+            printf("the closed-form inversion does not support the %s\n",name.c_str());
+            return;
+        }
+
+        iKinIpOptMin slv(chain,IKINCTRL_POSE_FULL,1e-3,1e-6,200);
+        slv.attachLIC(lic);
+        slv.setSolutionCache(false);
+
+        // the targets are reached by random configurations within the constraints
+        vector<Vector> targets;
+        while ((int)targets.size()<trials)
+        {
+            Vector q=randConfiguration(chain);
+            if (satisfies(lic,q))
+                targets.push_back(chain.EndEffPose(q));
+        }
+
+        printf("solving %d targets with the %s (%u DOF) ...\n",trials,name.c_str(),chain.getDOF());
+
+        vector<double> latAnalytic,latIpOpt;
+        latAnalytic.reserve(trials);
+        latIpOpt.reserve(trials);
+        double errAnalytic=0.0,errIpOpt=0.0;
+
+        for (int t=0; t<trials; t++)
+        {
+            Vector xd=targets[t];
+            Vector qd;
+
+            chain.setAng(q0);
+            double t0=Time::now();
+            bool hit=analytic.solve(q0,xd,qd);
+            double t1=Time::now();
+            if (hit)
+            {
+                latAnalytic.push_back(t1-t0);
+                Vector x=chain.EndEffPose(qd);
+                errAnalytic+=norm(x.subVector(0,2)-xd.subVector(0,2));
+            }
+
+            chain.setAng(q0);
+            double t2=Time::now();
+            Vector q=slv.solve(q0,xd);
+            double t3=Time::now();
+            latIpOpt.push_back(t3-t2);
+            Vector x=chain.EndEffPose(q);
+            errIpOpt+=norm(x.subVector(0,2)-xd.subVector(0,2));
+        }
+
+        printf("solved in closed form %d/%d (%.1f%%)\n",(int)latAnalytic.size(),trials,
+               100.0*latAnalytic.size()/trials);
+        if (!latAnalytic.empty())
+        {
+            printf("closed form    position error mean %.2e [m]\n",errAnalytic/latAnalytic.size());
+            report("closed form",latAnalytic);
+        }
+        printf("ipopt          position error mean %.2e [m]\n",errIpOpt/trials);
+        report("ipopt",latIpOpt);
+        printf("\n");
+    }
+#endif
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property opt;
+    opt.fromCommand(argc,argv);
+
+    string test=opt.check("test",Value("fwd")).asString();
+    bool torso=(opt.check("torso",Value("on")).asString()=="on");
+    srand(opt.check("seed",Value(0)).asInt());
+
+    if (test=="fwd")
+    {
+        int trials=std::max(opt.check("trials",Value(100000)).asInt(),1);
+
+        iCubArm arm("right");
+        if (torso)
+            for (int i=0; i<3; i++)
+                arm.releaseLink(i);
+        iCubLeg leg("right");
+
+        bool ok=testFwd(arm,"right arm",trials);
+        ok&=testFwd(leg,"right leg",trials);
+        if (!ok)
+            return 1;
+    }
+    else if (test=="batch")
+    {
+        int trials=std::max(opt.check("trials",Value(100000)).asInt(),1);
+        int batch=std::max(opt.check("batch",Value(64)).asInt(),1);
+
+        iCubArm arm("right");
+        if (torso)
+            for (int i=0; i<3; i++)
+                arm.releaseLink(i);
+        iCubLeg leg("right");
+
+        testBatch(arm,"right arm",trials,batch);
+        testBatch(leg,"right leg",trials,batch);
+    }
+#ifdef IKINBENCHMARK_USE_IPOPT
+    else if (test=="hessian")
+    {
+        int trials=std::max(opt.check("trials",Value(100)).asInt(),1);
+
+        iCubArm arm("right");
+        testHessian(arm,"right arm",trials);
+
+        iCubArm armTorso("right");
+        for (int i=0; i<3; i++)
+            armTorso.releaseLink(i);
+        testHessian(armTorso,"right arm+torso",trials);
+    }
+    else if (test=="analytic")
+    {
+        int trials=std::max(opt.check("trials",Value(1000)).asInt(),1);
+
+        iCubArm arm("right");
+        testAnalytic(arm,"right arm",trials);
+    }
+#endif
+    else
+    {
+        printf("unknown or unavailable test %s\n",test.c_str());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+*/
+
+/**
+\defgroup icub_iKinReachMapBuilder iKinReachMapBuilder
+@ingroup icub_tools
+
+Offline builder of the reachability maps of the iCub limbs.
+
+\section intro_sec Description
+The tool samples the workspace of the selected limb in parallel
+and saves the resulting \ref iKinReach "reachability map" to
+file. The map can be then given to the \ref iKinSlv "Cartesian
+Solver" through the option \e reach_map.
+
+\section lib_sec Libraries
+- YARP libraries.
+- \ref iKin "iKin" library.
+
+\section parameters_sec Parameters
+--part \e part
+- select the limb among left_arm, right_arm (default),
+  left_leg and right_leg.
+
+--type \e type
+- specify the hardware version of the limb (e.g. v2), as done
+  for the Cartesian Solver.
+
+--torso \e switch
+- if "on", the torso joints are released for the arms (default
+  "off"); the map is bound to this configuration.
+
+--voxel \e size
+- the size of the voxels in meters (default 0.02).
+
+--samples \e num
+- the number of random configurations (default 1000000).
+
+--threads \e num
+- the number of sampling threads (default 0, i.e. all cores).
+
+--seed \e num
+- the seed of the random generators (default 0).
+
+--out \e file
+- the output file (default <part>.map).
+
+\section tested_os_sec Tested OS
+Linux and Windows.
+*/
+
+#include <cstdio>
+#include <string>
+
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+
+#include <iCub/iKin/iKinFwd.h>
+#include <iCub/iKin/iKinReach.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace iCub::iKin;
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Property opt;
+    opt.fromCommand(argc,argv);
+
+    string part=opt.check("part",Value("right_arm")).asString();
+    string side=part.substr(0,part.find('_'));
+    string kind=part.substr(part.find('_')+1);
+    if (((side!="left") && (side!="right")) || ((kind!="arm") && (kind!="leg")))
+    {
+        printf("unknown part %s\n",part.c_str());
+        return 1;
+    }
+
+    string type=side;
+    if (opt.check("type"))
+        type+="_"+opt.find("type").asString();
+
+    iKinLimb *limb;
+    if (kind=="arm")
+    {
+        limb=new iCubArm(type);
+        if (opt.check("torso",Value("off")).asString()=="on")
+            for (int i=0; i<3; i++)
+                limb->releaseLink(i);
+    }
+    else
+        limb=new iCubLeg(type);
+
+    double voxelSize=opt.check("voxel",Value(0.02)).asDouble();
+    int samples=opt.check("samples",Value(1000000)).asInt();
+    int threads=opt.check("threads",Value(0)).asInt();
+    int seed=opt.check("seed",Value(0)).asInt();
+    string fileName=opt.check("out",Value(part+".map")).asString();
+
+    printf("sampling %s (%s, %d DOF) with %d configurations ...\n",
+           part.c_str(),limb->getType().c_str(),limb->getDOF(),samples);
+
+    iKinReachMap map;
+    double t0=Time::now();
+    bool ok=map.build(*limb,voxelSize,samples>0?samples:0,threads,seed);
+    double t1=Time::now();
+    delete limb;
+
+    if (!ok)
+    {
+        printf("failed to build the map\n");
+        return 1;
+    }
+
+    printf("%d voxels of %g [m] occupied in %g [s]\n",
+           (int)map.getNumVoxels(),voxelSize,t1-t0);
+
+    if (!map.save(fileName))
+    {
+        printf("failed to save the map to %s\n",fileName.c_str());
+        return 1;
+    }
+
+    printf("map saved to %s\n",fileName.c_str());
+    return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+*/
+
+/**
+\defgroup icub_sharedCanBenchmark sharedCanBenchmark
+@ingroup icub_tools
+
+Measures the dispatch throughput of the \e sharedcan device when
+many devices share the same bus.
+
+\section intro_sec Description
+The tool opens a \e sharedcan bus on top of a \e fakecan device
+with a given number of virtual boards. Every board sends its
+broadcast frames at a fixed period and is listened to by its own
+access point, which requests the broadcast ids of the board, as
+done by the analog sensors and the motion control devices. The
+tool reports the rate of the frames delivered to the access
+points against the rate produced by the boards, and the latency
+of the echo of the frames written by one access point towards
+all the others.
+
+\section lib_sec Libraries
+- YARP libraries.
+- The \e sharedcan and \e fakecan devices.
+
+\section parameters_sec Parameters
+--boards \e num
+- the number of virtual boards, each with its own access point
+  (default 15, max 15, as the board address takes 4 bits of the
+  broadcast ids).
+
+--period \e ms
+- the period of the broadcasts of the virtual boards (default 1).
+
+--busPeriod \e ms
+- the period of the reception thread of the shared bus (default 1).
+
+--duration \e s
+- the duration of the reception test (default 5).
+
+--burst \e num
+- the number of frames written at once in the echo test (default 64).
+
+--writes \e num
+- the number of writes timed in the echo test (default 1000).
+
+\section tested_os_sec Tested OS
+Linux.
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/CanBusInterface.h>
+
+#include <canControlConstants.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::dev;
+
+namespace
+{
+    const int BUFFER_SIZE=500;
+
+    /********************************************************************/
+    struct AccessPoint
+    {
+        PolyDriver driver;
+        ICanBus *bus;
+        ICanBufferFactory *factory;
+        CanBuffer buffer;
+        unsigned long received;
+    };
+
+    /********************************************************************/
+    unsigned long drain(vector<AccessPoint*> &aps)
+    {
+        unsigned long frames=0;
+        for (size_t i=0; i<aps.size(); i++)
+        {
+            unsigned int n=0;
+            aps[i]->bus->canRead(aps[i]->buffer,BUFFER_SIZE,&n,false);
+            aps[i]->received+=n;
+            frames+=n;
+        }
+        return frames;
+    }
+
+    /********************************************************************/
+    void report(const string &name, vector<double> &lat)
+    {
+        sort(lat.begin(),lat.end());
+        double mean=0.0;
+        for (size_t i=0; i<lat.size(); i++)
+            mean+=lat[i];
+        mean/=lat.size();
+
+        printf("%-10s mean %8.2f [us]  median %8.2f [us]  p99 %8.2f [us]  max %8.2f [us]\n",
+               name.c_str(),1e6*mean,1e6*lat[lat.size()/2],
+               1e6*lat[(size_t)(0.99*(lat.size()-1))],1e6*lat.back());
+    }
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Network::init();
+
+    Property opt;
+    opt.fromCommand(argc,argv);
+
+    int boards=std::min(std::max(opt.check("boards",Value(15)).asInt(),1),15);
+    int period=std::max(opt.check("period",Value(1)).asInt(),1);
+    int busPeriod=std::max(opt.check("busPeriod",Value(1)).asInt(),1);
+    double duration=std::max(opt.check("duration",Value(5.0)).asDouble(),0.1);
+    int burst=std::min(std::max(opt.check("burst",Value(64)).asInt(),1),BUFFER_SIZE);
+    int writes=std::max(opt.check("writes",Value(1000)).asInt(),1);
+
+    string addresses;
+    for (int b=1; b<=boards; b++)
+        addresses+=" "+std::to_string(b);
+
+    Property config;
+    config.fromString("(device sharedcan) (physDevice fakecan) (canDeviceNum 0)"
+                      " (canRxQueueSize "+std::to_string(BUFFER_SIZE)+")"
+                      " (GENERAL (Joints "+std::to_string(2*boards)+"))"
+                      " (CAN (CanAddresses"+addresses+")"
+                      " (FakeBoardPeriod "+std::to_string(period)+")"
+                      " (sharedCanPeriod "+std::to_string(busPeriod)+"))");
+
+    vector<AccessPoint*> aps;
+    for (int b=1; b<=boards; b++)
+    {
+        AccessPoint *ap=new AccessPoint;
+        if (!ap->driver.open(config) || !ap->driver.view(ap->bus) || !ap->driver.view(ap->factory))
+        {
+            printf("unable to open the access point of board %d\n",b);
+            delete ap;
+            break;
+        }
+        ap->buffer=ap->factory->createBuffer(BUFFER_SIZE);
+        ap->received=0;
+        for (int msg=0; msg<16; msg++)
+            ap->bus->canIdAdd(bcastId(b,msg));
+        aps.push_back(ap);
+    }
+
+    if ((int)aps.size()==boards)
+    {
+        printf("receiving the broadcasts of %d boards (period %d [ms], bus period %d [ms]) for %g [s] ...\n",
+               boards,period,busPeriod,duration);
+
+        drain(aps);
+        for (size_t i=0; i<aps.size(); i++)
+            aps[i]->received=0;
+
+        // the fake boards send the position and the status broadcasts at each period
+        unsigned long frames=0;
+        double t0=Time::now();
+        while (Time::now()-t0<duration)
+        {
+            Time::delay(0.001*busPeriod);
+            frames+=drain(aps);
+        }
+        double elapsed=Time::now()-t0;
+
+        unsigned long minReceived=aps[0]->received;
+        for (size_t i=1; i<aps.size(); i++)
+            minReceived=std::min(minReceived,aps[i]->received);
+
+        printf("delivered %.0f [frames/s], produced %.0f [frames/s], slowest access point %.0f [frames/s]\n",
+               frames/elapsed,2.0*boards*1000.0/period,minReceived/elapsed);
+
+        printf("timing %d writes of %d frames echoed to the other access points ...\n",writes,burst);
+
+        AccessPoint *writer=aps[0];
+        CanBuffer out=writer->factory->createBuffer(burst);
+        vector<double> lat;
+        lat.reserve(writes);
+        for (int w=0; w<writes; w++)
+        {
+            for (int m=0; m<burst; m++)
+            {
+                int board=1+(w*burst+m)%boards;
+                out[m].setId(bcastId(board,0xf));
+                out[m].setLen(0);
+            }
+
+            unsigned int sent=0;
+            double t1=Time::now();
+            writer->bus->canWrite(out,burst,&sent);
+            lat.push_back((Time::now()-t1)/burst);
+
+            drain(aps);
+        }
+        report("echo/frame",lat);
+        writer->factory->destroyBuffer(out);
+    }
+
+    for (size_t i=0; i<aps.size(); i++)
+    {
+        aps[i]->factory->destroyBuffer(aps[i]->buffer);
+        aps[i]->driver.close();
+        delete aps[i];
+    }
+
+    Network::fini();
+    return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2006-2020 Istituto Italiano di Tecnologia (IIT)
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms of the
+ * BSD-3-Clause license. See the accompanying LICENSE file for details.
+*/
+
+/**
+\defgroup icub_socketCanLoopback socketCanLoopback
+@ingroup icub_tools
+
+Checks the \e socketcan device end to end on a virtual CAN
+interface and measures its throughput.
+
+\section intro_sec Description
+The tool opens two \e socketcan devices on the same interface,
+which is meant to be a virtual one (vcan), so that the frames
+written by the first device are looped back to the second one.
+The frames are written in batches and every frame carries its
+sequence number in the payload, with an id and a length which
+change with the sequence number. The reader checks that all the
+frames arrive, in order and unaltered, and the tool reports the
+frames per second and the latency of a batch from the write to
+the reception of its last frame.
+
+The virtual interface can be set up with:
+\code
+sudo modprobe vcan
+sudo ip link add dev vcan0 type vcan
+sudo ip link set up vcan0
+\endcode
+
+\section lib_sec Libraries
+- YARP libraries.
+- The \e socketcan device.
+
+\section parameters_sec Parameters
+--device \e name
+- the interface (default vcan0).
+
+--frames \e num
+- the number of frames to send (default 100000).
+
+--batch \e num
+- the number of frames written and read at once (default 64).
+
+--queue \e num
+- the length of the rx and tx queues of the devices, in frames
+  (default 2047).
+
+\section tested_os_sec Tested OS
+Linux.
+*/
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Time.h>
+#include <yarp/dev/PolyDriver.h>
+#include <yarp/dev/CanBusInterface.h>
+
+using namespace std;
+using namespace yarp::os;
+using namespace yarp::dev;
+
+namespace
+{
+    /********************************************************************/
+    struct Endpoint
+    {
+        PolyDriver driver;
+        ICanBus *bus;
+        ICanBufferFactory *factory;
+        CanBuffer buffer;
+    };
+
+    /********************************************************************/
+    bool openEndpoint(Endpoint &ep, const string &device, const int queue, const int batch)
+    {
+        Property config;
+        config.put("device","socketcan");
+        config.put("CanDeviceName",device);
+        config.put("CanRxQueue",queue);
+        config.put("CanTxQueue",queue);
+        config.put("CanRxTimeout",100);
+        config.put("CanTxTimeout",100);
+
+        if (!ep.driver.open(config) || !ep.driver.view(ep.bus) || !ep.driver.view(ep.factory))
+            return false;
+
+        ep.buffer=ep.factory->createBuffer(batch);
+        return true;
+    }
+
+    /********************************************************************/
+    void closeEndpoint(Endpoint &ep)
+    {
+        if (ep.driver.isValid())
+        {
+            ep.factory->destroyBuffer(ep.buffer);
+            ep.driver.close();
+        }
+    }
+
+    /********************************************************************/
+    // the frame with sequence number seq
+    unsigned int frameId(const unsigned int seq)  { return seq&0x7ff; }
+    unsigned char frameLen(const unsigned int seq) { return 4+(seq%5); }
+
+    /********************************************************************/
+    void fillFrame(CanMessage &m, const unsigned int seq)
+    {
+        m.setId(frameId(seq));
+        m.setLen(frameLen(seq));
+        unsigned char *data=m.getData();
+        for (int k=0; k<8; k++)
+            data[k]=(k<4)?(unsigned char)((seq>>(8*k))&0xff):(unsigned char)(0xa0+k);
+    }
+
+    /********************************************************************/
+    bool checkFrame(CanMessage &m, const unsigned int seq)
+    {
+        if ((m.getId()!=frameId(seq)) || (m.getLen()!=frameLen(seq)))
+            return false;
+
+        const unsigned char *data=m.getData();
+        for (int k=0; k<m.getLen(); k++)
+        {
+            unsigned char expected=(k<4)?(unsigned char)((seq>>(8*k))&0xff):(unsigned char)(0xa0+k);
+            if (data[k]!=expected)
+                return false;
+        }
+        return true;
+    }
+
+    /********************************************************************/
+    void report(const string &name, vector<double> &lat)
+    {
+        sort(lat.begin(),lat.end());
+        double mean=0.0;
+        for (size_t i=0; i<lat.size(); i++)
+            mean+=lat[i];
+        mean/=lat.size();
+
+        printf("%-10s mean %8.2f [us]  median %8.2f [us]  p99 %8.2f [us]  max %8.2f [us]\n",
+               name.c_str(),1e6*mean,1e6*lat[lat.size()/2],
+               1e6*lat[(size_t)(0.99*(lat.size()-1))],1e6*lat.back());
+    }
+}
+
+
+/************************************************************************/
+int main(int argc, char *argv[])
+{
+    Network::init();
+
+    Property opt;
+    opt.fromCommand(argc,argv);
+
+    string device=opt.check("device",Value("vcan0")).asString();
+    int frames=std::max(opt.check("frames",Value(100000)).asInt(),1);
+    int batch=std::max(opt.check("batch",Value(64)).asInt(),1);
+    int queue=std::max(opt.check("queue",Value(2047)).asInt(),batch);
+
+    Endpoint writer,reader;
+    if (!openEndpoint(writer,device,queue,batch) || !openEndpoint(reader,device,queue,batch))
+    {
+        printf("unable to open socketcan on %s, is the interface up?\n",device.c_str());
+        closeEndpoint(writer);
+        closeEndpoint(reader);
+        Network::fini();
+        return 1;
+    }
+
+    printf("looping back %d frames in batches of %d on %s ...\n",frames,batch,device.c_str());
+
+    vector<double> lat;
+    lat.reserve(frames/batch+1);
+    unsigned int sent=0,received=0,errors=0;
+    bool lost=false;
+
+    double t0=Time::now();
+    while ((int)sent<frames)
+    {
+        unsigned int n=std::min(batch,frames-(int)sent);
+        for (unsigned int i=0; i<n; i++)
+            fillFrame(writer.buffer[i],sent+i);
+
+        double t1=Time::now();
+        unsigned int written=0;
+        if (!writer.bus->canWrite(writer.buffer,n,&written,true) || (written!=n))
+        {
+            printf("write failed after %u frames\n",sent+written);
+            sent+=written;
+            break;
+        }
+        sent+=n;
+
+        // the whole batch is read back before the next one is written
+        while (received<sent)
+        {
+            unsigned int got=0;
+            if (!reader.bus->canRead(reader.buffer,batch,&got,true) || (got==0))
+            {
+                lost=true;
+                break;
+            }
+
+            for (unsigned int i=0; i<got; i++)
+                if (!checkFrame(reader.buffer[i],received+i))
+                    errors++;
+            received+=got;
+        }
+        if (lost)
+            break;
+
+        lat.push_back(Time::now()-t1);
+    }
+    double elapsed=Time::now()-t0;
+
+    bool ok=!lost && (errors==0) && (received==sent) && ((int)sent==frames);
+    printf("sent %u, received %u, corrupted or out of order %u: %s\n",sent,received,errors,
+           ok?"OK":"FAILED");
+    if (!lat.empty())
+    {
+        printf("throughput %.0f [frames/s]\n",received/elapsed);
+        report("batch",lat);
+    }
+
+    closeEndpoint(writer);
+    closeEndpoint(reader);
+
+    Network::fini();
+    return (ok?0:1);
+}